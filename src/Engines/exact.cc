@@ -2,6 +2,7 @@
 #include "exact.h"
 
 #include "../Options/options.h"
+#include "../Options/optman.h"
 
 #include "../ExprLib/startup.h"
 #include "../ExprLib/exprman.h"
@@ -21,6 +22,8 @@
 #include "../_LSLib/lslib.h"
 #include "../_Timer/timerlib.h"
 
+#include <vector>
+
 // **************************************************************************
 // *                                                                        *
 // *                           exact_mcmsr  class                           *
@@ -38,12 +41,81 @@ public:
   virtual bool AppliesToModelType(hldsm::model_type) const;
 protected:
 
+  /**
+      Per-state values of measure expressions.
+      Each expression is evaluated once in each reachable state,
+      and its values are kept for later measures with the same
+      expression (e.g., one expression at several time points),
+      so that computing a measure is just a dot product.
+      As with visiting states, the expression is evaluated only
+      in states with nonzero probability; the other values are
+      computed when a later measure needs them.
+      At most max_vectors are kept (by default, two: each one
+      is as large as the solution vector); the oldest is discarded
+      before a new one is allocated, and all of them are discarded
+      if there is not enough memory for a new one.
+  */
+  class reward_cache {
+  public:
+    struct entry {
+      const expr* rhs;
+      /// Value in each state; 0 where not known.
+      double* values;
+      /// Which values are known.
+      std::vector <bool> known;
+    };
+  private:
+    class fill_visitor : public state_lldsm::state_visitor {
+      measure* m;
+      const double* p;
+      entry &e;
+      bool is_bool;
+      result tmp;
+    public:
+      long strange_index;
+      result strange;
+      fill_visitor(const hldsm* mdl, measure* m, const double* p,
+        entry &e, bool b);
+      virtual bool canSkipIndex();
+      virtual bool visit();
+    };
+    const hldsm* mdl;
+    const stochastic_lldsm* proc;
+    long num_states;
+    std::vector <entry> entries;
+  public:
+    static long max_vectors;
+  public:
+    reward_cache(const hldsm* mdl, const stochastic_lldsm* proc);
+    ~reward_cache();
+
+    /** Values of the expression of measure m in each state
+        with nonzero probability, computing them if necessary.
+          @param  p   Probability of each state.
+          @param  si  Output: the first state whose value is not
+                      a normal one, or -1 if all are normal.
+          @param  sv  Output: the value in state si.
+          @return   0 if the values cannot be cached; the measure
+                    must then be computed state by state.
+                    If si is not -1, the measure must also be
+                    computed state by state, using the known values.
+    */
+    const entry* get(measure* m, const double* p, long &si, result &sv);
+  };
+
   class msr_visitor : public state_lldsm::state_visitor {
   protected:
     measure *m;
     double* &p;
     // If proc is non-zero, then measure is infinity for recurrent states.
     const stochastic_lldsm::process* proc;
+    // If non-zero, use this for the values of the measure expression.
+    reward_cache* cache;
+    // If non-zero, values already computed while visiting states.
+    const reward_cache::entry* known;
+    // State and value, from the cache, that are not normal.
+    long strange_index;
+    result strange;
     result tmp;
     result ans;
   public:
@@ -51,6 +123,9 @@ protected:
     void infinity_on_recurrent(const stochastic_lldsm::process* _proc) {
       proc = _proc;
     }
+    void useCache(reward_cache* c) {
+      cache = c;
+    }
     inline void newMsr(measure* _m) {
       m = _m;
       m->PrecomputeRHS();
@@ -59,6 +134,38 @@ protected:
     inline void finish() {
       m->SetValue(ans);
     }
+    /// Compute measure _m; from the cache if we can, otherwise visit states.
+    inline void solve(const stochastic_lldsm* sp, measure* _m) {
+      DCASSERT(sp);
+      newMsr(_m);
+      known = cache ? cache->get(m, p, strange_index, strange) : 0;
+      if (known && strange_index < 0) {
+        accumulate(known->values, sp->getNumStates());
+      } else {
+        // don't evaluate again where the cache did
+        sp->visitStates(*this);
+      }
+      known = 0;
+      finish();
+    }
+    /// Compute the measure expression in the current state, into tmp.
+    inline void computeRHS(bool is_bool) {
+      const long i = x.current_state_index;
+      if (known) {
+        if (i == strange_index) {
+          tmp = strange;
+          return;
+        }
+        if (known->known[i]) {
+          if (is_bool)  tmp.setBool(known->values[i] != 0);
+          else          tmp.setReal(known->values[i]);
+          return;
+        }
+      }
+      m->ComputeRHS(x);
+    }
+    /// Same as visiting all states, using the per-state values r.
+    void accumulate(const double* r, long NS);
     virtual bool canSkipIndex() {
       return (0==p[x.current_state_index]);
     }
@@ -142,6 +249,163 @@ exact_mcmsr::msr_visitor::msr_visitor(const hldsm* mdl, double* &_p)
 {
   x.answer = &tmp;
   proc = 0;
+  cache = 0;
+  known = 0;
+  strange_index = -1;
+}
+
+void exact_mcmsr::msr_visitor::accumulate(const double* r, long NS)
+{
+  DCASSERT(r);
+  if (0==proc) {
+    //
+    // Everything is finite; plain dot product.
+    // Independent partial sums, so the loop can be pipelined.
+    //
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    long i;
+    for (i=0; i+4<=NS; i+=4) {
+      s0 += p[i] * r[i];
+      s1 += p[i+1] * r[i+1];
+      s2 += p[i+2] * r[i+2];
+      s3 += p[i+3] * r[i+3];
+    }
+    for (; i<NS; i++) {
+      s0 += p[i] * r[i];
+    }
+    ans.setReal((s0 + s1) + (s2 + s3));
+    return;
+  }
+
+  //
+  // Terms in recurrent states are infinite
+  //
+  for (long i=0; i<NS; i++) {
+    double term = p[i] * r[i];
+    if (0==term) continue;
+    if (!proc->isTransient(i)) {
+      if (ans.isInfinity()) {
+        if (ans.signInfinity() != SIGN(term)) {
+          infinitySubtract(m);
+          return;
+        }
+      } else {
+        ans.setInfinity(SIGN(term));
+      }
+    } else {
+      if (!ans.isInfinity()) {
+        ans.setReal(ans.getReal() + term);
+      }
+    }
+  }
+}
+
+// **************************************************************************
+// *                         reward_cache  methods                          *
+// **************************************************************************
+
+long exact_mcmsr::reward_cache::max_vectors;
+
+exact_mcmsr::reward_cache::fill_visitor
+::fill_visitor(const hldsm* mdl, measure* _m, const double* _p,
+  entry &_e, bool b)
+ : state_visitor(mdl), e(_e)
+{
+  x.answer = &tmp;
+  m = _m;
+  p = _p;
+  is_bool = b;
+  strange_index = -1;
+}
+
+bool exact_mcmsr::reward_cache::fill_visitor::canSkipIndex()
+{
+  const long i = x.current_state_index;
+  return (0==p[i]) || e.known[i];
+}
+
+bool exact_mcmsr::reward_cache::fill_visitor::visit()
+{
+  m->ComputeRHS(x);
+  if (!tmp.isNormal()) {
+    strange_index = x.current_state_index;
+    strange = tmp;
+    return true;
+  }
+  e.known[x.current_state_index] = true;
+  if (is_bool) {
+    e.values[x.current_state_index] = tmp.getBool() ? 1.0 : 0.0;
+  } else {
+    e.values[x.current_state_index] = tmp.getReal();
+  }
+  return false;
+}
+
+exact_mcmsr::reward_cache
+::reward_cache(const hldsm* m, const stochastic_lldsm* p)
+{
+  mdl = m;
+  proc = p;
+  DCASSERT(proc);
+  num_states = proc->getNumStates();
+}
+
+exact_mcmsr::reward_cache::~reward_cache()
+{
+  for (unsigned i=0; i<entries.size(); i++) {
+    free(entries[i].values);
+  }
+}
+
+const exact_mcmsr::reward_cache::entry*
+exact_mcmsr::reward_cache::get(measure* m, const double* p, long &si,
+  result &sv)
+{
+  DCASSERT(m);
+  DCASSERT(p);
+  si = -1;
+  if (max_vectors < 1 || num_states < 1) return 0;
+  const expr* rhs = m->GetRHS();
+  if (0==rhs) return 0;
+  unsigned i;
+  for (i=0; i<entries.size(); i++) {
+    if (entries[i].rhs == rhs) break;
+  }
+
+  if (i >= entries.size()) {
+    //
+    // New expression; make room for it
+    //
+    while (long(entries.size()) >= max_vectors) {
+      free(entries[0].values);
+      entries.erase(entries.begin());
+    }
+    entry e;
+    e.rhs = rhs;
+    e.values = (double*) calloc(num_states, sizeof(double));
+    while (0==e.values && !entries.empty()) {
+      // give the memory of older vectors back, and try again
+      free(entries[0].values);
+      entries.erase(entries.begin());
+      e.values = (double*) calloc(num_states, sizeof(double));
+    }
+    if (0==e.values) return 0;
+    e.known.assign(num_states, false);
+    entries.push_back(e);
+    i = entries.size()-1;
+  }
+
+  //
+  // Evaluate it where needed
+  //
+  entry &e = entries[i];
+  const type* mt = m->RHSType();
+  DCASSERT(mt);
+  fill_visitor fv(mdl, m, p, e, mt->getBaseType() == em->BOOL);
+  proc->visitStates(fv);
+  si = fv.strange_index;
+  sv = fv.strange;
+  return &e;
 }
 
 // **************************************************************************
@@ -157,7 +421,7 @@ bool exact_mcmsr::realmsr_visitor::visit()
 {
   DCASSERT(m->RHSType());
   DCASSERT(m->RHSType()->getBaseType() == em->REAL);
-  m->ComputeRHS(x);
+  computeRHS(false);
   if (tmp.isNormal()) {
     double term = p[x.current_state_index] * tmp.getReal();
     if (0==term) return false;
@@ -214,7 +478,7 @@ bool exact_mcmsr::boolmsr_visitor::visit()
 {
   DCASSERT(m->RHSType());
   DCASSERT(m->RHSType()->getBaseType() == em->BOOL);
-  m->ComputeRHS(x);
+  computeRHS(true);
   if (tmp.isNormal()) {
     if (false == tmp.getBool()) return false;
     if (proc && !proc->isTransient(x.current_state_index)) {
@@ -324,6 +588,9 @@ void mcex_steady::SolveMeasures(hldsm* mdl, set_of_measures* list)
   if (ok) {
     realmsr_visitor rv(mdl, p);
     boolmsr_visitor bv(mdl, p);
+    reward_cache rc(mdl, proc);
+    rv.useCache(&rc);
+    bv.useCache(&rc);
     long count = 0;
     timer w;
     if (startMsrs("steady-state", mdl->Name())) {
@@ -350,16 +617,12 @@ void mcex_steady::SolveMeasures(hldsm* mdl, set_of_measures* list)
       const type* mt = m->RHSType();
       if (mt) mt = mt->getBaseType();
       if (mt == em->REAL) {
-        rv.newMsr(m);
-        proc->visitStates(rv);
-        rv.finish();
+        rv.solve(proc, m);
         count++;
         continue;
       }
       if (mt == em->BOOL) {
-        bv.newMsr(m);
-        proc->visitStates(bv);
-        bv.finish();
+        bv.solve(proc, m);
         count++;
         continue;
       }
@@ -387,11 +650,16 @@ void mcex_steady::SolveMeasures(hldsm* mdl, set_of_measures* list)
 // **************************************************************************
 
 class mcex_trans : public exact_mcmsr {
+public:
+  /// Number of distinct times solved together.
+  static long batch_times;
 public:
   mcex_trans();
   virtual void SolveMeasures(hldsm* m, set_of_measures* list);
 };
 
+long mcex_trans::batch_times;
+
 mcex_trans the_mcex_trans;
 
 // **************************************************************************
@@ -442,63 +710,113 @@ void mcex_trans::SolveMeasures(hldsm* mdl, set_of_measures* list)
   statedist* initial = proc->getInitialDistribution();
   initial->ExportTo(p);
   Delete(initial);
-  realmsr_visitor rv(mdl, p);
-  boolmsr_visitor bv(mdl, p);
-
-  // go through measures
+  double* cur = p;
+  realmsr_visitor rv(mdl, cur);
+  boolmsr_visitor bv(mdl, cur);
+  reward_cache rc(mdl, proc);
+  rv.useCache(&rc);
+  bv.useCache(&rc);
+
+  // grab the measures, in time order
+  std::vector <time_measure*> msrs;
   for (measure* m = list->popMeasure(); m; m=list->popMeasure()) {
-    if (!ok) break;
     time_measure* tm = smart_cast <time_measure*> (m);
     DCASSERT(tm);
-    double dt = tm->GetTime() - last_time;
-    DCASSERT(dt >= 0);
-    if (dt) {
-      dist = 0;
-      if (eng_debug.startReport()) {
-        eng_debug.report() << "time = " << tm->GetTime();
-        eng_debug.report() << ", delta = " << dt << "\n";
-        eng_debug.stopIO();
+    msrs.push_back(tm);
+  }
+
+  //
+  // Go through measures, solving up to batch_times distinct
+  // times at once.  The distribution at the last time of a batch
+  // becomes the starting point for the next batch.
+  //
+  std::vector <double> times;
+  std::vector <double*> dists;
+  std::vector <long> first;   // first[k]: first measure with times[k]
+  size_t i = 0;
+  while (ok && i < msrs.size()) {
+    times.clear();
+    first.clear();
+    size_t j;
+    for (j=i; j<msrs.size(); j++) {
+      double dt = msrs[j]->GetTime() - last_time;
+      DCASSERT(dt >= 0);
+      if (times.size() && dt == times.back()) continue;
+      if (long(times.size()) >= MAX(1L, batch_times)) break;
+      times.push_back(dt);
+      first.push_back(j);
+    }
+    first.push_back(j);
+    while (dists.size() < times.size()) {
+      double* d = 0;
+      if (NS) {
+        d = (double*) malloc(NS * sizeof(double));
+        if (0==d) break;
       }
-      ok = proc->computeTransient(dt, p, aux1, aux2);
-      last_time = tm->GetTime();
-      if (!ok) break;
-    } // if dt
-    if (em->STATEDIST == m->Type()) {
-        //
-        // This is a distribution measure, just copy it!
-        //
-        result v;
-        if (0==dist) {
-          dist = new statedist(proc, p, NS);
-          v.setPtr(dist);
-        } else {
-          v.setPtr(Share(dist));
-        }
-        m->SetValue(v);
-        continue;
+      dists.push_back(d);
     }
-    //
-    // Ordinary measure, compute it
-    //
-    const type* mt = tm->RHSType();
-    if (mt) mt = mt->getBaseType();
-    if (mt == em->REAL) {
-      rv.newMsr(m);
-      proc->visitStates(rv);
-      rv.finish();
-      continue;
+    if (dists.size() < times.size()) {
+      if (dists.empty()) {
+        ok = false;
+        break;
+      }
+      // Not enough memory for the whole batch; use what we have
+      times.resize(dists.size());
+      first.resize(dists.size()+1);
     }
-    if (mt == em->BOOL) {
-      bv.newMsr(m);
-      proc->visitStates(bv);
-      bv.finish();
-      continue;
+    if (eng_debug.startReport()) {
+      eng_debug.report() << "times = " << last_time + times.front();
+      eng_debug.report() << " .. " << last_time + times.back();
+      eng_debug.report() << " (" << times.size() << " distinct)\n";
+      eng_debug.stopIO();
     }
-    //
-    // Some kind of error, null failsafe
-    //
-    m->SetNull();
-  } // for m
+    ok = proc->computeTransients(times.data(), int(times.size()), p,
+                                  dists.data(), aux1, aux2);
+    if (!ok) break;
+    last_time = msrs[first.back()-1]->GetTime();
+
+    for (size_t k=0; k<times.size(); k++) {
+      cur = dists[k];
+      dist = 0;
+      for (long mi=first[k]; mi<first[k+1]; mi++) {
+        time_measure* tm = msrs[mi];
+        if (em->STATEDIST == tm->Type()) {
+          //
+          // This is a distribution measure, just copy it!
+          //
+          result v;
+          if (0==dist) {
+            dist = new statedist(proc, cur, NS);
+            v.setPtr(dist);
+          } else {
+            v.setPtr(Share(dist));
+          }
+          tm->SetValue(v);
+          continue;
+        }
+        //
+        // Ordinary measure, compute it
+        //
+        const type* mt = tm->RHSType();
+        if (mt) mt = mt->getBaseType();
+        if (mt == em->REAL) {
+          rv.solve(proc, tm);
+          continue;
+        }
+        if (mt == em->BOOL) {
+          bv.solve(proc, tm);
+          continue;
+        }
+        //
+        // Some kind of error, null failsafe
+        //
+        tm->SetNull();
+      } // for mi
+    } // for k
+    SWAP(p, dists[times.size()-1]);
+    i = first.back();
+  } // while i
+  for (size_t k=0; k<dists.size(); k++) free(dists[k]);
   free(p);
   free(aux1);
   free(aux2);
@@ -573,6 +891,9 @@ void mcex_acc::SolveMeasures(hldsm* mdl, set_of_measures* list)
   Delete(initial);
   realmsr_visitor rv(mdl, n);
   boolmsr_visitor bv(mdl, n);
+  reward_cache rc(mdl, proc);
+  rv.useCache(&rc);
+  bv.useCache(&rc);
 
   // go through measures
   for (measure* m = list->popMeasure(); m; m=list->popMeasure()) {
@@ -600,15 +921,11 @@ void mcex_acc::SolveMeasures(hldsm* mdl, set_of_measures* list)
     const type* mt = tm->RHSType();
     if (mt) mt = mt->getBaseType();
     if (mt == em->REAL) {
-      rv.newMsr(m);
-      proc->visitStates(rv);
-      rv.finish();
+      rv.solve(proc, m);
       continue;
     }
     if (mt == em->BOOL) {
-      bv.newMsr(m);
-      proc->visitStates(bv);
-      bv.finish();
+      bv.solve(proc, m);
       continue;
     }
     m->SetNull();
@@ -693,6 +1010,9 @@ void mcex_infacc::SolveMeasures(hldsm* mdl, set_of_measures* list)
   rv.infinity_on_recurrent(proc->getPROC());
   boolmsr_visitor bv(mdl, n);
   bv.infinity_on_recurrent(proc->getPROC());
+  reward_cache rc(mdl, proc);
+  rv.useCache(&rc);
+  bv.useCache(&rc);
 
   // go through measures
   for (measure* m = list->popMeasure(); m; m=list->popMeasure()) {
@@ -720,15 +1040,11 @@ void mcex_infacc::SolveMeasures(hldsm* mdl, set_of_measures* list)
     const type* mt = tm->RHSType();
     if (mt) mt = mt->getBaseType();
     if (mt == em->REAL) {
-      rv.newMsr(m);
-      proc->visitStates(rv);
-      rv.finish();
+      rv.solve(proc, m);
       continue;
     }
     if (mt == em->BOOL) {
-      bv.newMsr(m);
-      proc->visitStates(bv);
-      bv.finish();
+      bv.solve(proc, m);
       continue;
     }
     m->SetNull();
@@ -999,6 +1315,7 @@ init_exactengines::init_exactengines() : initializer("init_exactengines")
 {
   usesResource("em");
   usesResource("engtypes");
+  buildsResource("exactengines");
 }
 
 bool init_exactengines::execute()
@@ -1026,6 +1343,24 @@ bool init_exactengines::execute()
 
   exact_mcmsr::ProcessGeneration = em->findEngineType("ProcessGeneration");
 
+  mcex_trans::batch_times = 16;
+  if (em->OptMan()) {
+    em->OptMan()->addIntOption(
+      "TransientBatchTimes",
+      "Maximum number of distinct time points solved together by the exact transient engine.  For CTMCs, the distributions at these times are obtained from a single uniformization pass, at about the cost of the largest time.  Each time point needs one real per state.",
+      mcex_trans::batch_times, 1, 1000000
+    );
+  }
+
+  exact_mcmsr::reward_cache::max_vectors = 2;
+  if (em->OptMan()) {
+    em->OptMan()->addIntOption(
+      "MeasureCacheVectors",
+      "Maximum number of per-state measure value vectors kept by the exact numerical engines, so that measures with the same expression (for instance, at several time points) are evaluated over the reachable states only once.  Each vector needs one real per state, as much as the solution vector; older vectors are discarded when there is not enough memory for a new one.  Use 0 to evaluate every measure state by state.",
+      exact_mcmsr::reward_cache::max_vectors, 0, 1000000
+    );
+  }
+
   return true;
 }
 
@@ -14,6 +14,7 @@
 
 // Generation templates
 #include "gen_templ.h"
+#include "gen_templ_mt.h"
 
 // External libs
 #include "../_StateLib/statelib.h"
@@ -23,6 +24,11 @@
 #include "../_Timer/timerlib.h"
 #include "../_StateLib/lchild_rsiblingt.h"
 
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
 // **************************************************************************
 // *                                                                        *
 // *                         indexed_statedbs class                         *
@@ -65,11 +71,21 @@ public:
 		id = db.InsertState(s->readState(), s->getStateSize());
 		return id >= oldsize;
 	}
+	inline bool concurrentTangibles() const {
+		return tandb.IsConcurrent();
+	}
+	inline bool addTangibleConcurrently(const shared_state* s, long &id) {
+		bool is_new;
+		id = tandb.InsertNewState(s->readState(), s->getStateSize(), is_new);
+		return is_new;
+	}
+	inline static void finishTangibles() {
+	}
 	inline bool hasUnexploredVanishing() const {
 		return van_unexp < vandb.Size();
 	}
 	inline bool hasUnexploredTangible() const {
-		return tan_unexp < tandb.Size();
+		return tan_unexp < tandb.ReadySize();
 	}
 	inline long getUnexploredVanishing(shared_state* s) {
 		DCASSERT(s);
@@ -86,6 +102,9 @@ public:
 			debug.report() << "Eliminating vanishing states\n";
 			debug.stopIO();
 		}
+		resetVanishing();
+	}
+	inline void resetVanishing() {
 		vandb.Clear();
 		van_unexp = 0;
 	}
@@ -128,6 +147,361 @@ indexed_statedbs::indexed_statedbs(StateLib::state_db &tdb,
 	tan_unexp = van_unexp = 0;
 }
 
+// **************************************************************************
+// *                                                                        *
+// *                           ddd_statedbs class                           *
+// *                                                                        *
+// **************************************************************************
+
+/**
+ States only, with delayed duplicate detection.
+ Reached tangible states are not looked up as they are found;
+ instead they are collected in memory, and written to disk as
+ sorted runs without duplicates.  Once the current breadth-first
+ layer is explored, the runs are merged against a sorted file of
+ all visited states, and the states not seen before are written
+ to a file that holds the next layer.
+ Thus, the duplicate checks are done by sequential file access only,
+ and tangible states are kept on disk during generation.
+ Since we do not know if a reached state is new until the merge,
+ add() reports tangible states as not new, and assertions are
+ checked for the new states during the merge instead.
+ Runs are merged with a heap over the run heads.  To bound the
+ number of open files, whenever MAX_FANIN runs of the same level
+ exist, they are merged into one run of the next level.
+ Once generation is done, finish() fills the tangible database
+ from the visited states, in lexical order of their encodings.
+ Vanishing states are handled as usual, in memory.
+ */
+struct ddd_statedbs: public indexed_statedbs {
+	/// For checking assertions on new states.
+	dsde_hlm &dsm;
+	/// Maximum number of states in the buffer.
+	const long run_states;
+	/// Number of integers per state; 0 until the first state is added.
+	int ssize;
+	/// Buffer of reached tangible states.
+	std::vector<int> buffer;
+	/// Number of states in the buffer.
+	long buffered;
+	/// Maximum number of runs merged at once, before the layer merge.
+	static const int MAX_FANIN = 32;
+	/// Sorted runs of reached states, for the current layer.
+	std::vector<FILE*> runs;
+	/// Level of each run: a run of level L is merged from MAX_FANIN^L buffers.
+	std::vector<int> levels;
+	/// Sorted file of all visited tangible states.
+	FILE* visited;
+	/// New states found by the last merge, to be explored.
+	FILE* layer;
+	/// Number of states left to explore in the layer.
+	long layer_left;
+	/// Scratch space for checking assertions.
+	shared_state* scratch;
+	traverse_data x;
+	result xans;
+public:
+	ddd_statedbs(dsde_hlm &m, StateLib::state_db &tdb,
+			StateLib::state_db &vdb, long rs);
+	~ddd_statedbs();
+
+	inline bool add(bool van, const shared_state* s, long &id) {
+		if (van)
+			return indexed_statedbs::add(van, s, id);
+		if (0 == ssize) {
+			ssize = s->getStateSize();
+			buffer.resize(run_states * ssize);
+		} DCASSERT(s->getStateSize() == ssize);
+		memcpy(buffer.data() + buffered * ssize, s->readState(),
+				ssize * sizeof(int));
+		if (++buffered >= run_states)
+			writeRun();
+		// We don't know yet; see mergeLayer().
+		makeIllegalID(id);
+		return false;
+	}
+	inline bool hasUnexploredTangible() {
+		if (layer_left)
+			return true;
+		if (0 == buffered && runs.empty())
+			return false;
+		mergeLayer();
+		return layer_left;
+	}
+	/// Explored states are numbered in the order we explore them.
+	inline long getUnexploredTangible(shared_state* s) {
+		DCASSERT(s); DCASSERT(layer_left > 0);
+		if (!read(layer, s->writeState()))
+			throw subengine::Engine_Failed;
+		layer_left--;
+		return tan_unexp++;
+	}
+	/// Add the visited states to the tangible database.
+	void finish();
+protected:
+	/// Sort the buffer, and write it as a new run.
+	void writeRun();
+	/// Merge the last n runs, which have the same level, into one.
+	void mergeRuns(int n);
+	/**
+	 Merge the runs with the visited states; new ones
+	 are checked for assertions and become the next layer.
+	 */
+	void mergeLayer();
+
+	inline int compare(const int* a, const int* b) const {
+		for (int i = 0; i < ssize; i++) {
+			if (a[i] != b[i])
+				return (a[i] < b[i]) ? -1 : 1;
+		}
+		return 0;
+	}
+	inline void write(FILE* f, const int* s) const {
+		if (fwrite(s, sizeof(int), ssize, f) != size_t(ssize))
+			throw subengine::IO_Failed;
+	}
+	inline bool read(FILE* f, int* s) const {
+		return fread(s, sizeof(int), ssize, f) == size_t(ssize);
+	}
+	static inline FILE* newFile() {
+		FILE* f = tmpfile();
+		if (0 == f)
+			throw subengine::IO_Failed;
+		return f;
+	}
+
+	/// Reads sorted runs in order, without duplicates.
+	class run_merger {
+		const ddd_statedbs &db;
+		const std::vector<FILE*> &files;
+		const int first;
+		/// Current state of each run.
+		std::vector<int> heads;
+		/// Runs with a current state; smallest at the front.
+		std::vector<int> heap;
+	public:
+		/// Merge runs first, first+1, ..., of f.
+		run_merger(const ddd_statedbs &d, const std::vector<FILE*> &f,
+				int first);
+		/// Get the next smallest state; returns false if there is none.
+		bool next(int* s);
+		/// Did reading any run fail?
+		bool failed() const;
+	private:
+		inline int* head(int r) {
+			return heads.data() + (r - first) * db.ssize;
+		}
+		inline void advance(int r) {
+			if (!db.read(files[r], head(r)))
+				return;
+			heap.push_back(r);
+			std::push_heap(heap.begin(), heap.end(), greater(*this));
+		}
+		struct greater {
+			run_merger &m;
+			greater(run_merger &rm) : m(rm) {
+			}
+			inline bool operator()(int a, int b) const {
+				return m.db.compare(m.head(a), m.head(b)) > 0;
+			}
+		};
+	};
+};
+
+ddd_statedbs::run_merger::run_merger(const ddd_statedbs &d,
+		const std::vector<FILE*> &f, int fr) :
+		db(d), files(f), first(fr) {
+	heads.resize((files.size() - first) * db.ssize);
+	for (unsigned r = first; r < files.size(); r++) {
+		rewind(files[r]);
+		advance(r);
+	}
+}
+
+bool ddd_statedbs::run_merger::next(int* s) {
+	if (heap.empty())
+		return false;
+	std::pop_heap(heap.begin(), heap.end(), greater(*this));
+	int r = heap.back();
+	heap.pop_back();
+	memcpy(s, head(r), db.ssize * sizeof(int));
+	advance(r);
+	// Runs have no duplicates, so each run has s at most once
+	while (!heap.empty() && 0 == db.compare(head(heap.front()), s)) {
+		std::pop_heap(heap.begin(), heap.end(), greater(*this));
+		r = heap.back();
+		heap.pop_back();
+		advance(r);
+	}
+	return true;
+}
+
+bool ddd_statedbs::run_merger::failed() const {
+	for (unsigned r = first; r < files.size(); r++) {
+		if (ferror(files[r]))
+			return true;
+	}
+	return false;
+}
+
+ddd_statedbs::ddd_statedbs(dsde_hlm &m, StateLib::state_db &tdb,
+		StateLib::state_db &vdb, long rs) :
+		indexed_statedbs(tdb, vdb), dsm(m), run_states(rs),
+		x(traverse_data::Compute) {
+	ssize = 0;
+	buffered = 0;
+	visited = 0;
+	layer = 0;
+	layer_left = 0;
+	scratch = new shared_state(&m);
+	x.answer = &xans;
+	x.current_state = scratch;
+}
+
+ddd_statedbs::~ddd_statedbs() {
+	for (unsigned r = 0; r < runs.size(); r++)
+		fclose(runs[r]);
+	if (visited)
+		fclose(visited);
+	if (layer)
+		fclose(layer);
+	x.current_state = 0;
+	Delete(scratch);
+}
+
+void ddd_statedbs::finish() {
+	DCASSERT(0 == layer_left); DCASSERT(0 == buffered); DCASSERT(runs.empty());
+	if (0 == visited)
+		return;
+	rewind(visited);
+	std::vector<int> st(ssize);
+	while (read(visited, st.data())) {
+		tandb.InsertState(st.data(), ssize);
+	}
+	bool failed = ferror(visited);
+	fclose(visited);
+	visited = 0;
+	if (failed)
+		throw subengine::IO_Failed;
+	DCASSERT(tandb.Size() == tan_unexp);
+}
+
+void ddd_statedbs::writeRun() {
+	if (0 == buffered)
+		return;
+	std::vector<const int*> order(buffered);
+	for (long i = 0; i < buffered; i++)
+		order[i] = buffer.data() + i * ssize;
+	std::sort(order.begin(), order.end(),
+			[this](const int* a, const int* b) {
+				return compare(a, b) < 0;
+			});
+
+	FILE* f = newFile();
+	runs.push_back(f);
+	levels.push_back(0);
+	const int* prev = 0;
+	for (long i = 0; i < buffered; i++) {
+		if (prev && 0 == compare(prev, order[i]))
+			continue;
+		write(f, order[i]);
+		prev = order[i];
+	}
+	buffered = 0;
+
+	// Levels never increase along the runs; merge full levels.
+	for (;;) {
+		const int nr = runs.size();
+		if (nr < MAX_FANIN)
+			break;
+		if (levels[nr - MAX_FANIN] != levels[nr - 1])
+			break;
+		mergeRuns(MAX_FANIN);
+	}
+}
+
+void ddd_statedbs::mergeRuns(int n) {
+	const int first = runs.size() - n;
+	FILE* f = newFile();
+	bool failed;
+	try {
+		run_merger merge(*this, runs, first);
+		std::vector<int> curr(ssize);
+		while (merge.next(curr.data()))
+			write(f, curr.data());
+		failed = merge.failed();
+	} catch (...) {
+		fclose(f);
+		throw;
+	}
+	const int level = levels[first] + 1;
+	for (unsigned r = first; r < runs.size(); r++)
+		fclose(runs[r]);
+	runs.resize(first);
+	levels.resize(first);
+	runs.push_back(f);
+	levels.push_back(level);
+	if (failed || ferror(f))
+		throw subengine::IO_Failed;
+}
+
+void ddd_statedbs::mergeLayer() {
+	writeRun();
+
+	run_merger merge(*this, runs, 0);
+	// Current visited state
+	std::vector<int> old(ssize);
+	bool old_live = false;
+	if (visited) {
+		rewind(visited);
+		old_live = read(visited, old.data());
+	}
+
+	FILE* nv = newFile();
+	if (layer) {
+		fclose(layer);
+		layer = 0;
+	}
+	layer = newFile();
+	std::vector<int> curr(ssize);
+	while (merge.next(curr.data())) {
+		// copy smaller visited states
+		while (old_live && compare(old.data(), curr.data()) < 0) {
+			write(nv, old.data());
+			old_live = read(visited, old.data());
+		}
+
+		if (!old_live || compare(old.data(), curr.data())) {
+			// New state
+			write(nv, curr.data());
+			write(layer, curr.data());
+			layer_left++;
+			memcpy(scratch->writeState(), curr.data(), ssize * sizeof(int));
+			dsm.checkAssertions(x);
+			if (0 == xans.getBool())
+				throw subengine::Assertion_Failure;
+		}
+	}
+	while (old_live) {
+		write(nv, old.data());
+		old_live = read(visited, old.data());
+	}
+
+	bool failed = merge.failed() || (visited && ferror(visited));
+	for (unsigned r = 0; r < runs.size(); r++)
+		fclose(runs[r]);
+	runs.clear();
+	levels.clear();
+	if (visited)
+		fclose(visited);
+	visited = nv;
+	if (ferror(layer))
+		failed = true;
+	rewind(layer);
+	if (failed)
+		throw subengine::IO_Failed;
+}
+
 // **************************************************************************
 // *                                                                        *
 // *                        indexed_reachgraph class                        *
@@ -268,6 +642,14 @@ public:
 		}
 		return true;
 	}
+	inline void finishTangibles() {
+		// States added concurrently are not in the chain yet
+		try {
+			smp.addTangibles(tandb.Size() - smp.getNumTangible());
+		} catch (MCLib::error e) {
+			convert(e, "add tangible states");
+		}
+	}
 	inline static bool statesOnly() {
 		return false;
 	}
@@ -350,6 +732,7 @@ indexed_smp::indexed_smp(hldsm &m, StateLib::state_db &tdb,
 // **************************************************************************
 
 class as_procgen: public process_generator {
+protected:
 	const exp_state_lib* statelib;
 public:
 	as_procgen(const exp_state_lib* sl);
@@ -366,8 +749,8 @@ protected:
 
 	 @throw  Appropriate error code.
 	 */
-	void generateRG(dsde_hlm* m, StateLib::state_db* rss, LS_Vector &s0,
-			GraphLib::dynamic_digraph* rg) const;
+	virtual void generateRG(dsde_hlm* m, StateLib::state_db* rss,
+			LS_Vector &s0, GraphLib::dynamic_digraph* rg) const;
 
 	/** Build the reachability set and (maybe) Markov chain.
 	 @param  m   High-level model.
@@ -377,8 +760,12 @@ protected:
 
 	 @throw  Appropriate error code.
 	 */
-	void generateMC(dsde_hlm* m, StateLib::state_db* ss, LS_Vector &s0,
-			MCLib::vanishing_chain* smp) const;
+	virtual void generateMC(dsde_hlm* m, StateLib::state_db* ss,
+			LS_Vector &s0, MCLib::vanishing_chain* smp) const;
+
+	/// Extra information for the generation report, if any.
+	virtual void reportMethod(OutputStream &) const {
+	}
 
 	inline void initial_distro(const LS_Vector &init) const {
 		if (!Debug().startReport())
@@ -476,6 +863,7 @@ void as_procgen::RunEngine(hldsm* hm, result &statesonly) {
 	if (startGen(*hm, the_proc)) {
 		if (!rss->IsStatic())
 			Report().report() << " using " << statelib->getDBMethod();
+		reportMethod(Report().report());
 		Report().report() << "\n";
 		Report().stopIO();
 	}
@@ -599,12 +987,14 @@ void as_procgen::generateRG(dsde_hlm* dsm, StateLib::state_db* tandb,
 
 	if (rg) {
 		indexed_reachgraph myrg(*tandb, *vandb, *rg);
-		generateRGt<indexed_reachgraph, long>(Debug(), *dsm, myrg);
+		generateRGt<indexed_reachgraph, long>(Debug(), *dsm, myrg,
+				incremental_enabling);
 		myrg.exportInitial(s0);
 		myrg.finish();
 	} else {
 		indexed_statedbs myrs(*tandb, *vandb);
-		generateRGt<indexed_statedbs, long>(Debug(), *dsm, myrs);
+		generateRGt<indexed_statedbs, long>(Debug(), *dsm, myrs,
+				incremental_enabling);
 	}
 
 	delete vandb;
@@ -626,11 +1016,13 @@ void as_procgen::generateMC(dsde_hlm* dsm, StateLib::state_db* tandb,
 
 		switch (remove_vanishing) {
 		case BY_PATH:
-			generateMCt<indexed_smp, long>(Debug(), *dsm, mysmp);
+			generateMCt<indexed_smp, long>(Debug(), *dsm, mysmp,
+					incremental_enabling);
 			break;
 
 		case BY_SUBGRAPH:
-			generateSMPt<indexed_smp, long>(Debug(), *dsm, mysmp);
+			generateSMPt<indexed_smp, long>(Debug(), *dsm, mysmp,
+					incremental_enabling);
 			break;
 
 		default:
@@ -645,16 +1037,221 @@ void as_procgen::generateMC(dsde_hlm* dsm, StateLib::state_db* tandb,
 
 		switch (remove_vanishing) {
 		case BY_PATH:
-			generateMCt<indexed_statedbs, long>(Debug(), *dsm, myrs);
+			generateMCt<indexed_statedbs, long>(Debug(), *dsm, myrs,
+					incremental_enabling);
 			break;
 
 		case BY_SUBGRAPH:
-			generateSMPt<indexed_statedbs, long>(Debug(), *dsm, myrs);
+			generateSMPt<indexed_statedbs, long>(Debug(), *dsm, myrs,
+					incremental_enabling);
+			break;
+
+		default:
+			DCASSERT(0);
+		}
+	}
+
+	delete vandb;
+}
+
+// **************************************************************************
+// *                                                                        *
+// *                           as_procgen_mt class                          *
+// *                                                                        *
+// **************************************************************************
+
+/**
+ Multi-threaded explicit generation.
+ Worker threads share the frontier of unexplored tangible states;
+ each keeps its own vanishing states.
+ Vanishing states are always eliminated by following paths.
+ */
+class as_procgen_mt: public as_procgen {
+public:
+	as_procgen_mt(const exp_state_lib* sl);
+
+protected:
+	virtual void generateRG(dsde_hlm* m, StateLib::state_db* rss,
+			LS_Vector &s0, GraphLib::dynamic_digraph* rg) const;
+	virtual void generateMC(dsde_hlm* m, StateLib::state_db* ss,
+			LS_Vector &s0, MCLib::vanishing_chain* smp) const;
+	virtual void reportMethod(OutputStream &s) const;
+
+	inline int numThreads() const {
+		return (num_threads > 0) ? int(num_threads) : 1;
+	}
+};
+
+// **************************************************************************
+// *                          as_procgen_mt methods                         *
+// **************************************************************************
+
+as_procgen_mt::as_procgen_mt(const exp_state_lib* sl) :
+		as_procgen(sl) {
+}
+
+void as_procgen_mt::reportMethod(OutputStream &s) const {
+	s << " with " << numThreads() << " threads";
+}
+
+void as_procgen_mt::generateRG(dsde_hlm* dsm, StateLib::state_db* tandb,
+		LS_Vector &s0, GraphLib::dynamic_digraph* rg) const {
+	DCASSERT(dsm); DCASSERT(tandb);
+
+	const int nt = numThreads();
+
+	// Private vanishing sets, one per thread
+	StateLib::state_db** vandbs = new StateLib::state_db*[nt];
+	indexed_statedbs** vans = new indexed_statedbs*[nt];
+	for (int i = 0; i < nt; i++) {
+		vandbs[i] = statelib->createStateDB(true, false);
+		vans[i] = new indexed_statedbs(*tandb, *vandbs[i]);
+	}
+
+	try {
+		if (rg) {
+			indexed_reachgraph myrg(*tandb, *vandbs[0], *rg);
+			generateRGt_mt<indexed_reachgraph, indexed_statedbs, long>(Debug(),
+					*dsm, myrg, vans, nt);
+			myrg.exportInitial(s0);
+			myrg.finish();
+		} else {
+			indexed_statedbs myrs(*tandb, *vandbs[0]);
+			generateRGt_mt<indexed_statedbs, indexed_statedbs, long>(Debug(),
+					*dsm, myrs, vans, nt);
+		}
+	} catch (...) {
+		for (int i = 0; i < nt; i++) {
+			delete vans[i];
+			delete vandbs[i];
+		}
+		delete[] vans;
+		delete[] vandbs;
+		throw;
+	}
+
+	for (int i = 0; i < nt; i++) {
+		delete vans[i];
+		delete vandbs[i];
+	}
+	delete[] vans;
+	delete[] vandbs;
+}
+
+void as_procgen_mt::generateMC(dsde_hlm* dsm, StateLib::state_db* tandb,
+		LS_Vector &s0, MCLib::vanishing_chain* smp) const {
+	DCASSERT(dsm); DCASSERT(tandb);
+
+	// TBD: put these options elsewhere
+	LS_Options vansolver;
+	vansolver.method = LS_Gauss_Seidel;
+
+	// Not used, but required by the wrappers
+	StateLib::state_db* vandb = statelib->createStateDB(true, false);
+
+	try {
+		if (smp) {
+			indexed_smp mysmp(*dsm, *tandb, *vandb, vansolver, *smp);
+			generateMCt_mt<indexed_smp, long>(Debug(), *dsm, mysmp,
+					numThreads());
+			mysmp.exportInitial(s0);
+			initial_distro(s0);
+		} else {
+			indexed_statedbs myrs(*tandb, *vandb);
+			generateMCt_mt<indexed_statedbs, long>(Debug(), *dsm, myrs,
+					numThreads());
+		}
+	} catch (...) {
+		delete vandb;
+		throw;
+	}
+
+	delete vandb;
+}
+
+// **************************************************************************
+// *                                                                        *
+// *                          as_procgen_ddd class                          *
+// *                                                                        *
+// **************************************************************************
+
+/**
+ Explicit generation with delayed duplicate detection.
+ Used for the reachability set only; when the graph or
+ Markov chain is required, we build it as usual.
+ */
+class as_procgen_ddd: public as_procgen {
+public:
+	as_procgen_ddd(const exp_state_lib* sl);
+
+protected:
+	virtual void generateRG(dsde_hlm* m, StateLib::state_db* rss,
+			LS_Vector &s0, GraphLib::dynamic_digraph* rg) const;
+	virtual void generateMC(dsde_hlm* m, StateLib::state_db* ss,
+			LS_Vector &s0, MCLib::vanishing_chain* smp) const;
+	virtual void reportMethod(OutputStream &s) const;
+};
+
+// **************************************************************************
+// *                         as_procgen_ddd methods                         *
+// **************************************************************************
+
+as_procgen_ddd::as_procgen_ddd(const exp_state_lib* sl) :
+		as_procgen(sl) {
+}
+
+void as_procgen_ddd::reportMethod(OutputStream &s) const {
+	s << " with delayed duplicate detection, runs of " << ddd_run_states
+			<< " states";
+}
+
+void as_procgen_ddd::generateRG(dsde_hlm* dsm, StateLib::state_db* tandb,
+		LS_Vector &s0, GraphLib::dynamic_digraph* rg) const {
+	if (rg)
+		return as_procgen::generateRG(dsm, tandb, s0, rg);
+	DCASSERT(dsm); DCASSERT(tandb);
+
+	StateLib::state_db* vandb = statelib->createStateDB(true, false);
+
+	try {
+		ddd_statedbs myrs(*dsm, *tandb, *vandb, ddd_run_states);
+		generateRGt<ddd_statedbs, long>(Debug(), *dsm, myrs);
+		myrs.finish();
+	} catch (...) {
+		delete vandb;
+		throw;
+	}
+
+	delete vandb;
+}
+
+void as_procgen_ddd::generateMC(dsde_hlm* dsm, StateLib::state_db* tandb,
+		LS_Vector &s0, MCLib::vanishing_chain* smp) const {
+	if (smp)
+		return as_procgen::generateMC(dsm, tandb, s0, smp);
+	DCASSERT(dsm); DCASSERT(tandb);
+
+	StateLib::state_db* vandb = statelib->createStateDB(true, false);
+
+	try {
+		ddd_statedbs myrs(*dsm, *tandb, *vandb, ddd_run_states);
+
+		switch (remove_vanishing) {
+		case BY_PATH:
+			generateMCt<ddd_statedbs, long>(Debug(), *dsm, myrs);
+			break;
+
+		case BY_SUBGRAPH:
+			generateSMPt<ddd_statedbs, long>(Debug(), *dsm, myrs);
 			break;
 
 		default:
 			DCASSERT(0);
 		}
+		myrs.finish();
+	} catch (...) {
+		delete vandb;
+		throw;
 	}
 
 	delete vandb;
@@ -1052,6 +1649,10 @@ bool init_asynchgen::execute() {
 
 	// Register engines
 	RegisterSubengine(em, "ProcessGeneration", "EXPLICIT", new as_procgen(sl));
+	RegisterSubengine(em, "ProcessGeneration", "EXPLICIT_MT",
+			new as_procgen_mt(sl));
+	RegisterSubengine(em, "ProcessGeneration", "EXPLICIT_DDD",
+			new as_procgen_ddd(sl));
 //  Register Coverability engines
 	RegisterSubengine(em, "ProcessGeneration", "EXPLICITCOV",
 			new as_procgenCOV(sl));
@@ -1,5 +1,6 @@
 
 #include "gen_meddly.h"
+#include "order_base.h"
 
 #include "../Options/options.h"
 #include "../Options/optman.h"
@@ -4430,6 +4431,24 @@ meddly_procgen::makePregen(const dsde_hlm &m, meddly_reachset &ms) const
   return mvo;
 }
 
+// Dynamic reordering options, shared by all forests over the domain
+inline void setReorderPolicies(forest::policies &p)
+{
+  if (static_varorder::NEVER == static_varorder::meddly_reordering) return;
+
+  p.setDynamicReordering(static_varorder::meddly_reorder_trigger);
+  switch (static_varorder::meddly_reorder_heuristic) {
+    case static_varorder::LOWEST_INVERSION:   p.setLowestInversion(); break;
+    case static_varorder::HIGHEST_INVERSION:  p.setHighestInversion(); break;
+    case static_varorder::SINK_DOWN:          p.setSinkDown(); break;
+    case static_varorder::BRING_UP:           p.setBringUp(); break;
+    case static_varorder::LOWEST_COST:        p.setLowestCost(); break;
+    case static_varorder::LOWEST_MEMORY:      p.setLowestMemory(); break;
+    case static_varorder::RANDOM:             p.setRandom(); break;
+    case static_varorder::LARC:               p.setLARC(); break;
+  }
+}
+
 forest::policies
 meddly_procgen::buildNSFPolicies() const
 {
@@ -4447,6 +4466,7 @@ meddly_procgen::buildNSFPolicies() const
       p.setPessimistic();
       break;
   } // switch
+  setReorderPolicies(p);
 
   return p;
 }
@@ -4469,6 +4489,7 @@ meddly_procgen::buildRSSPolicies() const
       p.setPessimistic();
       break;
   } // switch
+  setReorderPolicies(p);
 
   return p;
 }
@@ -184,6 +184,10 @@ public:
     return ms.getStates();
   }
 
+  inline shared_ddedge* readCheckpoint(MEDDLY::input &s) const {
+    return ms.readCheckpoint(s);
+  }
+
   inline void setLevel_maxTokens(std::vector<long> level_to_max_tokens){
     ms.setLevel_maxTokens(level_to_max_tokens);
   }
@@ -11,6 +11,8 @@
 
 #include "../_Timer/timerlib.h"
 
+#include <thread>
+
 // **************************************************************************
 // *                                                                        *
 // *                       process_generator  methods                       *
@@ -20,6 +22,9 @@
 reporting_msg process_generator::report;
 debugging_msg process_generator::debug;
 unsigned process_generator::remove_vanishing;
+long process_generator::num_threads;
+long process_generator::ddd_run_states;
+bool process_generator::incremental_enabling;
 
 process_generator::process_generator()
  : subengine()
@@ -150,6 +155,16 @@ bool init_procgen::execute()
       "Explicit process generation"
   );
   RegisterEngine(ProcessGeneration, ExplicitProcessGenerationCOV);
+  engine* ExplicitProcessGenerationMT = new engine(
+      "EXPLICIT_MT",
+      "Multi-threaded explicit process generation; see option ProcessGenerationThreads"
+  );
+  RegisterEngine(ProcessGeneration, ExplicitProcessGenerationMT);
+  engine* ExplicitProcessGenerationDDD = new engine(
+      "EXPLICIT_DDD",
+      "Explicit process generation with delayed duplicate detection on disk; see option DelayedDuplicateRunSize"
+  );
+  RegisterEngine(ProcessGeneration, ExplicitProcessGenerationDDD);
   /*
     Vanishing elimiation styles - as an option
   */
@@ -172,6 +187,30 @@ bool init_procgen::execute()
       "Explore vanishing portions of graph, then eliminate; can handle vanishing cycles.",
       process_generator::BY_SUBGRAPH
     );
+
+    process_generator::num_threads = std::thread::hardware_concurrency();
+    if (process_generator::num_threads < 1) {
+      process_generator::num_threads = 1;
+    }
+    em->OptMan()->addIntOption(
+      "ProcessGenerationThreads",
+      "Number of threads to use for multi-threaded process generation.",
+      process_generator::num_threads, 1, 1024
+    );
+
+    process_generator::ddd_run_states = 1L << 20;
+    em->OptMan()->addIntOption(
+      "DelayedDuplicateRunSize",
+      "Number of reached states kept in memory before they are sorted and written to disk, for process generation with delayed duplicate detection.",
+      process_generator::ddd_run_states, 1, 1L << 40
+    );
+
+    process_generator::incremental_enabling = false;
+    em->OptMan()->addBoolOption(
+      "IncrementalEnabling",
+      "During explicit process generation, should a tangible state reached by firing an event re-use the enabling of the events that do not depend on it?  Saves enabling evaluations for models with many events, at the cost of memory for each unexplored state.",
+      process_generator::incremental_enabling
+    );
   }
 
 
@@ -21,6 +21,12 @@ class process_generator : public subengine {
   static debugging_msg debug;
 protected:
   static unsigned remove_vanishing;
+  /// Number of threads for multi-threaded generation.
+  static long num_threads;
+  /// Number of states per sorted run, for delayed duplicate detection.
+  static long ddd_run_states;
+  /// Should explicit generation re-use enabling from parent states?
+  static bool incremental_enabling;
 public:
   static const unsigned BY_PATH = 0;
   static const unsigned BY_SUBGRAPH = 1;
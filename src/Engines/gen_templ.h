@@ -5,6 +5,8 @@
  */
 #include "../_StateLib/lchild_rsiblingt.h"
 #include <set>
+#include <map>
+#include <vector>
 #include <string>
 
 
@@ -33,11 +35,17 @@
  void show(OutputStream &s, bool isVanishing, const UID id, const shared_state* st);
  UID  illegalID();
 
+ @param  incremental  If true, a tangible state reached from a tangible
+ state by firing event t inherits the enabling values of
+ the events whose enabling does not depend on t
+ (see dsde_hlm::buildEnablingAffects()).
+
  @throws An appropriate error code
 
  */
 template<class RG, typename UID>
-void generateRGt(debugging_msg &debug, dsde_hlm &dsm, RG &rg) {
+void generateRGt(debugging_msg &debug, dsde_hlm &dsm, RG &rg,
+		bool incremental = false) {
 	// allocate temporary states
 	shared_state* curr_st = new shared_state(&dsm);
 	shared_state* next_st = new shared_state(&dsm);
@@ -45,6 +53,12 @@ void generateRGt(debugging_msg &debug, dsde_hlm &dsm, RG &rg) {
 	// allocate list of enabled events
 	List<model_event> enabled;
 
+	// enabling values inherited by unexplored tangible states
+	std::map<UID, std::vector<signed char> > inherited;
+	std::vector<signed char> parent_values;
+	if (incremental)
+		dsm.buildEnablingAffects();
+
 	// set up traverse data and such
 	traverse_data x(traverse_data::Compute);
 	result xans;
@@ -141,10 +155,21 @@ void generateRGt(debugging_msg &debug, dsde_hlm &dsm, RG &rg) {
 			//
 			// Make enabling list
 			//
-			if (current_is_vanishing)
+			if (current_is_vanishing) {
 				dsm.makeVanishingEnabledList(x, &enabled);
-			else
+			} else if (incremental) {
+				typename std::map<UID, std::vector<signed char> >::iterator
+					known = inherited.find(exp_id);
+				if (known != inherited.end()) {
+					dsm.makeTangibleEnabledList(x, &enabled, known->second);
+					inherited.erase(known);
+				} else {
+					dsm.makeTangibleEnabledList(x, &enabled);
+				}
+				dsm.saveEnabling(parent_values);
+			} else {
 				dsm.makeTangibleEnabledList(x, &enabled);
+			}
 			if (!x.answer->isNormal()) {
 				DCASSERT(1 == enabled.Length());
 				if (dsm.StartError(0)) {
@@ -168,7 +193,7 @@ void generateRGt(debugging_msg &debug, dsde_hlm &dsm, RG &rg) {
 				//
 				next_st->fillFrom(curr_st);
 				if (t->getNextstate()) {
-					t->getNextstate()->Compute(x);
+					t->computeNextstate(x);
 				}
 				if (!xans.isNormal()) {
 					if (dsm.StartError(0)) {
@@ -203,6 +228,10 @@ void generateRGt(debugging_msg &debug, dsde_hlm &dsm, RG &rg) {
 				UID next_id;
 				bool next_is_vanishing = xans.getBool();
 				next_is_new = rg.add(next_is_vanishing, next_st, next_id);
+				if (incremental && next_is_new && !next_is_vanishing
+						&& !current_is_vanishing) {
+					dsm.inheritEnabling(t, parent_values, inherited[next_id]);
+				}
 
 				//
 				// Debug info
@@ -734,7 +763,7 @@ lchild_rsiblingt* generateCGT(debugging_msg &debug, dsde_hlm &dsm,
 					next_st->fillFrom(curr_st);
 
 					if (t->getNextstate()) {
-						t->getNextstate()->Compute(x);
+						t->computeNextstate(x);
 					}
 					int beforesh=sh.size();
 					printf("XX%d\n",beforesh);
@@ -968,11 +997,14 @@ lchild_rsiblingt* generateCGT(debugging_msg &debug, dsde_hlm &dsm,
  void show(OutputStream &s, bool isVanishing, const UID id, const shared_state* st);
  UID  illegalID();
 
+ @param  incremental  Use incremental enabling, as in generateRGt().
+
  @throws An appropriate error code
 
  */
 template<class SMP, typename UID>
-void generateSMPt(debugging_msg &debug, dsde_hlm &dsm, SMP &smp) {
+void generateSMPt(debugging_msg &debug, dsde_hlm &dsm, SMP &smp,
+		bool incremental = false) {
 	// allocate temporary states
 	shared_state* curr_st = new shared_state(&dsm);
 	shared_state* next_st = new shared_state(&dsm);
@@ -980,6 +1012,12 @@ void generateSMPt(debugging_msg &debug, dsde_hlm &dsm, SMP &smp) {
 	// allocate list of enabled events
 	List<model_event> enabled;
 
+	// enabling values inherited by unexplored tangible states
+	std::map<UID, std::vector<signed char> > inherited;
+	std::vector<signed char> parent_values;
+	if (incremental)
+		dsm.buildEnablingAffects();
+
 	// set up traverse data and such
 	traverse_data x(traverse_data::Compute);
 	result xans;
@@ -1074,10 +1112,21 @@ void generateSMPt(debugging_msg &debug, dsde_hlm &dsm, SMP &smp) {
 			//
 			// Make enabling list
 			//
-			if (current_is_vanishing)
+			if (current_is_vanishing) {
 				dsm.makeVanishingEnabledList(x, &enabled);
-			else
+			} else if (incremental) {
+				typename std::map<UID, std::vector<signed char> >::iterator
+					known = inherited.find(from_id);
+				if (known != inherited.end()) {
+					dsm.makeTangibleEnabledList(x, &enabled, known->second);
+					inherited.erase(known);
+				} else {
+					dsm.makeTangibleEnabledList(x, &enabled);
+				}
+				dsm.saveEnabling(parent_values);
+			} else {
 				dsm.makeTangibleEnabledList(x, &enabled);
+			}
 			if (!x.answer->isNormal()) {
 				DCASSERT(1 == enabled.Length());
 				if (dsm.StartError(0)) {
@@ -1102,7 +1151,7 @@ void generateSMPt(debugging_msg &debug, dsde_hlm &dsm, SMP &smp) {
 				// t is enabled, fire and get new state
 				//
 				next_st->fillFrom(curr_st);
-				t->getNextstate()->Compute(x);
+				t->computeNextstate(x);
 				if (!xans.isNormal()) {
 					if (dsm.StartError(0)) {
 						dsm.SendError("Bad next-state expression for event ");
@@ -1126,7 +1175,7 @@ void generateSMPt(debugging_msg &debug, dsde_hlm &dsm, SMP &smp) {
 						} // if enabled.Length
 					} else {
 						x.which = traverse_data::ComputeExpoRate;
-						SafeComputeExpoRate(t->getDistribution(), x);
+						t->computeExpoRate(x);
 						x.which = traverse_data::Compute;
 					} // if current_is_vanishing
 
@@ -1172,6 +1221,10 @@ void generateSMPt(debugging_msg &debug, dsde_hlm &dsm, SMP &smp) {
 				bool next_is_new;
 				bool next_is_vanishing = xans.getBool();
 				next_is_new = smp.add(next_is_vanishing, next_st, to_id);
+				if (incremental && next_is_new && !next_is_vanishing
+						&& !current_is_vanishing) {
+					dsm.inheritEnabling(t, parent_values, inherited[to_id]);
+				}
 
 				//
 				// Debug info
@@ -1270,11 +1323,14 @@ void generateSMPt(debugging_msg &debug, dsde_hlm &dsm, SMP &smp) {
  void show(OutputStream &s, const UID id);
  void makeIllegalID(UID &);
 
+ @param  incremental  Use incremental enabling, as in generateRGt().
+
  @throws An appropriate error code
 
  */
 template<class MC, typename UID>
-void generateMCt(debugging_msg &debug, dsde_hlm &dsm, MC &mc) {
+void generateMCt(debugging_msg &debug, dsde_hlm &dsm, MC &mc,
+		bool incremental = false) {
 	//
 	// Build a buffer of states and incoming rates
 	//
@@ -1282,6 +1338,13 @@ void generateMCt(debugging_msg &debug, dsde_hlm &dsm, MC &mc) {
 
 	shared_state** statelist = new shared_state*[BUFSIZE];
 	double* weightlist = new double[BUFSIZE];
+	// event fired to reach each state on the stack
+	std::vector<model_event*> firedlist(BUFSIZE);
+	// enabling values inherited by unexplored tangible states
+	std::map<UID, std::vector<signed char> > inherited;
+	std::vector<signed char> parent_values;
+	if (incremental)
+		dsm.buildEnablingAffects();
 	// bool* isvanlist = new bool[BUFSIZE];
 	for (int i = 0; i < BUFSIZE; i++) {
 		statelist[i] = new shared_state(&dsm);
@@ -1402,10 +1465,21 @@ void generateMCt(debugging_msg &debug, dsde_hlm &dsm, MC &mc) {
 			// Make enabling list
 			//
 			x.current_state = statelist[curr];
-			if (current_is_vanishing)
+			if (current_is_vanishing) {
 				dsm.makeVanishingEnabledList(x, &enabled);
-			else
+			} else if (incremental) {
+				typename std::map<UID, std::vector<signed char> >::iterator
+					known = inherited.find(fromID);
+				if (known != inherited.end()) {
+					dsm.makeTangibleEnabledList(x, &enabled, known->second);
+					inherited.erase(known);
+				} else {
+					dsm.makeTangibleEnabledList(x, &enabled);
+				}
+				dsm.saveEnabling(parent_values);
+			} else {
 				dsm.makeTangibleEnabledList(x, &enabled);
+			}
 			if (!x.answer->isNormal()) {
 				DCASSERT(1 == enabled.Length());
 				if (dsm.StartError(0)) {
@@ -1446,9 +1520,10 @@ void generateMCt(debugging_msg &debug, dsde_hlm &dsm, MC &mc) {
 				//
 				// t is enabled, fire and get new state
 				//
+				firedlist[next] = t;
 				x.next_state = statelist[next];
 				statelist[next]->fillFrom(statelist[curr]);
-				t->getNextstate()->Compute(x);
+				t->computeNextstate(x);
 				if (!xans.isNormal()) {
 					if (dsm.StartError(0)) {
 						dsm.SendError("Bad next-state expression for event ");
@@ -1474,7 +1549,7 @@ void generateMCt(debugging_msg &debug, dsde_hlm &dsm, MC &mc) {
 						} // if enabled.Length
 					} else {
 						x.which = traverse_data::ComputeExpoRate;
-						SafeComputeExpoRate(t->getDistribution(), x);
+						t->computeExpoRate(x);
 						x.which = traverse_data::Compute;
 					} // if current_is_vanishing
 
@@ -1564,6 +1639,10 @@ void generateMCt(debugging_msg &debug, dsde_hlm &dsm, MC &mc) {
 					next_is_new = true;
 				} else {
 					next_is_new = mc.add(false, statelist[i], toID);
+					if (incremental && next_is_new && !current_is_vanishing) {
+						dsm.inheritEnabling(firedlist[i], parent_values,
+								inherited[toID]);
+					}
 				}
 
 				//
@@ -0,0 +1,873 @@
+/*
+ Multi-threaded explicit generation template functions.
+
+ Worker threads share the frontier of unexplored tangible states.
+ Each worker has its own temporary states, traverse data, and
+ vanishing states, and buffers the edges it discovers;
+ the buffers are merged into the process once exploration is done.
+ If the tangible state set allows concurrent insertions, workers
+ add states to it directly, and the lock is used only to put idle
+ workers to sleep and wake them up.  Otherwise, access to the shared
+ state set is serialized with the lock, so the underlying RG / MC
+ classes do not need to be thread safe.
+ Workers evaluate event expressions at the same time; the objects
+ they share are safe to share because link counts are atomic
+ (see shared.h).
+
+ States are "indexed" by a unique identifier.
+ */
+
+#ifndef GEN_TEMPL_MT_H
+#define GEN_TEMPL_MT_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+#include "../ExprLib/functions.h"
+
+// **************************************************************************
+// *                                                                        *
+// *                          mt_gen_control class                          *
+// *                                                                        *
+// **************************************************************************
+
+/**
+ Shared by all workers during multi-threaded generation.
+ */
+class mt_gen_control {
+public:
+	/// Protects the frontier, and the shared state set(s)
+	/// unless they allow concurrent insertions.
+	std::mutex lock;
+	/// Protects debugging output and error reports.
+	std::mutex io;
+	/// Signaled when new states arrive, or when exploration is done.
+	std::condition_variable wakeup;
+	/// Number of workers currently exploring a state.
+	int busy;
+	/// Number of workers waiting for new states.
+	std::atomic<int> idle;
+	/// Did any worker fail?
+	bool failed;
+	/// Error code of the first worker to fail.
+	subengine::error failure;
+public:
+	mt_gen_control() {
+		busy = 0;
+		idle = 0;
+		failed = false;
+		failure = subengine::Engine_Failed;
+	}
+	/// Record a worker failure; only the first one is kept.
+	inline void fail(subengine::error e) {
+		std::lock_guard<std::mutex> guard(lock);
+		if (!failed) {
+			failed = true;
+			failure = e;
+		}
+		wakeup.notify_all();
+	}
+	/**
+	 Wake up a waiting worker, if any, after a state was added
+	 without holding the lock.  Waiting workers check the frontier
+	 after announcing themselves as idle, so either they see the
+	 new state, or we see them.
+	 */
+	inline void added() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (0 == idle.load())
+			return;
+		std::lock_guard<std::mutex> guard(lock);
+		wakeup.notify_one();
+	}
+};
+
+// **************************************************************************
+// *                                                                        *
+// *                            mt_worker  class                            *
+// *                                                                        *
+// **************************************************************************
+
+/**
+ Base class for worker threads.
+ Each worker has its own scratch data for expression evaluation,
+ and its own buffers for edges and initial states.
+
+ RG is the shared process class, with the following required methods
+ (called only while holding the control lock, except as noted).
+
+ bool add(bool isVanishing, const shared_state*, UID &id);
+ bool hasUnexploredTangible();
+ UID  getUnexploredTangible(shared_state*);
+ bool statesOnly();
+ void makeIllegalID(UID &);
+ void show(OutputStream &s, bool isVanishing, const UID id, const shared_state* st);
+ void show(OutputStream &s, const shared_state* st);
+
+ bool concurrentTangibles();
+ (without the lock) bool addTangibleConcurrently(const shared_state*, UID &id);
+ void finishTangibles();
+
+ If concurrentTangibles() is true, tangible states are added
+ with addTangibleConcurrently(), by several threads at once,
+ and hasUnexploredTangible() and getUnexploredTangible() must
+ work while insertions are in progress.  Once exploration is
+ done, finishTangibles() is called before edges are added.
+ */
+template<class RG, typename UID>
+class mt_worker {
+public:
+	struct edge {
+		UID from;
+		UID to;
+		double wt;
+	};
+	/// Edges discovered by this worker.
+	std::vector<edge> edges;
+	/// Tangible states reached from initial vanishing states.
+	std::vector<edge> initials;
+protected:
+	debugging_msg &debug;
+	dsde_hlm &dsm;
+	RG &rg;
+	mt_gen_control &ctl;
+
+	traverse_data x;
+	result xans;
+	List<model_event> enabled;
+	/// Can we add tangible states without the lock?
+	bool concurrent;
+public:
+	mt_worker(debugging_msg &d, dsde_hlm &m, RG &r, mt_gen_control &c) :
+			debug(d), dsm(m), rg(r), ctl(c), x(traverse_data::Compute) {
+		x.answer = &xans;
+		concurrent = rg.concurrentTangibles();
+	}
+	virtual ~mt_worker() {
+	}
+
+	/**
+	 Explore from a state.  The state must already be loaded
+	 into the worker's scratch space (see load()).
+	 @param  from         Identifier of the tangible state being explored.
+	 @param  valid_from   If false, we are exploring an initial vanishing
+	 state, and reached tangibles are initial states.
+	 @param  is_vanishing Is the loaded state vanishing?
+	 @param  wt           Weight of the loaded state.
+
+	 @throws An appropriate error code
+	 */
+	virtual void explore(UID from, bool valid_from, bool is_vanishing,
+			double wt) = 0;
+
+	/// Scratch space for the next state to explore.
+	virtual shared_state* load() = 0;
+
+	/// Thread body: explore tangible states until there are none left.
+	void run(int slot) {
+		model_event::setWorkerSlot(slot);
+		bool working = false;
+		try {
+			for (;;) {
+				if (debug.caughtTerm()) {
+					error("Process construction prematurely terminated");
+					throw subengine::Terminated;
+				}
+				UID from;
+				{
+					std::unique_lock<std::mutex> guard(ctl.lock);
+					ctl.idle++;
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					while (!ctl.failed && ctl.busy
+							&& !rg.hasUnexploredTangible()) {
+						ctl.wakeup.wait(guard);
+					}
+					ctl.idle--;
+					if (ctl.failed || !rg.hasUnexploredTangible()) {
+						ctl.wakeup.notify_all();
+						return;
+					}
+					from = rg.getUnexploredTangible(load());
+					ctl.busy++;
+					working = true;
+				}
+				explore(from, true, false, 1.0);
+				{
+					std::lock_guard<std::mutex> guard(ctl.lock);
+					ctl.busy--;
+					working = false;
+					if (0 == ctl.busy || rg.hasUnexploredTangible())
+						ctl.wakeup.notify_all();
+				}
+			} // infinite loop
+		} catch (subengine::error e) {
+			stopWorking(working);
+			ctl.fail(e);
+		} catch (...) {
+			stopWorking(working);
+			ctl.fail(subengine::Engine_Failed);
+		}
+	}
+
+protected:
+	inline void stopWorking(bool working) {
+		if (!working)
+			return;
+		std::lock_guard<std::mutex> guard(ctl.lock);
+		ctl.busy--;
+	}
+
+	/// Add a tangible state to the shared set.
+	inline bool addTangible(const shared_state* s, UID &id) {
+		if (concurrent) {
+			bool is_new = rg.addTangibleConcurrently(s, id);
+			if (is_new)
+				ctl.added();
+			return is_new;
+		}
+		std::lock_guard<std::mutex> guard(ctl.lock);
+		bool is_new = rg.add(false, s, id);
+		if (is_new)
+			ctl.wakeup.notify_one();
+		return is_new;
+	}
+
+	inline void addEdge(UID from, bool valid_from, UID to, double wt) {
+		edge e;
+		e.from = from;
+		e.to = to;
+		e.wt = wt;
+		if (valid_from)
+			edges.push_back(e);
+		else
+			initials.push_back(e);
+	}
+
+	inline void error(const char* what) {
+		std::lock_guard<std::mutex> guard(ctl.io);
+		if (dsm.StartError(0)) {
+			dsm.SendError(what);
+			dsm.DoneError();
+		}
+	}
+
+	inline void eventError(const char* what, const model_event* t,
+			const char* where) {
+		std::lock_guard<std::mutex> guard(ctl.io);
+		if (dsm.StartError(0)) {
+			dsm.SendError(what);
+			dsm.SendError(t->Name());
+			dsm.SendError(where);
+			dsm.DoneError();
+		}
+	}
+
+	inline void assertions(shared_state* s) {
+		shared_state* old = x.current_state;
+		x.current_state = s;
+		{
+			std::lock_guard<std::mutex> guard(ctl.io);
+			dsm.checkAssertions(x);
+		}
+		x.current_state = old;
+		if (0 == xans.getBool()) {
+			throw subengine::Assertion_Failure;
+		}
+	}
+
+	inline void enablingList(bool is_vanishing) {
+		if (is_vanishing)
+			dsm.makeVanishingEnabledList(x, &enabled);
+		else
+			dsm.makeTangibleEnabledList(x, &enabled);
+		if (!x.answer->isNormal()) {
+			DCASSERT(1 == enabled.Length());
+			eventError("Bad enabling expression for event ",
+					enabled.Item(0), " during process generation");
+			throw subengine::Engine_Failed;
+		}
+	}
+
+	inline bool vanishing(shared_state* s) {
+		shared_state* old = x.current_state;
+		x.current_state = s;
+		dsm.checkVanishing(x);
+		x.current_state = old;
+		if (!xans.isNormal()) {
+			error("Couldn't determine vanishing / tangible");
+			throw subengine::Engine_Failed;
+		}
+		return xans.getBool();
+	}
+
+	inline void nextstate(model_event* t) {
+		t->computeNextstate(x);
+		if (!xans.isNormal()) {
+			std::lock_guard<std::mutex> guard(ctl.io);
+			if (dsm.StartError(0)) {
+				dsm.SendError("Bad next-state expression for event ");
+				dsm.SendError(t->Name());
+				dsm.SendError(" during process generation");
+				dsm.OutOfBoundsError(xans);
+				dsm.DoneError();
+			}
+			throw subengine::Engine_Failed;
+		}
+	}
+};
+
+// **************************************************************************
+// *                                                                        *
+// *                           mt_rg_worker class                           *
+// *                                                                        *
+// **************************************************************************
+
+/**
+ Worker for reachability graphs, as in generateRGt().
+ Vanishing states reached from a tangible state are kept
+ in a private set, and cleared once the tangible is explored.
+
+ VAN is the private vanishing set class, with required methods
+
+ bool add(bool isVanishing, const shared_state*, UID &id);
+ bool hasUnexploredVanishing();
+ UID  getUnexploredVanishing(shared_state*);
+ void resetVanishing();
+ */
+template<class RG, class VAN, typename UID>
+class mt_rg_worker: public mt_worker<RG, UID> {
+	typedef mt_worker<RG, UID> base;
+	VAN &van;
+	shared_state* curr_st;
+	shared_state* next_st;
+public:
+	mt_rg_worker(debugging_msg &d, dsde_hlm &m, RG &r, mt_gen_control &c,
+			VAN &v) :
+			base(d, m, r, c), van(v) {
+		curr_st = new shared_state(&m);
+		next_st = new shared_state(&m);
+		base::x.current_state = curr_st;
+		base::x.next_state = next_st;
+	}
+	virtual ~mt_rg_worker() {
+		base::x.current_state = 0;
+		base::x.next_state = 0;
+		Delete(curr_st);
+		Delete(next_st);
+	}
+
+	virtual shared_state* load() {
+		return curr_st;
+	}
+
+	virtual void explore(UID from, bool valid_from, bool is_vanishing,
+			double) {
+		UID exp_id = from;
+		van.resetVanishing();
+		if (is_vanishing) {
+			van.add(true, curr_st, exp_id);
+		}
+		for (;;) {
+			if (base::debug.startReport()) {
+				std::lock_guard<std::mutex> guard(base::ctl.io);
+				base::debug.report() << "Exploring ";
+				base::rg.show(base::debug.report(), is_vanishing, exp_id,
+						curr_st);
+				base::debug.report() << "\n";
+				base::debug.stopIO();
+			}
+
+			base::enablingList(is_vanishing);
+
+			for (int e = 0; e < base::enabled.Length(); e++) {
+				model_event* t = base::enabled.Item(e);
+				DCASSERT(t);DCASSERT(t->actsLikeImmediate() == is_vanishing);
+
+				next_st->fillFrom(curr_st);
+				if (t->getNextstate()) {
+					base::nextstate(t);
+				}
+
+				bool next_is_vanishing = base::vanishing(next_st);
+				UID next_id;
+				bool next_is_new;
+				if (next_is_vanishing) {
+					next_is_new = van.add(true, next_st, next_id);
+				} else {
+					next_is_new = base::addTangible(next_st, next_id);
+				}
+
+				if (base::debug.startReport()) {
+					std::lock_guard<std::mutex> guard(base::ctl.io);
+					base::debug.report() << "\t via event " << t->Name()
+							<< " to ";
+					base::rg.show(base::debug.report(), next_is_vanishing,
+							next_id, next_st);
+					base::debug.report() << "\n";
+					base::debug.stopIO();
+				}
+
+				if (next_is_new) {
+					base::assertions(next_st);
+				}
+
+				if (base::rg.statesOnly() || next_is_vanishing)
+					continue;
+
+				base::addEdge(from, valid_from, next_id, 1.0);
+			} // for e
+
+			if (!van.hasUnexploredVanishing())
+				break;
+			exp_id = van.getUnexploredVanishing(curr_st);
+			is_vanishing = true;
+		} // infinite loop
+	}
+};
+
+// **************************************************************************
+// *                                                                        *
+// *                           mt_mc_worker class                           *
+// *                                                                        *
+// **************************************************************************
+
+/**
+ Worker for Markov chains, as in generateMCt().
+ Vanishing paths are followed (with a private stack)
+ until tangible states are reached.
+ */
+template<class MC, typename UID>
+class mt_mc_worker: public mt_worker<MC, UID> {
+	typedef mt_worker<MC, UID> base;
+	static const int BUFSIZE = 2048; // TBD - make this an option
+	shared_state** statelist;
+	double* weightlist;
+public:
+	mt_mc_worker(debugging_msg &d, dsde_hlm &m, MC &r, mt_gen_control &c) :
+			base(d, m, r, c) {
+		statelist = new shared_state*[BUFSIZE];
+		weightlist = new double[BUFSIZE];
+		for (int i = 0; i < BUFSIZE; i++) {
+			statelist[i] = new shared_state(&m);
+		}
+	}
+	virtual ~mt_mc_worker() {
+		base::x.current_state = 0;
+		base::x.next_state = 0;
+		for (int i = 0; i < BUFSIZE; i++) {
+			Delete(statelist[i]);
+		}
+		delete[] statelist;
+		delete[] weightlist;
+	}
+
+	virtual shared_state* load() {
+		return statelist[0];
+	}
+
+	virtual void explore(UID fromID, bool valid_from, bool is_vanishing,
+			double wt) {
+		int curr = 0;
+		weightlist[0] = wt;
+		bool current_is_vanishing = is_vanishing;
+		for (;;) {
+			if (base::debug.startReport()) {
+				std::lock_guard<std::mutex> guard(base::ctl.io);
+				base::debug.report() << "Exploring ";
+				base::rg.show(base::debug.report(), current_is_vanishing,
+						fromID, statelist[curr]);
+				base::debug.report() << "\n";
+				base::debug.stopIO();
+			}
+
+			base::x.current_state = statelist[curr];
+			base::enablingList(current_is_vanishing);
+
+			int next = curr;
+			for (int e = 0; e < base::enabled.Length(); e++) {
+				model_event* t = base::enabled.Item(e);
+				DCASSERT(t);DCASSERT(t->hasFiringType(model_event::Immediate) == current_is_vanishing);
+				if (0 == t->getNextstate())
+					continue;  // firing is "no-op", don't bother
+
+				next++;
+				if (next >= BUFSIZE) {
+					base::error("Vanishing stack overflow");
+					throw subengine::Engine_Failed;
+				}
+
+				base::x.next_state = statelist[next];
+				statelist[next]->fillFrom(statelist[curr]);
+				base::nextstate(t);
+
+				if (base::rg.statesOnly()) {
+					weightlist[next] = 1.0;
+				} else {
+					weightlist[next] = weight(t, current_is_vanishing);
+				}
+
+				if (base::debug.startReport()) {
+					std::lock_guard<std::mutex> guard(base::ctl.io);
+					base::debug.report() << "\t via event " << t->Name();
+					if (!base::rg.statesOnly()) {
+						base::debug.report() << " (" << weightlist[next]
+								<< ")";
+					}
+					base::debug.report() << " to ";
+					base::rg.show(base::debug.report(), statelist[next]);
+					base::debug.report() << "\n";
+					base::debug.stopIO();
+				}
+			} // for enabled event e
+
+			//
+			// For vanishing states, get the total weight and normalize
+			//
+			if (current_is_vanishing) {
+				double wtotal = 0;
+				for (int i = next; i > curr; i--) {
+					wtotal += weightlist[i];
+				}
+				double inrate = weightlist[curr] / wtotal;
+				for (int i = next; i > curr; i--) {
+					weightlist[i] *= inrate;
+				}
+			}
+
+			//
+			// Vanishing states are pushed, tangible states are added.
+			//
+			for (int i = curr + 1; i <= next; i++) {
+				bool next_is_new;
+				UID toID;
+				bool next_is_vanishing = base::vanishing(statelist[i]);
+				if (next_is_vanishing) {
+					base::rg.makeIllegalID(toID);
+					next_is_new = true;
+				} else {
+					next_is_new = base::addTangible(statelist[i], toID);
+				}
+
+				if (next_is_new) {
+					base::assertions(statelist[i]);
+				}
+
+				if (next_is_vanishing) {
+					SWAP(statelist[curr], statelist[i]);
+					weightlist[curr] = weightlist[i];
+					curr++;
+				} else {
+					if (!base::rg.statesOnly()) {
+						base::addEdge(fromID, valid_from, toID, weightlist[i]);
+					}
+				}
+			} // for i
+
+			if (0 == curr)
+				break;
+			curr--;
+			current_is_vanishing = true;
+		} // infinite loop
+	}
+
+protected:
+	inline double weight(model_event* t, bool current_is_vanishing) {
+		if (current_is_vanishing) {
+			if (base::enabled.Length() > 1) {
+				SafeCompute(t->getWeight(), base::x);
+			} else {
+				base::xans.setReal(1.0);
+			}
+		} else {
+			base::x.which = traverse_data::ComputeExpoRate;
+			t->computeExpoRate(base::x);
+			base::x.which = traverse_data::Compute;
+		}
+		if (base::xans.isNormal() && base::xans.getReal() > 0.0) {
+			return base::xans.getReal();
+		}
+		std::lock_guard<std::mutex> guard(base::ctl.io);
+		if (base::dsm.StartError(0)) {
+			base::dsm.SendError("Bad value ");
+			base::dsm.SendRealError(base::xans);
+			if (current_is_vanishing) {
+				base::dsm.SendError(" for weight of event ");
+			} else {
+				base::dsm.SendError(" for rate of event ");
+			}
+			base::dsm.SendError(t->Name());
+			base::dsm.DoneError();
+		}
+		throw subengine::Engine_Failed;
+	}
+};
+
+// **************************************************************************
+// *                                                                        *
+// *                          Front-end  templates                          *
+// *                                                                        *
+// **************************************************************************
+
+/**
+ Start the workers, wait for them to finish, and stop
+ concurrent expression evaluation.
+
+ @throws The error code of the first worker to fail
+ */
+template<class W>
+void runWorkersMT(dsde_hlm &dsm, mt_gen_control &ctl, W** workers, int nt) {
+	std::vector<std::thread> threads;
+	dsm.reserveWorkerSlots(nt);
+	SetConcurrentFunctionCalls(true);
+	try {
+		for (int i = 1; i < nt; i++) {
+			threads.push_back(std::thread(&W::run, workers[i], i));
+		}
+	} catch (...) {
+		ctl.fail(subengine::Out_Of_Memory);
+	}
+	// The calling thread is worker 0
+	workers[0]->run(0);
+	for (unsigned i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+	SetConcurrentFunctionCalls(false);
+	if (ctl.failed)
+		throw ctl.failure;
+}
+
+/**
+ Multi-threaded version of generateRGt().
+ The resulting graph is the same as the one built by generateRGt(),
+ up to state renumbering.
+
+ @param  debug Debugging channel
+ @param  dsm   High-level model
+ @param  rg    Shared state set and reachability graph.
+ Required methods are as for generateRGt()
+ (see also class mt_worker), except that vanishing
+ states are handled by \a van, and edges are added
+ only after exploration is complete.
+ @param  van   Array of private vanishing sets, one per thread;
+ see class mt_rg_worker for required methods.
+ @param  nt    Number of threads to use.
+
+ @throws An appropriate error code
+ */
+template<class RG, class VAN, typename UID>
+void generateRGt_mt(debugging_msg &debug, dsde_hlm &dsm, RG &rg, VAN** van,
+		int nt) {
+	DCASSERT(nt > 0);
+	typedef mt_rg_worker<RG, VAN, UID> worker;
+	mt_gen_control ctl;
+	worker** workers = new worker*[nt];
+	for (int i = 0; i < nt; i++) {
+		workers[i] = new worker(debug, dsm, rg, ctl, *van[i]);
+	}
+
+	try {
+		//
+		// Initial states, by the calling thread.
+		// Initial vanishing states are explored right away.
+		//
+		traverse_data x(traverse_data::Compute);
+		result xans;
+		x.answer = &xans;
+		for (int i = 0; i < dsm.NumInitialStates(); i++) {
+			shared_state* st = workers[0]->load();
+			x.current_state = st;
+			dsm.GetInitialState(i, st);
+			dsm.checkVanishing(x);
+			if (!xans.isNormal()) {
+				if (dsm.StartError(0)) {
+					dsm.SendError("Couldn't determine vanishing / tangible");
+					dsm.DoneError();
+				}
+				throw subengine::Engine_Failed;
+			}
+			bool is_vanishing = xans.getBool();
+			UID id;
+			rg.makeIllegalID(id);
+			bool newinit = true;
+			if (!is_vanishing) {
+				newinit = rg.add(false, st, id);
+				rg.addInitial(id);
+			}
+			if (debug.startReport()) {
+				debug.report() << "Adding initial ";
+				if (is_vanishing) {
+					rg.show(debug.report(), st);
+				} else {
+					rg.show(debug.report(), false, id, st);
+				}
+				debug.report() << "\n";
+				debug.stopIO();
+			}
+			if (!newinit)
+				continue;
+			dsm.checkAssertions(x);
+			if (0 == xans.getBool()) {
+				throw subengine::Assertion_Failure;
+			}
+			if (is_vanishing) {
+				rg.makeIllegalID(id);
+				workers[0]->explore(id, false, true, 1.0);
+			}
+		} // for i
+
+		//
+		// Explore everything else, in parallel
+		//
+		runWorkersMT(dsm, ctl, workers, nt);
+
+		if (debug.startReport()) {
+			debug.report() << "Done exploring\n";
+			debug.stopIO();
+		}
+
+		//
+		// Merge
+		//
+		if (rg.concurrentTangibles())
+			rg.finishTangibles();
+		for (int i = 0; i < nt; i++) {
+			for (unsigned j = 0; j < workers[i]->initials.size(); j++) {
+				rg.addInitial(workers[i]->initials[j].to);
+			}
+			if (rg.statesOnly())
+				continue;
+			for (unsigned j = 0; j < workers[i]->edges.size(); j++) {
+				rg.addEdge(workers[i]->edges[j].from, workers[i]->edges[j].to);
+			}
+		}
+	} catch (...) {
+		for (int i = 0; i < nt; i++) {
+			delete workers[i];
+		}
+		delete[] workers;
+		throw;
+	}
+
+	for (int i = 0; i < nt; i++) {
+		delete workers[i];
+	}
+	delete[] workers;
+}
+
+/**
+ Multi-threaded version of generateMCt().
+ The resulting chain is the same as the one built by generateMCt(),
+ up to state renumbering.
+ Vanishing states are always eliminated by following paths.
+
+ @param  debug Debugging channel
+ @param  dsm   High-level model
+ @param  mc    Shared state set and Markov chain.
+ Required methods are as for generateMCt()
+ (see also class mt_worker), except that edges
+ are added only after exploration is complete.
+ @param  nt    Number of threads to use.
+
+ @throws An appropriate error code
+ */
+template<class MC, typename UID>
+void generateMCt_mt(debugging_msg &debug, dsde_hlm &dsm, MC &mc, int nt) {
+	DCASSERT(nt > 0);
+	typedef mt_mc_worker<MC, UID> worker;
+	mt_gen_control ctl;
+	worker** workers = new worker*[nt];
+	for (int i = 0; i < nt; i++) {
+		workers[i] = new worker(debug, dsm, mc, ctl);
+	}
+
+	try {
+		//
+		// Initial states, by the calling thread.
+		// Initial vanishing states are explored right away.
+		//
+		traverse_data x(traverse_data::Compute);
+		result xans;
+		x.answer = &xans;
+		for (int i = 0; i < dsm.NumInitialStates(); i++) {
+			shared_state* st = workers[0]->load();
+			x.current_state = st;
+			double wt = dsm.GetInitialState(i, st);
+			dsm.checkAssertions(x);
+			if (0 == xans.getBool()) {
+				throw subengine::Assertion_Failure;
+			}
+			dsm.checkVanishing(x);
+			if (!xans.isNormal()) {
+				if (dsm.StartError(0)) {
+					dsm.SendError("Couldn't determine vanishing / tangible");
+					dsm.DoneError();
+				}
+				throw subengine::Engine_Failed;
+			}
+			UID id;
+			mc.makeIllegalID(id);
+			if (xans.getBool()) {
+				if (debug.startReport()) {
+					debug.report() << "Exploring initial vanishing ";
+					mc.show(debug.report(), st);
+					debug.report() << " wt " << wt << "\n";
+					debug.stopIO();
+				}
+				workers[0]->explore(id, false, true, wt);
+				continue;
+			}
+			mc.add(false, st, id);
+			mc.addInitial(false, id, wt);
+			if (debug.startReport()) {
+				debug.report() << "Adding initial ";
+				mc.show(debug.report(), false, id, st);
+				debug.report() << " wt " << wt << "\n";
+				debug.stopIO();
+			}
+		} // for i
+
+		//
+		// Explore everything else, in parallel
+		//
+		runWorkersMT(dsm, ctl, workers, nt);
+
+		if (debug.startReport()) {
+			debug.report() << "Done exploring\n";
+			debug.stopIO();
+		}
+
+		//
+		// Merge
+		//
+		if (mc.concurrentTangibles())
+			mc.finishTangibles();
+		for (int i = 0; i < nt; i++) {
+			for (unsigned j = 0; j < workers[i]->initials.size(); j++) {
+				mc.addInitial(false, workers[i]->initials[j].to,
+						workers[i]->initials[j].wt);
+			}
+			if (mc.statesOnly())
+				continue;
+			for (unsigned j = 0; j < workers[i]->edges.size(); j++) {
+				mc.addTTEdge(workers[i]->edges[j].from,
+						workers[i]->edges[j].to, workers[i]->edges[j].wt);
+			}
+		}
+	} catch (...) {
+		for (int i = 0; i < nt; i++) {
+			delete workers[i];
+		}
+		delete[] workers;
+		throw;
+	}
+
+	for (int i = 0; i < nt; i++) {
+		delete workers[i];
+	}
+	delete[] workers;
+}
+
+#endif
@@ -27,6 +27,9 @@
 
 reporting_msg static_varorder::report;
 debugging_msg static_varorder::debug;
+unsigned static_varorder::meddly_reordering;
+long static_varorder::meddly_reorder_trigger;
+unsigned static_varorder::meddly_reorder_heuristic;
 
 static_varorder::static_varorder()
 : subengine()
@@ -149,6 +152,77 @@ bool init_static_varorder::execute()
       "When set, static variable ordering heuristic details are displayed."
   );
 
+  static_varorder::meddly_reordering = static_varorder::NEVER;
+  option* mdr = em->OptMan()->addRadioOption(
+      "MeddlyDynamicReordering",
+      "Should the variable order of Meddly forests change during state space generation, when the number of nodes grows too large.  The iteration engines (TRADITIONAL, FRONTIER, NEXT_ALL) can reorder after each of their operations, and SATURATION between its rounds, each of which adds the events of one more level.  The other saturation engines keep the variable order fixed.",
+      2, static_varorder::meddly_reordering
+  );
+  mdr->addRadioButton(
+      "NEVER",
+      "The variable order chosen by VariableOrdering is kept.",
+      static_varorder::NEVER
+  );
+  mdr->addRadioButton(
+      "SIFTING",
+      "When a forest grows past MeddlyReorderTrigger nodes, its variables are sifted, the other forests are moved to the new order using MeddlyReorderingHeuristic, and the trigger is doubled.",
+      static_varorder::SIFTING
+  );
+
+  static_varorder::meddly_reorder_heuristic = static_varorder::SINK_DOWN;
+  option* mrh = em->OptMan()->addRadioOption(
+      "MeddlyReorderingHeuristic",
+      "How Meddly forests are moved, one swap of adjacent variables at a time, to the variable order chosen by sifting; see MeddlyDynamicReordering.  Every heuristic reaches the same order, but they differ in time and in the number of nodes along the way.",
+      8, static_varorder::meddly_reorder_heuristic
+  );
+  mrh->addRadioButton(
+      "BRING_UP",
+      "Bubble up the lightest variables.",
+      static_varorder::BRING_UP
+  );
+  mrh->addRadioButton(
+      "HIGHEST_INVERSION",
+      "Always swap the highest pair of variables that is out of order.",
+      static_varorder::HIGHEST_INVERSION
+  );
+  mrh->addRadioButton(
+      "LARC",
+      "Always swap the pair of variables, out of order, with the lowest average reference count.",
+      static_varorder::LARC
+  );
+  mrh->addRadioButton(
+      "LOWEST_COST",
+      "Always swap the pair of variables, out of order, whose upper variable has the fewest nodes.",
+      static_varorder::LOWEST_COST
+  );
+  mrh->addRadioButton(
+      "LOWEST_INVERSION",
+      "Always swap the lowest pair of variables that is out of order.",
+      static_varorder::LOWEST_INVERSION
+  );
+  mrh->addRadioButton(
+      "LOWEST_MEMORY",
+      "Always swap the pair of variables, out of order, that leaves the fewest nodes.",
+      static_varorder::LOWEST_MEMORY
+  );
+  mrh->addRadioButton(
+      "RANDOM",
+      "Swap a random pair of variables that is out of order.",
+      static_varorder::RANDOM
+  );
+  mrh->addRadioButton(
+      "SINK_DOWN",
+      "Sink down the heaviest variables.",
+      static_varorder::SINK_DOWN
+  );
+
+  static_varorder::meddly_reorder_trigger = 100000;
+  em->OptMan()->addIntOption(
+      "MeddlyReorderTrigger",
+      "Number of nodes in a Meddly forest that first triggers dynamic reordering; see MeddlyDynamicReordering.",
+      static_varorder::meddly_reorder_trigger, 1, std::numeric_limits<long>::max()
+  );
+
   MakeEngineType(em,
                  "VariableOrdering",
                  "Algorithm to use to determine the (static) variable order for a high-level model",
@@ -21,6 +21,26 @@ public:
   virtual ~static_varorder();
 
   // Any useful helpers?
+
+  // Dynamic reordering of Meddly forests, in case the static order is bad
+  static unsigned meddly_reordering;
+  static const unsigned NEVER     = 0;
+  static const unsigned SIFTING   = 1;
+
+  // Number of forest nodes that first triggers dynamic reordering
+  static long meddly_reorder_trigger;
+
+  // How the other forests move to the order chosen by sifting,
+  // in name order
+  static unsigned meddly_reorder_heuristic;
+  static const unsigned BRING_UP          = 0;
+  static const unsigned HIGHEST_INVERSION = 1;
+  static const unsigned LARC              = 2;
+  static const unsigned LOWEST_COST       = 3;
+  static const unsigned LOWEST_INVERSION  = 4;
+  static const unsigned LOWEST_MEMORY     = 5;
+  static const unsigned RANDOM            = 6;
+  static const unsigned SINK_DOWN         = 7;
 };
 
 #endif
@@ -737,7 +737,18 @@ void meddly_implicitgen::buildRSS(meddly_varoption &x)
       subwatch.reset();
     }
 
-    generateRSS(x, subwatch);
+    MEDDLY::input* ckpt = meddly_reachset::pendingCheckpoint();
+    if (ckpt) {
+      meddly_reachset::setPendingCheckpoint(0);
+      try {
+        x.setStates(x.readCheckpoint(*ckpt));
+      }
+      catch (MEDDLY::error ce) {
+        convert(ce, "Reading checkpoint", x.getParent());
+      }
+    } else {
+      generateRSS(x, subwatch);
+    }
 
     if (Report().startReport()) {
       Report().report() << "Built    reachability set, took ";
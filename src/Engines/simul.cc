@@ -3,6 +3,7 @@
 
 // External libs
 #include "../_SimLib/sim.h"
+#include "../_SimLib/sim-models.h"
 #include "../_RngLib/rng.h"
 #include "../_Timer/timerlib.h"
 
@@ -14,8 +15,15 @@
 #include "../ExprLib/startup.h"
 #include "../ExprLib/exprman.h"
 #include "../ExprLib/engine.h"
+#include "../ExprLib/measures.h"
+#include "../ExprLib/functions.h"
+
+#include "../Formlsms/dsde_hlm.h"
 
 #include <climits>
+#include <math.h>
+#include <vector>
+#include <map>
 
 // #define DEBUG
 
@@ -91,12 +99,13 @@ bool conf_intl::Equals(const shared_object* o) const
     And, it provides encapsulation for the simulation and RNG options.
 */
 class sim_engine : public subengine {
-  static rng_manager* rngm;
   static long Samples;
   static double Confidence;
   static double Precision;
   static unsigned Type;
+  static long Threads;
 protected:
+  static rng_manager* rngm;
   static rng_stream* rng_main;
   static const unsigned V_CONFIDENCE  = 0;
   static const unsigned V_PRECISION   = 1;
@@ -109,6 +118,7 @@ public:
   inline double GetConfidence() const { return Confidence; }
   inline double GetPrecision() const { return Precision; }
   inline int GetType() const { return Type; }
+  inline int GetThreads() const { return Threads; }
 
   friend void PrintSimLibraryVersions(OutputStream &s);
   friend class jump_distance_option;
@@ -124,6 +134,7 @@ long sim_engine::Samples;
 double sim_engine::Confidence;
 double sim_engine::Precision;
 unsigned sim_engine::Type;
+long sim_engine::Threads;
 
 // **************************************************************************
 // *                           sim_engine methods                           *
@@ -156,8 +167,19 @@ public:
   virtual bool AppliesToModelType(hldsm::model_type mt) const;
   virtual void RunEngine(result* pass, int np, traverse_data &x);
 
-  // Provide in derived classes:
-  virtual sim_experiment* MakeExperiment(expr* e, traverse_data &x) const = 0;
+  /** Provide in derived classes.
+        @param  e         Expression to estimate.
+        @param  x         Traversal data for thread 0.
+        @param  streams   Random number stream for each thread,
+                          for cloning the experiment.
+  */
+  virtual sim_experiment* MakeExperiment(expr* e, traverse_data &x,
+        const std::vector <rng_stream*> &streams) const = 0;
+
+private:
+  /// Undo the thread setup of RunEngine(), and advance the main stream.
+  void FinishThreads(traverse_data &x, local_values* oldlocals,
+        std::vector <rng_stream*> &streams) const;
 
   friend class init_simul;
 };
@@ -193,31 +215,61 @@ void monte_carlo_engine
   }
   timer watch;
   e->PreCompute();
-  sim_experiment* se = MakeExperiment(e, x);
-  if (0==se)  throw Engine_Failed;
+
+  //
+  // Thread t uses stream t, which starts t jumps ahead of the main one.
+  // Afterwards, the main stream jumps ahead of the last one,
+  // so results are reproducible for a given seed and number of threads.
+  //
+  const int nt = GetThreads();
+  std::vector <rng_stream*> streams(1, rng_main);
+  for (int t=1; t<nt; t++) {
+    rng_stream* s = rngm->NewStreamByJumping(streams[t-1]);
+    if (0==s) break;
+    streams.push_back(s);
+  }
 
   rng_stream* old = x.stream;
   x.stream = rng_main;
+  local_values* oldlocals = x.locals;
+  if (streams.size() > 1) {
+    x.locals = new local_values;
+    SetConcurrentFunctionCalls(true);
+  }
 
+  sim_experiment* se = MakeExperiment(e, x, streams);
   sim_confintl avg;
-  switch (GetType()) {
-    case V_SAMPLES:
-        SIM_MonteCarlo_S(se, &avg, 1, GetConfidence(), GetPrecision());
-        break;
-    case V_PRECISION:
-        SIM_MonteCarlo_W(se, &avg, 1, GetSamples(), GetConfidence());
-        break;
-    case V_CONFIDENCE:
-        SIM_MonteCarlo_C(se, &avg, 1, GetSamples(), GetPrecision());
-        break;
-    default:
-        if (em->startInternal(__FILE__, __LINE__)) {
-          em->causedBy(e);
-          em->internal() << "Bad simulation type";
-          em->stopIO();
-        }
-        avg.is_valid = false;
-  } // switch
+  try {
+    if (0==se)  throw Engine_Failed;
+    switch (GetType()) {
+      case V_SAMPLES:
+          SIM_MonteCarlo_S(se, &avg, 1, GetConfidence(), GetPrecision(),
+                streams.size());
+          break;
+      case V_PRECISION:
+          SIM_MonteCarlo_W(se, &avg, 1, GetSamples(), GetConfidence(),
+                streams.size());
+          break;
+      case V_CONFIDENCE:
+          SIM_MonteCarlo_C(se, &avg, 1, GetSamples(), GetPrecision(),
+                streams.size());
+          break;
+      default:
+          if (em->startInternal(__FILE__, __LINE__)) {
+            em->causedBy(e);
+            em->internal() << "Bad simulation type";
+            em->stopIO();
+          }
+          avg.is_valid = false;
+    } // switch
+  }
+  catch (...) {
+    FinishThreads(x, oldlocals, streams);
+    x.stream = old;
+    delete se;
+    throw;
+  }
+  FinishThreads(x, oldlocals, streams);
 
   if (avg.is_valid) {
     x.answer->setConfidence( avg.average,
@@ -245,28 +297,84 @@ void monte_carlo_engine
   delete se;
 }
 
+void monte_carlo_engine::FinishThreads(traverse_data &x,
+  local_values* oldlocals, std::vector <rng_stream*> &streams) const
+{
+  if (streams.size() < 2) return;
+  SetConcurrentFunctionCalls(false);
+  delete x.locals;
+  x.locals = oldlocals;
+  rngm->InitStreamByJumping(rng_main, streams.back());
+  for (unsigned t=1; t<streams.size(); t++) {
+    delete streams[t];
+  }
+  streams.resize(1);
+}
+
 // **************************************************************************
 // *                                                                        *
 // *                      Simulation of avg(rand real)                      *
 // *                                                                        *
 // **************************************************************************
 
+/** Sample a rand real expression.
+    Copies for other threads have their own traverse data,
+    with their own stream and their own values of constant
+    functions (see local_values), so that rand symbols
+    are sampled independently by each thread.
+*/
 class real_expr_experiment : public sim_experiment {
   expr* e;
+  // For clones only
+  traverse_data* myx;
+  result myans;
+
   traverse_data &x;
+  const std::vector <rng_stream*> &streams;
 public:
-  real_expr_experiment(expr* what, traverse_data &where)
-   : sim_experiment(), x(where) { e = what; }
+  real_expr_experiment(expr* what, traverse_data &where,
+    const std::vector <rng_stream*> &s)
+   : sim_experiment(), myx(0), x(where), streams(s) { e = what; }
 
-  virtual ~real_expr_experiment() { };
+  virtual ~real_expr_experiment() {
+    if (myx) delete myx->locals;
+    delete myx;
+  }
 
   virtual void PerformExperiment(sim_outcome* r, int n);
+  virtual sim_experiment* Clone(int t) const;
+private:
+  real_expr_experiment(const real_expr_experiment* orig, int t);
 };
 
+real_expr_experiment
+::real_expr_experiment(const real_expr_experiment* orig, int t)
+ : sim_experiment(), myx(new traverse_data(orig->x)), x(*myx),
+   streams(orig->streams)
+{
+  e = orig->e;
+  x.answer = &myans;
+  x.stream = streams[t];
+  x.locals = new local_values;
+}
+
+sim_experiment* real_expr_experiment::Clone(int t) const
+{
+  if (0==x.locals) return 0;    // not set up for threads
+  if (t < 1 || unsigned(t) >= streams.size()) return 0;
+  return new real_expr_experiment(this, t);
+}
+
 void real_expr_experiment::PerformExperiment(sim_outcome* r, int n)
 {
   DCASSERT(1==n);
-  if (e)  e->ClearCache();
+  if (e) {
+    traverse_data cc(traverse_data::ClearCache);
+    result foo;
+    cc.answer = &foo;
+    cc.locals = x.locals;
+    e->Traverse(cc);
+  }
   SafeCompute(e, x);
   if (x.answer->isNormal()) {
     DCASSERT(e);
@@ -286,21 +394,519 @@ void real_expr_experiment::PerformExperiment(sim_outcome* r, int n)
 class sim_rr_avg : public monte_carlo_engine {
 public:
   sim_rr_avg();
-  virtual sim_experiment* MakeExperiment(expr* e, traverse_data &x) const;
+  virtual sim_experiment* MakeExperiment(expr* e, traverse_data &x,
+        const std::vector <rng_stream*> &streams) const;
 };
 
 sim_rr_avg::sim_rr_avg() : monte_carlo_engine()
 {
 }
 
-sim_experiment* sim_rr_avg::MakeExperiment(expr* e, traverse_data &x) const
+sim_experiment* sim_rr_avg::MakeExperiment(expr* e, traverse_data &x,
+  const std::vector <rng_stream*> &streams) const
 {
-  return new real_expr_experiment(e, x);
+  return new real_expr_experiment(e, x, streams);
 }
 
 sim_rr_avg the_sim_rr_avg;
 
 
+// **************************************************************************
+// *                                                                        *
+// *                    Batch means simulation of models                    *
+// *                                                                        *
+// **************************************************************************
+
+/** Model state, as seen by the simulation library.
+    Only tangible states are visible; immediate events
+    are fired when the state is reached.
+*/
+class sim_state {
+public:
+  shared_state* st;
+  /// Enabling expression values in st (see dsde_hlm::saveEnabling()).
+  std::vector <signed char> known;
+  /// Is each event enabled in st, taking priorities into account.
+  std::vector <char> enabled;
+public:
+  sim_state(const dsde_hlm* dsm, int ne) : known(ne, 0), enabled(ne, 0) {
+    st = new shared_state(dsm);
+  }
+  ~sim_state() {
+    Delete(st);
+  }
+};
+
+/// Measure to estimate, and how to obtain its value in a state.
+struct sim_measure {
+  measure* m;
+  bool is_bool;
+};
+
+/** A dsde_hlm model, for the simulation library.
+    Events have the same indexes as in the model's event array;
+    only exponentially distributed events are timed,
+    and immediate events are never enabled in visible states.
+
+    Enabling is updated incrementally: after an event fires,
+    only the enabling expressions that depend on the state
+    variables it changes are evaluated again, and only the
+    events whose enabling or rate may have changed are
+    rescheduled by the library.
+*/
+class dsde_sim_model : public sim_model {
+public:
+  /// Error codes, returned by the model functions.
+  enum code {
+    OK = 0,
+    Bad_Initial,
+    Bad_Enabling,
+    Bad_Vanishing,
+    Bad_Nextstate,
+    Bad_Weight,
+    Bad_Rate,
+    Vanishing_Loop,
+    Bad_Measure,
+    Assertion_Failed
+  };
+  /// Longest chain of immediate events, before we give up.
+  static const long MAX_VANISHING_CHAIN = 1000000;
+private:
+  dsde_hlm* dsm;
+  rng_stream* rng;
+  traverse_data x;
+  result xans;
+  List <model_event> enabled_list;
+  /// Scratch state, for firing immediate events.
+  shared_state* tmp_st;
+  /// Index of each event, in the model's event array.
+  std::map <const model_event*, int> index_of;
+  /// For each event t, the events whose enabling or rate may change when t fires.
+  std::vector < std::vector <int> > affects;
+  /// Events fired by the last call to FillNextState().
+  std::vector <int> fired;
+  /// Events that may have changed, by the last call to FillNextState().
+  std::vector <int> changed;
+  std::vector <char> mark;
+  std::vector <signed char> inherited;
+  /// Error from a function that cannot return one.
+  int error;
+public:
+  dsde_sim_model(dsde_hlm* m, rng_stream* r);
+  virtual ~dsde_sim_model();
+
+  virtual sim_state* CreateState() const;
+  virtual void DestroyState(sim_state* &state) const;
+  virtual int FillInitialState(sim_state* state);
+  virtual int FillNextState(int evno, const sim_state* curr, sim_state* next);
+  virtual bool IsEventEnabled(int evno, const sim_state* state);
+  virtual double GenerateEventTime(int evno, const sim_state* state);
+  virtual double GetEventSpeed(int evno, const sim_state* state);
+  virtual int GetAffectedEvents(const int* &list);
+  virtual int EvaluateMeasures(const sim_state* state,
+        int N, void* msrdata, double* vlist);
+
+  inline int getError() const { return error; }
+
+private:
+  /// Fire immediate events until st is tangible.
+  int Stabilize(shared_state* st);
+  /// Decide the enabled events of a tangible state.
+  int FinishState(const sim_state* from, sim_state* s);
+  /// Pick one enabled immediate event, according to the weights.
+  model_event* ChooseImmediate();
+  int Failed(int c, const char* what, const model_event* t);
+};
+
+dsde_sim_model::dsde_sim_model(dsde_hlm* m, rng_stream* r)
+ : sim_model(m->getNumEvents()), x(traverse_data::Compute)
+{
+  dsm = m;
+  rng = r;
+  x.answer = &xans;
+  x.stream = r;
+  tmp_st = new shared_state(dsm);
+  for (int i=0; i<num_events; i++) {
+    index_of[dsm->readEvent(i)] = i;
+  }
+  dsm->buildEnablingAffects();
+  dsm->buildTimingAffects(affects);
+  mark.resize(num_events, 0);
+  error = OK;
+}
+
+dsde_sim_model::~dsde_sim_model()
+{
+  Delete(tmp_st);
+}
+
+sim_state* dsde_sim_model::CreateState() const
+{
+  return new sim_state(dsm, num_events);
+}
+
+void dsde_sim_model::DestroyState(sim_state* &state) const
+{
+  delete state;
+  state = 0;
+}
+
+int dsde_sim_model::FillInitialState(sim_state* state)
+{
+  const int ni = dsm->NumInitialStates();
+  if (ni < 1) return Failed(Bad_Initial, "No initial state", 0);
+  int which = 0;
+  if (ni > 1) {
+    double total = 0;
+    for (int i=0; i<ni; i++) total += dsm->GetInitialState(i, state->st);
+    double u = rng->Uniform64() * total;
+    for (which=0; which+1<ni; which++) {
+      u -= dsm->GetInitialState(which, state->st);
+      if (u < 0) break;
+    }
+  }
+  dsm->GetInitialState(which, state->st);
+  fired.clear();
+  int c = Stabilize(state->st);
+  if (c) return c;
+  return FinishState(0, state);
+}
+
+int dsde_sim_model::FillNextState(int evno, const sim_state* curr, sim_state* next)
+{
+  if (error) return error;
+  model_event* t = dsm->getEvent(evno);
+  next->st->fillFrom(curr->st);
+  fired.clear();
+  fired.push_back(evno);
+  if (t->getNextstate()) {
+    x.current_state = curr->st;
+    x.next_state = next->st;
+    t->computeNextstate(x);
+    if (!xans.isNormal()) return Failed(Bad_Nextstate, "Bad next-state expression for event ", t);
+  }
+  int c = Stabilize(next->st);
+  if (c) return c;
+  return FinishState(curr, next);
+}
+
+bool dsde_sim_model::IsEventEnabled(int evno, const sim_state* state)
+{
+  CHECK_RANGE(0, evno, num_events);
+  return state->enabled[evno];
+}
+
+double dsde_sim_model::GenerateEventTime(int evno, const sim_state* state)
+{
+  // Rates are speeds; every event needs an expo(1) amount of work.
+  return -log(rng->Uniform64());
+}
+
+double dsde_sim_model::GetEventSpeed(int evno, const sim_state* state)
+{
+  const model_event* t = dsm->readEvent(evno);
+  x.current_state = state->st;
+  x.which = traverse_data::ComputeExpoRate;
+  t->computeExpoRate(x);
+  x.which = traverse_data::Compute;
+  if (xans.isNormal() && xans.getReal() > 0) return xans.getReal();
+  if (0==error) {
+    if (dsm->StartError(0)) {
+      dsm->SendError("Bad value ");
+      dsm->SendRealError(xans);
+      dsm->SendError(" for rate of event ");
+      dsm->SendError(t->Name());
+      dsm->SendError(" during simulation");
+      dsm->DoneError();
+    }
+    error = Bad_Rate;
+  }
+  // Anything positive; we stop at the next event anyway
+  return 1.0;
+}
+
+int dsde_sim_model::GetAffectedEvents(const int* &list)
+{
+  list = changed.data();
+  return changed.size();
+}
+
+int dsde_sim_model::EvaluateMeasures(const sim_state* state,
+  int N, void* msrdata, double* vlist)
+{
+  const sim_measure* msrs = (const sim_measure*) msrdata;
+  x.current_state = state->st;
+  for (int i=0; i<N; i++) {
+    msrs[i].m->ComputeRHS(x);
+    if (!xans.isNormal()) {
+      if (dsm->StartError(msrs[i].m)) {
+        dsm->SendError("Bad value for measure ");
+        dsm->SendError(msrs[i].m->Name());
+        dsm->SendError(" during simulation");
+        dsm->DoneError();
+      }
+      return Bad_Measure;
+    }
+    if (msrs[i].is_bool) {
+      vlist[i] = xans.getBool() ? 1.0 : 0.0;
+    } else {
+      vlist[i] = xans.getReal();
+    }
+  }
+  return OK;
+}
+
+int dsde_sim_model::Stabilize(shared_state* st)
+{
+  x.current_state = st;
+  x.next_state = tmp_st;
+  for (long n=0; ; n++) {
+    dsm->checkVanishing(x);
+    if (!xans.isNormal()) return Failed(Bad_Vanishing, "Couldn't determine vanishing / tangible", 0);
+    if (!xans.getBool()) break;
+    if (n >= MAX_VANISHING_CHAIN) {
+      return Failed(Vanishing_Loop, "Too many consecutive immediate events (vanishing loop?)", 0);
+    }
+    dsm->makeVanishingEnabledList(x, &enabled_list);
+    if (!xans.isNormal()) {
+      if (2 == enabled_list.Length()) {
+        return Failed(Bad_Weight, "Immediate events with different weight classes enabled: ", enabled_list.Item(0));
+      }
+      return Failed(Bad_Enabling, "Bad enabling expression for event ", enabled_list.Item(0));
+    }
+    model_event* t = ChooseImmediate();
+    if (0==t) return Bad_Weight;
+    fired.push_back(index_of[t]);
+    if (0==t->getNextstate()) continue;
+    tmp_st->fillFrom(st);
+    t->computeNextstate(x);
+    if (!xans.isNormal()) return Failed(Bad_Nextstate, "Bad next-state expression for event ", t);
+    st->fillFrom(tmp_st);
+  }
+  dsm->checkAssertions(x);
+  if (!xans.getBool()) return Assertion_Failed;
+  return OK;
+}
+
+int dsde_sim_model::FinishState(const sim_state* from, sim_state* s)
+{
+  x.current_state = s->st;
+  if (from) {
+    // enabling values not changed by the fired events carry over
+    inherited = from->known;
+    for (unsigned i=0; i<fired.size(); i++) {
+      dsm->inheritEnabling(dsm->readEvent(fired[i]), inherited, s->known);
+      inherited.swap(s->known);
+    }
+    dsm->makeTangibleEnabledList(x, &enabled_list, inherited);
+  } else {
+    dsm->makeTangibleEnabledList(x, &enabled_list);
+  }
+  if (!xans.isNormal()) {
+    return Failed(Bad_Enabling, "Bad enabling expression for event ", enabled_list.Item(0));
+  }
+  dsm->saveEnabling(s->known);
+  for (int i=0; i<num_events; i++) {
+    s->enabled[i] = dsm->readEvent(i)->knownEnabled();
+  }
+
+  //
+  // Events that may need rescheduling: enabling changed,
+  // or the rate may have changed.
+  //
+  changed.clear();
+  if (0==from) return OK;
+  for (int i=0; i<num_events; i++) {
+    if (from->enabled[i] == s->enabled[i]) continue;
+    changed.push_back(i);
+    mark[i] = 1;
+  }
+  for (unsigned f=0; f<fired.size(); f++) {
+    const std::vector <int> &A = affects[fired[f]];
+    for (unsigned a=0; a<A.size(); a++) {
+      if (mark[A[a]] || !s->enabled[A[a]]) continue;
+      changed.push_back(A[a]);
+      mark[A[a]] = 1;
+    }
+  }
+  for (unsigned i=0; i<changed.size(); i++) mark[changed[i]] = 0;
+  return OK;
+}
+
+model_event* dsde_sim_model::ChooseImmediate()
+{
+  DCASSERT(enabled_list.Length() > 0);
+  if (1==enabled_list.Length()) return enabled_list.Item(0);
+  std::vector <double> w(enabled_list.Length());
+  double total = 0;
+  for (int i=0; i<enabled_list.Length(); i++) {
+    model_event* t = enabled_list.Item(i);
+    SafeCompute(t->getWeight(), x);
+    if (!xans.isNormal() || xans.getReal() <= 0) {
+      if (dsm->StartError(0)) {
+        dsm->SendError("Bad value ");
+        dsm->SendRealError(xans);
+        dsm->SendError(" for weight of event ");
+        dsm->SendError(t->Name());
+        dsm->SendError(" during simulation");
+        dsm->DoneError();
+      }
+      return 0;
+    }
+    w[i] = xans.getReal();
+    total += w[i];
+  }
+  double u = rng->Uniform64() * total;
+  int i;
+  for (i=0; i+1<enabled_list.Length(); i++) {
+    u -= w[i];
+    if (u < 0) break;
+  }
+  return enabled_list.Item(i);
+}
+
+int dsde_sim_model::Failed(int c, const char* what, const model_event* t)
+{
+  if (dsm->StartError(0)) {
+    dsm->SendError(what);
+    if (t) dsm->SendError(t->Name());
+    if (Bad_Nextstate == c) dsm->OutOfBoundsError(xans);
+    dsm->SendError(" during simulation");
+    dsm->DoneError();
+  }
+  return c;
+}
+
+/** Steady-state measures, estimated with batch means
+    on a single long simulation run of the model.
+    The state space is never built.
+*/
+class batch_means_engine : public sim_engine {
+  static reporting_msg report;
+  static warning_msg absorbed;
+  static long Batches;
+  static long BatchSize;
+public:
+  batch_means_engine();
+  virtual ~batch_means_engine();
+
+  virtual bool AppliesToModelType(hldsm::model_type mt) const;
+  virtual void SolveMeasures(hldsm* m, set_of_measures* list);
+
+  friend class init_simul;
+};
+
+reporting_msg batch_means_engine::report;
+warning_msg batch_means_engine::absorbed;
+long batch_means_engine::Batches;
+long batch_means_engine::BatchSize;
+
+batch_means_engine the_batch_means_engine;
+
+// **************************************************************************
+// *                       batch_means_engine methods                       *
+// **************************************************************************
+
+batch_means_engine::batch_means_engine() : sim_engine()
+{
+}
+
+batch_means_engine::~batch_means_engine()
+{
+}
+
+bool batch_means_engine::AppliesToModelType(hldsm::model_type mt) const
+{
+  return (hldsm::Asynch_Events == mt);
+}
+
+void batch_means_engine::SolveMeasures(hldsm* mdl, set_of_measures* list)
+{
+  dsde_hlm* dsm = dynamic_cast <dsde_hlm*> (mdl);
+  if (0==dsm) throw No_Engine;
+
+  for (int i=0; i<dsm->getNumEvents(); i++) {
+    const model_event* t = dsm->readEvent(i);
+    if (t->actsLikeImmediate() || t->hasFiringType(model_event::Expo)) continue;
+    if (dsm->StartError(0)) {
+      dsm->SendError("Simulation requires immediate or exponential events; event ");
+      dsm->SendError(t->Name());
+      dsm->SendError(" is ");
+      dsm->SendError(model_event::nameOf(t->getFiringType()));
+      dsm->DoneError();
+    }
+    throw Engine_Failed;
+  }
+
+  //
+  // Measures we can estimate
+  //
+  std::vector <sim_measure> msrs;
+  for (measure* m = list->popMeasure(); m; m=list->popMeasure()) {
+    const type* mt = m->RHSType();
+    if (mt) mt = mt->getBaseType();
+    if (mt != em->REAL && mt != em->BOOL) {
+      // e.g., distributions; not possible without the states
+      m->SetNull();
+      continue;
+    }
+    m->PrecomputeRHS();
+    sim_measure sm;
+    sm.m = m;
+    sm.is_bool = (mt == em->BOOL);
+    msrs.push_back(sm);
+  }
+  if (msrs.empty()) return;
+
+  timer watch;
+  dsde_sim_model sm(dsm, rng_main);
+  std::vector <sim_confintl> est(msrs.size());
+  int code = SIM_BatchMeans(&sm, msrs.size(), msrs.data(), est.data(),
+    Batches, BatchSize, GetConfidence());
+  if (0==code) code = sm.getError();
+  if (code) {
+    for (unsigned i=0; i<msrs.size(); i++) msrs[i].m->SetNull();
+    throw Engine_Failed;
+  }
+
+  if (!est[0].is_valid) {
+    // Absorbed; the measures depend on which absorbing state was reached
+    if (dsm->StartWarning(absorbed, 0)) {
+      em->warn() << "Simulation reached a state with no enabled events";
+      em->warn() << " after " << est[0].samples << " events;";
+      em->newLine();
+      em->warn() << "steady-state measures are unknown";
+      dsm->DoneWarning();
+    }
+  }
+  for (unsigned i=0; i<msrs.size(); i++) {
+    result v;
+    if (est[i].is_valid) {
+      v.setConfidence( est[i].average,
+        new conf_intl(est[i].half_width, est[i].confidence) );
+    } else {
+      v.setUnknown();
+    }
+    msrs[i].m->SetValue(v);
+  }
+
+  if (report.startReport()) {
+    report.report() << "Finished batch means simulation of model ";
+    report.report() << dsm->Name() << "\n";
+    report.report() << "\t" << Batches << " batches of ";
+    report.report() << BatchSize << " events\n";
+    report.report() << "\t" << long(msrs.size()) << " measures estimated\n";
+    for (unsigned i=0; i<msrs.size(); i++) {
+      report.report() << "\t" << msrs[i].m->Name() << ": lag-1 autocorrelation ";
+      report.report() << est[i].autocorrelation << "\n";
+    }
+    report.report() << "Batch_Means: Simulation took ";
+    report.report() << watch.elapsed_seconds() << " seconds\n";
+    report.stopIO();
+  }
+}
+
+
 // **************************************************************************
 // *                                                                        *
 // *                           jump_watcher class                           *
@@ -381,6 +987,8 @@ init_simul::init_simul() : initializer("init_simul")
 {
   usesResource("em");
   usesResource("engtypes");
+  // so that EXACT stays the default for steady-state measures
+  usesResource("exactengines");
 }
 
 bool init_simul::execute()
@@ -397,6 +1005,9 @@ bool init_simul::execute()
   sim_engine::Confidence = 0.95;
   sim_engine::Precision = 0.001;
   sim_engine::Type = sim_engine::V_SAMPLES;
+  sim_engine::Threads = 1;
+  batch_means_engine::Batches = 100;
+  batch_means_engine::BatchSize = 10000;
 
   //
   // Add options
@@ -436,12 +1047,38 @@ bool init_simul::execute()
       "SAMPLES",
       "Number of samples (i.e., iterations) varies", sim_engine::V_SAMPLES
     );
+
+    em->OptMan()->addIntOption(
+      "SimThreads",
+      "Number of threads for Monte Carlo simulations.  Thread t uses its own random number stream, t jumps ahead of the main one (see option RngStreamSeparation), and runs a fixed share of the samples.  Results are reproducible for a given seed and number of threads, but change with the number of threads.",
+      sim_engine::Threads, 1, 1024
+    );
+
+    em->OptMan()->addIntOption(
+      "SimBatches",
+      "Number of batches for batch means simulation of models.",
+      batch_means_engine::Batches, 2, 1000000000
+    );
+
+    em->OptMan()->addIntOption(
+      "SimBatchSize",
+      "Number of events in each batch, for batch means simulation of models.  Batches should be long enough for the batch means to be nearly independent.",
+      batch_means_engine::BatchSize, 1, 1000000000
+    );
   }
 
   monte_carlo_engine::report.initialize(em->OptMan(), "Monte_Carlo",
     "When set, Monte Carlo Simulation performance data is displayed."
   );
 
+  batch_means_engine::report.initialize(em->OptMan(), "Batch_Means",
+    "When set, batch means simulation performance data is displayed."
+  );
+
+  batch_means_engine::absorbed.initialize(em->OptMan(), "sim_absorbed",
+    "For batch means simulations that reach a state with no enabled events"
+  );
+
   //
   // RNG options and such.
   //
@@ -485,6 +1122,13 @@ bool init_simul::execute()
     &the_sim_rr_avg
   );
 
+  RegisterEngine(em,
+    "SteadyStateAverage",
+    "SIMULATION",
+    "Batch means simulation of the model, without building the state space.",
+    &the_batch_means_engine
+  );
+
   //
   // Register libraries
   //
@@ -21,6 +21,12 @@ bool sv_encoder::Equals(const shared_object *o) const
   return (this == o);
 }
 
+void sv_encoder::buildMinMax(bool, const shared_object*,
+  const shared_object*, shared_object*)
+{
+  throw Failed;
+}
+
 const char* sv_encoder::getNameOfError(error e)
 {
   switch (e) {
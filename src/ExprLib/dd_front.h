@@ -260,6 +260,20 @@ public:
                             const shared_object* right,
                             shared_object* ans) = 0;
 
+  /** Build the minimum or maximum of two DD nodes.
+      The default implementation throws Failed.
+        @param  is_max  Maximum (otherwise, minimum).
+        @param  left    Left operand.
+        @param  right   Right operand.
+        @param  ans     An edge for storing the result,
+                        should have been created by makeEdge().
+                        Can be the same pointer as \a left or \a right.
+        @throws         Appropriate error code.
+  */
+  virtual void  buildMinMax(bool is_max, const shared_object* left,
+                            const shared_object* right,
+                            shared_object* ans);
+
 
   /** Determine the cardinality of a DD node.
       Normally that means the number of minterms that lead
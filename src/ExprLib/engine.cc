@@ -92,6 +92,9 @@ const char* subengine::getNameOfError(error e)
     case Bad_Value:
         return "Illegal value for engine parameter";
 
+    case IO_Failed:
+        return "Engine file input/output failed";
+
     case Engine_Failed:
         return "Engine failed";
   }
@@ -61,6 +61,8 @@ public:
     Assertion_Failure,
     /// Bad value for an engine parameter
     Bad_Value,
+    /// The engine could not open, read, or write a (temporary) file.
+    IO_Failed,
     /// Some other fatal run-time error with the engine.
     Engine_Failed
   };
@@ -369,6 +369,7 @@ void expr::Traverse(traverse_data &x)
   switch (x.which) {
     case traverse_data::None:
     case traverse_data::Block:
+    case traverse_data::ClearCache:
         return;
 
     case traverse_data::GetProducts:
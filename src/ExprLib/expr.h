@@ -27,6 +27,7 @@ class shared_state; // defined in mod_vars.h
 
 class expr;    // defined below
 class symbol;  // defined in symbols.h
+class local_values;  // defined in symbols.h
 
 // ******************************************************************
 // *                                                                *
@@ -110,6 +111,9 @@ struct traverse_data {
   /// Parent model, if any.
   model_def* model;
 
+  /// Per-thread values of constant functions, if any.
+  local_values* locals;
+
   /// The return value, usually.
   result* answer;
 
@@ -150,6 +154,7 @@ public:
     ddlib = 0;
     parent = 0;
     model = 0;
+    locals = 0;
     elist = 0;
     slist = 0;
     the_type = 0;
@@ -9,6 +9,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <limits.h>   // for INT_MIN
+#include <mutex>
 
 #include "values.h"  // for constant defaults
 
@@ -127,7 +128,8 @@ void fcall::Traverse(traverse_data &x)
 
     case traverse_data::GetVarDeps:
     case traverse_data::GetSymbols:
-    case traverse_data::PreCompute: {
+    case traverse_data::PreCompute:
+    case traverse_data::ClearCache: {
         for (int i=0; i<numpass; i++) if (pass[i]) {
           pass[i]->Traverse(x);
         } // for i
@@ -1385,6 +1387,9 @@ class top_user_func : public user_func {
   static long stack_size;
   static long stack_top;
   static result* stackptr;
+  /// Serializes calls while several threads evaluate expressions.
+  static std::recursive_mutex stack_lock;
+  static bool concurrent;
 public:
   top_user_func(function* f, formal_param** pl, int np);
   top_user_func(const location &W, const type* t, char* n,
@@ -1396,6 +1401,7 @@ public:
 
   // friends, because of stack manipulation
   friend void InitFunctions(exprman* om);
+  friend void SetConcurrentFunctionCalls(bool on);
 
   friend class stack_size_watcher;
 };
@@ -1404,6 +1410,8 @@ result* top_user_func::stack;
 result* top_user_func::stackptr;
 long top_user_func::stack_size;
 long top_user_func::stack_top;
+std::recursive_mutex top_user_func::stack_lock;
+bool top_user_func::concurrent = false;
 
 
 top_user_func::top_user_func(function* f, formal_param** pl, int np)
@@ -1437,6 +1445,10 @@ void top_user_func::Compute(traverse_data &x, expr** pass, int np)
     return;
   }
 
+  // the stack is shared; one caller at a time
+  std::unique_lock <std::recursive_mutex> guard(stack_lock, std::defer_lock);
+  if (concurrent) guard.lock();
+
   // first... make sure there is enough room on the stack to save params
   if (stack_top+np > stack_size) {
     if (em->startError()) {
@@ -1908,6 +1920,11 @@ expr* DefineUserFunction(const exprman* em, const location &W,
 
 
 
+void SetConcurrentFunctionCalls(bool on)
+{
+  top_user_func::concurrent = on;
+}
+
 void InitFunctions(exprman* em)
 {
   top_user_func::stack = new result[init_stack_size];
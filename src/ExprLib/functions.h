@@ -754,6 +754,15 @@ void ResetUserFunctionParams(const exprman* em, const location &W,
 expr* DefineUserFunction(const exprman* em, const location &W,
                           symbol* userfunc, expr* rhs, model_def* mdl);
 
+/** Allow (or stop allowing) several threads to evaluate
+    expressions that call user-defined functions.
+    Top-level user functions share a single run-time stack,
+    so while this is on, their calls are serialized.
+    Not thread safe; switch it before starting worker threads.
+      @param  on  true, if calls may come from several threads.
+*/
+void SetConcurrentFunctionCalls(bool on);
+
 void InitFunctions(exprman* om);
 
 #endif
@@ -88,6 +88,10 @@ public:
   inline const type* RHSType() const { 
     return rhs ? rhs->Type() : 0;
   }
+  /// The right hand side; measures that share it have equal values.
+  inline const expr* GetRHS() const {
+    return rhs;
+  }
   void Solve(traverse_data &x);
   virtual void Compute(traverse_data &x);
   virtual void Traverse(traverse_data &x);
@@ -99,6 +99,17 @@ void model_def::BuildModel(traverse_data &x)
   // Build new instance
   current = new model_instance(x.parent ? x.parent->Where() : location::NOWHERE(), this);
 
+  // Remember the parameters, for checking saved processes
+  StringStream ps;
+  for (int i=0; i<formals.getLength(); i++) {
+    if (i) ps << ", ";
+    const type* t = formals.getType(i);
+    DCASSERT(t);
+    if (t->isPrintable()) t->print(ps, current_params[i], 0, 17);
+    else                  ps << "?";
+  }
+  current->SetParameters(ps.GetString());
+
   InitModel();
   DCASSERT(stmt_block);
   stmt_block->Compute(x);
@@ -10,6 +10,8 @@
 #include "measures.h"
 #include "engine.h"
 
+#include <stdlib.h>
+
 // #define ARRAY_TRACE
 // #define DEBUG_PARTINFO
 
@@ -319,6 +321,7 @@ model_instance::model_instance(const location &W, const model_def* dfn)
   state = Constructing;
 
   compiled =0;
+  params = 0;
 
   if (dfn) {
     num_symbols = dfn->NumSlots();
@@ -534,6 +537,12 @@ void model_instance::SetConstructionError()
   // cleanup?
 }
 
+void model_instance::SetParameters(char* p)
+{
+  free(params);
+  params = p;
+}
+
 void model_instance::Deconstruct()
 {
   if (Deleted == state)  return;
@@ -563,6 +572,9 @@ void model_instance::Deconstruct()
   Delete(compiled);
   compiled = 0;
 
+  free(params);
+  params = 0;
+
   for (int i=0; i<num_groups; i++) delete mgroups[i];
   delete[] mgroups;
   num_groups = 0;
@@ -367,6 +367,9 @@ private:
   /// Discrete-state, compiled "meta" model used by engines.
   hldsm* compiled;
 
+  /// Parameter values the instance was built with, as text, or 0.
+  char* params;
+
   /** Symbols that can be exported (usually measures or arrays of measures).
       Stored as an array of symbols, sorted by name.
   */
@@ -387,6 +390,15 @@ public:
   inline instance_state GetState() const { return state; }
   inline hldsm* GetCompiledModel() const { return compiled; }
 
+  /** Record the parameter values used to build the instance.
+        @param  p   Text, one value per parameter, separated by
+                    commas.  Allocated with malloc; we take ownership.
+  */
+  void SetParameters(char* p);
+
+  /// Parameter values used to build the instance, as text.
+  inline const char* GetParameters() const { return params ? params : ""; }
+
   /** Start a warning message.
       Returns true on success.
   */
@@ -351,7 +351,12 @@ void constfunc::Compute(traverse_data &x)
 {
   DCASSERT(x.answer);
   DCASSERT(0==x.aggregate);
-  if (WillSubstitute()) {
+  local_values::entry* le = x.locals ? x.locals->find(this) : 0;
+  if (le && le->known) {
+    *(x.answer) = le->value;
+    return;
+  }
+  if (0==le && WillSubstitute()) {
     *(x.answer) = cache;
     return;
   }
@@ -362,8 +367,11 @@ void constfunc::Compute(traverse_data &x)
       if (item->isComputed()) continue;
       item->Compute(x);
     } // for i
-    delete deplist;
-    deplist = 0;
+    // with local values, other threads may be using the list
+    if (0==x.locals) {
+      delete deplist;
+      deplist = 0;
+    }
   } // if deplist
   SafeCompute(return_expr, x);
   // neat trick!!!
@@ -372,6 +380,14 @@ void constfunc::Compute(traverse_data &x)
     DCASSERT(mi);
     mi->Rename(SharedName());
   }
+  if (x.locals) {
+    if (Type() != em->VOID) {
+      le = &(x.locals->get(this));
+      le->value = *(x.answer);
+      le->known = true;
+    }
+    return;
+  }
   cache = *(x.answer);
   if (Type() != em->VOID) {
     SetSubstitution(true);
@@ -382,7 +398,12 @@ void constfunc::Traverse(traverse_data &x)
 {
   switch (x.which) {
     case traverse_data::ClearCache:
-        SetSubstitution(false);
+        if (x.locals)   x.locals->get(this).known = false;
+        else            SetSubstitution(false);
+        // rand symbols we depend on must be sampled again, too
+        if (0==Type()) return;
+        if (Type()->getModifier() != RAND) return;
+        if (return_expr)  return_expr->Traverse(x);
         return;
 
     case traverse_data::FindRange:
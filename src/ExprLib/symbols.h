@@ -10,6 +10,8 @@
 
 #include "expr.h"
 
+#include <map>
+
 class shared_string;
 class doc_formatter;
 class function;
@@ -85,6 +87,39 @@ public:
 };
 
 
+/** Values of constant functions, private to one thread.
+    When traverse_data::locals is set, constant functions
+    keep their computed values here instead of in the shared
+    expression tree, and a ClearCache traversal forgets the values
+    kept here.  This allows several threads to sample the same
+    "rand" expression at once (see the Monte Carlo engines).
+    Values computed before, and never cleared since,
+    are still taken from the symbols.
+*/
+class local_values {
+public:
+  struct entry {
+    /// Is value current; false if cleared since.
+    bool known;
+    result value;
+    entry() { known = false; }
+  };
+private:
+  std::map <const symbol*, entry> values;
+public:
+  /// Value of symbol s, or 0 if s was never computed or cleared here.
+  inline entry* find(const symbol* s) {
+    std::map <const symbol*, entry>::iterator i = values.find(s);
+    if (i == values.end()) return 0;
+    return &(i->second);
+  }
+  /// Value of symbol s, added (and not known) if necessary.
+  inline entry& get(const symbol* s) {
+    return values[s];
+  }
+};
+
+
 /** Derive from this class for adding new help topics.
 */
 class help_topic : public symbol {
@@ -0,0 +1,916 @@
+
+#include "config.h"
+
+#include "ckpt_msr.h"
+#include "../ExprLib/startup.h"
+#include "../ExprLib/engine.h"
+#include "../ExprLib/measures.h"
+#include "../ExprLib/mod_vars.h"
+#include "../Utils/strings.h"
+#include "../Streams/streams.h"
+
+#include "../Modules/expl_states.h"
+#include "../Modules/statevects.h"
+
+#include "basic_msr.h"
+#include "dsde_hlm.h"
+#include "graph_llm.h"
+#include "stoch_llm.h"
+#include "rss_expl.h"
+#include "rgr_grlib.h"
+#include "proc_mclib.h"
+#include "rss_meddly.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H) && defined(HAVE_UNISTD_H)
+#define USE_MMAP
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+/*
+  Checkpoint file format.
+
+  Integers are written with MEDDLY's varint encoding (zigzag if signed),
+  real values as raw doubles in native byte order; strings as their
+  length and characters.
+
+    header:   "SMARTckpt", version, kind, process type,
+              a double (CKPT_BYTE_ORDER, to check the byte order),
+              model name, model fingerprint (see fingerprint())
+    explicit: #states, ints per state, then each state in index order;
+              initial states (FSM) or initial distribution (MC);
+              then for each state, its outgoing edges (with weights for MCs)
+    meddly:   initial and reachable states, in Meddly's binary format
+    trailer:  "SMARTdone"
+
+  Meddly checkpoints hold only the states; the process is rebuilt
+  from the next-state function, which costs no fixed point iteration.
+*/
+
+const char* const CKPT_MAGIC = "SMARTckpt";
+const char* const CKPT_TRAILER = "SMARTdone";
+const unsigned long CKPT_VERSION = 2;
+const double CKPT_BYTE_ORDER = -1.0 / 3.0;
+const unsigned long CKPT_EXPLICIT = 0;
+const unsigned long CKPT_MEDDLY = 1;
+
+// ******************************************************************
+// *                                                                *
+// *                        ckpt_error class                        *
+// *                                                                *
+// ******************************************************************
+
+/// Problem with a checkpoint, not detected by Meddly's I/O.
+struct ckpt_error {
+  const char* what;
+  ckpt_error(const char* w) : what(w) { }
+};
+
+// ******************************************************************
+// *                                                                *
+// *                        ckpt_file  class                        *
+// *                                                                *
+// ******************************************************************
+
+/**
+    Contents of a checkpoint file, read-only.
+    Memory mapped when possible, otherwise read into a buffer.
+*/
+class ckpt_file {
+  public:
+    ckpt_file(const char* name);
+    ~ckpt_file();
+
+    inline bool isOpen() const { return data; }
+    inline const unsigned char* getData() const { return data; }
+    inline size_t getLength() const { return length; }
+
+  private:
+    const unsigned char* data;
+    size_t length;
+    bool mapped;
+};
+
+ckpt_file::ckpt_file(const char* name)
+{
+  data = 0;
+  length = 0;
+  mapped = false;
+
+  FILE* f = fopen(name, "rb");
+  if (0==f) return;
+  if (fseek(f, 0, SEEK_END) || ftell(f) <= 0) {
+    fclose(f);
+    return;
+  }
+  length = ftell(f);
+
+#ifdef USE_MMAP
+  void* m = mmap(0, length, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+  if (MAP_FAILED != m) {
+    data = (const unsigned char*) m;
+    mapped = true;
+    fclose(f);
+    return;
+  }
+#endif
+
+  unsigned char* buffer = (unsigned char*) malloc(length);
+  rewind(f);
+  if (buffer && fread(buffer, 1, length, f) == length) {
+    data = buffer;
+  } else {
+    free(buffer);
+  }
+  fclose(f);
+}
+
+ckpt_file::~ckpt_file()
+{
+#ifdef USE_MMAP
+  if (mapped) {
+    munmap((void*) data, length);
+    return;
+  }
+#endif
+  free((void*) data);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                       ckpt_output  class                       *
+// *                                                                *
+// ******************************************************************
+
+/**
+    Meddly output to a FILE.
+    Needed because MEDDLY::FILE_output is compiled out of SMART.
+*/
+class ckpt_output : public MEDDLY::output {
+  public:
+    ckpt_output(FILE* f);
+    virtual ~ckpt_output();
+    virtual void put(char x);
+    virtual void put(const char* x, int w);
+    virtual void put(long x, int w);
+    virtual void put(unsigned long x, int w);
+    virtual void put_hex(unsigned long x, int w);
+    virtual void put(double x, int w, int p, char f);
+    virtual size_t write(size_t bytes, const unsigned char* buffer);
+    virtual void flush();
+
+  private:
+    inline void check(int r) {
+      if (r < 0) {
+        throw MEDDLY::error(MEDDLY::error::COULDNT_WRITE, __FILE__, __LINE__);
+      }
+    }
+
+  private:
+    FILE* outf;
+};
+
+ckpt_output::ckpt_output(FILE* f) : output()
+{
+  outf = f;
+}
+
+ckpt_output::~ckpt_output()
+{
+}
+
+void ckpt_output::put(char x)
+{
+  check(fputc(x, outf));
+}
+
+void ckpt_output::put(const char* x, int w)
+{
+  check(fprintf(outf, "%*s", w, x));
+}
+
+void ckpt_output::put(long x, int w)
+{
+  check(fprintf(outf, "%*ld", w, x));
+}
+
+void ckpt_output::put(unsigned long x, int w)
+{
+  check(fprintf(outf, "%*lu", w, x));
+}
+
+void ckpt_output::put_hex(unsigned long x, int w)
+{
+  check(fprintf(outf, "%*lx", w, x));
+}
+
+void ckpt_output::put(double x, int w, int p, char f)
+{
+  switch (f) {
+    case 'e':   check(fprintf(outf, "%*.*e", w, p, x));   break;
+    case 'f':   check(fprintf(outf, "%*.*f", w, p, x));   break;
+    default:    check(fprintf(outf, "%*.*g", w, p, x));
+  }
+}
+
+size_t ckpt_output::write(size_t bytes, const unsigned char* buffer)
+{
+  return fwrite(buffer, 1, bytes, outf);
+}
+
+void ckpt_output::flush()
+{
+  check(fflush(outf));
+}
+
+// ******************************************************************
+// *                                                                *
+// *                        Header  and I/O                         *
+// *                                                                *
+// ******************************************************************
+
+inline void writeDouble(MEDDLY::output &s, double v)
+{
+  if (s.write(sizeof(double), (const unsigned char*) &v) != sizeof(double)) {
+    throw MEDDLY::error(MEDDLY::error::COULDNT_WRITE, __FILE__, __LINE__);
+  }
+}
+
+inline double readDouble(MEDDLY::input &s)
+{
+  double v;
+  if (s.read(sizeof(double), (unsigned char*) &v) != sizeof(double)) {
+    throw MEDDLY::error(MEDDLY::error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  return v;
+}
+
+/// Read a count, which must be at most max.
+inline long readCount(MEDDLY::input &s, long max)
+{
+  unsigned long c = s.get_varint();
+  if (c > (unsigned long) max) {
+    throw MEDDLY::error(MEDDLY::error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  return long(c);
+}
+
+/// Read a state index, coded relative to prev.
+inline long readIndex(MEDDLY::input &s, long prev, long ns)
+{
+  long i = prev + s.get_zigzag();
+  if (i < 0 || i >= ns) {
+    throw MEDDLY::error(MEDDLY::error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  return i;
+}
+
+void writeString(MEDDLY::output &s, const char* str)
+{
+  const size_t len = strlen(str);
+  s.put_varint(len);
+  if (s.write(len, (const unsigned char*) str) != len) {
+    throw MEDDLY::error(MEDDLY::error::COULDNT_WRITE, __FILE__, __LINE__);
+  }
+}
+
+/// Does the next string in the checkpoint equal str.
+bool matchString(MEDDLY::input &s, const char* str)
+{
+  const size_t len = strlen(str);
+  if (s.get_varint() != len) return false;
+  for (size_t i=0; i<len; i++) {
+    if (s.get_char() != (unsigned char) str[i]) return false;
+  }
+  return true;
+}
+
+/** Text that identifies an instance of a model: the parameters,
+    the state variables with their bounds, and the number of events.
+    Checkpoints for a different instance must not be restored.
+    The state variables are listed by name, because Meddly-based
+    generation may reorder them.
+    Allocated with malloc.
+*/
+char* fingerprint(const model_instance* mi, const hldsm* hlm)
+{
+  StringStream fp;
+  fp << "(" << mi->GetParameters() << ")";
+  const dsde_hlm* dsm = dynamic_cast <const dsde_hlm*> (hlm);
+  if (dsm) {
+    std::vector <std::string> vars;
+    for (int i=0; i<dsm->getNumStateVars(); i++) {
+      const model_statevar* sv = dsm->readStateVar(i);
+      StringStream vs;
+      vs << sv->Name();
+      const long nv = sv->NumPossibleValues();
+      if (nv >= 0) {
+        vs << "{";
+        for (long v=0; v<nv; v++) {
+          result val;
+          sv->GetValueNumber(v, val);
+          vs << (v ? "," : "") << val.getInt();
+        }
+        vs << "}";
+      }
+      vars.push_back(vs.ReadString());
+    }
+    std::sort(vars.begin(), vars.end());
+    for (size_t i=0; i<vars.size(); i++) {
+      fp << (i ? ", " : " ") << vars[i].c_str();
+    }
+    fp << "; " << dsm->getNumEvents() << " events";
+  }
+  return fp.GetString();
+}
+
+void writeHeader(MEDDLY::output &s, unsigned long kind,
+  const model_instance* mi, const hldsm* hlm, lldsm::model_type type)
+{
+  s.put(CKPT_MAGIC, 0);
+  s.put_varint(CKPT_VERSION);
+  s.put_varint(kind);
+  s.put_varint(type);
+  writeDouble(s, CKPT_BYTE_ORDER);
+  writeString(s, hlm->Name() ? hlm->Name() : "");
+  char* fp = fingerprint(mi, hlm);
+  try {
+    writeString(s, fp);
+  }
+  catch (...) {
+    free(fp);
+    throw;
+  }
+  free(fp);
+}
+
+/// Check the header against the model; returns the checkpoint kind.
+unsigned long readHeader(MEDDLY::input &s, const model_instance* mi,
+  const hldsm* hlm)
+{
+  s.consumeKeyword(CKPT_MAGIC);
+  if (s.get_varint() != CKPT_VERSION) {
+    throw ckpt_error("unsupported checkpoint version");
+  }
+  const unsigned long kind = s.get_varint();
+  if (kind != CKPT_EXPLICIT && kind != CKPT_MEDDLY) {
+    throw MEDDLY::error(MEDDLY::error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  if (s.get_varint() != (unsigned long) hlm->GetProcessType()) {
+    throw ckpt_error("checkpoint holds a different type of process");
+  }
+  const double bom = readDouble(s);
+  if (memcmp(&bom, &CKPT_BYTE_ORDER, sizeof(double))) {
+    throw ckpt_error("checkpoint was written with a different byte order");
+  }
+  if (!matchString(s, hlm->Name() ? hlm->Name() : "")) {
+    throw ckpt_error("checkpoint is for a different model");
+  }
+  char* fp = fingerprint(mi, hlm);
+  bool same;
+  try {
+    same = matchString(s, fp);
+  }
+  catch (...) {
+    free(fp);
+    throw;
+  }
+  free(fp);
+  if (!same) {
+    throw ckpt_error("checkpoint does not match the model parameters, state variables, or events");
+  }
+  return kind;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                      Explicit  processes                       *
+// *                                                                *
+// ******************************************************************
+
+void writeExplicitStates(MEDDLY::output &s, const hldsm* hlm,
+  indexed_reachset* irs)
+{
+  long ns;
+  irs->getNumStates(ns);
+  shared_state* st = new shared_state(hlm);
+  if (!st->isFixedSize()) {
+    Delete(st);
+    throw ckpt_error("states of varying size are not supported");
+  }
+  const int size = st->getStateSize();
+  s.put_varint(ns);
+  s.put_varint(size);
+
+  state_lldsm::reachset::iterator &I
+    = irs->iteratorForOrder(state_lldsm::NATURAL);
+  try {
+    long i = 0;
+    for (I.start(); I; I++, i++) {
+      if (I.index() != i) throw ckpt_error("states are not in index order");
+      I.copyState(st);
+      const int* data = st->readState();
+      for (int k=0; k<size; k++) s.put_zigzag(data[k]);
+    }
+  }
+  catch (...) {
+    Delete(st);
+    throw;
+  }
+  Delete(st);
+}
+
+void writeExplicitFSM(MEDDLY::output &s, const indexed_reachset* irs,
+  const grlib_reachgraph* rg)
+{
+  const intset &init = irs->getInitial();
+  s.put_varint(init.cardinality());
+  long prev = 0;
+  for (long i=init.getSmallestAfter(-1); i>=0; i=init.getSmallestAfter(i)) {
+    s.put_zigzag(i - prev);
+    prev = i;
+  }
+
+  const GraphLib::static_graph &E = rg->getOutEdges();
+  DCASSERT(E.isByRows());
+  long ns;
+  irs->getNumStates(ns);
+  if (E.getNumNodes() != ns) {
+    throw ckpt_error("reachability graph does not match the states");
+  }
+  for (long i=0; i<E.getNumNodes(); i++) {
+    s.put_varint(E.getNumEdgesFor(i));
+    prev = i;
+    for (long z=E.RowPointer(i); z<E.RowPointer(i+1); z++) {
+      s.put_zigzag(E.ColumnIndex(z) - prev);
+      prev = E.ColumnIndex(z);
+    }
+  }
+}
+
+void writeExplicitMC(MEDDLY::output &s, const stochastic_lldsm* mlm)
+{
+  statedist* p0 = mlm->getInitialDistribution();
+  if (0==p0) throw ckpt_error("no initial distribution");
+  long nnz = p0->countNNZs();
+  long* to = new long[nnz ? nnz : 1];
+  double* w = new double[nnz ? nnz : 1];
+  p0->ExportTo(to, w);
+  Delete(p0);
+
+  try {
+    s.put_varint(nnz);
+    long prev = 0;
+    for (long z=0; z<nnz; z++) {
+      s.put_zigzag(to[z] - prev);
+      writeDouble(s, w[z]);
+      prev = to[z];
+    }
+
+    long alloc = nnz ? nnz : 1;
+    const long ns = mlm->getNumStates();
+    for (long i=0; i<ns; i++) {
+      long n = mlm->getOutgoingWeights(i, to, w, alloc);
+      if (n > alloc) {
+        delete[] to;
+        delete[] w;
+        alloc = n;
+        to = new long[alloc];
+        w = new double[alloc];
+        mlm->getOutgoingWeights(i, to, w, alloc);
+      }
+      s.put_varint(n);
+      prev = i;
+      for (long z=0; z<n; z++) {
+        s.put_zigzag(to[z] - prev);
+        writeDouble(s, w[z]);
+        prev = to[z];
+      }
+    }
+  }
+  catch (...) {
+    delete[] to;
+    delete[] w;
+    throw;
+  }
+  delete[] to;
+  delete[] w;
+}
+
+/// Read the states into a new, indexed state database.
+StateLib::state_db* readExplicitStates(MEDDLY::input &s, const hldsm* hlm,
+  const exp_state_lib* statelib, long &ns)
+{
+  ns = readCount(s, LONG_MAX);
+  shared_state* st = new shared_state(hlm);
+  const int size = st->getStateSize();
+  Delete(st);
+  if (s.get_varint() != (unsigned long) size) {
+    throw ckpt_error("checkpoint states do not match the model");
+  }
+
+  StateLib::state_db* db = statelib->createStateDB(true, false);
+  int* data = new int[size ? size : 1];
+  try {
+    for (long i=0; i<ns; i++) {
+      for (int k=0; k<size; k++) data[k] = int(s.get_zigzag());
+      if (db->InsertState(data, size) != i) {
+        throw ckpt_error("checkpoint contains duplicate states");
+      }
+    }
+  }
+  catch (...) {
+    delete[] data;
+    delete db;
+    throw;
+  }
+  delete[] data;
+  return db;
+}
+
+state_lldsm* readExplicitFSM(MEDDLY::input &s, const hldsm* hlm,
+  const exp_state_lib* statelib)
+{
+  long ns;
+  StateLib::state_db* db = readExplicitStates(s, hlm, statelib, ns);
+  long* init = 0;
+  GraphLib::dynamic_digraph* rg = 0;
+  long ninit = 0;
+  try {
+    ninit = readCount(s, ns);
+    init = new long[ninit ? ninit : 1];
+    long prev = 0;
+    for (long z=0; z<ninit; z++) {
+      init[z] = prev = readIndex(s, prev, ns);
+    }
+
+    rg = new GraphLib::dynamic_digraph(true);
+    rg->addNodes(ns);
+    for (long i=0; i<ns; i++) {
+      const long n = readCount(s, ns);
+      prev = i;
+      for (long z=0; z<n; z++) {
+        prev = readIndex(s, prev, ns);
+        rg->addEdge(i, prev);
+      }
+    }
+    s.consumeKeyword(CKPT_TRAILER);
+  }
+  catch (...) {
+    delete[] init;
+    delete rg;
+    delete db;
+    throw;
+  }
+
+  graph_lldsm* glm = new graph_lldsm(lldsm::FSM);
+  glm->setRSS(new expl_reachset(db));
+  LS_Vector initial;
+  initial.size = ninit;
+  initial.index = init;
+  initial.d_value = 0;
+  initial.f_value = 0;
+  grlib_reachgraph* erg = new grlib_reachgraph(rg);
+  erg->setInitial(initial);
+  glm->setRGR(erg);
+  return glm;
+}
+
+state_lldsm* readExplicitMC(MEDDLY::input &s, const hldsm* hlm,
+  const exp_state_lib* statelib, lldsm::model_type type)
+{
+  const bool discrete = (lldsm::DTMC == type);
+  long ns;
+  StateLib::state_db* db = readExplicitStates(s, hlm, statelib, ns);
+  long* init = 0;
+  double* p0 = 0;
+  GraphLib::dynamic_summable<double>* G = 0;
+  long ninit = 0;
+  try {
+    ninit = readCount(s, ns);
+    init = new long[ninit ? ninit : 1];
+    p0 = new double[ninit ? ninit : 1];
+    long prev = 0;
+    for (long z=0; z<ninit; z++) {
+      init[z] = prev = readIndex(s, prev, ns);
+      p0[z] = readDouble(s);
+    }
+
+    G = new GraphLib::dynamic_summable<double>(discrete, true);
+    G->addNodes(ns);
+    for (long i=0; i<ns; i++) {
+      const long n = readCount(s, ns);
+      prev = i;
+      for (long z=0; z<n; z++) {
+        prev = readIndex(s, prev, ns);
+        G->addEdge(i, prev, readDouble(s));
+      }
+    }
+    s.consumeKeyword(CKPT_TRAILER);
+  }
+  catch (...) {
+    delete[] init;
+    delete[] p0;
+    delete G;
+    delete db;
+    throw;
+  }
+
+  stochastic_lldsm* mlm = new stochastic_lldsm(type);
+  mlm->setRSS(new expl_reachset(db));
+  LS_Vector initial;
+  initial.size = ninit;
+  initial.index = init;
+  initial.d_value = p0;
+  initial.f_value = 0;
+  // the initial distribution takes the arrays
+  mlm->setPROC(initial, new mclib_process(discrete, G));
+  return mlm;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                        ckpt_msr  class                         *
+// *                                                                *
+// ******************************************************************
+
+/// Base class for the checkpoint functions.
+class ckpt_msr : public proc_noengine {
+public:
+  ckpt_msr(const char* name);
+
+protected:
+  /// Evaluate the file name parameter; returns a shared string or 0.
+  shared_string* grabFilename(traverse_data &x, expr* p) const;
+
+  void reportError(const expr* cause, const char* what,
+    const shared_string* fn) const;
+};
+
+ckpt_msr::ckpt_msr(const char* name)
+ : proc_noengine(Nothing, em->BOOL, name, 2)
+{
+  SetFormal(1, em->STRING, "filename");
+}
+
+shared_string* ckpt_msr::grabFilename(traverse_data &x, expr* p) const
+{
+  result* answer = x.answer;
+  result foo;
+  x.answer = &foo;
+  SafeCompute(p, x);
+  x.answer = answer;
+  if (!foo.isNormal()) return 0;
+  return smart_cast <shared_string*> (Share(foo.getPtr()));
+}
+
+void ckpt_msr::reportError(const expr* cause, const char* what,
+  const shared_string* fn) const
+{
+  if (em->startError()) {
+    em->causedBy(cause);
+    em->cerr() << "Checkpoint file " << fn->getStr() << ": " << what;
+    em->stopIO();
+  }
+}
+
+// ******************************************************************
+// *                          save_process                          *
+// ******************************************************************
+
+class save_process_si : public ckpt_msr {
+public:
+  save_process_si();
+  virtual void Compute(traverse_data &x, expr** pass, int np);
+};
+
+save_process_si::save_process_si() : ckpt_msr("save_process")
+{
+  SetDocumentation("Builds if necessary, and writes the reachability set and underlying process of the model to a file named filename, so they can be restored in a later run with load_process.  For Meddly-based generation, only the states are written.  Returns true on success.");
+}
+
+void save_process_si::Compute(traverse_data &x, expr** pass, int np)
+{
+  DCASSERT(x.answer);
+  DCASSERT(0==x.aggregate);
+  DCASSERT(pass);
+  model_instance* mi = grabModelInstance(x, pass[0]);
+  hldsm* hlm = mi ? mi->GetCompiledModel() : 0;
+  shared_string* fn = grabFilename(x, pass[1]);
+  x.answer->setNull();
+  if (0==hlm || 0==fn) {
+    Delete(fn);
+    return;
+  }
+
+  // Meddly reachsets are saved without the process
+  state_lldsm* slm = BuildProc(hlm, true, x.parent);
+  meddly_reachset* mrs = 0;
+  if (slm && lldsm::Error != slm->Type()) {
+    mrs = dynamic_cast <meddly_reachset*> (slm->useRSS());
+    if (0==mrs) slm = BuildProc(hlm, false, x.parent);
+  }
+  if (0==slm || lldsm::Error == slm->Type()) {
+    Delete(fn);
+    return;
+  }
+
+  FILE* f = fopen(fn->getStr(), "wb");
+  if (0==f) {
+    reportError(x.parent, "couldn't open for writing", fn);
+    Delete(fn);
+    x.answer->setBool(false);
+    return;
+  }
+
+  const char* what = 0;
+  try {
+    ckpt_output s(f);
+    if (mrs) {
+      writeHeader(s, CKPT_MEDDLY, mi, hlm, slm->Type());
+      mrs->writeCheckpoint(s);
+    } else {
+      indexed_reachset* irs = dynamic_cast <indexed_reachset*> (slm->useRSS());
+      if (0==irs || 0==dynamic_cast <dsde_hlm*> (hlm)) {
+        throw ckpt_error("unsupported type of model");
+      }
+      writeHeader(s, CKPT_EXPLICIT, mi, hlm, slm->Type());
+      if (lldsm::FSM == slm->Type()) {
+        graph_lldsm* glm = dynamic_cast <graph_lldsm*> (slm);
+        const grlib_reachgraph* rg = glm
+          ? dynamic_cast <const grlib_reachgraph*> (glm->getRGR()) : 0;
+        if (0==rg) throw ckpt_error("unsupported reachability graph");
+        writeExplicitStates(s, hlm, irs);
+        writeExplicitFSM(s, irs, rg);
+      } else {
+        stochastic_lldsm* mlm = dynamic_cast <stochastic_lldsm*> (slm);
+        if (0==mlm || 0==mlm->getPROC()) {
+          throw ckpt_error("unsupported type of process");
+        }
+        writeExplicitStates(s, hlm, irs);
+        writeExplicitMC(s, mlm);
+      }
+    }
+    s.put(CKPT_TRAILER, 0);
+  }
+  catch (MEDDLY::error e) {
+    what = e.getName();
+  }
+  catch (ckpt_error e) {
+    what = e.what;
+  }
+  if (fclose(f) && 0==what) {
+    what = "couldn't finish writing";
+  }
+
+  if (what) {
+    remove(fn->getStr());
+    reportError(x.parent, what, fn);
+  }
+  x.answer->setBool(0==what);
+  Delete(fn);
+}
+
+// ******************************************************************
+// *                          load_process                          *
+// ******************************************************************
+
+class load_process_si : public ckpt_msr {
+public:
+  load_process_si();
+  virtual void Compute(traverse_data &x, expr** pass, int np);
+};
+
+load_process_si::load_process_si() : ckpt_msr("load_process")
+{
+  SetDocumentation("Restores the reachability set and underlying process of the model from a file named filename, written by save_process in an earlier run, instead of generating them.  The model must be the same, with the same parameters (this is checked); for Meddly-based generation, the engine and variable order must also be the same, and the process is rebuilt from the restored states.  Returns true on success, and false if the model has already been generated.");
+}
+
+void load_process_si::Compute(traverse_data &x, expr** pass, int np)
+{
+  DCASSERT(x.answer);
+  DCASSERT(0==x.aggregate);
+  DCASSERT(pass);
+  model_instance* mi = grabModelInstance(x, pass[0]);
+  hldsm* hlm = mi ? mi->GetCompiledModel() : 0;
+  shared_string* fn = grabFilename(x, pass[1]);
+  x.answer->setNull();
+  if (0==hlm || 0==fn) {
+    Delete(fn);
+    return;
+  }
+
+  if (hlm->GetProcess()) {
+    if (em->startWarning()) {
+      em->causedBy(x.parent);
+      em->warn() << "Process already built, ignoring checkpoint file ";
+      em->warn() << fn->getStr();
+      em->stopIO();
+    }
+    Delete(fn);
+    x.answer->setBool(false);
+    return;
+  }
+
+  ckpt_file F(fn->getStr());
+  if (!F.isOpen()) {
+    reportError(x.parent, "couldn't read", fn);
+    Delete(fn);
+    x.answer->setBool(false);
+    return;
+  }
+
+  const char* what = 0;
+  bool restored = false;
+  try {
+    MEDDLY::memory_input s(F.getData(), F.getLength());
+    if (CKPT_EXPLICIT == readHeader(s, mi, hlm)) {
+      if (0==dynamic_cast <dsde_hlm*> (hlm)) {
+        throw ckpt_error("unsupported type of model");
+      }
+      const exp_state_lib* statelib = InitExplicitStateStorage(em);
+      const lldsm::model_type type = hlm->GetProcessType();
+      hlm->SetProcess( (lldsm::FSM == type)
+        ? readExplicitFSM(s, hlm, statelib)
+        : readExplicitMC(s, hlm, statelib, type)
+      );
+      restored = true;
+    } else {
+      // The generation engine reads the states
+      meddly_reachset::setPendingCheckpoint(&s);
+      state_lldsm* slm = BuildProc(hlm, true, x.parent);
+      restored = (0==meddly_reachset::pendingCheckpoint());
+      meddly_reachset::setPendingCheckpoint(0);
+      if (0==slm || lldsm::Error == slm->Type()) {
+        // already reported
+        Delete(fn);
+        x.answer->setBool(false);
+        return;
+      }
+      if (restored) {
+        s.consumeKeyword(CKPT_TRAILER);
+      } else if (em->startWarning()) {
+        em->causedBy(x.parent);
+        em->warn() << "Generation engine can't read checkpoints, ";
+        em->warn() << "states were generated";
+        em->stopIO();
+      }
+    }
+  }
+  catch (MEDDLY::error e) {
+    meddly_reachset::setPendingCheckpoint(0);
+    what = e.getName();
+  }
+  catch (ckpt_error e) {
+    what = e.what;
+  }
+
+  if (what) {
+    reportError(x.parent, what, fn);
+    restored = false;
+  }
+  x.answer->setBool(restored);
+  Delete(fn);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                                                                *
+// *                         Initialization                         *
+// *                                                                *
+// *                                                                *
+// ******************************************************************
+
+class init_ckptmsrs : public initializer {
+  public:
+    init_ckptmsrs();
+    virtual bool execute();
+};
+init_ckptmsrs the_ckptmsr_initializer;
+
+init_ckptmsrs::init_ckptmsrs() : initializer("init_ckptmsrs")
+{
+  usesResource("em");
+  usesResource("procgen");
+  usesResource("stringtype");
+  buildsResource("CML");
+}
+
+bool init_ckptmsrs::execute()
+{
+  if (0==em) return false;
+
+  CML.Append(new save_process_si);
+  CML.Append(new load_process_si);
+
+  return true;
+}
@@ -0,0 +1,11 @@
+
+#ifndef CKPT_MSR_H
+#define CKPT_MSR_H
+
+/*
+  Functions to save the reachability set and process of a model
+  instance to a file, and to restore them in a later run.
+  Everything is registered by an initializer; nothing to export.
+*/
+
+#endif
@@ -2,16 +2,340 @@
 
 #include "dsde_hlm.h"
 
+#include "../ExprLib/dd_front.h"
+
 #include "../ExprLib/startup.h"
 #include "../ExprLib/sets.h"
+#include "../ExprLib/arrays.h"
 #include "../SymTabs/symtabs.h"
 #include "../Options/options.h"
 #include "../include/heap.h"
 
+#include <algorithm>
+#include <iterator>
+
 // #define DEBUG_PART
 // #define DEBUG_PRIO
 // #define DEBUG_ENABLED
 
+// ******************************************************************
+// *                                                                *
+// *                     event_program methods                      *
+// *                                                                *
+// ******************************************************************
+
+event_program::event_program() {
+	has_enabling = false;
+	has_firing = false;
+	has_rate = false;
+}
+
+bool event_program::code::isTree(int first) const {
+	const int n = list.size();
+	if (first >= n)
+		return false;
+	std::vector<int> uses(n - first, 0);
+	for (int i = first; i < n; i++) {
+		const int ops[2] = { list[i].a, list[i].b };
+		for (int j = 0; j < 2; j++) {
+			if (ops[j] < 0)
+				continue;
+			if (ops[j] < first || ops[j] >= i)
+				return false;
+			uses[ops[j] - first]++;
+		}
+	}
+	for (int i = first; i < n - 1; i++) {
+		if (1 != uses[i - first])
+			return false;
+	}
+	return 0 == uses[n - 1 - first];
+}
+
+/** Edges for program_encoder: the register holding a value.
+*/
+class code_edge: public shared_object {
+public:
+	int reg;
+public:
+	code_edge() {
+		reg = -1;
+	}
+	virtual bool Print(OutputStream &s, int) const {
+		s << "r" << reg;
+		return true;
+	}
+	virtual bool Equals(const shared_object *o) const {
+		return (this == o);
+	}
+};
+
+/** Encoder used by event_program::lower().
+ Each operation appends one instruction to the code.
+ Accepts only constants, state variables, and the operations
+ of event_program; anything else marks the traversal as failed.
+ Nothing is thrown, because some expressions report thrown
+ errors to the user, and a failed lowering is not an error.
+ */
+class program_encoder: public sv_encoder {
+	event_program::code &c;
+	mutable bool failed;
+public:
+	program_encoder(event_program::code &_c) : c(_c) {
+		failed = false;
+	}
+
+	/// Did the traversal succeed, with its value in edge e?
+	int getRegister(const result &e) const {
+		if (failed || !e.isNormal())
+			return -1;
+		const code_edge* ce = dynamic_cast<const code_edge*>(e.getPtr());
+		if (0 == ce)
+			return -1;
+		return ce->reg;
+	}
+
+	virtual void dumpNode(OutputStream &s, shared_object* e) const {
+		throw Failed;
+	}
+	virtual void showNodeGraph(OutputStream &s, shared_object* e) const {
+		throw Failed;
+	}
+	virtual void dumpForest(OutputStream &s) const {
+		throw Failed;
+	}
+	virtual bool arePrimedVarsSeparate() const {
+		return false;
+	}
+	virtual int getNumDDVars() const {
+		return 0;
+	}
+	virtual shared_object* makeEdge(const shared_object* e) {
+		code_edge* t = new code_edge;
+		if (e)
+			copyEdge(e, t);
+		return t;
+	}
+	virtual bool isValidEdge(const shared_object* e) const {
+		return dynamic_cast<const code_edge*>(e);
+	}
+	virtual void copyEdge(const shared_object* src, shared_object* dest) const {
+		const code_edge* s = dynamic_cast<const code_edge*>(src);
+		code_edge* d = dynamic_cast<code_edge*>(dest);
+		if (0 == s || 0 == d) {
+			failed = true;
+			return;
+		}
+		d->reg = s->reg;
+	}
+	virtual void buildSymbolicConst(bool t, shared_object* answer) {
+		setRegister(answer, c.emitConst(t ? 1 : 0));
+	}
+	virtual void buildSymbolicConst(long t, shared_object* answer) {
+		setRegister(answer, c.emitConst(t));
+	}
+	virtual void buildSymbolicConst(double t, shared_object* answer) {
+		setRegister(answer, c.emitConst(t));
+	}
+	virtual void buildSymbolicSV(const symbol* sv, bool primed, expr* f,
+			shared_object* answer) {
+		const model_statevar* v = dynamic_cast<const model_statevar*>(sv);
+		if (primed || f || 0 == v) {
+			failed = true;
+			return;
+		}
+		setRegister(answer, c.emitVar(v));
+	}
+	virtual void state2minterm(const shared_state* s, int* mt) const {
+		throw Failed;
+	}
+	virtual void minterm2state(const int* mt, shared_state *s) const {
+		throw Failed;
+	}
+	virtual const int* firstMinterm(shared_object* set) const {
+		throw Failed;
+	}
+	virtual const int* nextMinterm(shared_object* set) const {
+		throw Failed;
+	}
+	virtual void createMinterms(const int* const * mts, int n,
+			shared_object* ans) {
+		throw Failed;
+	}
+	virtual void createMinterms(const int* const * from,
+			const int* const * to, int n, shared_object* ans) {
+		throw Failed;
+	}
+	virtual void createMinterms(const int* const * from,
+			const int* const * to, const float* values, int n,
+			shared_object* ans) {
+		throw Failed;
+	}
+	virtual void buildUnary(exprman::unary_opcode op,
+			const shared_object* opnd, shared_object* ans) {
+		switch (op) {
+		case exprman::uop_neg:
+			emit(event_program::Neg, opnd, 0, ans);
+			return;
+		case exprman::uop_not:
+			emit(event_program::Not, opnd, 0, ans);
+			return;
+		default:
+			failed = true;
+		}
+	}
+	virtual void buildBinary(const shared_object* left,
+			exprman::binary_opcode op, const shared_object* right,
+			shared_object* ans) {
+		switch (op) {
+		case exprman::bop_equals:
+			emit(event_program::Eq, left, right, ans);
+			return;
+		case exprman::bop_nequal:
+			emit(event_program::Ne, left, right, ans);
+			return;
+		case exprman::bop_gt:
+			emit(event_program::Gt, left, right, ans);
+			return;
+		case exprman::bop_ge:
+			emit(event_program::Ge, left, right, ans);
+			return;
+		case exprman::bop_lt:
+			emit(event_program::Lt, left, right, ans);
+			return;
+		case exprman::bop_le:
+			emit(event_program::Le, left, right, ans);
+			return;
+		default:
+			failed = true;
+		}
+	}
+	virtual void buildAssoc(const shared_object* left, bool flip,
+			exprman::assoc_opcode op, const shared_object* right,
+			shared_object* ans) {
+		switch (op) {
+		case exprman::aop_plus:
+			emit(flip ? event_program::Sub : event_program::Add, left, right,
+					ans);
+			return;
+		case exprman::aop_times:
+			emit(flip ? event_program::Div : event_program::Mul, left, right,
+					ans);
+			return;
+		case exprman::aop_and:
+			if (flip)
+				break;
+			emit(event_program::And, left, right, ans);
+			return;
+		case exprman::aop_or:
+			if (flip)
+				break;
+			emit(event_program::Or, left, right, ans);
+			return;
+		default:
+			break;
+		}
+		failed = true;
+	}
+	virtual void buildMinMax(bool is_max, const shared_object* left,
+			const shared_object* right, shared_object* ans) {
+		emit(is_max ? event_program::Max : event_program::Min, left, right,
+				ans);
+	}
+	virtual void getCardinality(const shared_object* x, long &card) {
+		throw Failed;
+	}
+	virtual void getCardinality(const shared_object* x, double &card) {
+		throw Failed;
+	}
+	virtual void getCardinality(const shared_object* x, result &card) {
+		throw Failed;
+	}
+	virtual void isEmpty(const shared_object* x, bool &empty) {
+		throw Failed;
+	}
+	virtual void preImage(const shared_object* x, const shared_object* E,
+			shared_object* ans) {
+		throw Failed;
+	}
+	virtual void postImage(const shared_object* x, const shared_object* E,
+			shared_object* ans) {
+		throw Failed;
+	}
+	virtual void preImageStar(const shared_object* x, const shared_object* E,
+			shared_object* ans) {
+		throw Failed;
+	}
+	virtual void postImageStar(const shared_object* x,
+			const shared_object* E, shared_object* ans) {
+		throw Failed;
+	}
+	virtual void selectRows(const shared_object* E, const shared_object* rows,
+			shared_object* ans) {
+		throw Failed;
+	}
+	virtual void selectCols(const shared_object* E, const shared_object* cols,
+			shared_object* ans) {
+		throw Failed;
+	}
+	virtual void reportStats(OutputStream &out) {
+	}
+private:
+	inline int reg(const shared_object* e) const {
+		const code_edge* ce = dynamic_cast<const code_edge*>(e);
+		if (0 == ce || ce->reg < 0) {
+			failed = true;
+			return -1;
+		}
+		return ce->reg;
+	}
+	inline void setRegister(shared_object* e, int r) {
+		code_edge* ce = dynamic_cast<code_edge*>(e);
+		if (0 == ce || r < 0) {
+			failed = true;
+			return;
+		}
+		ce->reg = r;
+	}
+	/// ans := a op b; b is 0 for unary operations.
+	inline void emit(event_program::opcode op, const shared_object* a,
+			const shared_object* b, shared_object* ans) {
+		// a == b means an operand left the answer untouched
+		if (a == b) {
+			failed = true;
+			return;
+		}
+		const int ra = reg(a);
+		const int rb = b ? reg(b) : -1;
+		if (failed)
+			return;
+		setRegister(ans, c.emit(op, ra, rb));
+	}
+};
+
+int event_program::lower(expr* e, code &c,
+		traverse_data::traversal_type which) {
+	if (0 == e)
+		return -1;
+	const int first = c.size();
+	program_encoder* enc = new program_encoder(c);
+	traverse_data x(which);
+	result foo;
+	foo.setNull();
+	x.answer = &foo;
+	x.ddlib = enc;
+	e->Traverse(x);
+	int r = enc->getRegister(foo);
+	foo.setNull();
+	Delete(enc);
+	// the last instruction must hold the whole expression
+	if (r != c.size() - 1 || !c.isTree(first))
+		r = -1;
+	if (r < 0)
+		c.truncate(first);
+	return r;
+}
+
 // ******************************************************************
 // *                                                                *
 // *                       model_event methods                      *
@@ -53,7 +377,7 @@ void model_event::buildDepList(expr* e, intset* ld, intset* vd) {
 		DCASSERT(s);
 		model_statevar* mv = dynamic_cast<model_statevar*>(s);
 		if (0 == mv)
-			continue; CHECK_RANGE(1, mv->GetPart(), ld->getSize()); CHECK_RANGE(0, mv->GetIndex(), vd->getSize());
+			continue; CHECK_RANGE(0, mv->GetPart(), ld->getSize()); CHECK_RANGE(0, mv->GetIndex(), vd->getSize());
 		ld->addElement(mv->GetPart());
 		vd->addElement(mv->GetIndex());
 	}
@@ -87,9 +411,18 @@ void model_event::Init() {
 	enabling_variable_dependencies = 0;
 	nextstate_level_dependencies = 0;
 	nextstate_variable_dependencies = 0;
+	num_slots = 1;
+	enable_data = new enable_status[1];
+	enable_data[0] = unknown;
+	enabling_value = new enable_status[1];
+	enabling_value[0] = unknown;
+	program = 0;
 }
 
 model_event::~model_event() {
+	delete[] enable_data;
+	delete[] enabling_value;
+	delete program;
 	delete enabling_level_dependencies;
 	delete enabling_variable_dependencies;
 	delete nextstate_level_dependencies;
@@ -98,6 +431,24 @@ model_event::~model_event() {
 	delete[] prio_list;
 }
 
+thread_local int model_event::my_slot = 0;
+
+void model_event::reserveWorkerSlots(int n) {
+	if (n <= num_slots)
+		return;
+	enable_status* newdata = new enable_status[n];
+	enable_status* newvalue = new enable_status[n];
+	for (int i = 0; i < n; i++) {
+		newdata[i] = unknown;
+		newvalue[i] = unknown;
+	}
+	delete[] enable_data;
+	delete[] enabling_value;
+	enable_data = newdata;
+	enabling_value = newvalue;
+	num_slots = n;
+}
+
 void model_event::display(OutputStream &s) const {
 	const int width = 16;
 	s << nameOf(FT) << " " << Name() << "\n";
@@ -142,6 +493,19 @@ void model_event::setNextstate(expr *e) {
 		nextstate->PreCompute();
 }
 
+void model_event::setProgram(event_program *p) {
+	delete program;
+	program = 0;
+	if (0 == p)
+		return;
+	if (p->isEmpty()) {
+		delete p;
+		return;
+	}
+	DCASSERT(nextstate || !p->hasFiring());
+	program = p;
+}
+
 void model_event::setNondeterministic() {
 	DCASSERT(Unknown == FT);
 	FT = Nondeterm;
@@ -245,7 +609,7 @@ void model_event::decideEnabled(traverse_data &x) {
 #ifdef DEBUG_ENABLED
 	fprintf(stderr, "IN  decideEnabled for event %s\n", Name());
 #endif
-	DCASSERT(x.answer); DCASSERT(unknown == enable_data);
+	DCASSERT(x.answer); DCASSERT(unknown == status());
 	for (int i = prio_length - 1; i >= 0; i--) {
 		DCASSERT(prio_list[i]);
 		if (prio_list[i]->unknownIfEnabled())
@@ -253,11 +617,11 @@ void model_event::decideEnabled(traverse_data &x) {
 		if (!x.answer->isNormal())
 			return;
 		if (prio_list[i]->isEnabled()) {
-			enable_data = disabled;
+			status() = disabled;
 			x.answer->setBool(false);
 #ifdef DEBUG_ENABLED
 			fprintf(stderr, "OUT, priority disabled event %s, enable_data is %d\n",
-					Name(), enable_data);
+					Name(), status());
 #endif
 			return;
 		}
@@ -269,25 +633,39 @@ void model_event::decideEnabled(traverse_data &x) {
 #ifdef DEBUG_ENABLED
 	fprintf(stderr, "SET TO TRUE");
 #endif
+	} else if (unknown != expr_status()) {
+		// Known from a parent state
+		x.answer->setBool(enabled == expr_status());
 	} else {
-		enabling->Compute(x);
+		int known = -1;
+		if (program && program->hasEnabling()) {
+			known = program->Enabled(x.current_state);
+		}
+		if (known >= 0) {
+			x.answer->setBool(known > 0);
+		} else {
+			enabling->Compute(x);
+		}
+		if (x.answer->isNormal()) {
+			expr_status() = x.answer->getBool() ? enabled : disabled;
+		}
 #ifdef DEBUG_ENABLED
 	fprintf(stderr, "COMPUTE");
 #endif
 	}
 	if (x.answer->isNormal() && x.answer->getBool()) {
-		enable_data = enabled;
+		status() = enabled;
 #ifdef DEBUG_ENABLED
 	fprintf(stderr, "SET TO ENABLED");
 #endif
 	} else {
-		enable_data = disabled;
+		status() = disabled;
 #ifdef DEBUG_ENABLED
 	fprintf(stderr, "SET TO disable");
 #endif
 	}
 #ifdef DEBUG_ENABLED
-	fprintf(stderr, "OUT decideEnabled for event %s, enable_data is %d\n", Name(), enable_data);
+	fprintf(stderr, "OUT decideEnabled for event %s, enable_data is %d\n", Name(), status());
 #endif
 }
 
@@ -474,6 +852,135 @@ void dsde_hlm::checkVanishing(traverse_data &x) {
 	x.answer->setBool(false);
 }
 
+void dsde_hlm::reserveWorkerSlots(int n) {
+	for (int i = 0; i < num_events; i++) {
+		DCASSERT(event_data[i]);
+		event_data[i]->reserveWorkerSlots(n);
+	}
+}
+
+// Does e reach state variables through an array?
+// Those do not appear in the dependency lists.
+static bool usesArrays(expr* e) {
+	if (0 == e)
+		return false;
+	List<symbol> L;
+	e->BuildSymbolList(traverse_data::GetSymbols, 0, &L);
+	for (int i = 0; i < L.Length(); i++) {
+		if (dynamic_cast<array*>(L.Item(i)))
+			return true;
+	}
+	return false;
+}
+
+void dsde_hlm::buildAffects(bool timing,
+		std::vector<std::vector<int> > &affects) const {
+	int num_levels = 1;
+	for (int i = 0; i < num_vars; i++) {
+		num_levels = MAX(num_levels, state_data[i]->GetPart());
+	}
+	intset levels(num_levels + 1);
+	intset timed(num_vars);
+
+	// users[v]: events whose enabling (or timing) uses state variable v;
+	// users[num_vars]: events that might use any of them.
+	std::vector<std::vector<int> > users(num_vars + 1);
+	for (int u = 0; u < num_events; u++) {
+		model_event* ev = event_data[u];
+		DCASSERT(ev);
+		ev->buildEnablingDependencies(num_levels, num_vars);
+		ev->buildNextstateDependencies(num_levels, num_vars);
+		const intset* used = ev->enabling_variable_dependencies;
+		bool opaque = usesArrays(ev->getEnabling());
+		if (timing) {
+			switch (ev->getFiringType()) {
+				case model_event::Expo:
+				case model_event::Phase_int:
+				case model_event::Phase_real:
+				case model_event::Timed_general:
+					model_event::buildDepList(ev->getDistribution(), &levels,
+							&timed);
+					timed += *used;
+					used = &timed;
+					opaque = opaque || usesArrays(ev->getDistribution());
+					break;
+				default:
+					break;
+			}
+		}
+		if (opaque) {
+			users[num_vars].push_back(u);
+			continue;
+		}
+		for (long v = used->getSmallestAfter(-1); v >= 0;
+				v = used->getSmallestAfter(v)) {
+			users[v].push_back(u);
+		}
+	}
+
+	// t affects the users of the variables its next state uses,
+	// and the events that might use any variable
+	std::vector<int> seen(num_events, -1);
+	std::vector<long> changed;
+	affects.resize(num_events);
+	for (int t = 0; t < num_events; t++) {
+		affects[t].clear();
+		if (usesArrays(event_data[t]->getNextstate())) {
+			for (int u = 0; u < num_events; u++) {
+				affects[t].push_back(u);
+			}
+			continue;
+		}
+		const intset* ns = event_data[t]->nextstate_variable_dependencies;
+		changed.clear();
+		for (long v = ns->getSmallestAfter(-1); v >= 0;
+				v = ns->getSmallestAfter(v)) {
+			changed.push_back(v);
+		}
+		changed.push_back(num_vars);
+		for (unsigned i = 0; i < changed.size(); i++) {
+			const std::vector<int> &list = users[changed[i]];
+			for (unsigned j = 0; j < list.size(); j++) {
+				const int u = list[j];
+				if (seen[u] == t)
+					continue;
+				seen[u] = t;
+				affects[t].push_back(u);
+			}
+		}
+		std::sort(affects[t].begin(), affects[t].end());
+	}
+}
+
+void dsde_hlm::buildEnablingAffects() {
+	std::vector<std::vector<int> > affects;
+	buildAffects(false, affects);
+	for (int t = 0; t < num_events; t++) {
+		event_data[t]->affected.swap(affects[t]);
+	}
+}
+
+void dsde_hlm::buildTimingAffects(std::vector<std::vector<int> > &affects) const {
+	buildAffects(true, affects);
+}
+
+void dsde_hlm::saveEnabling(std::vector<signed char> &values) const {
+	values.resize(num_events);
+	for (int i = 0; i < num_events; i++) {
+		values[i] = event_data[i]->getEnablingValue();
+	}
+}
+
+void dsde_hlm::inheritEnabling(const model_event* t,
+		const std::vector<signed char> &parent, std::vector<signed char> &child) const {
+	DCASSERT(t); DCASSERT(int(parent.size()) == num_events);
+	child = parent;
+	for (unsigned j = 0; j < t->affected.size(); j++) {
+		CHECK_RANGE(0, t->affected[j], num_events);
+		child[t->affected[j]] = 0;
+	}
+}
+
 void dsde_hlm::makeEnabledList(traverse_data &x, List<model_event> *EL) {
 	DCASSERT(x.answer); DCASSERT(x.current_state);
 	if (EL)
@@ -614,10 +1121,25 @@ void dsde_hlm::makeTangibleEnabledListCov(traverse_data &x,
 }
 void dsde_hlm::makeTangibleEnabledList(traverse_data &x,
 		List<model_event> *EL) {
+	ResetEnabledList();
+	finishTangibleEnabledList(x, EL);
+}
+
+void dsde_hlm::makeTangibleEnabledList(traverse_data &x,
+		List<model_event> *EL, const std::vector<signed char> &known) {
+	DCASSERT(int(known.size()) == num_events);
+	ResetEnabledList();
+	for (int i = 0; i < num_events; i++) {
+		event_data[i]->setEnablingValue(known[i]);
+	}
+	finishTangibleEnabledList(x, EL);
+}
+
+void dsde_hlm::finishTangibleEnabledList(traverse_data &x,
+		List<model_event> *EL) {
 	DCASSERT(x.answer); DCASSERT(x.current_state);
 	if (EL)
 		EL->Clear();
-	ResetEnabledList();
 
 	int i = 0;
 	bool has_enabled = false;
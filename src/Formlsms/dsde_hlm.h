@@ -8,6 +8,356 @@
 #include "../_IntSets/intset.h"
 
 #include <vector>
+
+// **************************************************************************
+// *                                                                        *
+// *                          event_program  class                          *
+// *                                                                        *
+// **************************************************************************
+
+/** Compiled form of an event's enabling, next-state, and rate expressions.
+    Built by the formalism when the model is finalized
+    (e.g., Petri net transitions, their arcs, and their guards).
+
+    Each part is straight-line code for a small register machine:
+    every instruction writes its own register (a double, which holds
+    booleans and integers of less than 53 bits exactly).
+    Expressions built from constants, state variables, +, -, *, /,
+    min, max, comparisons, and boolean and, or, not are lowered
+    (see lower()); anything else is left to the expression tree.
+
+    The instructions run directly on the state data, without any
+    expression traversal.  Whenever a program cannot decide
+    (unknown or omega values, division by zero, out of bounds results),
+    it says so, and the caller falls back on the expressions,
+    so that errors are reported exactly as before.
+*/
+class event_program {
+public:
+  enum opcode {
+    /// reg := k
+    Const,
+    /// reg := var
+    Var,
+    /// reg := -a
+    Neg,
+    /// reg := !a
+    Not,
+    /// reg := a + b
+    Add,
+    /// reg := a - b
+    Sub,
+    /// reg := a * b
+    Mul,
+    /// reg := a / b
+    Div,
+    /// reg := min(a, b)
+    Min,
+    /// reg := max(a, b)
+    Max,
+    /// reg := a & b
+    And,
+    /// reg := a | b
+    Or,
+    /// reg := a == b
+    Eq,
+    /// reg := a != b
+    Ne,
+    /// reg := a < b
+    Lt,
+    /// reg := a <= b
+    Le,
+    /// reg := a > b
+    Gt,
+    /// reg := a >= b
+    Ge,
+    /// Disabled unless a is true.
+    Need,
+    /// Disabled unless var >= n.
+    Need_GE,
+    /// Disabled unless var < n.
+    Need_LT,
+    /// var' := var + a; must stay within 0..upper (or 0.. if upper < 0).
+    Update,
+    /// var' := var + n; as above.
+    Update_K
+  };
+
+  /// Longest code we build; the registers live on the stack.
+  static const int MAX_REGS = 256;
+
+private:
+  struct instr {
+    opcode op;
+    int a, b;
+    double k;
+    long n;
+    long upper;
+    const model_statevar* var;
+  };
+
+public:
+  /// Straight-line code, for one part of the program.
+  class code {
+    std::vector <instr> list;
+  public:
+    inline int size() const { return list.size(); }
+    inline bool isEmpty() const { return list.empty(); }
+    inline void clear() { list.clear(); }
+    /// Drop the instructions from number n on.
+    inline void truncate(int n) { list.resize(n); }
+
+    /// Append an instruction; returns its register, or -1 if too long.
+    inline int emit(opcode op, int a, int b) {
+      instr i = make(op);
+      i.a = a;
+      i.b = b;
+      return append(i);
+    }
+    inline int emitConst(double k) {
+      instr i = make(Const);
+      i.k = k;
+      return append(i);
+    }
+    inline int emitVar(const model_statevar* v) {
+      DCASSERT(v);
+      instr i = make(Var);
+      i.var = v;
+      return append(i);
+    }
+    inline bool need(int a) {
+      return emit(Need, a, -1) >= 0;
+    }
+    inline bool needAtLeast(const model_statevar* v, long n) {
+      return append(makeVar(Need_GE, v, n, -1)) >= 0;
+    }
+    inline bool needLessThan(const model_statevar* v, long n) {
+      return append(makeVar(Need_LT, v, n, -1)) >= 0;
+    }
+    inline bool addTo(const model_statevar* v, long n, long upper) {
+      return append(makeVar(Update_K, v, n, upper)) >= 0;
+    }
+    inline bool addTo(const model_statevar* v, int a, long upper) {
+      instr i = makeVar(Update, v, 0, upper);
+      i.a = a;
+      return append(i) >= 0;
+    }
+
+    /** Do instructions first, ..., size()-1 form one expression,
+        whose value is in the last register?  That is, every other
+        register among them is used exactly once, and nothing
+        before first is used.
+    */
+    bool isTree(int first) const;
+
+    /** Run the code.
+        Operands are read from state s; updates go to ns,
+        which must already be a copy of s (or 0, if there are none).
+          @param  r   Registers; at least size() of them.
+          @return 1 on success, 0 if a Need instruction failed,
+                  or -1 if the code cannot decide.
+    */
+    inline int Run(const shared_state* s, shared_state* ns, double* r) const;
+
+  private:
+    static inline instr make(opcode op) {
+      instr i;
+      i.op = op;
+      i.a = i.b = -1;
+      i.k = 0;
+      i.n = 0;
+      i.upper = -1;
+      i.var = 0;
+      return i;
+    }
+    static inline instr makeVar(opcode op, const model_statevar* v,
+      long n, long u)
+    {
+      DCASSERT(v);
+      instr i = make(op);
+      i.var = v;
+      i.n = n;
+      i.upper = u;
+      return i;
+    }
+    inline int append(const instr &i) {
+      if (list.size() >= unsigned(MAX_REGS)) return -1;
+      list.push_back(i);
+      return list.size()-1;
+    }
+  };
+
+private:
+  /// Enabling code; used only if has_enabling is set.
+  code enabling;
+  /// Firing code; used only if has_firing is set.
+  code firing;
+  /// Expo rate code, value in its last register; if has_rate is set.
+  code rate;
+  bool has_enabling;
+  bool has_firing;
+  bool has_rate;
+public:
+  event_program();
+
+  inline code& Enabling() { return enabling; }
+  inline code& Firing() { return firing; }
+  inline code& ExpoRate() { return rate; }
+
+  /// Done adding enabling instructions; drop them if not complete.
+  inline void finishEnabling(bool complete) {
+    has_enabling = complete;
+    if (!complete) enabling.clear();
+  }
+  /// Done adding firing instructions; drop them if not complete.
+  inline void finishFiring(bool complete) {
+    has_firing = complete;
+    if (!complete) firing.clear();
+  }
+  /// Done adding rate instructions; drop them if not complete.
+  inline void finishRate(bool complete) {
+    has_rate = complete && !rate.isEmpty();
+    if (!has_rate) rate.clear();
+  }
+
+  inline bool hasEnabling() const { return has_enabling; }
+  inline bool hasFiring() const { return has_firing; }
+  inline bool hasRate() const { return has_rate; }
+  inline bool isEmpty() const {
+    return !(has_enabling || has_firing || has_rate);
+  }
+
+  /** Lower an expression, using the decision diagram traversal
+      (see sv_encoder), appending to c.
+        @param  e     Expression to lower.
+        @param  c     Code to append to; unchanged on failure.
+        @param  which BuildDD, or BuildExpoRateDD for
+                      the rate of an expo distribution.
+        @return The register holding the value of e, or -1
+                if e cannot be lowered.
+  */
+  static int lower(expr* e, code &c, traverse_data::traversal_type which);
+
+  /** Evaluate the enabling code.
+        @param  s   Current state.
+        @return 1 if enabled, 0 if disabled,
+                or -1 if the program cannot decide.
+  */
+  inline int Enabled(const shared_state* s) const {
+    DCASSERT(has_enabling);
+    DCASSERT(s);
+    double r[MAX_REGS];
+    return enabling.Run(s, 0, r);
+  }
+
+  /** Run the firing code.
+      Amounts are evaluated in the current state.
+        @param  s   Current state.
+        @param  ns  Next state; must already be a copy of s.
+        @return true on success; false if the program cannot
+                decide (ns may be partially updated).
+  */
+  inline bool Fire(const shared_state* s, shared_state* ns) const {
+    DCASSERT(has_firing);
+    DCASSERT(s);
+    DCASSERT(ns);
+    double r[MAX_REGS];
+    return firing.Run(s, ns, r) > 0;
+  }
+
+  /** Compute the expo rate.
+        @param  s   Current state.
+        @param  ans Output: the rate.
+        @return true on success; false if the program cannot decide.
+  */
+  inline bool Rate(const shared_state* s, result &ans) const {
+    DCASSERT(has_rate);
+    double r[MAX_REGS];
+    if (rate.Run(s, 0, r) <= 0) return false;
+    ans.setReal(r[rate.size()-1]);
+    return true;
+  }
+};
+
+inline int event_program::code::Run(const shared_state* s,
+  shared_state* ns, double* r) const
+{
+  // Integers are exact below this; beyond it, let the expressions decide
+  const double big = 9007199254740992.0;
+  const int* data = s ? s->readState() : 0;
+  const instr* begin = list.data();
+  const instr* end = begin + list.size();
+  for (const instr* i = begin; i != end; i++) {
+    double &v = r[i - begin];
+    switch (i->op) {
+      case Const:   v = i->k;
+                    continue;
+
+      case Var: {
+                    DCASSERT(s);
+                    const int x = i->var->GetIndex();
+                    if (s->unknown(x) || s->omega(x)) return -1;
+                    v = data[x];
+                    continue;
+      }
+
+      case Neg:     v = -r[i->a];               continue;
+      case Not:     v = (0 == r[i->a]);         continue;
+      case Add:     v = r[i->a] + r[i->b];      break;
+      case Sub:     v = r[i->a] - r[i->b];      break;
+      case Mul:     v = r[i->a] * r[i->b];      break;
+      case Div:     if (0 == r[i->b]) return -1;
+                    v = r[i->a] / r[i->b];      break;
+      case Min:     v = MIN(r[i->a], r[i->b]);  continue;
+      case Max:     v = MAX(r[i->a], r[i->b]);  continue;
+      case And:     v = r[i->a] && r[i->b];     continue;
+      case Or:      v = r[i->a] || r[i->b];     continue;
+      case Eq:      v = (r[i->a] == r[i->b]);   continue;
+      case Ne:      v = (r[i->a] != r[i->b]);   continue;
+      case Lt:      v = (r[i->a] < r[i->b]);    continue;
+      case Le:      v = (r[i->a] <= r[i->b]);   continue;
+      case Gt:      v = (r[i->a] > r[i->b]);    continue;
+      case Ge:      v = (r[i->a] >= r[i->b]);   continue;
+
+      case Need:    if (0 == r[i->a]) return 0;
+                    continue;
+
+      case Need_GE:
+      case Need_LT: {
+                    DCASSERT(s);
+                    const int x = i->var->GetIndex();
+                    if (s->unknown(x) || s->omega(x)) return -1;
+                    if ((data[x] >= i->n) != (Need_GE == i->op)) return 0;
+                    continue;
+      }
+
+      case Update:
+      case Update_K: {
+                    DCASSERT(s);
+                    DCASSERT(ns);
+                    const int x = i->var->GetIndex();
+                    if (s->unknown(x) || s->omega(x)) return -1;
+                    long a = i->n;
+                    if (Update == i->op) {
+                      a = long(r[i->a]);
+                      if (a != r[i->a]) return -1;
+                    }
+                    const long nv = data[x] + a;
+                    if (nv < 0) return -1;
+                    if ((i->upper >= 0) && (nv > i->upper)) return -1;
+                    ns->writeState()[x] = nv;
+                    continue;
+      }
+
+      default:      DCASSERT(0);
+                    return -1;
+    }
+    // arithmetic results: stay finite and exact
+    if (!(v < big && v > -big)) return -1;
+  }
+  return 1;
+}
+
 // **************************************************************************
 // *                                                                        *
 // *                           model_event  class                           *
@@ -72,12 +422,28 @@ private:
   /// Number of events that have priority over us.
   int prio_length;
 
-  enum {
+  enum enable_status {
     disabled = -1,
     unknown = 0,
     enabled = 1,
     omega=OOmega
-  } enable_data;
+  };
+
+  /** Enabling status, one entry per worker slot.
+      Multi-threaded engines give each thread its own slot,
+      so that concurrent enabling checks do not interfere.
+  */
+  enable_status* enable_data;
+  /** Value of the enabling expression alone (ignoring priorities),
+      one entry per worker slot.  Unknown until computed for the
+      current state, or inherited from a parent state.
+  */
+  enable_status* enabling_value;
+  /// Dimension of enable_data and enabling_value.
+  int num_slots;
+
+  /// Worker slot used by the calling thread.
+  static thread_local int my_slot;
 
   intset* enabling_level_dependencies;
   intset* enabling_variable_dependencies;
@@ -85,6 +451,15 @@ private:
   intset* nextstate_level_dependencies;
   intset* nextstate_variable_dependencies;
 
+  /** Indexes of the events (in the model's event array) whose
+      enabling expression may change value when this event fires.
+      See dsde_hlm::buildEnablingAffects().
+  */
+  std::vector <int> affected;
+
+  /// Compiled form of our expressions, or 0.
+  event_program* program;
+
   static void buildDepList(expr* e, intset* ld, intset* vd);
 
 public:
@@ -149,6 +524,28 @@ public:
   /// Get the next state expression.
   inline expr* getNextstate() const { return nextstate; }
 
+  /** Set the compiled form of our expressions.
+      Must agree with the enabling, next state, and distribution
+      expressions; we take ownership.  Programs with nothing
+      compiled are discarded.
+  */
+  void setProgram(event_program* p);
+
+  inline const event_program* getProgram() const { return program; }
+
+  /** Fire the event: compute x.next_state from x.current_state.
+      The next state must already be a copy of the current state,
+      and the next state expression must be non-null.
+      Uses the compiled program when it can decide.
+  */
+  inline void computeNextstate(traverse_data &x) const {
+    DCASSERT(nextstate);
+    if (program && program->hasFiring()) {
+      if (program->Fire(x.current_state, x.next_state)) return;
+    }
+    nextstate->Compute(x);
+  }
+
   /// Build the lists of dependencies for the next state expression
   inline void buildNextstateDependencies(int num_levels, int num_vars) {
     if (0==nextstate_level_dependencies)
@@ -209,6 +606,18 @@ public:
     return distro;
   }
 
+  /** Compute the exponential rate of the event, in x.current_state.
+      x.which should be ComputeExpoRate.
+      Uses the compiled program when the rate is constant.
+  */
+  inline void computeExpoRate(traverse_data &x) const {
+    DCASSERT(x.answer);
+    if (program && program->hasRate()) {
+      if (program->Rate(x.current_state, *x.answer)) return;
+    }
+    SafeComputeExpoRate(distro, x);
+  }
+
   /** Set the weight and weight class for this event.
       Unnecessary for Non-deterministic events or
       timed events with continuous distributions.
@@ -250,22 +659,61 @@ public:
   */
   void finishPriorityInfo(List <model_event> &tmp, List <model_event> *ignored);
 
+  /** Make sure there are at least \a n worker slots for
+      the enabling status.  Not thread safe; call this before
+      starting any worker threads.
+  */
+  void reserveWorkerSlots(int n);
+
+  /** Set the worker slot for the calling thread.
+        @param  s   Slot number, between 0 and the number of
+                    reserved slots minus one.  The main thread
+                    always uses slot 0.
+  */
+  static inline void setWorkerSlot(int s) { my_slot = s; }
+
   void decideEnabled(traverse_data &x);
-  inline void clearEnabled() { enable_data = unknown; }
-  inline void setDisabled() { enable_data = disabled; }
-  inline bool unknownIfEnabled() const { return unknown == enable_data; }
-  inline bool knownEnabled() const { return enabled == enable_data; }
-  inline bool omegaIfEnabled() const { bool res=(omega == enable_data);printf("REEES is %i\n",res);return res; }
-  inline void setOmega() { enable_data = omega; printf("SET!!,%d\n",enable_data);}
+  inline void clearEnabled() { 
+    status() = unknown; 
+    expr_status() = unknown;
+  }
+  inline void setDisabled() { status() = disabled; }
+  inline bool unknownIfEnabled() const { return unknown == status(); }
+  inline bool knownEnabled() const { return enabled == status(); }
+  inline bool omegaIfEnabled() const { bool res=(omega == status());printf("REEES is %i\n",res);return res; }
+  inline void setOmega() { status() = omega; printf("SET!!,%d\n",status());}
   inline bool isEnabled() const {
-    DCASSERT(unknown != enable_data);
-    return enabled == enable_data;
+    DCASSERT(unknown != status());
+    return enabled == status();
   }
   inline bool isOmega() const {
-    // DCASSERT(unknown != enable_data);
-     return omega == enable_data;
+    // DCASSERT(unknown != status());
+     return omega == status();
    }
 
+  /// Enabling expression value: 1 true, -1 false, 0 unknown.
+  inline signed char getEnablingValue() const { return expr_status(); }
+  inline void setEnablingValue(signed char v) { expr_status() = enable_status(v); }
+
+private:
+  inline enable_status& status() {
+    CHECK_RANGE(0, my_slot, num_slots);
+    return enable_data[my_slot];
+  }
+  inline enable_status& expr_status() {
+    CHECK_RANGE(0, my_slot, num_slots);
+    return enabling_value[my_slot];
+  }
+  inline enable_status expr_status() const {
+    CHECK_RANGE(0, my_slot, num_slots);
+    return enabling_value[my_slot];
+  }
+  inline enable_status status() const {
+    CHECK_RANGE(0, my_slot, num_slots);
+    return enable_data[my_slot];
+  }
+
+  friend class dsde_hlm;
 };
 
 
@@ -426,8 +874,77 @@ public:
 
   /// Like makeEnabledList, but we know the current state is tangible.
   void makeTangibleEnabledList(traverse_data &x, List <model_event> *en);
+
+  /** Like makeTangibleEnabledList, but some enabling expressions
+      are known not to have changed since a parent state.
+        @param  known   Enabling values inherited from the parent,
+                        one per event, as built by inheritEnabling().
+  */
+  void makeTangibleEnabledList(traverse_data &x, List <model_event> *en,
+    const std::vector <signed char> &known);
   void makeTangibleEnabledListCov(traverse_data &x, List <model_event> *en, bool* misomega);
 
+  /** Prepare the events for concurrent enabling checks.
+      Not thread safe; call this before starting any worker threads.
+        @param  n   Number of worker threads that will explore
+                    this model; each should call
+                    model_event::setWorkerSlot() with a distinct
+                    slot between 0 and n-1.
+  */
+  void reserveWorkerSlots(int n);
+
+  /** Determine, for each event t, the events whose enabling
+      expression uses a state variable used by the next-state
+      expression of t.  Only those may change their enabling value
+      when t fires; the others keep the value they had in the
+      parent state.  Call this before inheritEnabling().
+  */
+  void buildEnablingAffects();
+
+  /** Like buildEnablingAffects(), but also for timing:
+      determine, for each event t, the events whose enabling
+      expression or firing distribution uses a state variable
+      used by the next-state expression of t.  Only those may
+      change their enabling value or their rate when t fires.
+        @param  affects   On output: affects[t] is the sorted
+                          list of such events, for each event t
+                          (by index in the model's event array).
+  */
+  void buildTimingAffects(std::vector <std::vector <int> > &affects) const;
+
+private:
+  /** Shared by buildEnablingAffects() and buildTimingAffects().
+      Uses the state variable dependencies of the events,
+      which are (re)built here, so the cost is proportional to
+      the sizes of the dependency lists, not to the number of
+      pairs of events.  Expressions that reach state variables
+      through arrays are assumed to depend on every variable.
+        @param  timing    Include the firing distributions.
+        @param  affects   On output: the sorted list of affected
+                          events, for each event.
+  */
+  void buildAffects(bool timing,
+    std::vector <std::vector <int> > &affects) const;
+
+public:
+
+  /** Save the enabling values computed for the current state.
+      Call right after building the enabled list.
+        @param  values  On output: the enabling value, for each event;
+                        1 for true, -1 for false, 0 for unknown.
+  */
+  void saveEnabling(std::vector <signed char> &values) const;
+
+  /** Enabling values for a state reached by firing an event.
+        @param  t       The event that fires.
+        @param  parent  Enabling values in the state where t fires,
+                        from saveEnabling().
+        @param  child   On output: the enabling values known
+                        for the reached state.
+  */
+  void inheritEnabling(const model_event* t, 
+    const std::vector <signed char> &parent, std::vector <signed char> &child) const;
+
 
   // Things to be defined in derived classes.
 
@@ -471,6 +988,8 @@ protected:
   /// Reorder events and such, as convenient.
   void determineModelType();
   void ProcessEvents();
+  /// Rest of makeTangibleEnabledList, once the statuses are reset.
+  void finishTangibleEnabledList(traverse_data &x, List <model_event> *en);
   inline void ResetEnabledList() {
     for (long e=num_events-1; e>=0; e--) {
       DCASSERT(event_data);
@@ -50,6 +50,7 @@ public:
   inline long hasUpper() const { return upper >= 0; }
 
   inline long getInit() const { return init; }
+  inline long getUpper() const { return upper; }
 
   inline void addInit(long i) {
     DCASSERT(i>=0);
@@ -138,7 +139,21 @@ public:
 
   void Compile(const exprman* em);
   void WriteDotArc(OutputStream &ds, void* tname) const;
+
+  /** Add our enabling test to p.
+      Returns false if it cannot be expressed by the program
+      (see event_program::lower()).
+  */
+  bool lowerEnabling(event_program* p) const;
+  /** Add our state change to p.
+      Returns false if it cannot be expressed by the program.
+  */
+  bool lowerFiring(event_program* p) const;
 protected:
+  /// Is x a constant (not marking dependent) with value k?
+  static bool constValue(expr* x, long &k);
+  /// Register holding x (0 is 0), or -1 if x cannot be lowered.
+  static int lowerValue(expr* x, event_program::code &c);
   // true iff there was a duplicate
   bool addWhere(expr* x, expr* &a, List <expr>* & as);
   expr* makeSum(const exprman* em, List <expr>* &x);
@@ -223,6 +238,85 @@ void arc_entry::WriteDotArc(OutputStream &ds, void* t) const
   ds.can_flush();
 }
 
+bool arc_entry::lowerEnabling(event_program* p) const
+{
+  DCASSERT(is_compiled);
+  DCASSERT(p);
+  const place_sv* pl = smart_cast <const place_sv*> (place);
+  DCASSERT(pl);
+  event_program::code &c = p->Enabling();
+  long k;
+  if (input) {
+    if (constValue(input, k)) {
+      if (!c.needAtLeast(pl, k)) return false;
+    } else {
+      const int rp = c.emitVar(pl);
+      const int ra = (rp < 0) ? -1 : lowerValue(input, c);
+      if (ra < 0) return false;
+      if (!c.need(c.emit(event_program::Ge, rp, ra))) return false;
+    }
+  }
+  if (inhibit) {
+    if (constValue(inhibit, k)) {
+      if (!c.needLessThan(pl, k)) return false;
+    } else {
+      const int rp = c.emitVar(pl);
+      const int ra = (rp < 0) ? -1 : lowerValue(inhibit, c);
+      if (ra < 0) return false;
+      if (!c.need(c.emit(event_program::Lt, rp, ra))) return false;
+    }
+  }
+  return true;
+}
+
+bool arc_entry::lowerFiring(event_program* p) const
+{
+  DCASSERT(is_compiled);
+  DCASSERT(p);
+  const place_sv* pl = smart_cast <const place_sv*> (place);
+  DCASSERT(pl);
+  event_program::code &c = p->Firing();
+  // Same bounds as place_sv::Affix()
+  long bound = (pl->hasUpper() && pl->getUpper() > 0) ? pl->getUpper() : -1;
+  long in = 0, out = 0;
+  const bool const_in = !input || constValue(input, in);
+  const bool const_out = !output || constValue(output, out);
+  if (const_in && const_out) return c.addTo(pl, out - in, bound);
+
+  const int rin = input ? lowerValue(input, c) : -1;
+  if (input && rin < 0) return false;
+  const int rout = output ? lowerValue(output, c) : -1;
+  if (output && rout < 0) return false;
+  int delta;
+  if (!input)         delta = rout;
+  else if (!output)   delta = c.emit(event_program::Neg, rin, -1);
+  else                delta = c.emit(event_program::Sub, rout, rin);
+  if (delta < 0) return false;
+  return c.addTo(pl, delta, bound);
+}
+
+bool arc_entry::constValue(expr* x, long &k)
+{
+  DCASSERT(x);
+  if (x->BuildExprList(traverse_data::GetSymbols, 0, 0)) return false;
+  traverse_data xd(traverse_data::Compute);
+  result foo;
+  xd.answer = &foo;
+  x->PreCompute();
+  x->Compute(xd);
+  if (!foo.isNormal()) return false;
+  k = foo.getInt();
+  return true;
+}
+
+int arc_entry::lowerValue(expr* x, event_program::code &c)
+{
+  DCASSERT(x);
+  long k;
+  if (constValue(x, k)) return c.emitConst(k);
+  return event_program::lower(x, c, traverse_data::BuildDD);
+}
+
 bool arc_entry::addWhere(expr* x, expr* &a, List <expr>* & as)
 {
   DCASSERT(!is_compiled);
@@ -283,6 +377,10 @@ class transition : public model_event {
   std::vector<expr*> enablings;
   /// List of enabling expressions
   std::vector<expr*> firings;
+  /// Arc for each enabling expression; valid until finalized
+  std::vector<arc_entry*> enabling_arcs;
+  /// Arc for each firing expression; valid until finalized
+  std::vector<arc_entry*> firing_arcs;
   /// Ignored enabling expressions
   std::vector<bool> ignore_enabling;
   /// Ignored firing expressions
@@ -343,6 +441,10 @@ public:
   /// Transition cannot be modified once finalized.
   void Finalize(OutputStream &ds);
 
+protected:
+  /// Lower the (non-ignored) arcs, guards, and rate, as much as possible.
+  event_program* makeProgram() const;
+
 protected:
   inline arc_entry* UniqueInsert(arc_entry* &tmp) {
     DCASSERT(tmp);
@@ -463,10 +565,12 @@ void transition::compile(OutputStream &ds)
       DCASSERT(a);
       if (a->getEnabling()) {
         enablings.push_back(a->getEnabling());
+        enabling_arcs.push_back(a);
         ignore_enabling.push_back(false);
       }
       if (a->getFiring()) {
         firings.push_back(a->getFiring());
+        firing_arcs.push_back(a);
         ignore_firing.push_back(false);
       }
     } // for i
@@ -474,6 +578,53 @@ void transition::compile(OutputStream &ds)
 }
 
 
+event_program* transition::makeProgram() const
+{
+  DCASSERT(enabling_arcs.size() == enablings.size());
+  DCASSERT(firing_arcs.size() == firings.size());
+  DCASSERT(build_data);
+  event_program* p = new event_program;
+
+  // Same order as the enabling expression: arcs, then guards.
+  // No enabling expression at all means "true", an empty program.
+  bool ok = true;
+  for (unsigned i = 0; ok && i < enablings.size(); i++) {
+    if (ignore_enabling[i]) continue;
+    ok = enabling_arcs[i]->lowerEnabling(p);
+  }
+  List <expr>* guards = build_data->guards;
+  for (int i = 0; ok && guards && i < guards->Length(); i++) {
+    event_program::code &c = p->Enabling();
+    const int r = event_program::lower(guards->Item(i), c,
+                    traverse_data::BuildDD);
+    ok = (r >= 0) && c.need(r);
+  }
+  p->finishEnabling(ok);
+
+  ok = getNextstate();
+  for (unsigned i = 0; ok && i < firings.size(); i++) {
+    if (ignore_firing[i]) continue;
+    ok = firing_arcs[i]->lowerFiring(p);
+  }
+  p->finishFiring(ok);
+
+  if (hasFiringType(Expo)) {
+    expr* d = getDistribution();
+    if (d && 0==d->BuildExprList(traverse_data::GetSymbols, 0, 0)) {
+      traverse_data x(traverse_data::ComputeExpoRate);
+      result foo;
+      x.answer = &foo;
+      d->Traverse(x);
+      if (foo.isNormal()) p->ExpoRate().emitConst(foo.getReal());
+    } else if (d) {
+      // marking dependent
+      event_program::lower(d, p->ExpoRate(), traverse_data::BuildExpoRateDD);
+    }
+    p->finishRate(true);
+  }
+  return p;
+}
+
 void transition::Finalize(OutputStream &ds)
 {
   if (!is_compiled) compile(ds);
@@ -552,10 +703,14 @@ void transition::Finalize(OutputStream &ds)
       setNextstate(compiled_firing);
       if (fptr < 2) delete[] firelist;
     }
+
+    setProgram(makeProgram());
   }
 
   delete build_data;
   build_data = 0;
+  enabling_arcs.clear();
+  firing_arcs.clear();
 
 #ifdef DEBUG_PNS
   em->cout() << "Finalized " << Name() << "\n";
@@ -2578,7 +2733,7 @@ void pn_rate::Compute(traverse_data &x, expr** pass, int np)
   }
 
   x.which = traverse_data::ComputeExpoRate;
-  SafeComputeExpoRate(t->getDistribution(), x);
+  t->computeExpoRate(x);
   x.which = traverse_data::Compute;
 }
 
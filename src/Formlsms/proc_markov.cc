@@ -24,8 +24,13 @@
 
 LS_Options* markov_process::lsopts = 0;
 unsigned markov_process::solver;
+unsigned markov_process::precond[markov_process::NUM_SOLVERS];
 reporting_msg markov_process::report;
 unsigned markov_process::access = markov_process::BY_COLUMNS;
+bool markov_process::index_edges = false;
+unsigned markov_process::transient = markov_process::UNIFORMIZATION;
+long markov_process::scc_threads = 0;
+unsigned markov_process::state_order = markov_process::DISCOVERY_ORDER;
 markov_process::reporter* markov_process::my_timer = 0;
 
 // ******************************************************************
@@ -48,6 +53,11 @@ const LS_Options& markov_process::getSolverOptions()
   CHECK_RANGE(0, solver, NUM_SOLVERS);
   // fix the option values that are not automatically linked
   lsopts[solver].use_relaxation = (lsopts[solver].relaxation != 1.0);
+  switch (precond[solver]) {
+    case PRECOND_NONE:    lsopts[solver].precond = LS_Precond_None;   break;
+    case PRECOND_JACOBI:  lsopts[solver].precond = LS_Precond_Jacobi; break;
+    default:              lsopts[solver].precond = LS_Precond_ILU0;
+  }
   return lsopts[solver];
 }
 
@@ -175,6 +185,9 @@ const char* markov_process::getSolver()
     case GAUSS_SEIDEL:    return "Gauss-Seidel";
     case JACOBI:          return "Jacobi";
     case ROW_JACOBI:      return "Row Jacobi";
+    case GMRES:           return "GMRES";
+    case BICGSTAB:        return "BiCGSTAB";
+    case AGGREGATION:     return "Aggregation-disaggregation";
     default:              return "unknown solver";
   }
 }
@@ -267,6 +280,8 @@ class init_markovproc : public initializer {
     virtual bool execute();
 
     option_manager* makeSubsettings(unsigned i, bool auxvectors);
+    option_manager* makeKrylovSettings(unsigned i, bool restarts);
+    option_manager* makeAggregationSettings(unsigned i);
 };
 init_markovproc the_markovproc_initializer;
 
@@ -301,6 +316,9 @@ bool init_markovproc::execute()
   markov_process::lsopts[markov_process::GAUSS_SEIDEL].method = LS_Gauss_Seidel;
   markov_process::lsopts[markov_process::JACOBI].method = LS_Jacobi;
   markov_process::lsopts[markov_process::ROW_JACOBI].method = LS_Row_Jacobi;
+  markov_process::lsopts[markov_process::GMRES].method = LS_GMRES;
+  markov_process::lsopts[markov_process::BICGSTAB].method = LS_BiCGSTAB;
+  markov_process::lsopts[markov_process::AGGREGATION].method = LS_Aggregation;
 
   markov_process::solver = markov_process::GAUSS_SEIDEL;
 
@@ -311,7 +329,7 @@ bool init_markovproc::execute()
     option* solvers = em->OptMan()->addRadioOption(
       "MCSolver",
       "Numerical method to use for solving linear systems during Markov chain analysis.",
-      3, markov_process::solver
+      6, markov_process::solver
     );
 
     option_enum* currsolv = solvers->addRadioButton(
@@ -338,6 +356,30 @@ bool init_markovproc::execute()
             makeSubsettings(markov_process::ROW_JACOBI, true)
     );
 
+    currsolv = solvers->addRadioButton(
+      "GMRES", "Restarted GMRES, a Krylov subspace method",
+      markov_process::GMRES
+    );
+    currsolv->makeSettings(
+            makeKrylovSettings(markov_process::GMRES, true)
+    );
+
+    currsolv = solvers->addRadioButton(
+      "BICGSTAB", "BiCGSTAB, a Krylov subspace method",
+      markov_process::BICGSTAB
+    );
+    currsolv->makeSettings(
+            makeKrylovSettings(markov_process::BICGSTAB, false)
+    );
+
+    currsolv = solvers->addRadioButton(
+      "AGGREGATION", "Iterative aggregation-disaggregation, for nearly completely decomposable chains; linear systems other than steady-state use Gauss-Seidel",
+      markov_process::AGGREGATION
+    );
+    currsolv->makeSettings(
+            makeAggregationSettings(markov_process::AGGREGATION)
+    );
+
 
     option* mcby = em->OptMan()->addRadioOption("MCAccessBy",
       "Specifiy initial storage method for Markov chains: by rows (required for simulations) or by columns (required for certain linear solvers).",
@@ -354,10 +396,71 @@ bool init_markovproc::execute()
       "Access to rows",
       markov_process::BY_ROWS
     );
+
+    option* trans = em->OptMan()->addRadioOption("MCTransient",
+      "Numerical method to use for transient analysis of CTMCs.  All of them report the number of vector-matrix multiplications.",
+      3, markov_process::transient
+    );
+
+    trans->addRadioButton(
+      "UNIFORMIZATION",
+      "Uniformization, with the largest total outgoing rate",
+      markov_process::UNIFORMIZATION
+    );
+    trans->addRadioButton(
+      "ADAPTIVE_UNIFORMIZATION",
+      "Adaptive uniformization; the rate grows with the set of states reachable after each jump.  Helps when fast states are far from the initial states.",
+      markov_process::ADAPTIVE_UNIF
+    );
+    trans->addRadioButton(
+      "KRYLOV",
+      "Krylov subspace approximation of the matrix exponential, with time stepping.  Helps for stiff chains and long times.",
+      markov_process::KRYLOV_EXP
+    );
+
+    em->OptMan()->addIntOption("MCSCCThreads",
+      "Number of threads for the strongly-connected component decomposition used to classify the states of a Markov chain, during construction.  If 0, the sequential algorithm is used.  The classification is the same either way.",
+      markov_process::scc_threads, 0, 1024
+    );
+
+    option* order = em->OptMan()->addRadioOption("MCStateOrder",
+      "How to number the states of a Markov chain within each class.  Orders other than discovery order take extra time during construction, but can reduce cache misses during numerical solution.  The renumbering time is reported under mc_finish, and solution times under mc_solve.",
+      4, markov_process::state_order
+    );
+
+    order->addRadioButton(
+      "DISCOVERY",
+      "The order in which the states were generated",
+      markov_process::DISCOVERY_ORDER
+    );
+    order->addRadioButton(
+      "BFS",
+      "Breadth-first levels of the graph, ignoring edge directions",
+      markov_process::BFS_ORDER
+    );
+    order->addRadioButton(
+      "RCM",
+      "Reverse Cuthill-McKee, to reduce the bandwidth of the matrix",
+      markov_process::RCM_ORDER
+    );
+    order->addRadioButton(
+      "PARTITION",
+      "Recursive bisection of the graph, into parts of a few thousand states",
+      markov_process::PARTITION_ORDER
+    );
+
+    em->OptMan()->addBoolOption("MCIndexedEdges",
+      "Should Markov chains store each distinct rate or probability once, with a small index per edge?  Saves memory and speeds up numerical solution when the chain has few distinct values (at most 65536; otherwise, the option is ignored).",
+      markov_process::index_edges
+    );
   }
 
   markov_process::solver = markov_process::GAUSS_SEIDEL;
   markov_process::access = markov_process::BY_COLUMNS;
+  markov_process::index_edges = false;
+  markov_process::transient = markov_process::UNIFORMIZATION;
+  markov_process::scc_threads = 0;
+  markov_process::state_order = markov_process::DISCOVERY_ORDER;
 
   markov_process::report.initialize(em->OptMan(), "mc_solve",
       "When set, Markov chain solution performance is reported."
@@ -419,6 +522,122 @@ option_manager* init_markovproc::makeSubsettings(unsigned i, bool auxvectors)
     }
     markov_process::lsopts[i].float_vectors = false;
 
+    settings->addIntOption(
+        "Threads",
+        "Number of threads to use for each iteration.",
+        markov_process::lsopts[i].num_threads, 1, 1024
+    );
+    markov_process::lsopts[i].num_threads = 1;
+
+    if (markov_process::GAUSS_SEIDEL == i) {
+      settings->addIntOption(
+          "Blocks",
+          "With more than one thread, the states are split into this many blocks of consecutive states, updated in order within each block; blocks that do not depend on each other are updated at the same time.  If 0, single states are used instead of blocks.",
+          markov_process::lsopts[i].gs_blocks, 0, 2000000000
+      );
+    }
+    markov_process::lsopts[i].gs_blocks = 0;
+
+    // That's all
+    settings->DoneAddingOptions();
+
+    return settings;
+}
+
+option_manager* init_markovproc::makeKrylovSettings(unsigned i, bool restarts)
+{
+#ifdef DEBUG_NUMERICAL_ITERATIONS
+    markov_process::lsopts[i].debug = true;
+#endif
+    option_manager* settings = MakeOptionManager();
+    settings->addIntOption(
+        "MaxIters",
+        "Maximum number of iterations (matrix-vector multiplications for GMRES, pairs of them for BiCGSTAB).  The solver will terminate if either the termination criteria has been met (see options for Precision), or the maximum number of iterations has been reached.",
+        markov_process::lsopts[i].max_iters, 0, 2000000000
+    );
+    markov_process::lsopts[i].max_iters = 5000;
+
+    settings->addRealOption(
+        "Precision",
+        "Desired precision.  Solvers will run until the 2-norm of the residual, relative to the 2-norm of the right-hand side, is less than epsilon.",
+        markov_process::lsopts[i].precision,
+        true, false, 0.0,
+        true, false, 1.0
+    );
+    markov_process::lsopts[i].precision = 1e-8;
+
+    if (restarts) {
+      settings->addIntOption(
+          "Restart",
+          "Dimension of the Krylov subspace; the method restarts after this many iterations.  Larger values converge in fewer iterations but require one vector of storage each.",
+          markov_process::lsopts[i].krylov_dim, 1, 1000
+      );
+    }
+    markov_process::lsopts[i].krylov_dim = 30;
+
+    option* pre = settings->addRadioOption(
+        "Preconditioner",
+        "Preconditioner to use.",
+        3, markov_process::precond[i]
+    );
+    pre->addRadioButton(
+        "NONE", "No preconditioning",
+        markov_process::PRECOND_NONE
+    );
+    pre->addRadioButton(
+        "JACOBI", "Divide by the diagonal",
+        markov_process::PRECOND_JACOBI
+    );
+    pre->addRadioButton(
+        "ILU0", "Incomplete LU factorization, without fill; requires an explicit matrix",
+        markov_process::PRECOND_ILU0
+    );
+    markov_process::precond[i] = markov_process::PRECOND_ILU0;
+
+    // That's all
+    settings->DoneAddingOptions();
+
+    return settings;
+}
+
+option_manager* init_markovproc::makeAggregationSettings(unsigned i)
+{
+#ifdef DEBUG_NUMERICAL_ITERATIONS
+    markov_process::lsopts[i].debug = true;
+#endif
+    option_manager* settings = MakeOptionManager();
+    settings->addIntOption(
+        "MinIters",
+        "Minimum number of iterations.  Guarantees that at least this many iterations will occur.",
+        markov_process::lsopts[i].min_iters, 0, 2000000000
+    );
+    markov_process::lsopts[i].min_iters = 2;
+
+    settings->addIntOption(
+        "MaxIters",
+        "Maximum number of iterations.  Once the minimum number of iterations has been reached, the solver will terminate if either the termination criteria has been met (see options for Precision), or the maximum number of iterations has been reached.",
+        markov_process::lsopts[i].max_iters, 0, 2000000000
+    );
+    markov_process::lsopts[i].max_iters = 5000;
+
+    settings->addRealOption(
+        "Precision",
+        "Desired precision.  Solvers will run until each solution vector element has changed less than epsilon.  Relative or absolute precision may be used, see option TBD.",
+        markov_process::lsopts[i].precision,
+        true, false, 0.0,
+        true, false, 1.0
+    );
+    markov_process::lsopts[i].precision = 1e-5;
+
+    settings->addRealOption(
+        "Threshold",
+        "Determines the blocks of states to aggregate: two states are in the same block if they are connected through rates at least this fraction of the largest rate out of the same state.",
+        markov_process::lsopts[i].aggregate_threshold,
+        true, false, 0.0,
+        true, true, 1.0
+    );
+    markov_process::lsopts[i].aggregate_threshold = 0.1;
+
     // That's all
     settings->DoneAddingOptions();
 
@@ -42,19 +42,50 @@ class markov_process : public stochastic_lldsm::process {
     static LS_Options* lsopts;
     // options, shared by all Markov-chain low-level models.
     static unsigned solver;
-    static const unsigned GAUSS_SEIDEL = 0;
-    static const unsigned JACOBI       = 1;
-    static const unsigned ROW_JACOBI   = 2;
-    static const unsigned NUM_SOLVERS  = 3;
+    // radio button indexes must follow the alphabetical order of names
+    static const unsigned AGGREGATION  = 0;
+    static const unsigned BICGSTAB     = 1;
+    static const unsigned GAUSS_SEIDEL = 2;
+    static const unsigned GMRES        = 3;
+    static const unsigned JACOBI       = 4;
+    static const unsigned ROW_JACOBI   = 5;
+    static const unsigned NUM_SOLVERS  = 6;
+    // preconditioner, for each solver (only used by GMRES, BICGSTAB)
+    static unsigned precond[NUM_SOLVERS];
+    static const unsigned PRECOND_ILU0   = 0;
+    static const unsigned PRECOND_JACOBI = 1;
+    static const unsigned PRECOND_NONE   = 2;
     static reporting_msg report;
     static unsigned access;
     static const unsigned BY_COLUMNS = 0;
     static const unsigned BY_ROWS    = 1;
+    static bool index_edges;
+  public:
+    // method for CTMC transient analysis, in name order
+    static const unsigned ADAPTIVE_UNIF   = 0;
+    static const unsigned KRYLOV_EXP      = 1;
+    static const unsigned UNIFORMIZATION  = 2;
+  private:
+    static unsigned transient;
+    // threads for SCC decomposition; 0 for the sequential algorithm
+    static long scc_threads;
+  public:
+    // state ordering within classes, for locality, in name order
+    static const unsigned BFS_ORDER       = 0;
+    static const unsigned DISCOVERY_ORDER = 1;
+    static const unsigned PARTITION_ORDER = 2;
+    static const unsigned RCM_ORDER       = 3;
+  private:
+    static unsigned state_order;
   protected:
     static reporter* my_timer;
 
   public:
     inline static bool storeByRows() { return BY_ROWS == access; }
+    inline static bool indexEdgeValues() { return index_edges; }
+    inline static unsigned transientMethod() { return transient; }
+    inline static int sccThreads() { return int(scc_threads); }
+    inline static unsigned stateOrder() { return state_order; }
     static const LS_Options& getSolverOptions();
     static const char* getSolver();
 
@@ -131,7 +131,8 @@ GraphLib::node_renumberer* mclib_process::initChain(GraphLib::dynamic_graph *g)
 {
   // Classify states
   GraphLib::timer_hook *sw = my_timer ? my_timer->switchMe() : 0;
-  GraphLib::abstract_classifier* ac = g->determineSCCs(0, 1, true, sw);
+  GraphLib::abstract_classifier* ac = g->determineSCCs(0, 1, true, sw,
+    sccThreads());
   GraphLib::static_classifier C;
   GraphLib::node_renumberer *Ren = ac->buildRenumbererAndStatic(C);
 
@@ -139,12 +140,21 @@ GraphLib::node_renumberer* mclib_process::initChain(GraphLib::dynamic_graph *g)
   DCASSERT(Ren);
   g->renumberNodes(*Ren);
 
+  // State order within classes
+  const bool reorder = (stateOrder() != DISCOVERY_ORDER);
+  GraphLib::locality_order ord = GraphLib::RCM_Order;
+  switch (stateOrder()) {
+    case BFS_ORDER:       ord = GraphLib::BFS_Order;        break;
+    case PARTITION_ORDER: ord = GraphLib::Partition_Order;  break;
+    default:              ord = GraphLib::RCM_Order;
+  }
+
   // Build chain; try using doubles
   GraphLib::dynamic_summable <double> *Gd =
     dynamic_cast < GraphLib::dynamic_summable <double> *> (g);
 
   if (Gd) {
-    chain = new MCLib::Markov_chain(is_discrete, *Gd, C, sw);
+    chain = new MCLib::Markov_chain(is_discrete, *Gd, C, sw, reorder, ord);
   }
 
   if (0==chain) {
@@ -153,8 +163,27 @@ GraphLib::node_renumberer* mclib_process::initChain(GraphLib::dynamic_graph *g)
       dynamic_cast < GraphLib::dynamic_summable <float> *> (g);
 
     if (Gf) {
-      chain = new MCLib::Markov_chain(is_discrete, *Gf, C, sw);
+      chain = new MCLib::Markov_chain(is_discrete, *Gf, C, sw, reorder, ord);
+    }
+  }
+
+  // Combine class and locality renumberings
+  GraphLib::node_renumberer* L = chain ? chain->takeLocalityRenumberer() : 0;
+  if (L) {
+    if (L->changes_something()) {
+      const long ns = chain->getNumStates();
+      long* nn = new long[ns];
+      for (long i=0; i<ns; i++) {
+        nn[i] = L->new_number(Ren->new_number(i));
+      }
+      delete Ren;
+      Ren = new GraphLib::array_renumberer(nn, ns);
     }
+    delete L;
+  }
+
+  if (chain && indexEdgeValues()) {
+    chain->compressEdgeValues();
   }
 
   if (0==chain) {
@@ -291,6 +320,25 @@ void mclib_process::showClasses(OutputStream &os, state_lldsm::reachset* RSS,
 
 // ******************************************************************
 
+void mclib_process
+::setTransientMethod(MCLib::Markov_chain::CTMC_transient_options &opts)
+{
+  switch (transientMethod()) {
+    case ADAPTIVE_UNIF:
+      opts.method = MCLib::Markov_chain::CTMC_transient_options::Adaptive_Uniformization;
+      return;
+
+    case KRYLOV_EXP:
+      opts.method = MCLib::Markov_chain::CTMC_transient_options::Krylov;
+      return;
+
+    default:
+      opts.method = MCLib::Markov_chain::CTMC_transient_options::Uniformization;
+  }
+}
+
+// ******************************************************************
+
 bool mclib_process::isTransient(long st) const
 {
   DCASSERT(chain);
@@ -400,6 +448,7 @@ bool mclib_process
       MCLib::Markov_chain::CTMC_transient_options opts;
       opts.vm_result = aux1;
       opts.accumulator = aux2;
+      setTransientMethod(opts);
 
       startTransientReport(w, t);
       chain->computeTransient(t, probs, opts);
@@ -423,6 +472,41 @@ bool mclib_process
 
 // ******************************************************************
 
+bool mclib_process::computeTransients(const double* times, int ntimes,
+  const double* p0, double** dists, double* aux1, double* aux2) const
+{
+  if (is_discrete || ntimes < 2 || transientMethod() != UNIFORMIZATION) {
+    return markov_process::computeTransients(times, ntimes, p0, dists, aux1, aux2);
+  }
+  if (0==chain || 0==p0 || 0==dists || 0==aux1 || 0==aux2)  return false;
+
+  try {
+    timer w;
+    MCLib::Markov_chain::CTMC_transient_options opts;
+    opts.vm_result = aux1;
+    opts.accumulator = aux2;
+
+    startTransientReport(w, times[ntimes-1]);
+    chain->computeTransient(times, ntimes, p0, dists, opts);
+    stopTransientReport(w, opts.multiplications);
+
+    opts.vm_result = 0;
+    opts.accumulator = 0;
+    return true;
+  }
+  catch (MCLib::error e) {
+    if (em->startInternal(__FILE__, __LINE__)) {
+      em->causedBy(0);
+      em->internal() << "Unexpected error: ";
+      em->internal() << e.getString();
+      em->stopIO();
+    }
+    return false;
+  }
+}
+
+// ******************************************************************
+
 bool mclib_process::computeAccumulated(double t, const double* p0, double* n,
                                   double* aux, double* aux2) const
 {
@@ -769,6 +853,7 @@ bool mclib_process::reachesAcceptBy(double t, double* x) const
       stopRevTransReport(w, opts.multiplications);
     } else {
       MCLib::Markov_chain::CTMC_transient_options opts;
+      setTransientMethod(opts);
       startRevTransReport(w, t);
       chain->reverseTransient(t, x, opts);
       stopRevTransReport(w, opts.multiplications);
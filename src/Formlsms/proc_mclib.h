@@ -31,6 +31,9 @@ class mclib_process : public markov_process {
     // Helper, used by attachToParent.
     GraphLib::node_renumberer* initChain(GraphLib::dynamic_graph *g);
 
+    // Helper: set the transient method from our option.
+    static void setTransientMethod(MCLib::Markov_chain::CTMC_transient_options &opts);
+
   public:
     virtual long getNumStates() const;
     virtual void getNumClasses(long &count) const;
@@ -41,6 +44,8 @@ class mclib_process : public markov_process {
     virtual long getOutgoingWeights(long from, long* to, double* w, long n) const;
     virtual bool computeTransient(double t, double* probs, 
         double* aux, double* aux2) const;
+    virtual bool computeTransients(const double* times, int ntimes,
+        const double* p0, double** dists, double* aux, double* aux2) const;
     virtual bool computeAccumulated(double t, const double* p0, double* n,
         double* aux, double* aux2) const;
     virtual bool computeSteadyState(double* probs) const;
@@ -1,6 +1,20 @@
 
 #include "proc_meddly.h"
 #include "rss_meddly.h"
+#include "dsde_hlm.h"
+
+#include "../Modules/statevects.h"
+#include "../_LSLib/lslib.h"
+#include "../_Distros/distros.h"
+#include "../_Meddly/src/meddly_expert.h"
+
+#include <string.h>
+
+// Precision for the Poisson distributions in uniformization
+const double POISSON_EPSILON = 1e-20;
+
+// Slack on the largest row sum, so the uniformized chain is aperiodic
+const double UNIFORM_SLACK = 1.02;
 
 // ******************************************************************
 // *                                                                *
@@ -12,11 +26,22 @@ meddly_process::meddly_process(meddly_encoder* wrap)
 {
   mxd_wrap = wrap;
   proc = 0;
+  mrss = 0;
   num_states = 0;
+  rates = 0;
+  rates_wrap = 0;
+  VM = 0;
+  max_rowsum = 0;
+  initial = 0;
+  num_classes = 0;
 }
 
 meddly_process::~meddly_process()
 {
+  if (VM) MEDDLY::destroyOperation(VM);
+  Delete(rates);
+  Delete(rates_wrap);
+  Delete(initial);
   Delete(mxd_wrap);
   Delete(proc);
 }
@@ -28,7 +53,19 @@ void meddly_process::attachToParent(stochastic_lldsm* p, LS_Vector &init, state_
   process::attachToParent(p, init, rss);
 
   rss->getNumStates(num_states); 
-  // TBD
+
+  mrss = smart_cast <meddly_reachset*> (rss);
+  DCASSERT(mrss);
+  mrss->buildIndexSet();
+
+  //
+  // Generation does not give us an initial vector;
+  // we use the initial states instead.
+  //
+  buildInitial(p);
+
+  if (!prepareNumerical()) return;
+  classify();
 }
 
 long meddly_process::getNumStates() const
@@ -185,24 +222,477 @@ void meddly_process::showInternal(OutputStream &os) const
 
 void meddly_process::getNumClasses(long &count) const
 {
-  DCASSERT(0);
+  count = num_classes;
 }
 
 void meddly_process::showClasses(OutputStream &os, state_lldsm::reachset* rss, 
       shared_state* st) const
 {
-  DCASSERT(0);
+  DCASSERT(mrss);
+  MEDDLY::enumerator I(MEDDLY::enumerator::FULL, mrss->getMddForest());
+
+  // Class 0 is the transient states
+  for (long c = state_class.empty() ? 1 : 0; c<=num_classes; c++) {
+    bool comma = false;
+    long i = 0;
+    for (I.start(mrss->getStates()); I; ++I, i++) {
+      if (!state_class.empty() && state_class[i] != c) continue;
+      if (!comma) {
+        if (0==c) {
+          os << "Transient states";
+        } else {
+          os << "Recurrent class " << c;
+        }
+        os << ":\n\t{";
+      } else {
+        os << ", ";
+      }
+      comma = true;
+      mrss->MddMinterm2State(I.getAssignments(), st);
+      rss->showState(os, st);
+      os.flush();
+    }
+    if (comma) os << "}\n";
+  }
 }
 
 bool meddly_process::isTransient(long st) const
 {
-  DCASSERT(0);
-  return false;
+  if (state_class.empty()) return false;
+  CHECK_RANGE(0, st, num_states);
+  return 0==state_class[st];
 }
 
 statedist* meddly_process::getInitialDistribution() const
 {
-  DCASSERT(0);
-  return 0;
+  return Share(initial);
+}
+
+// ******************************************************************
+
+bool meddly_process::computeTransient(double t, double* probs,
+  double* aux, double* aux2) const
+{
+  if (0==VM || 0==probs || 0==aux || 0==aux2) return false;
+
+  timer w;
+  startTransientReport(w, t);
+  const double q = uniformRate();
+  long mults = 0;
+  if (q > 0 && t > 0) {
+    discrete_pdf poisson;
+    computePoissonPDF(q * t, POISSON_EPSILON, poisson);
+
+    // aux accumulates; probs and aux2 hold successive vectors
+    double* x = probs;
+    double* y = aux2;
+    memset(aux, 0, num_states * sizeof(double));
+    try {
+      for (long k=0; k<=poisson.right_trunc(); k++) {
+        if (k >= poisson.left_trunc()) {
+          const double fk = poisson.f(k);
+          for (long i=0; i<num_states; i++) aux[i] += fk * x[i];
+        }
+        if (k == poisson.right_trunc()) break;
+        uniformStep(x, y, q);
+        mults++;
+        SWAP(x, y);
+      }
+    }
+    catch (MEDDLY::error e) {
+      return meddlyFailed("transient", e);
+    }
+    memcpy(probs, aux, num_states * sizeof(double));
+  }
+  stopTransientReport(w, mults);
+  return true;
+}
+
+// ******************************************************************
+
+bool meddly_process::computeAccumulated(double t, const double* p0, double* n,
+  double* aux, double* aux2) const
+{
+  if (0==VM || 0==p0 || 0==n || 0==aux || 0==aux2) return false;
+
+  timer w;
+  startAccumulatedReport(w, t);
+  memset(n, 0, num_states * sizeof(double));
+  const double q = uniformRate();
+  long mults = 0;
+  if (t <= 0) {
+    // nothing accumulated
+  } else if (0==q) {
+    // No transitions; we stay put
+    for (long i=0; i<num_states; i++) n[i] = t * p0[i];
+  } else {
+    discrete_pdf poisson;
+    computePoissonPDF(q * t, POISSON_EPSILON, poisson);
+
+    //
+    // n = (1/q) sum_k Pr{Poisson > k} x_k
+    //
+    memcpy(aux, p0, num_states * sizeof(double));
+    double* x = aux;
+    double* y = aux2;
+    double cdf = 0;
+    try {
+      for (long k=0; k<=poisson.right_trunc(); k++) {
+        if (k >= poisson.left_trunc()) cdf += poisson.f(k);
+        const double wk = (1.0 - cdf) / q;
+        if (wk <= 0) break;
+        for (long i=0; i<num_states; i++) n[i] += wk * x[i];
+        if (k == poisson.right_trunc()) break;
+        uniformStep(x, y, q);
+        mults++;
+        SWAP(x, y);
+      }
+    }
+    catch (MEDDLY::error e) {
+      return meddlyFailed("accumulated", e);
+    }
+  }
+  stopAccumulatedReport(w, mults);
+  return true;
+}
+
+// ******************************************************************
+
+bool meddly_process::computeSteadyState(double* probs) const
+{
+  if (0==VM || 0==probs) return false;
+  if (0==num_states) return true;
+  if (1==num_states) {
+    probs[0] = 1;
+    return true;
+  }
+
+  double* old = new double[num_states];
+  bool ok;
+  try {
+    if (state_class.empty()) {
+      ok = jacobiSteadyState(probs, old);
+    } else {
+      ok = powerSteadyState(probs, old);
+    }
+  }
+  catch (MEDDLY::error e) {
+    ok = meddlyFailed("steady-state", e);
+  }
+  delete[] old;
+  return ok;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                    meddly_process  helpers                     *
+// *                                                                *
+// ******************************************************************
+
+void meddly_process::buildInitial(stochastic_lldsm* p)
+{
+  double* init = new double[num_states];
+  for (long i=0; i<num_states; i++) init[i] = 0;
+
+  //
+  // Use the initial weights given by the model, if we can
+  //
+  const dsde_hlm* dsm = dynamic_cast <const dsde_hlm*> (p->GetParent());
+  if (dsm && weighInitial(*dsm, init)) {
+    initial = new statedist(p, init, num_states);
+    delete[] init;
+    return;
+  }
+
+  //
+  // Otherwise, equally likely initial states
+  //
+  for (long i=0; i<num_states; i++) init[i] = 0;
+  long count = 0;
+  MEDDLY::enumerator I(MEDDLY::enumerator::FULL, mrss->getMddForest());
+  for (I.start(mrss->getInitial()); I; ++I) {
+    long i = mrss->getMintermIndex(I.getAssignments());
+    if (i < 0 || i >= num_states) continue;
+    init[i] = 1;
+    count++;
+  }
+  if (count > 1) {
+    for (long i=0; i<num_states; i++) init[i] /= count;
+    if (em->startWarning()) {
+      em->causedBy(0);
+      em->warn() << "Initial state weights unavailable; ";
+      em->warn() << "using equally likely initial states";
+      em->stopIO();
+    }
+  }
+  initial = new statedist(p, init, num_states);
+  delete[] init;
+}
+
+bool meddly_process::weighInitial(const dsde_hlm &dsm, double* init) const
+{
+  shared_state* st = new shared_state(&dsm);
+  int* mt = new int[mrss->getNumLevels()];
+  double total = 0;
+  bool dropped = false;
+  try {
+    for (int n=0; n<dsm.NumInitialStates(); n++) {
+      double wt = dsm.GetInitialState(n, st);
+      mrss->MddState2Minterm(st, mt);
+      long i = mrss->getMintermIndex(mt);
+      if (i < 0 || i >= num_states) {
+        dropped = true;
+        continue;
+      }
+      init[i] += wt;
+      total += wt;
+    }
+  }
+  catch (sv_encoder::error e) {
+    total = 0;
+  }
+  delete[] mt;
+  Delete(st);
+
+  if (total <= 0) return false;
+  for (long i=0; i<num_states; i++) init[i] /= total;
+
+  if (dropped && em->startWarning()) {
+    em->causedBy(0);
+    em->warn() << "Ignoring initial states that are not in the ";
+    em->warn() << "tangible reachability set";
+    em->stopIO();
+  }
+  return true;
+}
+
+bool meddly_process::prepareNumerical()
+{
+  DCASSERT(proc);
+  DCASSERT(mrss);
+  try {
+    //
+    // Vector-matrix multiply requires a multi-terminal matrix
+    //
+    MEDDLY::forest* pf = proc->getForest();
+    if (pf->isMultiTerminal()) {
+      rates = Share(proc);
+    } else {
+      MEDDLY::forest* mtf = pf->useDomain()->createForest(
+        true, MEDDLY::forest::REAL, MEDDLY::forest::MULTI_TERMINAL
+      );
+      rates_wrap = mxd_wrap->copyWithDifferentForest("MT rates", mtf);
+      rates = new shared_ddedge(mtf);
+      MEDDLY::apply(MEDDLY::COPY, proc->E, rates->E);
+    }
+
+    const MEDDLY::dd_edge &ind = mrss->getIndexSet();
+    VM = MEDDLY::EXPLVECT_MATR_MULT->buildOperation(ind, rates->E, ind);
+
+    //
+    // Row sums: R times the vector of all ones
+    //
+    MEDDLY::specialized_operation* MV
+      = MEDDLY::MATR_EXPLVECT_MULT->buildOperation(ind, rates->E, ind);
+    std::vector <double> ones(num_states, 1.0);
+    rowsums.assign(num_states, 0.0);
+    MV->compute(rowsums.data(), ones.data());
+    MEDDLY::destroyOperation(MV);
+
+    max_rowsum = 0;
+    for (long i=0; i<num_states; i++) {
+      if (rowsums[i] > max_rowsum) max_rowsum = rowsums[i];
+    }
+    return true;
+  }
+  catch (MEDDLY::error e) {
+    if (VM) MEDDLY::destroyOperation(VM);
+    VM = 0;
+    return meddlyFailed("numerical", e);
+  }
+}
+
+bool meddly_process::classify()
+{
+  DCASSERT(rates);
+  DCASSERT(mrss);
+  MEDDLY::forest* bf = 0;
+  meddly_encoder* bool_wrap = 0;
+  try {
+    //
+    // Graph of the chain: nonzero rates
+    //
+    bf = rates->getForest()->useDomain()->createForest(
+      true, MEDDLY::forest::BOOLEAN, MEDDLY::forest::MULTI_TERMINAL
+    );
+    bool_wrap = mxd_wrap->copyWithDifferentForest("graph", bf);
+    MEDDLY::dd_edge graph(bf);
+    MEDDLY::apply(MEDDLY::COPY, rates->E, graph);
+
+    //
+    // Bottom SCCs, by forward and backward reachability:
+    // if everything reachable from s can reach s, then
+    // the states reachable from s form a recurrent class;
+    // either way, the states that reach s are done.
+    //
+    MEDDLY::forest* mf = mrss->getMddForest();
+    MEDDLY::dd_edge empty(mf);
+    MEDDLY::dd_edge remaining(mf), candidates(mf), s(mf);
+    MEDDLY::dd_edge fwd(mf), back(mf), escape(mf);
+    std::vector <MEDDLY::dd_edge> bottom;
+    remaining = mrss->getStates();
+    candidates = remaining;
+    num_classes = 0;
+    while (remaining != empty) {
+      MEDDLY::apply(MEDDLY::SELECT, candidates, s);
+      MEDDLY::apply(MEDDLY::REACHABLE_STATES_DFS, s, graph, fwd);
+      MEDDLY::apply(MEDDLY::REVERSE_REACHABLE_DFS, s, graph, back);
+      MEDDLY::apply(MEDDLY::DIFFERENCE, fwd, back, escape);
+      if (escape == empty) {
+        bottom.push_back(fwd);
+      }
+      MEDDLY::apply(MEDDLY::DIFFERENCE, remaining, back, remaining);
+      // Move downstream, towards a bottom SCC, if we can
+      MEDDLY::apply(MEDDLY::INTERSECTION, escape, remaining, candidates);
+      if (candidates == empty) candidates = remaining;
+    }
+    num_classes = bottom.size();
+
+    //
+    // Irreducible chains need nothing else
+    //
+    bool irreducible = (1==num_classes) && (bottom[0] == mrss->getStates());
+    if (!irreducible) {
+      state_class.assign(num_states, 0);
+      MEDDLY::enumerator I(MEDDLY::enumerator::FULL, mf);
+      for (long c=0; c<num_classes; c++) {
+        for (I.start(bottom[c]); I; ++I) {
+          long i = mrss->getMintermIndex(I.getAssignments());
+          CHECK_RANGE(0, i, num_states);
+          state_class[i] = c+1;
+        }
+      }
+    }
+  }
+  catch (MEDDLY::error e) {
+    Delete(bool_wrap);
+    return meddlyFailed("state classification", e);
+  }
+  Delete(bool_wrap);
+  return true;
+}
+
+void meddly_process::multiply(const double* x, double* y) const
+{
+  DCASSERT(VM);
+  memset(y, 0, num_states * sizeof(double));
+  VM->compute(y, x);
+}
+
+void meddly_process::uniformStep(const double* x, double* y, double q) const
+{
+  multiply(x, y);
+  for (long i=0; i<num_states; i++) {
+    y[i] = x[i] + (y[i] - x[i] * rowsums[i]) / q;
+  }
+}
+
+double meddly_process::uniformRate() const
+{
+  return max_rowsum * UNIFORM_SLACK;
+}
+
+bool meddly_process::jacobiSteadyState(double* probs, double* old) const
+{
+  const LS_Options &opts = getSolverOptions();
+  const double omega = opts.use_relaxation ? opts.relaxation : 1.0;
+  timer w;
+  startSteadyReport(w);
+
+  for (long i=0; i<num_states; i++) probs[i] = 1.0 / num_states;
+
+  //
+  // probs[j] * rowsums[j] = (probs R)[j], which holds
+  // with self loops, since those appear on both sides.
+  //
+  long iters;
+  double maxerror = 0;
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    memcpy(old, probs, num_states * sizeof(double));
+    multiply(old, probs);
+    double total = 0;
+    for (long j=0; j<num_states; j++) {
+      DCASSERT(rowsums[j] > 0);
+      probs[j] /= rowsums[j];
+      if (omega != 1.0) probs[j] = omega * probs[j] + (1-omega) * old[j];
+      total += probs[j];
+    }
+    maxerror = 0;
+    for (long j=0; j<num_states; j++) {
+      probs[j] /= total;
+      double delta = probs[j] - old[j];
+      if (opts.use_relative && probs[j]) delta /= probs[j];
+      if (delta < 0) delta = -delta;
+      if (delta > maxerror) maxerror = delta;
+    }
+    if (iters >= opts.min_iters && maxerror < opts.precision) break;
+  }
+  stopSteadyReport(w, iters);
+  if (maxerror >= opts.precision && em->startWarning()) {
+    em->causedBy(0);
+    em->warn() << "Markov chain linear solver (for steady-state) did not converge";
+    em->stopIO();
+  }
+  return true;
+}
+
+bool meddly_process::powerSteadyState(double* probs, double* old) const
+{
+  const LS_Options &opts = getSolverOptions();
+  timer w;
+  startSteadyReport(w);
+
+  DCASSERT(initial);
+  initial->ExportTo(probs);
+
+  const double q = uniformRate();
+  if (0==q) {
+    // No transitions; every state is absorbing
+    stopSteadyReport(w, 0);
+    return true;
+  }
+
+  long iters;
+  double maxerror = 0;
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    memcpy(old, probs, num_states * sizeof(double));
+    uniformStep(old, probs, q);
+    maxerror = 0;
+    for (long j=0; j<num_states; j++) {
+      double delta = probs[j] - old[j];
+      if (opts.use_relative && probs[j]) delta /= probs[j];
+      if (delta < 0) delta = -delta;
+      if (delta > maxerror) maxerror = delta;
+    }
+    if (iters >= opts.min_iters && maxerror < opts.precision) break;
+  }
+  stopSteadyReport(w, iters);
+  if (maxerror >= opts.precision && em->startWarning()) {
+    em->causedBy(0);
+    em->warn() << "Markov chain power method (for steady-state) did not converge";
+    em->stopIO();
+  }
+  return true;
+}
+
+bool meddly_process::meddlyFailed(const char* who, const MEDDLY::error &e) const
+{
+  if (em->startError()) {
+    em->causedBy(0);
+    em->cerr() << "Meddly error during Markov chain " << who;
+    em->cerr() << " solution: " << e.getName();
+    em->stopIO();
+  }
+  return false;
 }
 
@@ -5,12 +5,36 @@
 #include "proc_markov.h"
 #include "../Modules/glue_meddly.h"
 
+#include <vector>
+
+class meddly_reachset;
+class dsde_hlm;
+class statedist;
+
+namespace MEDDLY {
+  class specialized_operation;
+};
+
 // ******************************************************************
 // *                                                                *
 // *                      meddly_process class                      *
 // *                                                                *
 // ******************************************************************
 
+/**
+    Markov chain stored as a decision diagram.
+
+    Numerical solution is hybrid: the rate matrix stays symbolic,
+    while probability vectors are explicit arrays indexed
+    by the lexical order of the reachable states (see
+    meddly_reachset::buildIndexSet()).  Vector-matrix products
+    are done directly on the decision diagram.
+
+    Steady-state uses Jacobi for irreducible chains, and the power
+    method on the uniformized chain (starting from the initial
+    distribution) otherwise.  Transient and accumulated
+    measures use uniformization.
+*/
 class meddly_process : public markov_process {
 
   public:
@@ -48,11 +72,68 @@ class meddly_process : public markov_process {
     virtual bool isTransient(long st) const;
     virtual statedist* getInitialDistribution() const;
 
+  //
+  // Numerical solution
+  //
+  public:
+    virtual bool computeTransient(double t, double* probs,
+          double* aux, double* aux2) const;
+    virtual bool computeAccumulated(double t, const double* p0, double* n,
+          double* aux, double* aux2) const;
+    virtual bool computeSteadyState(double* probs) const;
+
+  private:
+    /// Set up the vector-matrix multiply and the row sums.
+    bool prepareNumerical();
+    /// Determine the recurrent classes.
+    bool classify();
+    /// Build the initial distribution from the initial states.
+    void buildInitial(stochastic_lldsm* p);
+    /** Add the model's initial state weights to init, normalized.
+        Returns false if the weights cannot be used.
+    */
+    bool weighInitial(const dsde_hlm &dsm, double* init) const;
+
+    /// Compute y = x R, where R is the rate matrix.
+    void multiply(const double* x, double* y) const;
+    /** Compute y = x P, where P = I + (R - diag(rowsums)) / q
+        is the uniformized chain.
+    */
+    void uniformStep(const double* x, double* y, double q) const;
+    /// Uniformization constant, large enough to make P aperiodic.
+    double uniformRate() const;
+
+    bool jacobiSteadyState(double* probs, double* old) const;
+    bool powerSteadyState(double* probs, double* old) const;
+    bool meddlyFailed(const char* who, const MEDDLY::error &e) const;
+
   private:
     meddly_encoder* mxd_wrap;
     shared_ddedge* proc;
+    meddly_reachset* mrss;
 
     long num_states;
+
+    /// Rate matrix, as a multi-terminal MxD (shares proc when possible).
+    shared_ddedge* rates;
+    /// Owns the forest for rates, if different from the one for proc.
+    meddly_encoder* rates_wrap;
+    /// For y += x R, with states indexed by the reachable state index set.
+    MEDDLY::specialized_operation* VM;
+    /// Total outgoing rate of each state (including self loops).
+    std::vector <double> rowsums;
+    double max_rowsum;
+
+    /// Initial distribution.
+    statedist* initial;
+
+    /// Number of recurrent classes.
+    long num_classes;
+    /** For each state, its recurrent class (1 to num_classes),
+        or 0 if the state is transient.
+        Empty if the chain is irreducible.
+    */
+    std::vector <long> state_class;
 };
 
 
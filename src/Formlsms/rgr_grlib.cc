@@ -201,7 +201,7 @@ void grlib_reachgraph
   } // for s
 
   const long* outrowptr = OutEdges.RowPointer();
-  const long* outcolindex = OutEdges.ColumnIndex();
+  const GraphLib::node_index* outcolindex = OutEdges.ColumnIndex();
 
   // Depth first search, starting from "src" states.
   while (stack_top) {
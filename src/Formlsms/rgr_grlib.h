@@ -34,6 +34,11 @@ class grlib_reachgraph : public ectl_reachgraph {
       return deadlocks.contains(st);
     }
 
+    // Edges by source state, for saving the graph
+    inline const GraphLib::static_graph& getOutEdges() const {
+      return OutEdges;
+    }
+
     virtual void countPaths(const stateset* src, const stateset* dest, result& count);
 
   protected:
@@ -13,6 +13,8 @@
 // *                                                                *
 // ******************************************************************
 
+MEDDLY::input* meddly_reachset::pending_checkpoint = 0;
+
 meddly_reachset::meddly_reachset()
 {
   vars = 0;
@@ -115,6 +117,29 @@ void meddly_reachset::setStates(shared_ddedge* S)
   }
 }
 
+void meddly_reachset::writeCheckpoint(MEDDLY::output &s) const
+{
+  DCASSERT(initial);
+  DCASSERT(states);
+  MEDDLY::dd_edge list[2];
+  list[0] = initial->E;
+  list[1] = states->E;
+  getMddForest()->writeEdgesBinary(s, list, 2);
+}
+
+shared_ddedge* meddly_reachset::readCheckpoint(MEDDLY::input &s) const
+{
+  DCASSERT(initial);
+  MEDDLY::dd_edge list[2];
+  getMddForest()->readEdgesBinary(s, list, 2);
+  if (list[0] != initial->E) {
+    throw MEDDLY::error(MEDDLY::error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  shared_ddedge* S = newMddEdge();
+  S->E = list[1];
+  return S;
+}
+
 stateset* meddly_reachset::attachWeight(const stateset* p) {
   const meddly_stateset* mp = dynamic_cast<const meddly_stateset*>(p);
   shared_ddedge* e = nullptr;
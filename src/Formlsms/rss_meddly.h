@@ -133,6 +133,38 @@ class meddly_reachset : public state_lldsm::reachset {
       DCASSERT(states);
       return states->E;
     }
+
+    /**
+        Write the initial and reachable states, in Meddly's
+        binary format, so they can be restored by a later run.
+          @throws   A MEDDLY::error, on failure.
+    */
+    void writeCheckpoint(MEDDLY::output &s) const;
+
+    /**
+        Read states written by writeCheckpoint().
+        The initial states must already be set,
+        and must match the ones in the checkpoint.
+          @return   The reachable states.
+          @throws   A MEDDLY::error, if the checkpoint
+                    does not match this reachset.
+    */
+    shared_ddedge* readCheckpoint(MEDDLY::input &s) const;
+
+    /**
+        Checkpoint waiting to be loaded, or null.
+        Set while the process of a model is restored;
+        generation engines that support it read the
+        reachable states from here instead of generating them,
+        and then clear it.
+    */
+    static inline MEDDLY::input* pendingCheckpoint() {
+      return pending_checkpoint;
+    }
+
+    static inline void setPendingCheckpoint(MEDDLY::input* s) {
+      pending_checkpoint = s;
+    }
   
     inline void setLevel_maxTokens(std::vector<long> level_to_max_tokens)
     {
@@ -197,6 +229,14 @@ class meddly_reachset : public state_lldsm::reachset {
       return index;
     }
 
+    //
+    // Get the index set itself, for numerical operations
+    //
+    inline const MEDDLY::dd_edge& getIndexSet() const {
+      DCASSERT(state_indexes);
+      return state_indexes->E;
+    }
+
     //
     // Remember the mxd wrapper for later (explicit only)
     //
@@ -263,6 +303,8 @@ class meddly_reachset : public state_lldsm::reachset {
     // Total kludge for 2-phase explicit generation
     // Remember the mxd wrapper for phase 2
     meddly_encoder* mxd_wrap;
+
+    static MEDDLY::input* pending_checkpoint;
 };
 
 #endif
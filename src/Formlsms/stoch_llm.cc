@@ -136,6 +136,25 @@ bool stochastic_lldsm::process::computeTransient(double t, double*, double*, dou
   return false;
 }
 
+bool stochastic_lldsm::process::computeTransients(const double* times,
+  int ntimes, const double* p0, double** dists, double* aux, double* aux2) const
+{
+  const long NS = getNumStates();
+  const double* prev = p0;
+  double prev_time = 0.0;
+  for (int i=0; i<ntimes; i++) {
+    if (0==dists[i]) return false;
+    for (long s=0; s<NS; s++) dists[i][s] = prev[s];
+    const double dt = times[i] - prev_time;
+    if (dt > 0) {
+      if (!computeTransient(dt, dists[i], aux, aux2)) return false;
+    }
+    prev = dists[i];
+    prev_time = times[i];
+  }
+  return true;
+}
+
 bool stochastic_lldsm::process::computeAccumulated(double t, const double*, double*, double*, double*) const
 {
   parent->bailOut(__FILE__, __LINE__, "Can't compute accumulated");
@@ -137,9 +137,30 @@ public:
 
               @return    true on success, false otherwise.
         */
-        virtual bool computeTransient(double t, double* probs, 
+        virtual bool computeTransient(double t, double* probs,
               double* aux, double* aux2) const;
- 
+
+        /** Compute the distributions at several times.
+            The default behavior here is to call computeTransient()
+            once per time, on the difference from the previous time;
+            derived classes may do better.
+              @param  times   Times, in increasing order.
+              @param  ntimes  Number of times.
+              @param  p0      An array of dimension getNumStates(), holding
+                              the probability for each state at time 0.
+              @param  dists   Array of ntimes vectors, each of dimension
+                              getNumStates().  On output, dists[i] holds
+                              the probability for each state at times[i].
+              @param  aux     Auxiliary vector, dimension getNumStates().
+              @param  aux2    Another auxiliary vector, dimension getNumStates(),
+                              required only for CTMCs.
+
+              @return    true on success, false otherwise.
+        */
+        virtual bool computeTransients(const double* times, int ntimes,
+              const double* p0, double** dists,
+              double* aux, double* aux2) const;
+
         /** Accumulate expected time spent in each state, until time t.
             This must be provided in derived classes, the
             default behavior here is to print an error message.
@@ -466,6 +487,13 @@ public:
     DCASSERT(PROC);
     return PROC->computeTransient(t, probs, aux, aux2);
   }
+
+  inline bool computeTransients(const double* times, int ntimes,
+              const double* p0, double** dists, double* aux, double* aux2) const
+  {
+    DCASSERT(PROC);
+    return PROC->computeTransients(times, ntimes, p0, dists, aux, aux2);
+  }
  
   inline bool computeAccumulated(double t, const double* p0, double* n,
               double* aux, double* aux2) const
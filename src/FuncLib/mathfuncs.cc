@@ -5,6 +5,7 @@
 #include "../ExprLib/startup.h"
 #include "../ExprLib/exprman.h"
 #include "../ExprLib/intervals.h"
+#include "../ExprLib/dd_front.h"
 #include "../SymTabs/symtabs.h"
 #include "../Streams/streams.h"
 
@@ -363,6 +364,43 @@ void sqrt_si::Compute(traverse_data &x, expr** pass, int np)
   x.answer->setNull();
 }
 
+// ******************************************************************
+// *                     min and max  front end                     *
+// ******************************************************************
+
+/// BuildDD traversal for min and max: combine the operands in order.
+static void BuildMinMaxDD(traverse_data &x, expr** pass, int np, bool is_max)
+{
+  DCASSERT(x.answer);
+  DCASSERT(x.ddlib);
+  DCASSERT(pass[0]);
+  shared_object* dd = 0;
+  pass[0]->Traverse(x);
+  if (x.answer->isNormal()) dd = Share(x.answer->getPtr());
+  for (int i=1; i<np; i++) {
+    if (0==dd) break;
+    DCASSERT(pass[i]);
+    shared_object* tmp = 0;
+    pass[i]->Traverse(x);
+    if (x.answer->isNormal()) tmp = Share(x.answer->getPtr());
+    if (tmp) {
+      try {
+        x.ddlib->buildMinMax(is_max, dd, tmp, dd);
+      }
+      catch (sv_encoder::error e) {
+        Delete(dd);
+        dd = 0;
+      }
+      Delete(tmp);
+    } else {
+      Delete(dd);
+      dd = 0;
+    }
+  } // for i
+  if (0==dd) x.answer->setNull();
+  else       x.answer->setPtr(dd);
+}
+
 // ******************************************************************
 // *                         max_si  methods                        *
 // ******************************************************************
@@ -380,6 +418,10 @@ max_si::max_si(const type* args) : simple_internal(args, "max", 1)
 
 int max_si::Traverse(traverse_data &x, expr** pass, int np)
 {
+  if (x.which == traverse_data::BuildDD) {
+    BuildMinMaxDD(x, pass, np, true);
+    return 0;
+  }
   if (x.which != traverse_data::FindRange)
         return simple_internal::Traverse(x, pass, np);
 
@@ -577,6 +619,10 @@ min_si::min_si(const type* args) : simple_internal(args, "min", 1)
 
 int min_si::Traverse(traverse_data &x, expr** pass, int np)
 {
+  if (x.which == traverse_data::BuildDD) {
+    BuildMinMaxDD(x, pass, np, false);
+    return 0;
+  }
   if (x.which != traverse_data::FindRange)
         return simple_internal::Traverse(x, pass, np);
 
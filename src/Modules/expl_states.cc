@@ -381,9 +381,12 @@ exp_state_lib::exp_state_lib() : library(false, false)
 class my_exp_state_lib : public exp_state_lib {
   static long max_stack_depth;
   unsigned storage;
-  static const unsigned HASHING  = 0;
-  static const unsigned RED_BLACK  = 1;
-  static const unsigned SPLAY  = 2;
+  // in name order, as required for the radio buttons
+  static const unsigned CONCURRENT_HASHING = 0;
+  static const unsigned DISK_HASHING = 1;
+  static const unsigned HASHING  = 2;
+  static const unsigned RED_BLACK  = 3;
+  static const unsigned SPLAY  = 4;
   // methods for substate dbs
   unsigned substate_style;
   static const unsigned SEPARATED = 0;
@@ -414,7 +417,7 @@ my_exp_state_lib::my_exp_state_lib(exprman* em) : exp_state_lib()
     option* ess = em->OptMan()->addRadioOption(
         "ExplicitStateStorage",
         "Data structure to use for explicitly storing states.",
-        3, storage
+        5, storage
     );
     ess->addRadioButton(
         "HASHING",
@@ -431,6 +434,16 @@ my_exp_state_lib::my_exp_state_lib(exprman* em) : exp_state_lib()
         "States are stored in a splay tree.",
         SPLAY
     );
+    ess->addRadioButton(
+        "CONCURRENT_HASHING",
+        "States are stored in a hash table that allows simultaneous insertions from several threads.",
+        CONCURRENT_HASHING
+    );
+    ess->addRadioButton(
+        "DISK_HASHING",
+        "States are stored in a memory-mapped temporary file (in directory $TMPDIR, or /tmp), with a hash table in memory.  Allows state spaces larger than main memory.",
+        DISK_HASHING
+    );
     storage = HASHING;    // Default.  Currently fastest.
 
 
@@ -480,6 +493,8 @@ const char* my_exp_state_lib::getDBMethod() const
   switch (storage) {
     case HASHING:     return "hash table";
     case RED_BLACK:   return "red-black tree";
+    case CONCURRENT_HASHING:  return "concurrent hash table";
+    case DISK_HASHING:        return "hash table with states on disk";
     default:          return "splay tree";
   }
   return "keep dumb compilers happy";
@@ -499,6 +514,16 @@ my_exp_state_lib::createStateDB(bool indexed, bool store_sizes) const
         store_sizes);
       break;
 
+    case CONCURRENT_HASHING:
+      sdb = StateLib::CreateStateDB(StateLib::SDBT_ConcurrentHash, indexed,
+        store_sizes);
+      break;
+
+    case DISK_HASHING:
+      sdb = StateLib::CreateStateDB(StateLib::SDBT_DiskHash, indexed,
+        store_sizes);
+      break;
+
     default:
       sdb = StateLib::CreateStateDB(StateLib::SDBT_Splay, indexed,
         store_sizes);
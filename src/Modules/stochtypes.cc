@@ -1964,8 +1964,8 @@ public:
   choose_rand(const type* argtype);
   virtual void Compute(traverse_data &x, expr** pass, int np);
 private:
-  static double* probarray;
-  static int probarray_size;
+  static thread_local double* probarray;
+  static thread_local int probarray_size;
 
   inline void expandArray(int np) {
     if (np <= probarray_size) return;
@@ -1981,8 +1981,8 @@ private:
   }
 };
 
-double* choose_rand::probarray = 0;
-int choose_rand::probarray_size = 0;
+thread_local double* choose_rand::probarray = 0;
+thread_local int choose_rand::probarray_size = 0;
 
 choose_rand::choose_rand(const type* argt) : choose_si(argt)
 {
@@ -157,7 +157,8 @@ long* build_inverse(long* A, long size)
   return B;
 }
 
-void show_array(const char* name, const long* A, long size)
+template <class INT>
+void show_array(const char* name, const INT* A, long size)
 {
   using namespace std;
   cout << name << ": [" << A[0];
@@ -173,6 +174,138 @@ void show_graph(const char* name, const static_graph &G)
   show_array("    column index", G.ColumnIndex(), G.getNumEdges());
 }
 
+/*
+    Locality orderings, on a shuffled grid with two classes
+    (top half and bottom half).  Returns false on failure.
+*/
+
+const char* order_name(locality_order ord)
+{
+  switch (ord) {
+    case BFS_Order:       return "BFS";
+    case RCM_Order:       return "RCM";
+    case Partition_Order: return "partition";
+  }
+  return "?";
+}
+
+// Max and average distance between ends of edges in the same class
+void edge_spread(const long* edges, long num_edges,
+  long half, const node_renumberer* r, long &max, double &avg)
+{
+  max = 0;
+  avg = 0;
+  long count = 0;
+  for (long e=0; e<num_edges; e++) {
+    long u = edges[2*e];
+    long v = edges[2*e+1];
+    if ((u < half) != (v < half)) continue;
+    if (r) {
+      u = r->new_number(u);
+      v = r->new_number(v);
+    }
+    long d = (u>v) ? u-v : v-u;
+    if (d > max) max = d;
+    avg += d;
+    count++;
+  }
+  if (count) avg /= count;
+}
+
+bool test_locality(long width)
+{
+  using namespace std;
+  const long N = width * width;
+  const long half = (width/2) * width;
+
+  cout << "Testing locality orderings on a shuffled ";
+  cout << width << "x" << width << " grid\n";
+
+  //
+  // Shuffle within each class
+  //
+  long* shuffle = build_shuffle(N);
+  long* top = build_shuffle(half);
+  long* bottom = build_shuffle(N-half);
+  for (long i=0; i<half; i++) shuffle[i] = top[i];
+  for (long i=half; i<N; i++) shuffle[i] = half + bottom[i-half];
+  delete[] top;
+  delete[] bottom;
+
+  dynamic_digraph G(true);
+  G.addNodes(N);
+  long* edges = new long[4*N];
+  long num_edges = 0;
+  for (long r=0; r<width; r++) {
+    for (long c=0; c<width; c++) {
+      const long g = r*width+c;
+      if (c+1 < width) {
+        edges[2*num_edges] = shuffle[g];
+        edges[2*num_edges+1] = shuffle[g+1];
+        num_edges++;
+      }
+      if (r+1 < width) {
+        edges[2*num_edges] = shuffle[g];
+        edges[2*num_edges+1] = shuffle[g+width];
+        num_edges++;
+      }
+    }
+  }
+  for (long e=0; e<num_edges; e++) G.addEdge(edges[2*e], edges[2*e+1]);
+  delete[] shuffle;
+
+  //
+  // Two contiguous classes
+  //
+  long* cl = new long[N];
+  for (long i=0; i<N; i++) cl[i] = (i<half) ? 0 : 1;
+  general_classifier gc(cl, N, 2);
+  static_classifier C;
+  node_renumberer* none = gc.buildRenumbererAndStatic(C);
+  delete none;
+
+  long smax;
+  double savg;
+  edge_spread(edges, num_edges, half, 0, smax, savg);
+  cout << "    shuffled: bandwidth " << smax << ", average " << savg << "\n";
+
+  const locality_order orders[] = { BFS_Order, RCM_Order, Partition_Order };
+  bool ok = true;
+  for (int k=0; k<3; k++) {
+    node_renumberer* r = G.localityRenumberer(C, orders[k]);
+
+    // Must be a permutation that keeps classes
+    bool* seen = new bool[N];
+    for (long i=0; i<N; i++) seen[i] = false;
+    for (long i=0; i<N; i++) {
+      const long j = r->new_number(i);
+      if (j<0 || j>=N || seen[j] || ((i<half) != (j<half))) {
+        cout << "    " << order_name(orders[k]) << ": bad renumbering\n";
+        ok = false;
+        break;
+      }
+      seen[j] = true;
+    }
+    delete[] seen;
+
+    long max;
+    double avg;
+    edge_spread(edges, num_edges, half, r, max, avg);
+    cout << "    " << order_name(orders[k]) << ": bandwidth " << max;
+    cout << ", average " << avg;
+    if (avg*4 < savg && (Partition_Order == orders[k] || max*4 < smax)) {
+      cout << " (OK)\n";
+    } else {
+      cout << " not improved!\n";
+      ok = false;
+    }
+    delete r;
+  }
+
+  delete[] edges;
+  return ok;
+}
+
 int main()
 {
   using namespace std;
@@ -259,7 +392,7 @@ int main()
       return 1;
     }
     if (memcmp(first.ColumnIndex(), second.ColumnIndex(), 
-               sizeof(long) * first.getNumEdges())) 
+               sizeof(node_index) * first.getNumEdges())) 
     {
       cout << "Column index array mismatch\n";
       show_graph("first graph", first);
@@ -270,6 +403,7 @@ int main()
     cout << ". . . . . . test passed\n";
   }
 
+  if (!test_locality(100)) return 1;
 
   return 0;
 }
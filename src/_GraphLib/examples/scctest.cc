@@ -4,7 +4,9 @@
 */
 
 #include <iostream>
+#include <stdlib.h>
 #include "graphlib.h"
+#include "timerlib.h"
 
 // #define VERBOSE
 
@@ -185,14 +187,106 @@ bool testGraph(const char* name, long nodes, const edge E[], long nonterm,
       break;
     }
   }
+  delete SCCs;
+
+  //
+  // Multi-threaded algorithm must give the same answer
+  //
+  for (int threads=1; pass && threads<=4; threads*=2) {
+    SCCs = G->determineSCCs(nonterm, sink, true, 0, threads);
+    for (long i=0; i<nodes; i++) {
+      if (answer[i] != SCCs->classOfNode(i)) {
+        cerr << "SCC mismatch in " << name << " with " << threads << " threads\n";
+        pass = false;
+        break;
+      }
+    }
+    delete SCCs;
+  }
+  if (pass) {
+    static_graph S;
+    G->exportToStatic(S, 0);
+    SCCs = S.determineSCCs(nonterm, sink, 2, 0);
+    for (long i=0; i<nodes; i++) {
+      if (answer[i] != SCCs->classOfNode(i)) {
+        cerr << "SCC mismatch in " << name << " for static graph\n";
+        pass = false;
+        break;
+      }
+    }
+    delete SCCs;
+  }
 
   delete G;
-  delete SCCs;
   return pass;
 }
 
-int main()
+/*
+  Benchmark: sequential vs. multi-threaded SCCs on a random graph.
+  The first half of the nodes is (very likely) one big SCC;
+  the second half is mostly forward edges with a few short
+  backward edges, giving many small SCCs.
+*/
+bool benchGraph(long nodes, long degree)
 {
+  cout << "Benchmark: " << nodes << " nodes, about ";
+  cout << nodes*degree << " edges\n";
+
+  dynamic_digraph* G = new dynamic_digraph(true);
+  G->addNodes(nodes);
+  unsigned long seed = 12345;
+  const long half = nodes/2;
+  for (long i=0; i<nodes; i++) {
+    for (long d=0; d<degree; d++) {
+      seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+      const long r = (seed >> 33);
+      long j;
+      if (i < half) {
+        j = r % half;
+      } else if (d) {
+        j = i + 1 + r % 16;
+      } else {
+        j = i - r % 4;
+      }
+      if (j >= nodes) j = i;
+      G->addEdge(i, j);
+    }
+  }
+
+  timer watch;
+  abstract_classifier* seq = G->determineSCCs(0, 1, true, 0);
+  cout << "    sequential: " << watch.elapsed_seconds() << " seconds\n";
+
+  bool pass = true;
+  for (int threads=1; threads<=8; threads*=2) {
+    watch.reset();
+    abstract_classifier* par = G->determineSCCs(0, 1, true, 0, threads);
+    cout << "    " << threads << " thread(s): ";
+    cout << watch.elapsed_seconds() << " seconds\n";
+    for (long i=0; i<nodes; i++) {
+      if (seq->classOfNode(i) != par->classOfNode(i)) {
+        cerr << "SCC mismatch in benchmark with " << threads << " threads\n";
+        pass = false;
+        break;
+      }
+    }
+    delete par;
+    if (!pass) break;
+  }
+
+  delete seq;
+  delete G;
+  return pass;
+}
+
+int main(int argc, const char** argv)
+{
+  //
+  // Optional argument: number of nodes for the benchmark
+  //
+  long bench_nodes = 200000;
+  if (argc > 1) bench_nodes = atol(argv[1]);
+
   if (!testGraph("graph1 test1", nodes1, graph1, -1, -1, scc1_nn)) return 1;
   if (!testGraph("graph1 test2", nodes1, graph1, -1, 7, scc1_n7)) return 1;
   if (!testGraph("graph1 test3", nodes1, graph1, 3, -1, scc1_nn)) return 1;
@@ -220,5 +314,7 @@ int main()
   if (!testGraph("graph4 test3", nodes4, graph4, 1, -1, scc4_1n)) return 1;
   if (!testGraph("graph4 test4", nodes4, graph4, 3, 5, scc4_35)) return 1;
 
+  if (bench_nodes > 0 && !benchGraph(bench_nodes, 5)) return 1;
+
   return 0;
 }
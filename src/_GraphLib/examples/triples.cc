@@ -33,7 +33,8 @@ inline int equilikely(rng_stream *rngs, int a, int b)
   return int(a+ rngs->Uniform32() * (b-a+1));
 }
 
-void show_array(const char* name, const long* A, long n)
+template <class INT>
+void show_array(const char* name, const INT* A, long n)
 {
   printf("%s: ", name);
   if (0==A) {
@@ -42,9 +43,9 @@ void show_array(const char* name, const long* A, long n)
   }
   printf("[");
   if (n>0) {
-    printf("%ld", A[0]);
+    printf("%ld", long(A[0]));
     for (long i=1; i<n; i++) {
-      printf(", %ld", A[i]);
+      printf(", %ld", long(A[i]));
     }
   }
   printf("]\n");
@@ -71,7 +72,7 @@ bool match(const GraphLib::static_graph &A, const GraphLib::static_graph &B)
   if (memcmp(A.RowPointer(), B.RowPointer(), 
     (A.getNumNodes()+1) * sizeof(long))) return false;
   if (memcmp(A.ColumnIndex(), B.ColumnIndex(), 
-    A.getNumEdges() * sizeof(long))) return false;
+    A.getNumEdges() * sizeof(node_index))) return false;
   if (memcmp(A.Labels(), B.Labels(), 
     A.getNumEdges() * A.EdgeBytes())) return false;
 
@@ -5,6 +5,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include "sccs.h"
 
 // External libraries
@@ -12,7 +16,7 @@
 #include "intset.h"
 
 const int MAJOR_VERSION = 3;
-const int MINOR_VERSION = 0;
+const int MINOR_VERSION = 1;
 
 // #define DEBUG_DEFRAG
 // #define DEBUG_TRANSPOSE_FROM
@@ -23,14 +27,15 @@ const int MINOR_VERSION = 0;
 // *                                                                *
 // ******************************************************************
 
-inline void ShowArray(const char* name, const long* ptr, long N)
+template <class INT>
+inline void ShowArray(const char* name, const INT* ptr, long N)
 {
   if (0==ptr) {
     printf("%s: null\n", name);
     return;
   }
-  printf("%s: [%ld", name, ptr[0]);
-  for (long i=1; i<N; i++) printf(", %ld", ptr[i]);
+  printf("%s: [%ld", name, long(ptr[0]));
+  for (long i=1; i<N; i++) printf(", %ld", long(ptr[i]));
   printf("]\n");
 }
 
@@ -508,13 +513,22 @@ size_t GraphLib::static_graph::getMemTotal() const
 {
   long mem = 0;
   if (row_pointer)  mem += (num_nodes+1) * sizeof(long);
-  if (column_index) mem += num_edges * sizeof(long);
+  if (column_index) mem += num_edges * sizeof(node_index);
   if (label)        mem += num_edges * edge_bytes;
   return mem;
 }
 
 // ******************************************************************
 
+void GraphLib::static_graph::replaceLabels(unsigned char bytes, void* newlabels)
+{
+  free(label);
+  label = (unsigned char*) newlabels;
+  edge_bytes = bytes;
+}
+
+// ******************************************************************
+
 void GraphLib::static_graph::allocate(long nodes, long edges)
 {
   // row pointers
@@ -527,11 +541,11 @@ void GraphLib::static_graph::allocate(long nodes, long edges)
   num_nodes = nodes;
 
   // column indexes
-  long* nci = 0;
+  node_index* nci = 0;
   if (0==edges) {
     free(column_index);
   } else {
-    nci = (long*) realloc(column_index, edges * sizeof(long)); 
+    nci = (node_index*) realloc(column_index, edges * sizeof(node_index)); 
     if (0==nci) {
       throw error(error::Out_Of_Memory);
     }
@@ -594,6 +608,10 @@ GraphLib::dynamic_graph::addNodes(long count)
   const int MAX_NODE_ADD = 1024;
 
   long final_nodes = num_nodes+count;
+  if (final_nodes > std::numeric_limits<node_index>::max()) {
+    // Can't store the new nodes as edge targets
+    throw GraphLib::error(GraphLib::error::Out_Of_Memory);
+  }
   if (final_nodes > nodes_alloc) {
     long newnodes = nodes_alloc+1;
     while (newnodes <= final_nodes) {
@@ -628,7 +646,7 @@ GraphLib::dynamic_graph::addEdge(long from, long to, const void* wt)
   if (num_edges >= edges_alloc) {
     long newedges = MIN(2*edges_alloc, edges_alloc + MAX_EDGE_ADD);
     newedges = MAX(newedges, 16L);
-    long* nci = (long *) realloc(column_index, newedges*sizeof(long));
+    node_index* nci = (node_index *) realloc(column_index, newedges*sizeof(node_index));
     long* nn = (long *) realloc(next, newedges*sizeof(long));
     void* nl = 0;
     if (edge_size) {
@@ -791,6 +809,248 @@ GraphLib::dynamic_graph::renumberNodes(const node_renumberer &r)
 
 
 
+// ******************************************************************
+
+/*
+  Helpers for dynamic_graph::localityRenumberer().
+  The graph is kept as undirected adjacency lists, in compressed
+  format, with only the edges between nodes of the same class.
+*/
+namespace GraphLib {
+
+  /// Nodes per part, for partition ordering; about a cache worth of doubles.
+  const long LOCALITY_PART_SIZE = 4096;
+
+  struct locality_graph {
+    long num_nodes;
+    long* adj_pointer;
+    long* adj;
+
+    locality_graph() { adj_pointer = 0; adj = 0; }
+    ~locality_graph() { delete[] adj_pointer; delete[] adj; }
+
+    inline long degree(long v) const {
+      return adj_pointer[v+1] - adj_pointer[v];
+    }
+
+    /**
+        Breadth-first search from root, over unmarked nodes
+        with where[v] == seg, appending to order[pos].
+        Visited nodes get mark[v] = pass.
+          @param  sort  If true, visit neighbors by increasing
+                        degree (Cuthill-McKee).
+          @param  last  On output, where the last level
+                        visited starts in order[].
+          @param  depth On output, the number of levels.
+          @return The new pos.
+    */
+    long BFS(long root, long seg, const long* where, long* mark, long pass,
+      long* order, long pos, bool sort, long &last, long &depth) const
+    {
+      long head = pos;
+      order[pos++] = root;
+      mark[root] = pass;
+      last = head;
+      depth = 1;
+      long level_end = pos;
+      while (head < pos) {
+        if (head == level_end) {
+          last = head;
+          level_end = pos;
+          depth++;
+        }
+        const long v = order[head++];
+        const long first = pos;
+        for (long e=adj_pointer[v]; e<adj_pointer[v+1]; e++) {
+          const long w = adj[e];
+          if (mark[w] == pass) continue;
+          if (where && where[w] != seg) continue;
+          mark[w] = pass;
+          order[pos++] = w;
+        }
+        if (sort) {
+          std::sort(order+first, order+pos, by_degree(this));
+        }
+      }
+      return pos;
+    }
+
+    struct by_degree {
+      const locality_graph* G;
+      by_degree(const locality_graph* g) { G = g; }
+      inline bool operator()(long a, long b) const {
+        const long da = G->degree(a);
+        const long db = G->degree(b);
+        if (da != db) return da < db;
+        return a < b;
+      }
+    };
+  };
+
+};
+
+// ******************************************************************
+
+GraphLib::node_renumberer*
+GraphLib::dynamic_graph::localityRenumberer(const static_classifier &C,
+  locality_order ord) const
+{
+  const long N = num_nodes;
+  long* newnumber = new long[N ? N : 1];
+
+  //
+  // Build undirected adjacency lists within classes
+  //
+  long* cls = new long[N ? N : 1];
+  for (long c=0; c<C.getNumClasses(); c++) {
+    for (long s=C.firstNodeOfClass(c); s<=C.lastNodeOfClass(c); s++) {
+      cls[s] = c;
+    }
+  }
+  locality_graph L;
+  L.num_nodes = N;
+  L.adj_pointer = new long[N+1];
+  for (long s=0; s<=N; s++) L.adj_pointer[s] = 0;
+  for (long s=0; s<N; s++) {
+    long edge = row_pointer[s];
+    if (edge<0) continue;
+    do {
+      const long t = column_index[edge];
+      if (t != s && cls[t] == cls[s]) {
+        L.adj_pointer[s+1]++;
+        L.adj_pointer[t+1]++;
+      }
+      edge = next[edge];
+    } while (edge != row_pointer[s]);
+  }
+  for (long s=0; s<N; s++) L.adj_pointer[s+1] += L.adj_pointer[s];
+  L.adj = new long[L.adj_pointer[N] ? L.adj_pointer[N] : 1];
+  // Use newnumber as the fill pointers
+  for (long s=0; s<N; s++) newnumber[s] = L.adj_pointer[s];
+  for (long s=0; s<N; s++) {
+    long edge = row_pointer[s];
+    if (edge<0) continue;
+    do {
+      const long t = column_index[edge];
+      if (t != s && cls[t] == cls[s]) {
+        L.adj[newnumber[s]++] = t;
+        L.adj[newnumber[t]++] = s;
+      }
+      edge = next[edge];
+    } while (edge != row_pointer[s]);
+  }
+
+  //
+  // Determine the new order of nodes; order[k] is the node
+  // that will be numbered k.  Array cls becomes the marks.
+  //
+  long* order = new long[N ? N : 1];
+  long* mark = cls;
+  for (long s=0; s<N; s++) mark[s] = -1;
+  long pass = 0;
+  long last, depth;
+
+  for (long c=0; c<C.getNumClasses(); c++) {
+    const long lo = C.firstNodeOfClass(c);
+    const long hi = C.lastNodeOfClass(c)+1;
+    if (hi - lo < 2) {
+      for (long s=lo; s<hi; s++) order[s] = s;
+      continue;
+    }
+
+    switch (ord) {
+      case BFS_Order: {
+        long pos = lo;
+        for (long r=lo; r<hi; r++) {
+          if (mark[r] >= 0) continue;
+          pos = L.BFS(r, 0, 0, mark, 0, order, pos, false, last, depth);
+        }
+        break;
+      }
+
+      case RCM_Order: {
+        long pos = lo;
+        for (long r=lo; r<hi; r++) {
+          if (mark[r] >= 0) continue;
+          //
+          // Find a pseudo-peripheral node in r's component:
+          // restart from a node of smallest degree in the
+          // last level, while the number of levels increases.
+          // Components are disjoint, so each pass only
+          // touches nodes of this component.
+          //
+          long root = r;
+          long levels = 0;
+          for (int i=0; i<5; i++) {
+            pass++;
+            long d;
+            const long end = L.BFS(root, 0, 0, mark, pass, order, pos,
+                                   false, last, d);
+            if (d <= levels) break;
+            levels = d;
+            long best = order[last];
+            for (long k=last+1; k<end; k++) {
+              if (L.degree(order[k]) < L.degree(best)) best = order[k];
+            }
+            root = best;
+          }
+          pass++;
+          pos = L.BFS(root, 0, 0, mark, pass, order, pos, true, last, depth);
+        }
+        // Reverse Cuthill-McKee
+        std::reverse(order+lo, order+hi);
+        break;
+      }
+
+      case Partition_Order: {
+        //
+        // Recursive bisection: order the segment breadth-first,
+        // then split it in half, until parts are small enough.
+        // Array where gives the segment of each node.
+        //
+        long* where = newnumber;
+        long* tmp = new long[hi-lo];
+        for (long s=lo; s<hi; s++) {
+          where[s] = lo;
+          order[s] = s;
+        }
+        std::vector <long> segs;
+        segs.push_back(lo);
+        segs.push_back(hi);
+        while (!segs.empty()) {
+          const long b = segs.back();
+          segs.pop_back();
+          const long a = segs.back();
+          segs.pop_back();
+          pass++;
+          long pos = 0;
+          for (long k=a; k<b; k++) {
+            const long r = order[k];
+            if (mark[r] == pass) continue;
+            pos = L.BFS(r, a, where, mark, pass, tmp, pos, false, last, depth);
+          }
+          memcpy(order+a, tmp, (b-a)*sizeof(long));
+          if (b-a <= LOCALITY_PART_SIZE) continue;
+          const long m = a + (b-a)/2;
+          for (long k=m; k<b; k++) where[order[k]] = m;
+          segs.push_back(m);
+          segs.push_back(b);
+          segs.push_back(a);
+          segs.push_back(m);
+        }
+        delete[] tmp;
+        break;
+      }
+    } // switch
+  } // for c
+
+  for (long k=0; k<N; k++) newnumber[order[k]] = k;
+
+  delete[] order;
+  delete[] cls;
+  return new array_renumberer(newnumber, N);
+}
+
 // ******************************************************************
 
 void GraphLib::dynamic_graph::transpose(timer_hook* sw)
@@ -852,7 +1112,7 @@ GraphLib::dynamic_graph::exportToStatic(static_graph &g, timer_hook *sw)
   // Copy everything over
   g.is_by_rows = is_by_rows;
   memcpy(g.row_pointer, row_pointer, (1+num_nodes) * sizeof(long));
-  memcpy(g.column_index, column_index, num_edges * sizeof(long));
+  memcpy(g.column_index, column_index, num_edges * sizeof(node_index));
   if (edge_size) {
     memcpy(g.label, label, num_edges * edge_size);
   }
@@ -880,7 +1140,7 @@ GraphLib::dynamic_graph::exportAndDestroy(static_graph &g, timer_hook *sw)
     row_pointer = (long*) realloc(row_pointer, (1+num_nodes)*sizeof(long));
   } 
   if (edges_alloc > num_edges) {
-    column_index = (long*) realloc(column_index, num_edges*sizeof(long));
+    column_index = (node_index*) realloc(column_index, num_edges*sizeof(node_index));
     label = (unsigned char*) realloc(label, num_edges*edge_size);
   } 
   // Transfer things over
@@ -1006,7 +1266,7 @@ GraphLib::dynamic_graph::getMemTotal() const
 {
   long mem = 0;
   if (row_pointer)  mem += (nodes_alloc+1) * sizeof(long);
-  if (column_index) mem += edges_alloc * sizeof(long);
+  if (column_index) mem += edges_alloc * sizeof(node_index);
   if (next)         mem += edges_alloc * sizeof(long);
   if (label)        mem += edges_alloc * edge_size;
   return mem;
@@ -55,6 +55,24 @@ namespace GraphLib {
   };
 
 
+  // ======================================================================
+  // |                                                                    |
+  // |                          Edge index type                           |
+  // |                                                                    |
+  // ======================================================================
+
+  /**
+    Type used to store the node at the far end of each edge.
+    Edge arrays dominate graph storage, and 32 bits are enough for
+    any graph with fewer than 2^31 nodes.  Define
+    GRAPHLIB_LONG_NODE_INDEX to store full longs instead.
+  */
+#ifdef GRAPHLIB_LONG_NODE_INDEX
+  typedef long node_index;
+#else
+  typedef int node_index;
+#endif
+
   // ======================================================================
   // |                                                                    |
   // |                          timer_hook class                          |
@@ -182,6 +200,20 @@ namespace GraphLib {
       virtual bool changes_something() const = 0;
   };
 
+  /**
+      Node orderings for better memory locality,
+      see dynamic_graph::localityRenumberer().
+  */
+  enum locality_order {
+    /// Breadth-first levels, from the lowest numbered node.
+    BFS_Order,
+    /// Reverse Cuthill-McKee; reduces the bandwidth.
+    RCM_Order,
+    /// Recursive bisection of breadth-first orders, into parts
+    /// of a few thousand nodes.
+    Partition_Order
+  };
+
   // ======================================================================
   // |                                                                    |
   // |                     nochange_renumberer  class                     |
@@ -502,11 +534,28 @@ namespace GraphLib {
       /// Total memory required for graph storage, in bytes.
       size_t getMemTotal() const;
 
+      /** Replace the edge labels.
+            @param  bytes       Bytes per edge label.
+            @param  newlabels   New labels, in the same order
+                                as the edges; allocated with malloc().
+                                The graph takes ownership.
+      */
+      void replaceLabels(unsigned char bytes, void* newlabels);
+
+      /** Compute the terminal sccs, using the multi-threaded
+          algorithm; requires the graph to be stored "by rows".
+          Parameters and result are the same as for
+          dynamic_graph::determineSCCs().
+          Implementation is in sccs.cc
+      */
+      abstract_classifier* determineSCCs(long nonterminal, long sinks,
+        int threads, timer_hook* sw) const;
+
     public:
       // Read-only access to internal storage
 
       inline const long* RowPointer() const { return row_pointer; }
-      inline const long* ColumnIndex() const { return column_index; }
+      inline const node_index* ColumnIndex() const { return column_index; }
       inline const void* Labels() const { return label; } 
       inline unsigned char EdgeBytes() const { return edge_bytes; }
 
@@ -531,7 +580,7 @@ namespace GraphLib {
       long* row_pointer;
 
       /// Column index of each edge.  Dimension #edges.
-      long* column_index;
+      node_index* column_index;
 
       /// Label of each edge.  Size is #edges * (bytes per edgeval)
       unsigned char* label;
@@ -617,6 +666,20 @@ namespace GraphLib {
       void renumberNodes(const node_renumberer &r);
 
 
+      /**
+          Build a renumbering of the nodes for better memory locality,
+          when the graph is used as a matrix.  Nodes only move within
+          their class, so classes stay contiguous.  Edge direction
+          is ignored, and so are edges between classes.
+          Implementation is in graphlib.cc
+            @param  C     Classes of nodes; must be contiguous.
+            @param  ord   Ordering to use.
+            @return       A new renumberer, to be deleted by the caller.
+      */
+      node_renumberer* localityRenumberer(const static_classifier &C,
+        locality_order ord) const;
+
+
       /** Reverse direction of all edges.
           Or, equivalently, flip storage between
           "store by outgoing edges" and "store by incoming edges".
@@ -647,6 +710,11 @@ namespace GraphLib {
 
             @param  sw            Where to report timing information 
                                   (nowhere if 0).
+
+            @param  threads       If positive, use the multi-threaded
+                                  algorithm (see sccs.h) with this many
+                                  threads, and ignore cons.
+                                  The result is the same.
   
 
             @return   A classification for each node.  SCCs will be 
@@ -662,7 +730,7 @@ namespace GraphLib {
                       and 36..49 will be empty.)
       */
       abstract_classifier* determineSCCs(long nonterminal, long sinks, 
-        bool cons, timer_hook* sw) const;
+        bool cons, timer_hook* sw, int threads=0) const;
   
 
       /**
@@ -803,7 +871,7 @@ namespace GraphLib {
 
     private:
       long* row_pointer;
-      long* column_index;
+      node_index* column_index;
       long* next;
       unsigned char* label;
       long nodes_alloc;
@@ -3,6 +3,9 @@
 #include "graphlib.h"
 
 #include <stdlib.h>
+#include <thread>
+#include <vector>
+#include <new>
 
 // #define DEBUG_SCCS
 
@@ -18,13 +21,50 @@
 
 GraphLib::abstract_classifier*
 GraphLib::dynamic_graph::determineSCCs(long nonterminal, long sinks, 
-  bool cons, timer_hook* sw) const
+  bool cons, timer_hook* sw, int threads) const
 {
   //
   // Sanity checks
   //
 
   if (getNumNodes() < 1) return 0;
+  if (!isByRows()) throw error(error::Format_Mismatch);
+
+  if (threads > 0) {
+    //
+    // Copy the edges into compressed row format,
+    // for the multi-threaded algorithm.
+    //
+    long* rowptr = new long[getNumNodes()+1];
+    long edges = 0;
+    for (long i=0; i<getNumNodes(); i++) {
+      rowptr[i] = edges;
+      long edge = row_pointer[i];
+      if (edge<0) continue;
+      do {
+        edges++;
+        edge = next[edge];
+      } while (edge != row_pointer[i]);
+    }
+    rowptr[getNumNodes()] = edges;
+    node_index* colidx = new node_index[edges ? edges : 1];
+    for (long i=0; i<getNumNodes(); i++) {
+      long e = rowptr[i];
+      long edge = row_pointer[i];
+      if (edge<0) continue;
+      do {
+        colidx[e++] = column_index[edge];
+        edge = next[edge];
+      } while (edge != row_pointer[i]);
+    }
+
+    abstract_classifier* ac = parallelSCCs(getNumNodes(), rowptr, colidx,
+      nonterminal, sinks, threads, sw);
+
+    delete[] rowptr;
+    delete[] colidx;
+    return ac;
+  }
 
   //
   // Build scc map and auxiliary memory
@@ -221,6 +261,118 @@ GraphLib::dynamic_graph::determineSCCs(long nonterminal, long sinks,
 }
 
 
+// ******************************************************************
+
+GraphLib::abstract_classifier*
+GraphLib::static_graph::determineSCCs(long nonterminal, long sinks,
+  int threads, timer_hook* sw) const
+{
+  if (getNumNodes() < 1) return 0;
+  if (!isByRows()) throw error(error::Format_Mismatch);
+
+  return parallelSCCs(getNumNodes(), row_pointer, column_index,
+    nonterminal, sinks, threads, sw);
+}
+
+// ******************************************************************
+
+/*
+  Multi-threaded SCCs, then the same classification and numbering
+  of SCCs as dynamic_graph::determineSCCs(), for a graph
+  in compressed row format.
+*/
+GraphLib::abstract_classifier*
+GraphLib::parallelSCCs(long num_nodes, const long* rowptr, const node_index* colidx,
+  long nonterminal, long sinks, int threads, timer_hook* sw)
+{
+  if (threads < 1) threads = 1;
+
+  long* sccmap = new long[num_nodes];
+  long* aux = new long[num_nodes];
+
+  //
+  // Determine "raw" SCCs; each node gets
+  // the index of a representative node in its SCC.
+  //
+  {
+    parallel_scc foo(num_nodes, rowptr, colidx, threads);
+    foo.Run(sccmap, sw);
+  }
+
+  const long TSCC = -1;
+  for (long i=0; i<num_nodes; i++) aux[i] = TSCC;
+
+  //
+  // Mark SCCs that can reach other SCCs as nonterminal
+  //
+  if (nonterminal>=0) {
+    if (sw) sw->start("Finding terminal SCCs");
+    for (long i=0; i<num_nodes; i++) {
+      const long c = sccmap[i];
+      if (nonterminal == aux[c]) continue;
+      for (long e=rowptr[i]; e<rowptr[i+1]; e++) {
+        if (sccmap[colidx[e]] != c) {
+          aux[c] = nonterminal;
+          break;
+        }
+      }
+    } // for i
+    if (sw) sw->stop();
+  }
+
+  //
+  // Mark absorbing states as sinks
+  //
+  if (sinks>=0) {
+    if (sw) sw->start("Finding sink nodes");
+    for (long i=0; i<num_nodes; i++) {
+      bool absorbing = true;
+      for (long e=rowptr[i]; e<rowptr[i+1]; e++) {
+        if (colidx[e] != i) {
+          absorbing = false;
+          break;
+        }
+      }
+      if (absorbing) aux[sccmap[i]] = sinks;
+    } // for i
+    if (sw) sw->stop();
+  }
+
+  //
+  // Compact the numbering, exactly as for dynamic graphs
+  //
+  if (sw) sw->start("Renumbering SCCs");
+
+  long termcount = 0;
+  if (nonterminal == termcount) termcount++;
+  if (sinks == termcount) termcount++;
+  if (nonterminal == termcount) termcount++;
+
+  for (long i=0; i<num_nodes; i++) {
+    const long c = sccmap[i];
+    if (aux[c] != TSCC) {
+      sccmap[i] = aux[c];
+      continue;
+    }
+    aux[c] = termcount;
+    sccmap[i] = aux[c];
+
+    termcount++;
+    if (nonterminal == termcount) termcount++;
+    if (sinks == termcount) termcount++;
+    if (nonterminal == termcount) termcount++;
+  } // for i
+
+  long num_classes = MAX(termcount, nonterminal+1);
+  num_classes = MAX(num_classes, sinks+1);
+
+  if (sw) sw->stop();
+
+  delete[] aux;
+  return new general_classifier(sccmap, num_nodes, num_classes);
+}
+
+
 // ======================================================================
 // |                                                                    |
 // |                dynamic_graph::scc_traversal methods                |
@@ -482,3 +634,474 @@ void GraphLib::dynamic_graph::scc_traversal::EnlargeCallStack(long newsize)
 
 
 
+
+
+// ======================================================================
+// |                                                                    |
+// |                      parallel_scc  methods                       |
+// |                                                                    |
+// ======================================================================
+
+/// Ranges smaller than this (per thread) are not worth a thread.
+const long MIN_CHUNK = 4096;
+
+/// Rounds of coloring before we finish sequentially.
+const int MAX_COLORING_ROUNDS = 16;
+
+GraphLib::parallel_scc::parallel_scc(long nodes, const long* rowptr,
+  const node_index* colidx, int threads)
+  : num_nodes(nodes), row_pointer(rowptr), column_index(colidx),
+    num_threads(threads > 0 ? threads : 1)
+{
+  trans_pointer = 0;
+  trans_index = 0;
+  scc = 0;
+  color = 0;
+  degree = 0;
+  flag = 0;
+  active_count = 0;
+  scc_count = 0;
+}
+
+// ******************************************************************
+
+GraphLib::parallel_scc::~parallel_scc()
+{
+  delete[] trans_pointer;
+  delete[] trans_index;
+  delete[] scc;
+  delete[] color;
+  delete[] degree;
+  delete[] flag;
+}
+
+// ******************************************************************
+
+void GraphLib::parallel_scc::Run(long* sccs, timer_hook* sw)
+{
+  if (sw) sw->start("Transposing graph");
+  Transpose();
+  scc = new std::atomic <long> [num_nodes];
+  color = new std::atomic <long> [num_nodes];
+  degree = new std::atomic <long> [num_nodes];
+  flag = new std::atomic <char> [num_nodes];
+  for (long i=0; i<num_nodes; i++) {
+    scc[i].store(-1, std::memory_order_relaxed);
+    flag[i].store(0, std::memory_order_relaxed);
+  }
+  active_count = num_nodes;
+  scc_count = 0;
+  if (sw) sw->stop();
+
+  if (sw) sw->start("Trimming and forward-backward search");
+  Trim();
+  ForwardBackward();
+  Trim();
+  if (sw) sw->stop();
+
+  if (sw) sw->start("Coloring SCCs");
+  for (int r=0; r<MAX_COLORING_ROUNDS && active_count>0; r++) {
+    Coloring();
+  }
+  if (sw) sw->stop();
+
+  if (sw) sw->start("Finding remaining SCCs");
+  Finish();
+  if (sw) sw->stop();
+
+  DCASSERT(0==active_count);
+  for (long i=0; i<num_nodes; i++) {
+    sccs[i] = scc[i].load(std::memory_order_relaxed);
+  }
+}
+
+// ******************************************************************
+
+void GraphLib::parallel_scc::Transpose()
+{
+  const long num_edges = row_pointer[num_nodes];
+  trans_pointer = new long[num_nodes+1];
+  trans_index = new node_index[num_edges ? num_edges : 1];
+
+  for (long i=0; i<=num_nodes; i++) trans_pointer[i] = 0;
+  for (long e=0; e<num_edges; e++) trans_pointer[column_index[e]+1]++;
+  for (long i=0; i<num_nodes; i++) trans_pointer[i+1] += trans_pointer[i];
+
+  // Use trans_pointer[j] as the next free slot for column j,
+  // then shift everything back.
+  for (long i=0; i<num_nodes; i++) {
+    for (long e=row_pointer[i]; e<row_pointer[i+1]; e++) {
+      trans_index[ trans_pointer[column_index[e]]++ ] = i;
+    }
+  }
+  for (long i=num_nodes; i>0; i--) trans_pointer[i] = trans_pointer[i-1];
+  trans_pointer[0] = 0;
+}
+
+// ******************************************************************
+
+void GraphLib::parallel_scc::Trim()
+{
+  //
+  // Count incoming and outgoing edges within active nodes,
+  // ignoring self loops.
+  //
+  Split(num_nodes, [this](int, long lo, long hi) {
+    for (long i=lo; i<hi; i++) {
+      if (!isActive(i)) continue;
+      long out = 0;
+      for (long e=row_pointer[i]; e<row_pointer[i+1]; e++) {
+        const long j = column_index[e];
+        if (j!=i && isActive(j)) out++;
+      }
+      long in = 0;
+      for (long e=trans_pointer[i]; e<trans_pointer[i+1]; e++) {
+        const long j = trans_index[e];
+        if (j!=i && isActive(j)) in++;
+      }
+      degree[i].store(out, std::memory_order_relaxed);
+      color[i].store(in, std::memory_order_relaxed);
+    }
+  });
+
+  //
+  // Remove nodes with no incoming or no outgoing edges;
+  // each is its own SCC.  Removing a node may expose others.
+  //
+  std::vector <long> removed(num_threads, 0);
+  Split(num_nodes, [this, &removed](int t, long lo, long hi) {
+    std::vector <long> stack;
+    for (long i=lo; i<hi; i++) {
+      if (!isActive(i)) continue;
+      if (degree[i].load(std::memory_order_relaxed) &&
+          color[i].load(std::memory_order_relaxed)) continue;
+      if (Claim(i, i)) stack.push_back(i);
+    }
+    while (!stack.empty()) {
+      const long i = stack.back();
+      stack.pop_back();
+      removed[t]++;
+      for (long e=row_pointer[i]; e<row_pointer[i+1]; e++) {
+        const long j = column_index[e];
+        if (j==i || !isActive(j)) continue;
+        if (1==color[j].fetch_sub(1) && Claim(j, j)) stack.push_back(j);
+      }
+      for (long e=trans_pointer[i]; e<trans_pointer[i+1]; e++) {
+        const long j = trans_index[e];
+        if (j==i || !isActive(j)) continue;
+        if (1==degree[j].fetch_sub(1) && Claim(j, j)) stack.push_back(j);
+      }
+    } // while stack
+  });
+
+  for (int t=0; t<num_threads; t++) {
+    active_count -= removed[t];
+    scc_count += removed[t];
+  }
+}
+
+// ******************************************************************
+
+void GraphLib::parallel_scc::ForwardBackward()
+{
+  if (0==active_count) return;
+
+  //
+  // Pivot: the active node with the most edges (after trimming),
+  // smallest index on ties.
+  //
+  std::vector <long> best(num_threads, -1);
+  Split(num_nodes, [this, &best](int t, long lo, long hi) {
+    long bestw = -1;
+    for (long i=lo; i<hi; i++) {
+      if (!isActive(i)) continue;
+      const long w = (degree[i].load(std::memory_order_relaxed)+1) *
+                     (color[i].load(std::memory_order_relaxed)+1);
+      if (w > bestw) {
+        bestw = w;
+        best[t] = i;
+      }
+    }
+  });
+  long pivot = -1;
+  long pivotw = -1;
+  for (int t=0; t<num_threads; t++) {
+    const long i = best[t];
+    if (i<0) continue;
+    const long w = (degree[i].load(std::memory_order_relaxed)+1) *
+                   (color[i].load(std::memory_order_relaxed)+1);
+    if (w > pivotw) {
+      pivotw = w;
+      pivot = i;
+    }
+  }
+  DCASSERT(pivot>=0);
+
+  std::vector < std::vector <long> > next(num_threads);
+  std::vector <long> frontier;
+
+  //
+  // Forward search from the pivot; mark reached nodes.
+  //
+  flag[pivot].store(1);
+  frontier.push_back(pivot);
+  while (!frontier.empty()) {
+    for (int t=0; t<num_threads; t++) next[t].clear();
+    Split(frontier.size(), [this, &frontier, &next](int t, long lo, long hi) {
+      for (long k=lo; k<hi; k++) {
+        const long i = frontier[k];
+        for (long e=row_pointer[i]; e<row_pointer[i+1]; e++) {
+          const long j = column_index[e];
+          if (!isActive(j)) continue;
+          if (flag[j].load(std::memory_order_relaxed)) continue;
+          if (0==flag[j].exchange(1)) next[t].push_back(j);
+        }
+      }
+    });
+    frontier.clear();
+    for (int t=0; t<num_threads; t++) {
+      frontier.insert(frontier.end(), next[t].begin(), next[t].end());
+    }
+  }
+
+  //
+  // Backward search from the pivot, within the marked nodes,
+  // gives the SCC of the pivot.
+  //
+  std::vector <long> removed(num_threads, 0);
+  Claim(pivot, pivot);
+  removed[0]++;
+  frontier.push_back(pivot);
+  while (!frontier.empty()) {
+    for (int t=0; t<num_threads; t++) next[t].clear();
+    Split(frontier.size(),
+      [this, pivot, &frontier, &next, &removed](int t, long lo, long hi) {
+        for (long k=lo; k<hi; k++) {
+          const long i = frontier[k];
+          for (long e=trans_pointer[i]; e<trans_pointer[i+1]; e++) {
+            const long j = trans_index[e];
+            if (0==flag[j].load(std::memory_order_relaxed)) continue;
+            if (Claim(j, pivot)) {
+              next[t].push_back(j);
+              removed[t]++;
+            }
+          }
+        }
+      }
+    );
+    frontier.clear();
+    for (int t=0; t<num_threads; t++) {
+      frontier.insert(frontier.end(), next[t].begin(), next[t].end());
+    }
+  }
+
+  Split(num_nodes, [this](int, long lo, long hi) {
+    for (long i=lo; i<hi; i++) flag[i].store(0, std::memory_order_relaxed);
+  });
+
+  for (int t=0; t<num_threads; t++) active_count -= removed[t];
+  scc_count++;
+}
+
+// ******************************************************************
+
+long GraphLib::parallel_scc::Coloring()
+{
+  std::vector < std::vector <long> > next(num_threads);
+  std::vector <long> frontier;
+
+  //
+  // Each active node starts with its own index as color,
+  // and all active nodes start in the frontier.
+  //
+  Split(num_nodes, [this, &next](int t, long lo, long hi) {
+    next[t].clear();
+    for (long i=lo; i<hi; i++) {
+      if (!isActive(i)) continue;
+      color[i].store(i, std::memory_order_relaxed);
+      flag[i].store(1, std::memory_order_relaxed);
+      next[t].push_back(i);
+    }
+  });
+
+  //
+  // Push the largest color forward, until nothing changes.
+  // The final color of a node is the largest index of
+  // the active nodes that reach it.
+  //
+  for (;;) {
+    frontier.clear();
+    for (int t=0; t<num_threads; t++) {
+      frontier.insert(frontier.end(), next[t].begin(), next[t].end());
+      next[t].clear();
+    }
+    if (frontier.empty()) break;
+
+    Split(frontier.size(), [this, &frontier, &next](int t, long lo, long hi) {
+      for (long k=lo; k<hi; k++) {
+        const long i = frontier[k];
+        flag[i].store(0);
+        const long c = color[i].load();
+        for (long e=row_pointer[i]; e<row_pointer[i+1]; e++) {
+          const long j = column_index[e];
+          if (j==i || !isActive(j)) continue;
+          long cj = color[j].load(std::memory_order_relaxed);
+          while (cj < c && !color[j].compare_exchange_weak(cj, c)) { }
+          if (cj >= c) continue;
+          if (0==flag[j].exchange(1)) next[t].push_back(j);
+        }
+      }
+    });
+  }
+
+  //
+  // Nodes that kept their own color are roots; the SCC of a root
+  // is the set of nodes of its color that reach it.
+  //
+  Split(num_nodes, [this, &next](int t, long lo, long hi) {
+    for (long i=lo; i<hi; i++) {
+      if (isActive(i) && color[i].load(std::memory_order_relaxed) == i) {
+        next[t].push_back(i);
+      }
+    }
+  });
+  std::vector <long> roots;
+  for (int t=0; t<num_threads; t++) {
+    roots.insert(roots.end(), next[t].begin(), next[t].end());
+  }
+
+  std::vector <long> removed(num_threads, 0);
+  Split(roots.size(), [this, &roots, &removed](int t, long lo, long hi) {
+    std::vector <long> stack;
+    for (long k=lo; k<hi; k++) {
+      const long r = roots[k];
+      if (Claim(r, r)) stack.push_back(r);
+      while (!stack.empty()) {
+        const long i = stack.back();
+        stack.pop_back();
+        removed[t]++;
+        for (long e=trans_pointer[i]; e<trans_pointer[i+1]; e++) {
+          const long j = trans_index[e];
+          if (color[j].load(std::memory_order_relaxed) != r) continue;
+          if (Claim(j, r)) stack.push_back(j);
+        }
+      }
+    }
+  });
+
+  long total = 0;
+  for (int t=0; t<num_threads; t++) total += removed[t];
+  active_count -= total;
+  scc_count += roots.size();
+  return total;
+}
+
+// ******************************************************************
+
+void GraphLib::parallel_scc::Finish()
+{
+  if (0==active_count) return;
+
+  //
+  // Sequential, stack-based Tarjan over the active nodes.
+  // Array color holds the visit order (0 for unvisited),
+  // and array degree holds the minimum reached.
+  // Visited nodes that are still active are on the visit stack.
+  //
+  for (long i=0; i<num_nodes; i++) {
+    color[i].store(0, std::memory_order_relaxed);
+  }
+  std::vector <long> visits;
+  std::vector <long> calls;   // pairs (node, next edge)
+  long visit_id = 0;
+
+  for (long s=0; s<num_nodes; s++) {
+    if (!isActive(s) || color[s].load(std::memory_order_relaxed)) continue;
+
+    visit_id++;
+    color[s].store(visit_id, std::memory_order_relaxed);
+    degree[s].store(visit_id, std::memory_order_relaxed);
+    visits.push_back(s);
+    calls.push_back(s);
+    calls.push_back(row_pointer[s]);
+
+    while (!calls.empty()) {
+      const long i = calls[calls.size()-2];
+      const long e = calls.back();
+      if (e < row_pointer[i+1]) {
+        calls.back()++;
+        const long j = column_index[e];
+        if (!isActive(j)) continue;
+        const long vj = color[j].load(std::memory_order_relaxed);
+        if (vj) {
+          if (vj < degree[i].load(std::memory_order_relaxed)) {
+            degree[i].store(vj, std::memory_order_relaxed);
+          }
+          continue;
+        }
+        // "by hand" recursion
+        visit_id++;
+        color[j].store(visit_id, std::memory_order_relaxed);
+        degree[j].store(visit_id, std::memory_order_relaxed);
+        visits.push_back(j);
+        calls.push_back(j);
+        calls.push_back(row_pointer[j]);
+        continue;
+      }
+
+      // All edges of i explored
+      calls.pop_back();
+      calls.pop_back();
+      const long min = degree[i].load(std::memory_order_relaxed);
+      if (min == color[i].load(std::memory_order_relaxed)) {
+        long mbr;
+        do {
+          mbr = visits.back();
+          visits.pop_back();
+          scc[mbr].store(i, std::memory_order_relaxed);
+          active_count--;
+        } while (mbr != i);
+        scc_count++;
+      }
+      if (!calls.empty()) {
+        const long p = calls[calls.size()-2];
+        if (min < degree[p].load(std::memory_order_relaxed)) {
+          degree[p].store(min, std::memory_order_relaxed);
+        }
+      }
+    } // while calls
+  } // for s
+}
+
+// ******************************************************************
+
+void GraphLib::parallel_scc::Split(long n,
+  const std::function <void(int, long, long)> &f)
+{
+  long nt = num_threads;
+  if (n / MIN_CHUNK < nt) nt = n / MIN_CHUNK;
+  if (nt <= 1) {
+    f(0, 0, n);
+    return;
+  }
+
+  std::atomic <bool> out_of_memory(false);
+  auto job = [&f, &out_of_memory, n, nt](int t) {
+    try {
+      f(t, n*t/nt, n*(t+1)/nt);
+    }
+    catch (std::bad_alloc &) {
+      out_of_memory = true;
+    }
+  };
+
+  std::vector <std::thread> workers;
+  for (int t=1; t<nt; t++) {
+    workers.push_back(std::thread(job, t));
+  }
+  job(0);
+  for (unsigned t=0; t<workers.size(); t++) {
+    workers[t].join();
+  }
+  if (out_of_memory) throw error(error::Out_Of_Memory);
+}
@@ -4,6 +4,9 @@
 
 #include "graphlib.h"
 
+#include <atomic>
+#include <functional>
+
 /*
   Functions for strongly-connected components
   and variations.
@@ -136,6 +139,109 @@ namespace GraphLib {
       long call_stack_size;
   };
 
+
+
+  // ======================================================================
+  // |                                                                    |
+  // |                         parallel_scc class                         |
+  // |                                                                    |
+  // ======================================================================
+
+  /**
+    Multi-threaded SCC decomposition, for a graph stored in
+    compressed row format (outgoing edges for each node).
+
+    Nodes that cannot be in a nontrivial SCC are trimmed first.
+    Then, a forward-backward search from a pivot removes the
+    (usually) giant SCC, and rounds of coloring remove the rest.
+    After a few rounds, whatever is left is handled by a sequential
+    Tarjan-style traversal.  Neither the SCCs found nor their
+    representatives depend on thread timing.
+  */
+  class parallel_scc {
+    public:
+      /**
+          Constructor.
+            @param  nodes     Number of nodes.
+            @param  rowptr    Start of the outgoing edges of each node;
+                              dimension nodes+1.
+            @param  colidx    Target of each edge.
+            @param  threads   Number of threads to use.
+      */
+      parallel_scc(long nodes, const long* rowptr, const node_index* colidx,
+        int threads);
+      ~parallel_scc();
+
+      /**
+          Determine the SCCs.
+            @param  sccs  On output, sccs[i] is the representative
+                          of the SCC containing node i; this is
+                          the one node j in the SCC with sccs[j] = j.
+            @param  sw    Where to report timing information
+                          (nowhere if 0).
+      */
+      void Run(long* sccs, timer_hook* sw);
+
+      inline long NumSCCs() const { return scc_count; }
+
+    private:
+      void Transpose();
+      /// Remove nodes with no active incoming or outgoing edges.
+      void Trim();
+      /// Remove the SCC containing the node with the most edges.
+      void ForwardBackward();
+      /// One round of coloring; returns the number of nodes removed.
+      long Coloring();
+      /// Sequential SCC traversal of the remaining nodes.
+      void Finish();
+
+      /**
+          Split [0, n) into one range per thread,
+          and run f(t, lo, hi) for each thread t.
+          Small ranges are handled by the calling thread alone.
+      */
+      void Split(long n, const std::function <void(int, long, long)> &f);
+
+      inline bool isActive(long i) const {
+        return scc[i].load(std::memory_order_relaxed) < 0;
+      }
+      inline bool Claim(long i, long rep) {
+        long expect = -1;
+        return scc[i].compare_exchange_strong(expect, rep);
+      }
+
+    private:
+      const long num_nodes;
+      const long* row_pointer;
+      const node_index* column_index;
+      /// Incoming edges, same format.
+      long* trans_pointer;
+      node_index* trans_index;
+      const int num_threads;
+
+      /// Representative for each node, or -1 if not yet known.
+      std::atomic <long>* scc;
+      /// Colors; active incoming degree while trimming.
+      std::atomic <long>* color;
+      /// Active outgoing degree while trimming.
+      std::atomic <long>* degree;
+      /// Per-node flags, for frontiers.
+      std::atomic <char>* flag;
+      long active_count;
+      long scc_count;
+  };
+
+
+  /**
+      Multi-threaded version of dynamic_graph::determineSCCs(),
+      for a graph in compressed row format.
+      The classification (and numbering) of SCCs is the same.
+      Implementation is in sccs.cc.
+  */
+  abstract_classifier* parallelSCCs(long num_nodes, const long* rowptr,
+    const node_index* colidx, long nonterminal, long sinks, int threads,
+    timer_hook* sw);
+
 };
 
 
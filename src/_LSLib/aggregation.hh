@@ -0,0 +1,379 @@
+
+#ifndef AGGREGATION_HH
+#define AGGREGATION_HH
+
+#include "lslib.h"
+#include "debug.hh"
+#include "krylov.hh"
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <new>
+
+/*
+    Iterative aggregation-disaggregation, for Ax=0 only.
+
+    The rows Start(), ..., Stop()-1 are partitioned into blocks;
+    each iteration
+      (1) builds the (small) aggregated system, with one row per
+          block, weighting each state by its share of the block's
+          probability in the current vector;
+      (2) solves it, and scales each block of the vector so that its
+          total matches;
+      (3) does one Gauss-Seidel sweep, block by block.
+
+    For nearly completely decomposable chains, step (2) takes care of
+    the slow moving probability between blocks, and step (3) of the
+    fast moving probability within them.
+*/
+
+// ******************************************************************
+// *                                                                *
+// *                     LS_Aggregates   class                      *
+// *                                                                *
+// ******************************************************************
+
+/**
+    Partition of the rows, in local indexes.
+*/
+class LS_Aggregates {
+  /// Block of each row.
+  std::vector <long> block;
+  /// Block b has rows rows[block_ptr[b]], ..., rows[block_ptr[b+1]-1].
+  std::vector <long> block_ptr;
+  std::vector <long> rows;
+public:
+  /// Use the given partition; p[s] is the block of row s.
+  void Use(const long* p, long start, long n);
+
+  /**
+      Find the blocks automatically: rows are in the same block
+      when they are connected through strong entries.  An entry
+      is weak if it is less than threshold times the largest
+      off-diagonal entry with the same column.
+  */
+  void Find(const std::vector <long> &ptr, const std::vector <long> &ind,
+    const std::vector <double> &val, double threshold);
+
+  inline long Size() const { return long(block.size()); }
+  inline long NumBlocks() const { return long(block_ptr.size()) - 1; }
+  inline long Block(long i) const { return block[i]; }
+  inline long BlockStart(long b) const { return block_ptr[b]; }
+  inline long BlockStop(long b) const { return block_ptr[b+1]; }
+  inline long Row(long k) const { return rows[k]; }
+
+private:
+  /// Fill block_ptr and rows, from block[].
+  void group(long nblocks);
+};
+
+void LS_Aggregates::Use(const long* p, long start, long n)
+{
+  // renumber the blocks from 0
+  std::vector <long> ids(p+start, p+start+n);
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  block.resize(n);
+  for (long i=0; i<n; i++) {
+    block[i] = std::lower_bound(ids.begin(), ids.end(), p[start+i]) - ids.begin();
+  }
+  group(ids.size());
+}
+
+void LS_Aggregates::Find(const std::vector <long> &ptr,
+  const std::vector <long> &ind, const std::vector <double> &val,
+  double threshold)
+{
+  const long n = long(ptr.size()) - 1;
+
+  // largest entry in each column
+  std::vector <double> colmax(n, 0.0);
+  for (long a=0; a<ptr[n]; a++) {
+    double v = fabs(val[a]);
+    if (v > colmax[ind[a]]) colmax[ind[a]] = v;
+  }
+
+  // union-find, over the strong entries
+  std::vector <long> parent(n);
+  for (long i=0; i<n; i++) parent[i] = i;
+  for (long i=0; i<n; i++) {
+    for (long a=ptr[i]; a<ptr[i+1]; a++) {
+      const long j = ind[a];
+      if (fabs(val[a]) < threshold * colmax[j]) continue;
+      long ri = i;
+      while (parent[ri] != ri) ri = parent[ri] = parent[parent[ri]];
+      long rj = j;
+      while (parent[rj] != rj) rj = parent[rj] = parent[parent[rj]];
+      if (ri < rj) parent[rj] = ri;
+      else         parent[ri] = rj;
+    }
+  }
+
+  // number the blocks, in order of their first row
+  block.resize(n);
+  long nblocks = 0;
+  for (long i=0; i<n; i++) {
+    long r = i;
+    while (parent[r] != r) r = parent[r];
+    if (r == i) block[i] = nblocks++;
+    else        block[i] = block[r];
+  }
+  group(nblocks);
+}
+
+void LS_Aggregates::group(long nblocks)
+{
+  const long n = Size();
+  block_ptr.assign(nblocks+1, 0);
+  for (long i=0; i<n; i++) block_ptr[block[i]+1]++;
+  for (long b=0; b<nblocks; b++) block_ptr[b+1] += block_ptr[b];
+  rows.resize(n);
+  std::vector <long> fill(block_ptr.begin(), block_ptr.end()-1);
+  for (long i=0; i<n; i++) rows[fill[block[i]]++] = i;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                    Aggregated system  solver                   *
+// *                                                                *
+// ******************************************************************
+
+/*
+    Solve the aggregated system, stored by rows in the same
+    format as the original (off-diagonals in ptr, ind, val;
+    diagonals in diag), with the solution summing to one.
+
+    Small systems are solved directly; larger ones by
+    Gauss-Seidel, starting from the given vector.
+*/
+
+inline void SolveAggregated(const std::vector <long> &ptr,
+  const std::vector <long> &ind, const std::vector <double> &val,
+  const std::vector <double> &diag, double* xi, const LS_Options &opts)
+{
+  const long nb = long(diag.size());
+  if (nb <= 256) {
+    //
+    // Dense Gaussian elimination, with partial pivoting.
+    // The last equation is replaced by sum(xi) = 1.
+    //
+    std::vector <double> M(nb*nb, 0.0);
+    std::vector <double> rhs(nb, 0.0);
+    for (long i=0; i<nb; i++) {
+      M[i*nb+i] = diag[i];
+      for (long a=ptr[i]; a<ptr[i+1]; a++) M[i*nb+ind[a]] += val[a];
+    }
+    for (long j=0; j<nb; j++) M[(nb-1)*nb+j] = 1;
+    rhs[nb-1] = 1;
+    for (long k=0; k<nb; k++) {
+      long p = k;
+      for (long i=k+1; i<nb; i++) {
+        if (fabs(M[i*nb+k]) > fabs(M[p*nb+k])) p = i;
+      }
+      if (p != k) {
+        for (long j=0; j<nb; j++) std::swap(M[k*nb+j], M[p*nb+j]);
+        std::swap(rhs[k], rhs[p]);
+      }
+      const double pivot = M[k*nb+k];
+      if (0==pivot) continue;   // singular; leave this one alone
+      for (long i=k+1; i<nb; i++) {
+        const double f = M[i*nb+k] / pivot;
+        if (0==f) continue;
+        for (long j=k; j<nb; j++) M[i*nb+j] -= f * M[k*nb+j];
+        rhs[i] -= f * rhs[k];
+      }
+    }
+    for (long i=nb-1; i>=0; i--) {
+      double sum = rhs[i];
+      for (long j=i+1; j<nb; j++) sum -= M[i*nb+j] * xi[j];
+      xi[i] = M[i*nb+i] ? sum / M[i*nb+i] : 0;
+    }
+  } else {
+    //
+    // Gauss-Seidel, until well past the requested precision
+    //
+    for (long iters=0; iters<opts.max_iters; iters++) {
+      double maxerror = 0;
+      double total = 0;
+      for (long i=0; i<nb; i++) {
+        double tmp = 0;
+        for (long a=ptr[i]; a<ptr[i+1]; a++) tmp += val[a] * xi[ind[a]];
+        tmp = diag[i] ? -tmp / diag[i] : xi[i];
+        double delta = fabs(tmp - xi[i]);
+        if (tmp) delta /= tmp;
+        if (delta > maxerror) maxerror = delta;
+        xi[i] = tmp;
+        total += tmp;
+      }
+      if (total) for (long i=0; i<nb; i++) xi[i] /= total;
+      if (maxerror < opts.precision * 1e-2) break;
+    }
+  }
+  // Guard against tiny negatives from roundoff
+  double total = 0;
+  for (long i=0; i<nb; i++) {
+    if (xi[i] < 0) xi[i] = 0;
+    total += xi[i];
+  }
+  if (total) for (long i=0; i<nb; i++) xi[i] /= total;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                   Aggregation-disaggregation                   *
+// *                                                                *
+// ******************************************************************
+
+/**
+    Workhorse for iterative aggregation-disaggregation solving Ax=0.
+
+    @param  A     Matrix; must be CRS or CCS.
+    @param  x     Vector
+    @param  opts  options; the partition is taken from
+                  aggregates, or found using aggregate_threshold.
+    @param  out   Output information
+*/
+template <class MATRIX>
+void New_Aggregation_Ax0(
+          const MATRIX &A,          // explicit matrix
+          double *x,                // solution vector
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+  out.relaxation = 1;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  const long start = A.Start();
+  const long n = A.Stop() - A.Start();
+  if (n < 1) {
+    out.status = LS_Success;
+    out.precision = 0;
+    return;
+  }
+
+  std::vector <long> ptr, ind;
+  std::vector <double> val;
+  LS_Aggregates P;
+  std::vector <double> ood;
+  std::vector <double> weight, xi, xold;
+  std::vector <long> cptr, cind;
+  std::vector <double> cval, cdiag;
+  std::vector <double> spa;
+  std::vector <long> touched;
+  try {
+    GetLocalRows(A, ptr, ind, val);
+    if (opts.aggregates) P.Use(opts.aggregates, start, n);
+    else                 P.Find(ptr, ind, val, opts.aggregate_threshold);
+    ood.resize(n);
+    for (long i=0; i<n; i++) ood[i] = A.one_over_diag[start+i];
+    weight.resize(n);
+    xi.resize(P.NumBlocks());
+    xold.resize(n);
+    cptr.resize(P.NumBlocks()+1);
+    cdiag.resize(P.NumBlocks());
+    spa.assign(P.NumBlocks(), 0.0);
+  }
+  catch (std::bad_alloc &) {
+    throw LS_Out_Of_Memory;
+  }
+  const long nb = P.NumBlocks();
+  if (opts.debug) {
+    printf("Aggregation using %ld blocks for %ld states\n", nb, n);
+  }
+
+  double* lx = x + start;
+  long iters;
+  double maxerror = 0;
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    if (opts.debug)  DebugIter("Aggregation", iters, x, A.Start(), A.Stop());
+    for (long i=0; i<n; i++) xold[i] = lx[i];
+
+    //
+    // (1) Aggregate.
+    //     Weights are the conditional probabilities within each block.
+    //
+    for (long b=0; b<nb; b++) {
+      double total = 0;
+      for (long k=P.BlockStart(b); k<P.BlockStop(b); k++) {
+        total += lx[P.Row(k)];
+      }
+      xi[b] = total;
+      for (long k=P.BlockStart(b); k<P.BlockStop(b); k++) {
+        const long i = P.Row(k);
+        weight[i] = total ? lx[i] / total
+                          : 1.0 / (P.BlockStop(b) - P.BlockStart(b));
+      }
+    }
+    cind.clear();
+    cval.clear();
+    cptr[0] = 0;
+    for (long b=0; b<nb; b++) {
+      double d = 0;
+      for (long k=P.BlockStart(b); k<P.BlockStop(b); k++) {
+        const long i = P.Row(k);
+        if (ood[i]) d -= weight[i] / ood[i];
+        for (long a=ptr[i]; a<ptr[i+1]; a++) {
+          const long c = P.Block(ind[a]);
+          const double v = val[a] * weight[ind[a]];
+          if (c == b) {
+            d += v;
+            continue;
+          }
+          if (0==spa[c]) touched.push_back(c);
+          spa[c] += v;
+        }
+      }
+      cdiag[b] = d;
+      for (unsigned t=0; t<touched.size(); t++) {
+        cind.push_back(touched[t]);
+        cval.push_back(spa[touched[t]]);
+        spa[touched[t]] = 0;
+      }
+      touched.clear();
+      cptr[b+1] = cind.size();
+    }
+
+    //
+    // (2) Solve the aggregated system, and disaggregate
+    //
+    SolveAggregated(cptr, cind, cval, cdiag, xi.data(), opts);
+    for (long i=0; i<n; i++) lx[i] = weight[i] * xi[P.Block(i)];
+
+    //
+    // (3) Gauss-Seidel sweep, block by block
+    //
+    double total = 0;
+    for (long k=0; k<n; k++) {
+      const long i = P.Row(k);
+      double tmp = 0;
+      for (long a=ptr[i]; a<ptr[i+1]; a++) tmp += val[a] * lx[ind[a]];
+      lx[i] = tmp * ood[i];
+      total += lx[i];
+    }
+    if (total) for (long i=0; i<n; i++) lx[i] /= total;
+
+    //
+    // Check for convergence
+    //
+    maxerror = 0;
+    for (long i=0; i<n; i++) {
+      double delta = lx[i] - xold[i];
+      if (opts.use_relative) if (lx[i]) delta /= lx[i];
+      if (delta<0) delta = -delta;
+      if (delta > maxerror) maxerror = delta;
+    }
+    if (iters < opts.min_iters) continue;
+    if (maxerror < opts.precision) {
+      out.status = LS_Success;
+      break;
+    }
+  } // for iters
+  out.num_iters = iters;
+  out.precision = maxerror;
+}
+
+#endif
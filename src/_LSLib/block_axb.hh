@@ -0,0 +1,190 @@
+#ifndef BLOCK_AXB_HH
+#define BLOCK_AXB_HH
+
+#include "lslib.h"
+#include <math.h>
+#include <vector>
+#include <new>
+
+/**
+
+    Workhorse for Row Gauss-Seidel solving AX=B, for a block of
+    k vectors stored interleaved (element i of vector j at i*k+j).
+    Each row of the matrix is read once per iteration, for all k.
+
+    The MATRIX class must provide the following methods/members:
+
+      one_over_diag[]                     : negated reciprocals of diagonals
+      long Start()                        : index of first row
+      long Stop()                         : one plus index of last row
+      BlockRowDotProduct(r, X, k, sums)   : Row r times X_j is added to sums[j]
+
+    @param  A     Matrix
+    @param  X     Solution vectors
+    @param  B     Constant right-hand side vectors (full)
+    @param  k     Number of vectors
+    @param  opts  options
+    @param  out   Output information
+*/
+
+template <bool RELAX, class MATRIX>
+void New_Block_RowGS_Axb(
+          const MATRIX &A,          // abstract matrix
+          double *X,                // solution vectors
+          const double* B,          // constant vectors (right side)
+          int k,                    // number of vectors
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  double one_minus_omega;
+  if (RELAX) {
+    out.relaxation = opts.relaxation;
+    one_minus_omega = 1.0 - opts.relaxation;
+  } else {
+    out.relaxation = 1;
+    one_minus_omega = 0;
+  }
+  std::vector <double> tmp(k);
+  long iters;
+  double maxerror = 0;
+
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    maxerror = 0;
+    bool check = (iters >= opts.min_iters);
+    for (long s=A.Start(); s<A.Stop(); s++) {
+      double* xs = X + s*k;
+      const double* bs = B + s*k;
+
+      for (int j=0; j<k; j++) tmp[j] = -bs[j];
+      A.BlockRowDotProduct(s, X, k, tmp.data());
+
+      for (int j=0; j<k; j++) {
+        double t = tmp[j];
+        if (RELAX) {
+          t *= A.one_over_diag[s] * opts.relaxation;
+          t += xs[j] * one_minus_omega;
+        } else {
+          t *= A.one_over_diag[s];
+        }
+
+        double delta = t - xs[j];
+        xs[j] = t;
+
+        if (check) {
+          if (opts.use_relative) if (t) delta /= t;
+          if (delta<0) delta = -delta;
+          if (delta > maxerror) maxerror = delta;
+        }
+      } // for j
+      if (check && maxerror >= opts.precision && iters < opts.max_iters) {
+        check = false;
+      }
+    } // for s
+
+    if (iters < opts.min_iters) continue;
+    if (maxerror < opts.precision) {
+      out.status = LS_Success;
+      break;
+    }
+  } // for iters
+  out.num_iters = iters;
+  out.precision = maxerror;
+}
+
+
+/**
+
+    Workhorse for Row Jacobi solving AX=B, for a block of k vectors;
+    see New_Block_RowGS_Axb().
+
+    @param  A     Matrix
+    @param  X     Solution vectors
+    @param  B     Constant right-hand side vectors (full)
+    @param  k     Number of vectors
+    @param  Xold  Auxiliary vectors, same dimension as X
+    @param  opts  options
+    @param  out   Output information
+*/
+
+template <bool RELAX, class MATRIX>
+void New_Block_RowJacobi_Axb(
+          const MATRIX &A,          // abstract matrix
+          double *X,                // solution vectors
+          const double* B,          // constant vectors (right side)
+          int k,                    // number of vectors
+          double* Xold,             // auxiliary vectors
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  double one_minus_omega;
+  if (RELAX) {
+    out.relaxation = opts.relaxation;
+    one_minus_omega = 1.0 - opts.relaxation;
+  } else {
+    out.relaxation = 1;
+    one_minus_omega = 0;
+  }
+  const long lo = A.Start() * k;
+  const long hi = A.Stop() * k;
+  long iters;
+  double maxerror = 0;
+
+  // Entries outside our rows are constant
+  for (long i=A.Size()*k-1; i>=0; i--) Xold[i] = X[i];
+
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    for (long i=lo; i<hi; i++) {
+      Xold[i] = X[i];
+      X[i] = -B[i];
+    }
+
+    maxerror = 0;
+    bool check = (iters >= opts.min_iters);
+    for (long s=A.Start(); s<A.Stop(); s++) {
+      double* xs = X + s*k;
+      const double* olds = Xold + s*k;
+      A.BlockRowDotProduct(s, Xold, k, xs);
+
+      for (int j=0; j<k; j++) {
+        if (RELAX) {
+          xs[j] *= A.one_over_diag[s] * opts.relaxation;
+          xs[j] += olds[j] * one_minus_omega;
+        } else {
+          xs[j] *= A.one_over_diag[s];
+        }
+
+        if (check) {
+          double delta = xs[j] - olds[j];
+          if (opts.use_relative) if (xs[j]) delta /= xs[j];
+          if (delta<0) delta = -delta;
+          if (delta > maxerror) maxerror = delta;
+        }
+      } // for j
+      if (check && maxerror >= opts.precision && iters < opts.max_iters) {
+        check = false;
+      }
+    } // for s
+
+    if (iters < opts.min_iters) continue;
+    if (maxerror < opts.precision) {
+      out.status = LS_Success;
+      break;
+    }
+  } // for iters
+  out.num_iters = iters;
+  out.precision = maxerror;
+}
+
+#endif
@@ -0,0 +1,215 @@
+
+#ifndef COLORING_HH
+#define COLORING_HH
+
+#include <vector>
+#include <new>
+
+// ******************************************************************
+// *                                                                *
+// *                       LS_Coloring  class                       *
+// *                                                                *
+// ******************************************************************
+
+/**
+    Coloring of the rows of a matrix, for parallel Gauss-Seidel.
+    The rows are split into blocks of consecutive rows
+    (possibly, one row per block).  Two blocks get different colors
+    if a row of either one uses an element of the solution vector
+    for the other; so the blocks of one color may be updated
+    at the same time, while the rows within a block are updated
+    in order, as with a single thread.
+
+    Within each color, blocks are kept in increasing order, and
+    split among the members of a team of threads so that each
+    member gets about the same number of nonzeroes.
+*/
+class LS_Coloring {
+  int nt;
+  /// Rows, grouped by color.
+  std::vector <long> rows;
+  /// Color c has rows[color_ptr[c]], ..., rows[color_ptr[c+1]-1].
+  std::vector <long> color_ptr;
+  /// Within color c, member t has rows[bounds[c*(nt+1)+t]], ...
+  std::vector <long> bounds;
+public:
+  LS_Coloring() { nt = 1; }
+
+  /**
+      Split the rows of A into nb blocks with about the same number
+      of nonzeroes (or, one block per row if nb is 0),
+      color the blocks greedily, and split them among nt threads.
+  */
+  template <class REAL>
+  inline void Build(const LS_CRS_Matrix <REAL> &A, int nt, long nb) {
+    buildRows(A, nt, nb);
+  }
+  inline void Build(const LS_CRS_Indexed_Matrix &A, int nt, long nb) {
+    buildRows(A, nt, nb);
+  }
+
+  /**
+      Columns are not enough to color the rows (and,
+      Gauss-Seidel is not possible by columns anyway).
+  */
+  template <class REAL>
+  inline void Build(const LS_CCS_Matrix <REAL> &, int, long) {
+    throw LS_Wrong_Format;
+  }
+  inline void Build(const LS_CCS_Indexed_Matrix &, int, long) {
+    throw LS_Wrong_Format;
+  }
+
+  inline long NumColors() const { return long(color_ptr.size()) - 1; }
+  inline long Low(long c, int t) const { return bounds[c*(nt+1)+t]; }
+  inline long High(long c, int t) const { return bounds[c*(nt+1)+t+1]; }
+  inline long Row(long i) const { return rows[i]; }
+
+private:
+  /// The MATRIX class must provide row_ptr[], col_ind[] and NumEntries().
+  template <class MATRIX>
+  void buildRows(const MATRIX &A, int nt, long nb);
+};
+
+template <class MATRIX>
+void LS_Coloring::buildRows(const MATRIX &A, int n, long nb)
+{
+  nt = (n>1) ? n : 1;
+  const long start = A.Start();
+  const long size = A.Stop() - A.Start();
+  try {
+    //
+    // Split into blocks; block b has rows bptr[b], ..., bptr[b+1]-1,
+    // relative to start.
+    //
+    std::vector <long> bptr;
+    std::vector <long> block;   // block[r]: block containing row r
+    if ((nb <= 0) || (nb >= size)) {
+      nb = size;
+      bptr.resize(size+1);
+      block.resize(size);
+      for (long r=0; r<size; r++) bptr[r] = block[r] = r;
+      bptr[size] = size;
+    } else {
+      const long total = A.NumEntries(start, A.Stop()) + size;
+      bptr.push_back(0);
+      block.resize(size);
+      long sofar = 0;
+      for (long r=0; r<size; r++) {
+        const long b = long(bptr.size()) - 1;
+        block[r] = b;
+        sofar += 1 + A.NumEntries(r+start, r+start+1);
+        if ((b+1 < nb) && (sofar * nb >= total * (b+1))) bptr.push_back(r+1);
+      }
+      if (bptr.back() < size) bptr.push_back(size);
+      nb = long(bptr.size()) - 1;
+    }
+
+    //
+    // Build the transpose of the block graph, so we can
+    // find the blocks that use each block.
+    //
+    std::vector <long> mark(nb, -1);
+    std::vector <long> tptr(nb+1, 0);
+    for (long b=0; b<nb; b++) {
+      for (long s=bptr[b]+start; s<bptr[b+1]+start; s++) {
+        for (long a=A.row_ptr[s]; a<A.row_ptr[s+1]; a++) {
+          long j = A.col_ind[a];
+          if ((j<start) || (j>=A.Stop())) continue;
+          long bj = block[j-start];
+          if ((bj == b) || (mark[bj] == b)) continue;
+          mark[bj] = b;
+          tptr[bj+1]++;
+        }
+      }
+    }
+    for (long b=0; b<nb; b++) tptr[b+1] += tptr[b];
+    std::vector <long> tind(tptr[nb]);
+    std::vector <long> fill(tptr.begin(), tptr.end()-1);
+    mark.assign(nb, -1);
+    for (long b=0; b<nb; b++) {
+      for (long s=bptr[b]+start; s<bptr[b+1]+start; s++) {
+        for (long a=A.row_ptr[s]; a<A.row_ptr[s+1]; a++) {
+          long j = A.col_ind[a];
+          if ((j<start) || (j>=A.Stop())) continue;
+          long bj = block[j-start];
+          if ((bj == b) || (mark[bj] == b)) continue;
+          mark[bj] = b;
+          tind[fill[bj]++] = b;
+        }
+      }
+    }
+
+    //
+    // Greedy coloring, in block order
+    //
+    std::vector <long> color(nb, -1);
+    std::vector <long> seen;   // seen[c] == b: color c used by a neighbor of b
+    long ncolors = 0;
+    for (long b=0; b<nb; b++) {
+      for (long s=bptr[b]+start; s<bptr[b+1]+start; s++) {
+        for (long a=A.row_ptr[s]; a<A.row_ptr[s+1]; a++) {
+          long j = A.col_ind[a];
+          if ((j<start) || (j>=A.Stop())) continue;
+          long cj = color[block[j-start]];
+          if (cj >= 0) seen[cj] = b;
+        }
+      }
+      for (long a=tptr[b]; a<tptr[b+1]; a++) {
+        long cj = color[tind[a]];
+        if (cj >= 0) seen[cj] = b;
+      }
+      long c;
+      for (c=0; c<ncolors; c++) if (seen[c] != b) break;
+      if (c == ncolors) {
+        ncolors++;
+        seen.push_back(-1);
+      }
+      color[b] = c;
+    }
+
+    //
+    // Group rows by color, keeping the blocks whole
+    //
+    color_ptr.assign(ncolors+1, 0);
+    for (long b=0; b<nb; b++) color_ptr[color[b]+1] += bptr[b+1] - bptr[b];
+    for (long c=0; c<ncolors; c++) color_ptr[c+1] += color_ptr[c];
+    rows.resize(size);
+    fill.assign(color_ptr.begin(), color_ptr.end()-1);
+    for (long r=0; r<size; r++) rows[fill[color[block[r]]]++] = r+start;
+
+    //
+    // Split each color, by nonzeroes, between blocks
+    //
+    bounds.resize(ncolors*(nt+1));
+    for (long c=0; c<ncolors; c++) {
+      long total = 0;
+      for (long i=color_ptr[c]; i<color_ptr[c+1]; i++) {
+        total += 1 + A.NumEntries(rows[i], rows[i]+1);
+      }
+      long* b = bounds.data() + c*(nt+1);
+      b[0] = color_ptr[c];
+      long i = color_ptr[c];
+      long sofar = 0;
+      for (int t=1; t<nt; t++) {
+        const long target = (total * t) / nt;
+        while (i<color_ptr[c+1]) {
+          if (sofar >= target) break;
+          // advance over the whole block
+          const long bl = block[rows[i]-start];
+          do {
+            sofar += 1 + A.NumEntries(rows[i], rows[i]+1);
+            i++;
+          } while ((i<color_ptr[c+1]) && (block[rows[i]-start] == bl));
+        }
+        b[t] = i;
+      }
+      b[nt] = color_ptr[c+1];
+    }
+  }
+  catch (std::bad_alloc &) {
+    throw LS_Out_Of_Memory;
+  }
+}
+
+#endif
@@ -51,7 +51,7 @@ void DebugMatrix(const LS_CRS_Matrix<REAL> &A)
     printf("[");
     for (long i=0; i<A.row_ptr[A.stop]; i++) {
       if (i) printf(", ");
-      printf("%ld", A.col_ind[i]);
+      printf("%ld", long(A.col_ind[i]));
     }
     printf("]");
   } else {
@@ -100,7 +100,7 @@ void DebugMatrix(const LS_CCS_Matrix<REAL> &A)
     printf("[");
     for (long i=0; i<A.col_ptr[A.stop]; i++) {
       if (i) printf(", ");
-      printf("%ld", A.row_ind[i]);
+      printf("%ld", long(A.row_ind[i]));
     }
     printf("]");
   } else {
@@ -132,6 +132,53 @@ void DebugMatrix(const LS_CCS_Matrix<REAL> &A)
 }
 
 
+// ******************************************************************
+// *                  Indexed  matrices  debugging                  *
+// ******************************************************************
+
+template <class MATRIX>
+void DebugIndexedMatrix(const MATRIX &A, const long* ptr, const LS_Index* ind)
+{
+  printf("Using A matrix:\n");
+  printf("\n  start: %ld\n  stop: %ld\n  pointers: [", A.start, A.stop);
+  for (long i=0; i<=A.stop; i++) {
+    if (i) printf(", ");
+    printf("%ld", ptr[i]);
+  }
+  printf("]\n  indexes: [");
+  for (long i=0; i<ptr[A.stop]; i++) {
+    if (i) printf(", ");
+    printf("%ld", long(ind[i]));
+  }
+  printf("]\n  val: [");
+  for (long i=0; i<ptr[A.stop]; i++) {
+    if (i) printf(", ");
+    printf("%lg", A.Value(i));
+  }
+  printf("]\n  one_over_diag: ");
+  if (A.one_over_diag) {
+    printf("[");
+    for (long i=0; i<A.stop; i++) {
+      if (i) printf(", ");
+      printf("%lg", A.one_over_diag[i]);
+    }
+    printf("]");
+  } else {
+    printf("null");
+  }
+  printf("\n");
+}
+
+void DebugMatrix(const LS_CRS_Indexed_Matrix &A)
+{
+  DebugIndexedMatrix(A, A.row_ptr, A.col_ind);
+}
+
+void DebugMatrix(const LS_CCS_Indexed_Matrix &A)
+{
+  DebugIndexedMatrix(A, A.col_ptr, A.row_ind);
+}
+
 // ******************************************************************
 // *                   LS_Sparse_Vector debugging                   *
 // ******************************************************************
@@ -5,6 +5,7 @@
 #include "matrix.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <iostream>
 #include <iomanip>
@@ -200,13 +201,21 @@ int Usage(const char* name)
     cerr << "\tr: Jacobi by rows\n";
     cerr << "\tj: Jacobi by vector-matrix multiply\n";
     cerr << "\tg: Gauss-Seidel (by rows)\n";
+    cerr << "\tk: GMRES\n";
+    cerr << "\tb: BiCGSTAB\n";
     cerr << "\ta: use abstract matrix\n";
     cerr << "\tc: store matrix by columns\n";
     cerr << "\tt: store vector as truncated full\n";
     cerr << "\ts: show solution vector\n";
     cerr << "\tw x: sets relaxation parameter (default 1.0)\n";
     cerr << "\te epsilon: sets precision\n";
+    cerr << "\ti prec: sets preconditioner for GMRES, BiCGSTAB:\n";
+    cerr << "\t\tnone, jacobi, or ilu0 (default)\n";
+    cerr << "\tl blocks: sets blocks for Gauss-Seidel with threads\n";
+    cerr << "\t\t(default 0: single rows)\n";
+    cerr << "\tm threads: sets number of threads (default 1)\n";
     cerr << "\tn iters: sets maximum number of iterations (default 10000)\n";
+    cerr << "\tx dim: sets GMRES restart (default 30)\n";
     return 0;
 }
 
@@ -224,7 +233,7 @@ int main(int argc, char** argv)
   bool show_solution = false;
   opts.max_iters = 10000;
   for (;;) {
-    ch = getopt(argc, argv, "?rjgacstw:e:n:");
+    ch = getopt(argc, argv, "?rjgabckstw:e:i:l:m:n:x:");
     if (ch<0) break;
     switch (ch) {
       case 'a':  
@@ -247,6 +256,14 @@ int main(int argc, char** argv)
           opts.method = LS_Gauss_Seidel;
           break;
 
+      case 'k':
+          opts.method = LS_GMRES;
+          break;
+
+      case 'b':
+          opts.method = LS_BiCGSTAB;
+          break;
+
       case 't':
           sparse_b = false;
           break;
@@ -282,6 +299,41 @@ int main(int argc, char** argv)
           }
           break;
 
+      case 'l':
+          if (optarg) {
+            long n = atol(optarg);
+            if (n>=0) {
+              opts.gs_blocks = n;
+            }
+          }
+          break;
+
+      case 'm':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.num_threads = n;
+            }
+          }
+          break;
+
+      case 'i':
+          if (optarg) {
+            if (0==strcmp(optarg, "none"))    opts.precond = LS_Precond_None;
+            if (0==strcmp(optarg, "jacobi"))  opts.precond = LS_Precond_Jacobi;
+            if (0==strcmp(optarg, "ilu0"))    opts.precond = LS_Precond_ILU0;
+          }
+          break;
+
+      case 'x':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.krylov_dim = n;
+            }
+          }
+          break;
+
       default:
           return Usage(name);
     } // switch
@@ -324,6 +376,12 @@ int main(int argc, char** argv)
     case LS_Jacobi: 
         cerr << "Jacobi\n";
         break;
+    case LS_GMRES: 
+        cerr << "GMRES(" << opts.krylov_dim << ")\n";
+        break;
+    case LS_BiCGSTAB: 
+        cerr << "BiCGSTAB\n";
+        break;
     default:
         cerr << "Unknown solver\n";
         return 1;
@@ -5,10 +5,13 @@
 #include "matrix.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -110,6 +113,46 @@ double CompareVector(istream &s, double* x)
   return maxerror;
 }
 
+LS_CRS_Indexed_Matrix riA;
+LS_CCS_Indexed_Matrix ciA;
+vector <double> dictionary;
+vector <unsigned short> val_index;
+vector <double> one_over_diag_d;
+
+/*
+  Build the indexed matrices, from the explicit ones.
+  Returns false if there are too many distinct values.
+*/
+bool BuildIndexed()
+{
+  const float* val = by_cols ? cA.val : rA.val;
+  const long nnz = by_cols ? cA.col_ptr[size] : rA.row_ptr[size];
+  dictionary.assign(val, val+nnz);
+  sort(dictionary.begin(), dictionary.end());
+  dictionary.erase(unique(dictionary.begin(), dictionary.end()), dictionary.end());
+  if (dictionary.size() > 65536) return false;
+  val_index.resize(nnz);
+  for (long a=0; a<nnz; a++) {
+    val_index[a] = lower_bound(dictionary.begin(), dictionary.end(), double(val[a])) - dictionary.begin();
+  }
+  one_over_diag_d.assign(one_over_diag, one_over_diag+size);
+
+  riA.start = ciA.start = 0;
+  riA.stop = ciA.stop = size;
+  riA.size = ciA.size = size;
+  riA.dict = ciA.dict = dictionary.data();
+  riA.val_index = ciA.val_index = val_index.data();
+  riA.col_ind = rA.col_ind;
+  riA.row_ptr = rA.row_ptr;
+  ciA.row_ind = cA.row_ind;
+  ciA.col_ptr = cA.col_ptr;
+  riA.one_over_diag = ciA.one_over_diag = one_over_diag_d.data();
+
+  cerr << "Using " << dictionary.size() << " distinct values for ";
+  cerr << nnz << " entries\n";
+  return true;
+}
+
 int Usage(const char* name)
 {
     cerr << "Usage: " << name << " [file]\n\nSwitches:\n";
@@ -119,14 +162,25 @@ int Usage(const char* name)
     cerr << "\tf: auxiliary vectors are floats\n";
     cerr << "\tg: Gauss-Seidel (by rows)\n";
     cerr << "\tj: Jacobi by vector-matrix multiply\n";
+    cerr << "\tb: BiCGSTAB\n";
+    cerr << "\tk: GMRES\n";
     cerr << "\tp: Power method\n";
     cerr << "\tr: Jacobi by rows\n";
     cerr << "\ts: show solution vector\n";
+    cerr << "\tv: store each distinct matrix value once\n";
+    cerr << "\ty: aggregation-disaggregation\n";
     cerr << "\n";
     cerr << "\td iters: show precision achieved after this many iterations\n";
     cerr << "\te epsilon: sets precision\n";
+    cerr << "\ti prec: sets preconditioner for GMRES, BiCGSTAB:\n";
+    cerr << "\t\tnone, jacobi, or ilu0 (default)\n";
+    cerr << "\tl blocks: sets blocks for Gauss-Seidel with threads\n";
+    cerr << "\t\t(default 0: single rows)\n";
+    cerr << "\tm threads: sets number of threads (default 1)\n";
     cerr << "\tn iters: sets maximum number of iterations (default 10000)\n";
+    cerr << "\tt frac: sets aggregation threshold (default 0.1)\n";
     cerr << "\tw x: sets relaxation parameter (default 1.0)\n";
+    cerr << "\tx dim: sets GMRES restart (default 30)\n";
     return 0;
 }
 
@@ -140,12 +194,13 @@ int main(int argc, char** argv)
   int ch;
   by_cols = false;
   bool use_abstract = false;
+  bool use_indexed = false;
   bool show_solution = false;
   int deltaiters = 1000000;
   int totaliters = 10000;
   opts.float_vectors = false;
   for (;;) {
-    ch = getopt(argc, argv, "?acfgjprsd:e:n:w:");
+    ch = getopt(argc, argv, "?abcfgjkprsvyd:e:i:l:m:n:t:w:x:");
     if (ch<0) break;
     switch (ch) {
       case 'a':  
@@ -172,14 +227,30 @@ int main(int argc, char** argv)
           opts.method = LS_Gauss_Seidel;
           break;
 
+      case 'k':
+          opts.method = LS_GMRES;
+          break;
+
+      case 'b':
+          opts.method = LS_BiCGSTAB;
+          break;
+
       case 'p':
           opts.method = LS_Power;
           break;
 
+      case 'y':
+          opts.method = LS_Aggregation;
+          break;
+
       case 's':
           show_solution = true;
           break;
 
+      case 'v':
+          use_indexed = true;
+          break;
+
       case 'w':
           if (optarg) {
             double r = atof(optarg);
@@ -216,6 +287,50 @@ int main(int argc, char** argv)
           }
           break;
 
+      case 'l':
+          if (optarg) {
+            long n = atol(optarg);
+            if (n>=0) {
+              opts.gs_blocks = n;
+            }
+          }
+          break;
+
+      case 'm':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.num_threads = n;
+            }
+          }
+          break;
+
+      case 'i':
+          if (optarg) {
+            if (0==strcmp(optarg, "none"))    opts.precond = LS_Precond_None;
+            if (0==strcmp(optarg, "jacobi"))  opts.precond = LS_Precond_Jacobi;
+            if (0==strcmp(optarg, "ilu0"))    opts.precond = LS_Precond_ILU0;
+          }
+          break;
+
+      case 'x':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.krylov_dim = n;
+            }
+          }
+          break;
+
+      case 't':
+          if (optarg) {
+            double t = atof(optarg);
+            if (t>0 && t<=1) {
+              opts.aggregate_threshold = t;
+            }
+          }
+          break;
+
       default:
           return Usage(name);
     } // switch
@@ -241,6 +356,14 @@ int main(int argc, char** argv)
     cerr << "standard input\n";
     ReadInput(cin);
   }
+  if (use_indexed && !use_abstract) {
+    if (!BuildIndexed()) {
+      cerr << "Too many distinct values\n";
+      return 1;
+    }
+  } else {
+    use_indexed = false;
+  }
   if (opts.relaxation != 1.0) {
     opts.use_relaxation = 1;
     cerr << "Using relaxation parameter " << opts.relaxation << "\n";
@@ -257,9 +380,18 @@ int main(int argc, char** argv)
     case LS_Jacobi: 
         cerr << "Jacobi\n";
         break;
+    case LS_GMRES: 
+        cerr << "GMRES(" << opts.krylov_dim << ")\n";
+        break;
+    case LS_BiCGSTAB: 
+        cerr << "BiCGSTAB\n";
+        break;
     case LS_Power: 
         cerr << "Power method\n";
         break;
+    case LS_Aggregation: 
+        cerr << "aggregation-disaggregation\n";
+        break;
     default:
         cerr << "Unknown solver\n";
         return 1;
@@ -281,6 +413,10 @@ int main(int argc, char** argv)
     if (opts.min_iters > opts.max_iters) opts.min_iters = opts.max_iters;
     totaliters -= deltaiters;
     if (use_abstract)   Solve_AxZero(*AA, x, opts, out);
+    else if (use_indexed) {
+      if (by_cols)      Solve_AxZero(ciA, x, opts, out);
+      else              Solve_AxZero(riA, x, opts, out);
+    }
     else if (by_cols)   Solve_AxZero(cA, x, opts, out);
     else                Solve_AxZero(rA, x, opts, out);
     iters_so_far += out.num_iters;
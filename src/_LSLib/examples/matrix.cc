@@ -41,7 +41,7 @@ sparse_matrix::sparse_matrix(long nodes, long edges, bool transpose)
   
   edges_alloc = (edges>0) ? edges : 0;
   if (edges_alloc) {
-    column_index =  (long*) malloc(edges_alloc * sizeof(long));
+    column_index =  (LS_Index*) malloc(edges_alloc * sizeof(LS_Index));
     value = (float*) malloc(edges_alloc * sizeof(float));
     next = (long*) malloc(edges_alloc * sizeof(long));
   } else {
@@ -144,7 +144,7 @@ bool sparse_matrix::ResizeEdges(long new_edges)
 {
   if (IsStatic()) return false;
   if (edges_alloc == new_edges) return true;
-  long* nci = (long *) realloc(column_index, new_edges*sizeof(long));
+  LS_Index* nci = (LS_Index *) realloc(column_index, new_edges*sizeof(LS_Index));
   float* nv = (float *) realloc(value, new_edges*sizeof(float));
   long* nn = (long *) realloc(next, new_edges*sizeof(long));
   if (new_edges) {
@@ -27,7 +27,7 @@ private:
       Only \a num_edges of the entries are in use, though.
       Each entry corresponds to the "target node" of an arc.
   */
-  long* column_index;
+  LS_Index* column_index;
 
   /** Array of weights.
       The array dimension is \a edges_alloc.
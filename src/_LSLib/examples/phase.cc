@@ -181,7 +181,7 @@ void parseInput(istream &s, LS_CRS_Matrix_float &A, double* &initial)
   A.stop = N;
   A.size = N;
   long* rp = new long[N+1];
-  long* ci = new long[E];
+  LS_Index* ci = new LS_Index[E];
   float* fv = new float[E];
   A.row_ptr = rp;
   A.col_ind = ci;
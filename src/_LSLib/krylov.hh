@@ -0,0 +1,741 @@
+
+#ifndef KRYLOV_HH
+#define KRYLOV_HH
+
+#include "lslib.h"
+#include "debug.hh"
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <new>
+
+/*
+    Projection (Krylov subspace) methods.
+
+    Only rows and columns Start(), ..., Stop()-1 of the matrix
+    take part; internally, vectors are indexed from 0 for row Start().
+
+    The system solved is N x = rhs, where N is the matrix with its
+    diagonal put back (the diagonal is minus one over one_over_diag).
+    For Ax=0, one element x[p] is fixed to 1: column p is dropped
+    and row p is replaced by x[p] = 1, which makes the system
+    nonsingular (for irreducible chains).  The answer is normalized
+    afterwards.
+
+    Convergence is decided on the 2-norm of the residual,
+    relative to the 2-norm of the right-hand side.
+*/
+
+// ******************************************************************
+// *                                                                *
+// *                    LS_Krylov_System  class                     *
+// *                                                                *
+// ******************************************************************
+
+template <class MATRIX>
+class LS_Krylov_System {
+  const MATRIX &A;
+  long start;
+  long n;
+  /// Pivot (fixed element) in local index, or -1.
+  long pivot;
+  /// Diagonal of N.
+  std::vector <double> diag;
+  /// Full length vectors, for the matrix multiply.
+  std::vector <double> in;
+  std::vector <double> out;
+public:
+  LS_Krylov_System(const MATRIX &M, long piv);
+
+  inline long Size() const { return n; }
+  inline long Start() const { return start; }
+  inline long Pivot() const { return pivot; }
+  inline double Diag(long i) const { return diag[i]; }
+  inline const MATRIX& Matrix() const { return A; }
+
+  /// w = N v, local vectors.
+  inline void Apply(const double* v, double* w) { multiply(v, w, true); }
+
+  /// w = column p of N, without the pivot replacement.
+  inline void PivotColumn(double* w) {
+    std::vector <double> e(n, 0.0);
+    e[pivot] = 1;
+    multiply(e.data(), w, false);
+  }
+
+  /// w = (off-diagonal part) * x, using only x outside our rows.
+  inline void OutsideProduct(const double* x, double* w) {
+    for (long s=0; s<long(in.size()); s++) in[s] = x[s];
+    for (long i=0; i<n; i++) in[start+i] = 0;
+    for (long i=0; i<n; i++) out[start+i] = 0;
+    A.MatrixVectorMultiply(out.data(), in.data());
+    for (long i=0; i<n; i++) w[i] = out[start+i];
+    for (long s=0; s<long(in.size()); s++) in[s] = 0;
+  }
+
+private:
+  inline void multiply(const double* v, double* w, bool usepivot) {
+    for (long i=0; i<n; i++) {
+      in[start+i] = v[i];
+      out[start+i] = 0;
+    }
+    if (usepivot && pivot>=0) in[start+pivot] = 0;
+    A.MatrixVectorMultiply(out.data(), in.data());
+    for (long i=0; i<n; i++) {
+      w[i] = out[start+i] + diag[i] * in[start+i];
+    }
+    if (usepivot && pivot>=0) w[pivot] = v[pivot];
+  }
+};
+
+template <class MATRIX>
+LS_Krylov_System<MATRIX>::LS_Krylov_System(const MATRIX &M, long piv)
+ : A(M)
+{
+  start = A.Start();
+  n = A.Stop() - A.Start();
+  pivot = piv;
+  try {
+    diag.resize(n);
+    in.assign(A.Size(), 0.0);
+    out.assign(A.Size(), 0.0);
+  }
+  catch (std::bad_alloc &) {
+    throw LS_Out_Of_Memory;
+  }
+  for (long i=0; i<n; i++) {
+    double d = A.one_over_diag[start+i];
+    diag[i] = d ? -1.0 / d : 0.0;
+  }
+}
+
+// ******************************************************************
+// *                                                                *
+// *                        Preconditioners                         *
+// *                                                                *
+// ******************************************************************
+
+/// Preconditioner: approximately solve N z = r.
+class LS_Precond {
+public:
+  virtual ~LS_Precond() { }
+  virtual void Solve(const double* r, double* z) const = 0;
+};
+
+class LS_Identity_Precond : public LS_Precond {
+  long n;
+public:
+  LS_Identity_Precond(long size) { n = size; }
+  virtual void Solve(const double* r, double* z) const {
+    for (long i=0; i<n; i++) z[i] = r[i];
+  }
+};
+
+class LS_Diag_Precond : public LS_Precond {
+  std::vector <double> one_over;
+public:
+  template <class MATRIX>
+  LS_Diag_Precond(const LS_Krylov_System<MATRIX> &N) {
+    one_over.resize(N.Size());
+    for (long i=0; i<N.Size(); i++) {
+      double d = (i == N.Pivot()) ? 1.0 : N.Diag(i);
+      one_over[i] = d ? 1.0 / d : 1.0;
+    }
+  }
+  virtual void Solve(const double* r, double* z) const {
+    for (long i=0; i<long(one_over.size()); i++) z[i] = r[i] * one_over[i];
+  }
+};
+
+/*
+    Off-diagonal entries of rows start, ..., stop-1, by rows,
+    in local indexes; entries in other columns are skipped.
+    Not possible for user-defined matrices.
+*/
+
+template <class MATRIX>
+inline void GetLocalRowsByRows(const MATRIX &A,
+  std::vector <long> &ptr, std::vector <long> &ind, std::vector <double> &val)
+{
+  const long n = A.Stop() - A.Start();
+  ptr.assign(n+1, 0);
+  for (long s=A.Start(); s<A.Stop(); s++) {
+    for (long a=A.row_ptr[s]; a<A.row_ptr[s+1]; a++) {
+      long j = A.col_ind[a];
+      if ((j<A.Start()) || (j>=A.Stop())) continue;
+      ind.push_back(j - A.Start());
+      val.push_back(A.Value(a));
+    }
+    ptr[s-A.Start()+1] = ind.size();
+  }
+}
+
+template <class MATRIX>
+inline void GetLocalRowsByCols(const MATRIX &A,
+  std::vector <long> &ptr, std::vector <long> &ind, std::vector <double> &val)
+{
+  // transpose
+  const long n = A.Stop() - A.Start();
+  ptr.assign(n+1, 0);
+  for (long a=A.col_ptr[A.Start()]; a<A.col_ptr[A.Stop()]; a++) {
+    long i = A.row_ind[a];
+    if ((i<A.Start()) || (i>=A.Stop())) continue;
+    ptr[i-A.Start()+1]++;
+  }
+  for (long r=0; r<n; r++) ptr[r+1] += ptr[r];
+  ind.resize(ptr[n]);
+  val.resize(ptr[n]);
+  std::vector <long> fill(ptr.begin(), ptr.end()-1);
+  for (long s=A.Start(); s<A.Stop(); s++) {
+    for (long a=A.col_ptr[s]; a<A.col_ptr[s+1]; a++) {
+      long i = A.row_ind[a];
+      if ((i<A.Start()) || (i>=A.Stop())) continue;
+      long f = fill[i-A.Start()]++;
+      ind[f] = s - A.Start();
+      val[f] = A.Value(a);
+    }
+  }
+}
+
+template <class REAL>
+inline void GetLocalRows(const LS_CRS_Matrix<REAL> &A,
+  std::vector <long> &ptr, std::vector <long> &ind, std::vector <double> &val)
+{
+  GetLocalRowsByRows(A, ptr, ind, val);
+}
+
+inline void GetLocalRows(const LS_CRS_Indexed_Matrix &A,
+  std::vector <long> &ptr, std::vector <long> &ind, std::vector <double> &val)
+{
+  GetLocalRowsByRows(A, ptr, ind, val);
+}
+
+template <class REAL>
+inline void GetLocalRows(const LS_CCS_Matrix<REAL> &A,
+  std::vector <long> &ptr, std::vector <long> &ind, std::vector <double> &val)
+{
+  GetLocalRowsByCols(A, ptr, ind, val);
+}
+
+inline void GetLocalRows(const LS_CCS_Indexed_Matrix &A,
+  std::vector <long> &ptr, std::vector <long> &ind, std::vector <double> &val)
+{
+  GetLocalRowsByCols(A, ptr, ind, val);
+}
+
+inline void GetLocalRows(const LS_Generic_Matrix &,
+  std::vector <long> &, std::vector <long> &, std::vector <double> &)
+{
+  throw LS_Wrong_Format;
+}
+
+/**
+    Incomplete LU factorization, with no fill.
+    L (unit diagonal) and U share the sparsity pattern of N.
+*/
+class LS_ILU0_Precond : public LS_Precond {
+  long n;
+  std::vector <long> ptr;
+  std::vector <long> ind;
+  std::vector <double> val;
+  /// Position of the diagonal element in each row.
+  std::vector <long> dpos;
+public:
+  template <class MATRIX>
+  LS_ILU0_Precond(const LS_Krylov_System<MATRIX> &N);
+
+  virtual void Solve(const double* r, double* z) const {
+    // forward: L y = r
+    for (long i=0; i<n; i++) {
+      double sum = r[i];
+      for (long a=ptr[i]; a<dpos[i]; a++) sum -= val[a] * z[ind[a]];
+      z[i] = sum;
+    }
+    // backward: U z = y
+    for (long i=n-1; i>=0; i--) {
+      double sum = z[i];
+      for (long a=dpos[i]+1; a<ptr[i+1]; a++) sum -= val[a] * z[ind[a]];
+      z[i] = sum / val[dpos[i]];
+    }
+  }
+private:
+  void factor();
+};
+
+template <class MATRIX>
+LS_ILU0_Precond::LS_ILU0_Precond(const LS_Krylov_System<MATRIX> &N)
+{
+  n = N.Size();
+  try {
+    std::vector <long> optr, oind;
+    std::vector <double> oval;
+    GetLocalRows(N.Matrix(), optr, oind, oval);
+
+    //
+    // Rows of N, sorted by column, with the diagonal
+    //
+    ptr.resize(n+1);
+    dpos.resize(n);
+    ind.reserve(oind.size() + n);
+    val.reserve(oind.size() + n);
+    std::vector < std::pair <long, double> > row;
+    ptr[0] = 0;
+    for (long i=0; i<n; i++) {
+      row.clear();
+      if (i == N.Pivot()) {
+        row.push_back(std::make_pair(i, 1.0));
+      } else {
+        double d = N.Diag(i);
+        for (long a=optr[i]; a<optr[i+1]; a++) {
+          if (oind[a] == N.Pivot()) continue;
+          if (oind[a] == i) {
+            d += oval[a];
+            continue;
+          }
+          row.push_back(std::make_pair(oind[a], oval[a]));
+        }
+        row.push_back(std::make_pair(i, d));
+      }
+      std::sort(row.begin(), row.end());
+      for (unsigned a=0; a<row.size(); a++) {
+        // merge duplicate entries, if any
+        if (a && row[a].first == row[a-1].first) {
+          val.back() += row[a].second;
+          continue;
+        }
+        if (row[a].first == i) dpos[i] = ind.size();
+        ind.push_back(row[a].first);
+        val.push_back(row[a].second);
+      }
+      ptr[i+1] = ind.size();
+    }
+  }
+  catch (std::bad_alloc &) {
+    throw LS_Out_Of_Memory;
+  }
+  factor();
+}
+
+void LS_ILU0_Precond::factor()
+{
+  std::vector <long> where(n, -1);
+  for (long i=0; i<n; i++) {
+    for (long a=ptr[i]; a<ptr[i+1]; a++) where[ind[a]] = a;
+
+    for (long a=ptr[i]; a<dpos[i]; a++) {
+      const long k = ind[a];
+      val[a] /= val[dpos[k]];
+      for (long b=dpos[k]+1; b<ptr[k+1]; b++) {
+        long w = where[ind[b]];
+        if (w >= 0) val[w] -= val[a] * val[b];
+      }
+    }
+
+    // Guard against (nearly) zero pivots
+    double rownorm = 0;
+    for (long a=ptr[i]; a<ptr[i+1]; a++) rownorm += fabs(val[a]);
+    double tiny = 1e-12 * (rownorm ? rownorm : 1.0);
+    if (fabs(val[dpos[i]]) < tiny) {
+      val[dpos[i]] = (val[dpos[i]] < 0) ? -tiny : tiny;
+    }
+
+    for (long a=ptr[i]; a<ptr[i+1]; a++) where[ind[a]] = -1;
+  }
+}
+
+// ******************************************************************
+// *                                                                *
+// *                        Vector  helpers                         *
+// *                                                                *
+// ******************************************************************
+
+inline double Dot(const double* x, const double* y, long n)
+{
+  double sum = 0;
+  for (long i=0; i<n; i++) sum += x[i] * y[i];
+  return sum;
+}
+
+inline double Norm2(const double* x, long n)
+{
+  return sqrt(Dot(x, x, n));
+}
+
+// ******************************************************************
+// *                                                                *
+// *                         GMRES(m)                               *
+// *                                                                *
+// ******************************************************************
+
+/**
+    Restarted GMRES, with right preconditioning.
+
+    @param  N     System
+    @param  K     Preconditioner
+    @param  x     Solution vector, local indexes.
+                  On input: the initial guess.
+    @param  rhs   Right-hand side, local indexes.
+    @param  opts  options; krylov_dim is the restart value
+    @param  out   Output information; num_iters counts
+                  matrix-vector multiplications
+*/
+template <class MATRIX>
+void New_GMRES(
+          LS_Krylov_System<MATRIX> &N,
+          const LS_Precond &K,
+          double* x,
+          const double* rhs,
+          const LS_Options &opts,
+          LS_Output &out
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+  out.relaxation = 1;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  const long n = N.Size();
+  const int m = (opts.krylov_dim > 0) ? int(opts.krylov_dim) : 1;
+
+  double bnorm = Norm2(rhs, n);
+  if (0==bnorm) bnorm = 1;
+
+  std::vector < std::vector <double> > V(m+1);
+  std::vector <double> H((m+1)*m);   // column major
+  std::vector <double> cs(m), sn(m), g(m+1), y(m);
+  std::vector <double> z, w;
+  try {
+    for (int i=0; i<=m; i++) V[i].resize(n);
+    z.resize(n);
+    w.resize(n);
+  }
+  catch (std::bad_alloc &) {
+    throw LS_Out_Of_Memory;
+  }
+#define HH(i, j) H[(j)*(m+1)+(i)]
+
+  long iters = 0;
+  double relres = 0;
+  for (;;) {
+    //
+    // True residual
+    //
+    N.Apply(x, w.data());
+    for (long i=0; i<n; i++) V[0][i] = rhs[i] - w[i];
+    double beta = Norm2(V[0].data(), n);
+    relres = beta / bnorm;
+    if (opts.debug) {
+      printf("GMRES after %ld iterations: residual %lg\n", iters, relres);
+    }
+    if (relres < opts.precision) {
+      out.status = LS_Success;
+      break;
+    }
+    if (iters >= opts.max_iters) break;
+
+    //
+    // Arnoldi process
+    //
+    for (long i=0; i<n; i++) V[0][i] /= beta;
+    g.assign(m+1, 0.0);
+    g[0] = beta;
+    int k = 0;
+    while ((k<m) && (iters<opts.max_iters)) {
+      K.Solve(V[k].data(), z.data());
+      N.Apply(z.data(), w.data());
+      iters++;
+
+      // modified Gram-Schmidt
+      for (int i=0; i<=k; i++) {
+        double h = Dot(w.data(), V[i].data(), n);
+        HH(i, k) = h;
+        for (long j=0; j<n; j++) w[j] -= h * V[i][j];
+      }
+      double h = Norm2(w.data(), n);
+      HH(k+1, k) = h;
+      if (h) for (long j=0; j<n; j++) V[k+1][j] = w[j] / h;
+
+      // apply previous rotations, then a new one
+      for (int i=0; i<k; i++) {
+        double t = cs[i] * HH(i, k) + sn[i] * HH(i+1, k);
+        HH(i+1, k) = -sn[i] * HH(i, k) + cs[i] * HH(i+1, k);
+        HH(i, k) = t;
+      }
+      double r = sqrt(HH(k, k)*HH(k, k) + h*h);
+      if (r) {
+        cs[k] = HH(k, k) / r;
+        sn[k] = h / r;
+      } else {
+        cs[k] = 1;
+        sn[k] = 0;
+      }
+      HH(k, k) = r;
+      HH(k+1, k) = 0;
+      g[k+1] = -sn[k] * g[k];
+      g[k] = cs[k] * g[k];
+      k++;
+
+      if (0==h) break;    // lucky breakdown
+      if (fabs(g[k]) / bnorm < opts.precision) break;
+    } // while k
+
+    //
+    // Update x: solve the triangular system, then x += K^{-1} V y
+    //
+    for (int i=k-1; i>=0; i--) {
+      double sum = g[i];
+      for (int j=i+1; j<k; j++) sum -= HH(i, j) * y[j];
+      y[i] = HH(i, i) ? sum / HH(i, i) : 0;
+    }
+    for (long j=0; j<n; j++) w[j] = 0;
+    for (int i=0; i<k; i++) {
+      for (long j=0; j<n; j++) w[j] += y[i] * V[i][j];
+    }
+    K.Solve(w.data(), z.data());
+    for (long j=0; j<n; j++) x[j] += z[j];
+  } // for (;;)
+#undef HH
+
+  out.num_iters = iters;
+  out.precision = relres;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                           BiCGSTAB                             *
+// *                                                                *
+// ******************************************************************
+
+/**
+    BiCGSTAB, with right preconditioning.
+
+    @param  N     System
+    @param  K     Preconditioner
+    @param  x     Solution vector, local indexes.
+                  On input: the initial guess.
+    @param  rhs   Right-hand side, local indexes.
+    @param  opts  options
+    @param  out   Output information; each iteration
+                  requires two matrix-vector multiplications
+*/
+template <class MATRIX>
+void New_BiCGSTAB(
+          LS_Krylov_System<MATRIX> &N,
+          const LS_Precond &K,
+          double* x,
+          const double* rhs,
+          const LS_Options &opts,
+          LS_Output &out
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+  out.relaxation = 1;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  const long n = N.Size();
+
+  double bnorm = Norm2(rhs, n);
+  if (0==bnorm) bnorm = 1;
+
+  std::vector <double> r, rhat, p, v, phat, s, shat, t;
+  try {
+    r.resize(n);
+    rhat.resize(n);
+    p.assign(n, 0.0);
+    v.assign(n, 0.0);
+    phat.resize(n);
+    s.resize(n);
+    shat.resize(n);
+    t.resize(n);
+  }
+  catch (std::bad_alloc &) {
+    throw LS_Out_Of_Memory;
+  }
+
+  N.Apply(x, t.data());
+  for (long i=0; i<n; i++) rhat[i] = r[i] = rhs[i] - t[i];
+  double relres = Norm2(r.data(), n) / bnorm;
+  double rho = 1, alpha = 1, omega = 1;
+
+  long iters;
+  for (iters=0; iters<opts.max_iters; ) {
+    if (opts.debug) {
+      printf("BiCGSTAB after %ld iterations: residual %lg\n", iters, relres);
+    }
+    if (relres < opts.precision) {
+      out.status = LS_Success;
+      break;
+    }
+    iters++;
+
+    double rho_new = Dot(rhat.data(), r.data(), n);
+    if (0==rho_new || 0==omega) {
+      // breakdown; start over from the current residual
+      for (long i=0; i<n; i++) {
+        rhat[i] = r[i];
+        p[i] = v[i] = 0;
+      }
+      rho = alpha = omega = 1;
+      rho_new = Dot(r.data(), r.data(), n);
+    }
+    double beta = (rho_new / rho) * (alpha / omega);
+    rho = rho_new;
+    for (long i=0; i<n; i++) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+
+    K.Solve(p.data(), phat.data());
+    N.Apply(phat.data(), v.data());
+    double rv = Dot(rhat.data(), v.data(), n);
+    if (0==rv) {
+      out.status = LS_No_Convergence;
+      break;
+    }
+    alpha = rho / rv;
+    for (long i=0; i<n; i++) s[i] = r[i] - alpha * v[i];
+
+    double snorm = Norm2(s.data(), n) / bnorm;
+    if (snorm < opts.precision) {
+      for (long i=0; i<n; i++) x[i] += alpha * phat[i];
+      relres = snorm;
+      out.status = LS_Success;
+      break;
+    }
+
+    K.Solve(s.data(), shat.data());
+    N.Apply(shat.data(), t.data());
+    double tt = Dot(t.data(), t.data(), n);
+    omega = tt ? Dot(t.data(), s.data(), n) / tt : 0;
+
+    for (long i=0; i<n; i++) {
+      x[i] += alpha * phat[i] + omega * shat[i];
+      r[i] = s[i] - omega * t[i];
+    }
+    relres = Norm2(r.data(), n) / bnorm;
+  } // for iters
+
+  out.num_iters = iters;
+  out.precision = relres;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                      Front end  templates                      *
+// *                                                                *
+// ******************************************************************
+
+template <class MATRIX>
+void Krylov_Solve(LS_Krylov_System<MATRIX> &N, double* x, const double* rhs,
+  const LS_Options &opts, LS_Output &out)
+{
+  LS_Precond* K = 0;
+  switch (opts.precond) {
+    case LS_Precond_Jacobi:
+        K = new LS_Diag_Precond(N);
+        break;
+
+    case LS_Precond_ILU0:
+        K = new LS_ILU0_Precond(N);
+        break;
+
+    default:
+        K = new LS_Identity_Precond(N.Size());
+  }
+  try {
+    if (LS_GMRES == opts.method) {
+      New_GMRES(N, *K, x, rhs, opts, out);
+    } else {
+      New_BiCGSTAB(N, *K, x, rhs, opts, out);
+    }
+  }
+  catch (LS_Error e) {
+    delete K;
+    throw e;
+  }
+  delete K;
+}
+
+/**
+    Solve Ax=0 with a projection method.
+    The MATRIX class must provide
+    MatrixVectorMultiply(y, x), one_over_diag[],
+    Start(), Stop() and Size().
+*/
+template <class MATRIX>
+void Krylov_Ax0(const MATRIX &A, double *x, const LS_Options &opts,
+  LS_Output &out)
+{
+  const long n = A.Stop() - A.Start();
+  if (n < 1) {
+    out.status = LS_Success;
+    out.num_iters = 0;
+    out.precision = 0;
+    return;
+  }
+  double* lx = x + A.Start();
+
+  // Fix the largest element of the initial guess
+  long p = 0;
+  for (long i=1; i<n; i++) if (fabs(lx[i]) > fabs(lx[p])) p = i;
+  if (0==lx[p]) {
+    for (long i=0; i<n; i++) lx[i] = 1;
+  }
+  double scale = 1.0 / lx[p];
+  for (long i=0; i<n; i++) lx[i] *= scale;
+
+  LS_Krylov_System<MATRIX> N(A, p);
+  std::vector <double> rhs;
+  try {
+    rhs.resize(n);
+  }
+  catch (std::bad_alloc &) {
+    throw LS_Out_Of_Memory;
+  }
+  N.PivotColumn(rhs.data());
+  for (long i=0; i<n; i++) rhs[i] = -rhs[i];
+  rhs[p] = 1;
+
+  Krylov_Solve(N, lx, rhs.data(), opts, out);
+
+  // Normalize
+  double total = 0;
+  for (long i=0; i<n; i++) total += lx[i];
+  if (total) {
+    total = 1.0 / total;
+    for (long i=0; i<n; i++) lx[i] *= total;
+  }
+}
+
+/**
+    Solve Ax=b with a projection method.
+    Elements of x outside Start(), ..., Stop()-1 are constants.
+*/
+template <class MATRIX, class VECTOR>
+void Krylov_Axb(const MATRIX &A, double *x, const VECTOR &b,
+  const LS_Options &opts, LS_Output &out)
+{
+  const long n = A.Stop() - A.Start();
+  if (n < 1) {
+    out.status = LS_Success;
+    out.num_iters = 0;
+    out.precision = 0;
+    return;
+  }
+  LS_Krylov_System<MATRIX> N(A, -1);
+  std::vector <double> rhs, negb;
+  try {
+    rhs.resize(n);
+    negb.assign(A.Size(), 0.0);
+  }
+  catch (std::bad_alloc &) {
+    throw LS_Out_Of_Memory;
+  }
+  b.CopyNegativeToFull(negb.data(), A.Start(), A.Stop());
+  N.OutsideProduct(x, rhs.data());
+  for (long i=0; i<n; i++) rhs[i] = -negb[A.Start()+i] - rhs[i];
+
+  Krylov_Solve(N, x + A.Start(), rhs.data(), opts, out);
+}
+
+#endif
@@ -14,6 +14,10 @@ template <class T> inline T MAX(T X,T Y) { return ((X>Y)?X:Y); }
 
 #include "vectors.hh"
 #include "debug.hh"
+#include "threads.hh"
+#include "coloring.hh"
+#include "krylov.hh"
+#include "aggregation.hh"
 
 #include "row_gs_ax0.hh"
 #include "row_jac_ax0.hh"
@@ -23,8 +27,10 @@ template <class T> inline T MAX(T X,T Y) { return ((X>Y)?X:Y); }
 #include "row_jac_axb.hh"
 #include "vmm_jac_axb.hh"
 
+#include "block_axb.hh"
+
 const int MAJOR_VERSION = 2;
-const int MINOR_VERSION = 1;
+const int MINOR_VERSION = 6;
 
 // ******************************************************************
 // *                                                                *
@@ -69,6 +75,132 @@ void LS_Generic_Matrix::RowDotProduct(long, const double*, double &) const
 // *                                                                *
 // ******************************************************************
 
+// Multi-threaded solvers, for explicit matrices.
+template <class MATRIX>
+void Threaded_Ax0_Solver(const MATRIX &A, double *x, const LS_Options &opts, 
+      LS_Output &out)
+{
+  LS_Team team(opts.num_threads);
+  team.Split(A);
+  float* fold;
+  double* dold;
+  switch (opts.method) {
+    case LS_Jacobi:
+        PrepareMultiply(team, A);
+        if (opts.float_vectors) {
+            fold = (float*) malloc(A.Size() * sizeof(float));
+            if (NULL==fold) throw LS_Out_Of_Memory;
+            if (opts.use_relaxation) {
+                Par_VMMJacobi_Ax0<true>(A, x, fold, team, opts, out);
+            } else {
+                Par_VMMJacobi_Ax0<false>(A, x, fold, team, opts, out);
+            }
+            free(fold);
+        } else { 
+            dold = (double*) malloc(A.Size() * sizeof(double));
+            if (NULL==dold) throw LS_Out_Of_Memory;
+            if (opts.use_relaxation) {
+                Par_VMMJacobi_Ax0<true>(A, x, dold, team, opts, out);
+            } else {
+                Par_VMMJacobi_Ax0<false>(A, x, dold, team, opts, out);
+            }
+            free(dold);
+        } 
+        return;    
+
+    case LS_Row_Jacobi:
+        if (opts.float_vectors) {
+            fold = (float*) malloc(A.Size() * sizeof(float));
+            if (NULL==fold) throw LS_Out_Of_Memory;
+            if (opts.use_relaxation) {
+                Par_RowJacobi_Ax0<true>(A, x, fold, team, opts, out);
+            } else {
+                Par_RowJacobi_Ax0<false>(A, x, fold, team, opts, out);
+            }
+            free(fold);
+        } else { 
+            dold = (double*) malloc(A.Size() * sizeof(double));
+            if (NULL==dold) throw LS_Out_Of_Memory;
+            if (opts.use_relaxation) {
+                Par_RowJacobi_Ax0<true>(A, x, dold, team, opts, out);
+            } else {
+                Par_RowJacobi_Ax0<false>(A, x, dold, team, opts, out);
+            }
+            free(dold);
+        } 
+        return;    
+
+    case LS_Gauss_Seidel:
+        {
+          LS_Coloring C;
+          C.Build(A, team.Size(), opts.gs_blocks);
+          if (opts.use_relaxation) {
+              Par_RowGS_Ax0<true>(A, x, C, team, opts, out);
+          } else {
+              Par_RowGS_Ax0<false>(A, x, C, team, opts, out);
+          }
+        }
+        return;    
+
+    default:
+        out.status = LS_Not_Implemented;
+        return;
+  } 
+}
+
+// Use threads, if we can; returns true on success.
+template <class REAL>
+inline bool Threaded_Ax0(const LS_CRS_Matrix<REAL> &A, double *x, 
+      const LS_Options &opts, LS_Output &out)
+{
+  Threaded_Ax0_Solver(A, x, opts, out);
+  return true;
+}
+
+template <class REAL>
+inline bool Threaded_Ax0(const LS_CCS_Matrix<REAL> &A, double *x, 
+      const LS_Options &opts, LS_Output &out)
+{
+  Threaded_Ax0_Solver(A, x, opts, out);
+  return true;
+}
+
+inline bool Threaded_Ax0(const LS_CRS_Indexed_Matrix &A, double *x, 
+      const LS_Options &opts, LS_Output &out)
+{
+  Threaded_Ax0_Solver(A, x, opts, out);
+  return true;
+}
+
+inline bool Threaded_Ax0(const LS_CCS_Indexed_Matrix &A, double *x, 
+      const LS_Options &opts, LS_Output &out)
+{
+  Threaded_Ax0_Solver(A, x, opts, out);
+  return true;
+}
+
+inline bool Threaded_Ax0(const LS_Generic_Matrix &, double *, 
+      const LS_Options &, LS_Output &)
+{
+  // We don't know if the user's matrix is thread safe
+  return false;
+}
+
+// Can the method use more than one thread?
+inline bool ThreadsSupported(const LS_Options &opts)
+{
+  if (opts.num_threads <= 1) return true;
+  switch (opts.method) {
+    case LS_Jacobi:
+    case LS_Row_Jacobi:
+    case LS_Gauss_Seidel:
+        return true;
+
+    default:
+        return false;
+  }
+}
+
 // Decide which solver to call.
 template <class MATRIX>
 void Ax0_Solver(const MATRIX &A, double *x, const LS_Options &opts, LS_Output &out)
@@ -76,6 +208,10 @@ void Ax0_Solver(const MATRIX &A, double *x, const LS_Options &opts, LS_Output &o
   if (opts.debug) {
     DebugMatrix(A);
   }
+  if (!ThreadsSupported(opts)) {
+    out.status = LS_Not_Implemented;
+    return;
+  }
   float* fold;
   double* dold;
   switch (opts.method) {
@@ -85,6 +221,9 @@ void Ax0_Solver(const MATRIX &A, double *x, const LS_Options &opts, LS_Output &o
 
 
     case LS_Jacobi:
+        if (opts.num_threads > 1) {
+            if (Threaded_Ax0(A, x, opts, out)) return;
+        }
         if (opts.float_vectors) {
             fold = (float*) malloc(A.Size() * sizeof(float));
             if (NULL==fold) throw LS_Out_Of_Memory;
@@ -107,6 +246,9 @@ void Ax0_Solver(const MATRIX &A, double *x, const LS_Options &opts, LS_Output &o
         return;    
 
     case LS_Row_Jacobi:
+        if (opts.num_threads > 1) {
+            if (Threaded_Ax0(A, x, opts, out)) return;
+        }
         if (opts.float_vectors) {
             fold = (float*) malloc(A.Size() * sizeof(float));
             if (NULL==fold) throw LS_Out_Of_Memory;
@@ -129,6 +271,9 @@ void Ax0_Solver(const MATRIX &A, double *x, const LS_Options &opts, LS_Output &o
         return;    
 
     case LS_Gauss_Seidel:
+        if (opts.num_threads > 1) {
+            if (Threaded_Ax0(A, x, opts, out)) return;
+        }
         if (opts.use_relaxation) {
             New_RowGS_Ax0<true>(A, x, opts, out);
         } else {
@@ -136,6 +281,15 @@ void Ax0_Solver(const MATRIX &A, double *x, const LS_Options &opts, LS_Output &o
         }
         return;    
 
+    case LS_GMRES:
+    case LS_BiCGSTAB:
+        Krylov_Ax0(A, x, opts, out);
+        return;
+
+    case LS_Aggregation:
+        New_Aggregation_Ax0(A, x, opts, out);
+        return;
+
     default:
         out.status = LS_Not_Implemented;
         return;
@@ -146,6 +300,118 @@ void Ax0_Solver(const MATRIX &A, double *x, const LS_Options &opts, LS_Output &o
 // ******************************************************************
 
 
+// Multi-threaded solvers, for explicit matrices.
+template <class MATRIX, class VECTOR>
+void Threaded_Axb_Solver(const MATRIX &A, double *x, const VECTOR &b, 
+      const LS_Options &opts, LS_Output &out)
+{
+  LS_Team team(opts.num_threads);
+  team.Split(A);
+  float* fold;
+  double* dold;
+  switch (opts.method) {
+    case LS_Jacobi:
+        PrepareMultiply(team, A);
+        if (opts.float_vectors) {
+            fold = (float*) malloc(A.Size() * sizeof(float));
+            if (NULL==fold) throw LS_Out_Of_Memory;
+            if (opts.use_relaxation) {
+                Par_VMMJacobi_Axb<true>(A, x, b, fold, team, opts, out);
+            } else {
+                Par_VMMJacobi_Axb<false>(A, x, b, fold, team, opts, out);
+            }
+            free(fold);
+        } else { 
+            dold = (double*) malloc(A.Size() * sizeof(double));
+            if (NULL==dold) throw LS_Out_Of_Memory;
+            if (opts.use_relaxation) {
+                Par_VMMJacobi_Axb<true>(A, x, b, dold, team, opts, out);
+            } else {
+                Par_VMMJacobi_Axb<false>(A, x, b, dold, team, opts, out);
+            }
+            free(dold);
+        } 
+        return;    
+
+    case LS_Row_Jacobi:
+        if (opts.float_vectors) {
+            fold = (float*) malloc(A.Size() * sizeof(float));
+            if (NULL==fold) throw LS_Out_Of_Memory;
+            if (opts.use_relaxation)
+                Par_RowJacobi_Axb<true>(A, x, b, fold, team, opts, out);
+            else
+                Par_RowJacobi_Axb<false>(A, x, b, fold, team, opts, out);
+            free(fold);
+        } else { 
+            dold = (double*) malloc(A.Size() * sizeof(double));
+            if (NULL==dold) throw LS_Out_Of_Memory;
+            if (opts.use_relaxation)
+                Par_RowJacobi_Axb<true>(A, x, b, dold, team, opts, out);
+            else
+                Par_RowJacobi_Axb<false>(A, x, b, dold, team, opts, out);
+            free(dold);
+        } 
+        return;    
+
+    case LS_Gauss_Seidel:
+        {
+          LS_Coloring C;
+          C.Build(A, team.Size(), opts.gs_blocks);
+          if (opts.use_relaxation) {
+              Par_RowGS_Axb<true>(A, x, b, C, team, opts, out);
+          } else {
+              Par_RowGS_Axb<false>(A, x, b, C, team, opts, out);
+          }
+        }
+        return;    
+
+    default:
+        out.status = LS_Illegal_Method;
+        return;
+  } 
+}
+
+// Use threads, if we can; returns true on success.
+template <class REAL, class VECTOR>
+inline bool Threaded_Axb(const LS_CRS_Matrix<REAL> &A, double *x, 
+      const VECTOR &b, const LS_Options &opts, LS_Output &out)
+{
+  Threaded_Axb_Solver(A, x, b, opts, out);
+  return true;
+}
+
+template <class REAL, class VECTOR>
+inline bool Threaded_Axb(const LS_CCS_Matrix<REAL> &A, double *x, 
+      const VECTOR &b, const LS_Options &opts, LS_Output &out)
+{
+  Threaded_Axb_Solver(A, x, b, opts, out);
+  return true;
+}
+
+template <class VECTOR>
+inline bool Threaded_Axb(const LS_CRS_Indexed_Matrix &A, double *x, 
+      const VECTOR &b, const LS_Options &opts, LS_Output &out)
+{
+  Threaded_Axb_Solver(A, x, b, opts, out);
+  return true;
+}
+
+template <class VECTOR>
+inline bool Threaded_Axb(const LS_CCS_Indexed_Matrix &A, double *x, 
+      const VECTOR &b, const LS_Options &opts, LS_Output &out)
+{
+  Threaded_Axb_Solver(A, x, b, opts, out);
+  return true;
+}
+
+template <class VECTOR>
+inline bool Threaded_Axb(const LS_Generic_Matrix &, double *, 
+      const VECTOR &, const LS_Options &, LS_Output &)
+{
+  // We don't know if the user's matrix is thread safe
+  return false;
+}
+
 // Decide which solver to call.
 template <class MATRIX, class VECTOR>
 void Axb_Solver(const MATRIX &A, double *x, const VECTOR &b, 
@@ -155,10 +421,17 @@ void Axb_Solver(const MATRIX &A, double *x, const VECTOR &b,
     DebugMatrix(A);
     DebugVector(b);
   }
+  if (!ThreadsSupported(opts)) {
+    out.status = LS_Not_Implemented;
+    return;
+  }
   float* fold;
   double* dold;
   switch (opts.method) {
     case LS_Jacobi:
+        if (opts.num_threads > 1) {
+            if (Threaded_Axb(A, x, b, opts, out)) return;
+        }
         if (opts.float_vectors) {
             fold = (float*) malloc(A.Size() * sizeof(float));
             if (NULL==fold) throw LS_Out_Of_Memory;
@@ -181,6 +454,9 @@ void Axb_Solver(const MATRIX &A, double *x, const VECTOR &b,
         return;    
 
     case LS_Row_Jacobi:
+        if (opts.num_threads > 1) {
+            if (Threaded_Axb(A, x, b, opts, out)) return;
+        }
         if (opts.float_vectors) {
             fold = (float*) malloc(A.Size() * sizeof(float));
             if (NULL==fold) throw LS_Out_Of_Memory;
@@ -201,6 +477,9 @@ void Axb_Solver(const MATRIX &A, double *x, const VECTOR &b,
         return;    
 
     case LS_Gauss_Seidel:
+        if (opts.num_threads > 1) {
+            if (Threaded_Axb(A, x, b, opts, out)) return;
+        }
         if (opts.use_relaxation) {
             New_RowGS_Axb<true>(A, x, b, opts, out);
         } else {
@@ -208,6 +487,20 @@ void Axb_Solver(const MATRIX &A, double *x, const VECTOR &b,
         }
         return;    
 
+    case LS_GMRES:
+    case LS_BiCGSTAB:
+        Krylov_Axb(A, x, b, opts, out);
+        return;
+
+    case LS_Aggregation:
+        {
+          // Nothing to aggregate; use Gauss-Seidel instead
+          LS_Options gsopts = opts;
+          gsopts.method = LS_Gauss_Seidel;
+          Axb_Solver(A, x, b, gsopts, out);
+        }
+        return;
+
     default:
         out.status = LS_Illegal_Method;
         return;
@@ -246,6 +539,71 @@ void Axb_VectorExpand(const MATRIX &A, double *x, const LS_Vector &b,
 }
 
 
+// Block solvers.
+template <class MATRIX>
+void Block_Axb_Solver(const MATRIX &A, double *X, const double* B, int k,
+      const LS_Options &opts, LS_Output &out)
+{
+  double* Xold;
+  switch (opts.method) {
+    case LS_Jacobi:
+    case LS_Row_Jacobi:
+        Xold = (double*) malloc(A.Size() * k * sizeof(double));
+        if (NULL==Xold) throw LS_Out_Of_Memory;
+        if (opts.use_relaxation)
+            New_Block_RowJacobi_Axb<true>(A, X, B, k, Xold, opts, out);
+        else
+            New_Block_RowJacobi_Axb<false>(A, X, B, k, Xold, opts, out);
+        free(Xold);
+        return;
+
+    case LS_Gauss_Seidel:
+    case LS_Aggregation:
+        // Nothing to aggregate; use Gauss-Seidel
+        if (opts.use_relaxation)
+            New_Block_RowGS_Axb<true>(A, X, B, k, opts, out);
+        else
+            New_Block_RowGS_Axb<false>(A, X, B, k, opts, out);
+        return;
+
+    default:
+        break;
+  }
+
+  //
+  // One vector at a time
+  //
+  const long size = A.Size();
+  double* x = (double*) malloc(2 * size * sizeof(double));
+  if (NULL==x) throw LS_Out_Of_Memory;
+  double* b = x + size;
+  LS_Vector bv;
+  bv.size = size;
+  bv.index = 0;
+  bv.d_value = b;
+  bv.f_value = 0;
+
+  out.status = LS_Success;
+  out.num_iters = 0;
+  out.precision = 0;
+  out.relaxation = 1;
+  for (int j=0; j<k; j++) {
+    for (long i=0; i<size; i++) {
+      x[i] = X[i*k+j];
+      b[i] = B[i*k+j];
+    }
+    LS_Output oj;
+    Axb_VectorExpand(A, x, bv, opts, oj);
+    for (long i=0; i<size; i++) X[i*k+j] = x[i];
+    out.num_iters = MAX(out.num_iters, oj.num_iters);
+    out.precision = MAX(out.precision, oj.precision);
+    out.relaxation = oj.relaxation;
+    if (oj.status != LS_Success) out.status = oj.status;
+  }
+  free(x);
+}
+
+
 // ******************************************************************
 // *                                                                *
 // *                                                                *
@@ -306,6 +664,26 @@ void Solve_AxZero(const LS_CCS_Matrix_double &A, double* x, const LS_Options &op
   };
 }
 
+void Solve_AxZero(const LS_CRS_Indexed_Matrix &A, double* x, const LS_Options &opts, LS_Output &out)
+{
+  try {
+    Ax0_Solver(A, x, opts, out);
+  }
+  catch (LS_Error e) {
+    out.status = e;
+  };
+}
+
+void Solve_AxZero(const LS_CCS_Indexed_Matrix &A, double* x, const LS_Options &opts, LS_Output &out)
+{
+  try {
+    Ax0_Solver(A, x, opts, out);
+  }
+  catch (LS_Error e) {
+    out.status = e;
+  };
+}
+
 void Solve_AxZero(const LS_Generic_Matrix &A, double* x, const LS_Options &opts, LS_Output &out)
 {
   try {
@@ -358,6 +736,26 @@ void Solve_Axb(const LS_CCS_Matrix_double &A, double* x, const LS_Vector &b, con
   }
 }
 
+void Solve_Axb(const LS_CRS_Indexed_Matrix &A, double* x, const LS_Vector &b, const LS_Options &opts, LS_Output &out)
+{
+  try {
+    Axb_VectorExpand(A, x, b, opts, out);
+  }
+  catch (LS_Error e) {
+    out.status = e;
+  }
+}
+
+void Solve_Axb(const LS_CCS_Indexed_Matrix &A, double* x, const LS_Vector &b, const LS_Options &opts, LS_Output &out)
+{
+  try {
+    Axb_VectorExpand(A, x, b, opts, out);
+  }
+  catch (LS_Error e) {
+    out.status = e;
+  }
+}
+
 void Solve_Axb(const LS_Generic_Matrix &A, double* x, const LS_Vector &b, const LS_Options &opts, LS_Output &out)
 {
   try {
@@ -368,4 +766,34 @@ void Solve_Axb(const LS_Generic_Matrix &A, double* x, const LS_Vector &b, const
   }
 }
 
+// ******************************************************************
+
+void Solve_Axb_Block(const LS_CRS_Matrix_float &A, double* X, const double* B, int k, const LS_Options &opts, LS_Output &out)
+{
+  try {
+    Block_Axb_Solver(A, X, B, k, opts, out);
+  }
+  catch (LS_Error e) {
+    out.status = e;
+  }
+}
+
+void Solve_Axb_Block(const LS_CRS_Matrix_double &A, double* X, const double* B, int k, const LS_Options &opts, LS_Output &out)
+{
+  try {
+    Block_Axb_Solver(A, X, B, k, opts, out);
+  }
+  catch (LS_Error e) {
+    out.status = e;
+  }
+}
 
+void Solve_Axb_Block(const LS_CRS_Indexed_Matrix &A, double* X, const double* B, int k, const LS_Options &opts, LS_Output &out)
+{
+  try {
+    Block_Axb_Solver(A, X, B, k, opts, out);
+  }
+  catch (LS_Error e) {
+    out.status = e;
+  }
+}
@@ -20,12 +20,40 @@ enum LS_Method {
   LS_Jacobi,
 
   ///  Gauss-Seidel method.
-  LS_Gauss_Seidel
+  LS_Gauss_Seidel,
+
+  ///  Restarted GMRES, a projection method.
+  LS_GMRES,
+
+  ///  BiCGSTAB, a projection method.
+  LS_BiCGSTAB,
+
+  /**  Iterative aggregation-disaggregation, with a
+       Gauss-Seidel sweep in each iteration.
+       For Ax = 0 systems, on explicit (CRS or CCS) matrices, only;
+       Ax = b systems are solved with Gauss-Seidel instead.
+  */
+  LS_Aggregation
 
   // other, fancy methods?  block methods?
 };
 
 
+///  Preconditioners, for the projection methods.
+enum LS_Preconditioner {
+  ///  No preconditioning.
+  LS_Precond_None,
+
+  ///  Divide by the diagonal.
+  LS_Precond_Jacobi,
+
+  /**  Incomplete LU factorization, without fill.
+       Requires an explicit (CRS or CCS) matrix.
+  */
+  LS_Precond_ILU0
+};
+
+
 /// Error codes.
 enum LS_Error {
   /// No errors.
@@ -71,6 +99,45 @@ struct LS_Options {
   bool use_relative;
   /// Desired precision
   double precision;
+  /** Number of threads to use.
+      Only the Jacobi and Gauss-Seidel methods, on explicit
+      (CRS or CCS) matrices, currently use more than one thread.
+      Gauss-Seidel then visits the rows by color (see gs_blocks),
+      so the iterations differ from the single thread version;
+      the fewer the colors, the closer the iterations are to
+      those of a single thread.
+      The Ax=0 and Ax=b solvers report LS_Not_Implemented
+      if more than one thread is requested for any other method;
+      the block solvers always use one thread.
+  */
+  long num_threads;
+  /** For Gauss-Seidel with more than one thread:
+      number of blocks of consecutive rows, with about the same
+      number of nonzeroes.  Rows within a block are updated in order,
+      and blocks are colored so that blocks of the same color do not
+      use each other's elements.  Zero colors single rows instead,
+      which gives the most parallelism but usually the most iterations.
+      The iterations depend on the blocks, but not on num_threads.
+  */
+  long gs_blocks;
+  /** Preconditioner, for GMRES and BiCGSTAB.
+      For these methods, the precision is that of the residual
+      (2-norm, relative to the right-hand side), and min_iters is ignored.
+  */
+  LS_Preconditioner precond;
+  /// Krylov subspace dimension before restarting GMRES.
+  long krylov_dim;
+  /** Partition of the states, for aggregation.
+      If not null, aggregates[s] is the block containing state s;
+      otherwise, blocks are found using aggregate_threshold.
+  */
+  const long* aggregates;
+  /** For aggregation without a given partition:
+      two states are in the same block if they are connected
+      through entries at least this fraction of the largest
+      rate out of the same state.
+  */
+  double aggregate_threshold;
 public:
   /// Constructor.  Allows us to set reasonable defaults.
   LS_Options() {
@@ -83,6 +150,12 @@ public:
     max_iters = 10000;
     use_relative = 1;
     precision = 1e-6;
+    num_threads = 1;
+    gs_blocks = 0;
+    precond = LS_Precond_ILU0;
+    krylov_dim = 30;
+    aggregates = 0;
+    aggregate_threshold = 0.1;
   }
 };
 
@@ -121,6 +194,20 @@ struct LS_Vector {
 };
 
 
+/**
+    Type of the column (or row) index stored for each nonzero
+    of a compressed matrix.  32 bits suffice for any matrix with
+    fewer than 2^31 rows, and index arrays are a large part of
+    the bandwidth of a matrix-vector multiply.  Define
+    LS_LONG_INDEX to use longs instead.
+*/
+#ifdef LS_LONG_INDEX
+typedef long LS_Index;
+#else
+typedef int LS_Index;
+#endif
+
+
 /**
     Matrix in compressed row storage format.
     Except that the diagonal elements are stored separately,
@@ -139,7 +226,7 @@ struct LS_CRS_Matrix {
   /// Array of matrix values, dimension at least #nonzeroes
   const REAL* val;
   /// Array of column indexes, dimension at least #nonzeroes
-  const long* col_ind;
+  const LS_Index* col_ind;
   /// Array of row pointers, dimension at least stop+1.
   const long* row_ptr;
 
@@ -154,6 +241,9 @@ public:
   inline long Stop() const { return stop; }
   inline long Size() const { return size; }
 
+  /// Value of entry a.
+  inline double Value(long a) const { return val[a]; }
+
   /**
       Compute y += (this without diagonals) * x
   */
@@ -167,6 +257,26 @@ public:
       }
   }
 
+  /**
+      Compute y += (this without diagonals) * x,
+      for rows lo, ..., hi-1 of y only.
+  */
+  template <class REAL2>
+  inline void MatrixVectorMultiply(double *y, const REAL2* x,
+    long lo, long hi) const {
+      long a = row_ptr[lo];
+      for (long i=lo; i<hi; i++) {
+        for ( ; a < row_ptr[i+1]; a++) {
+          y[i] += x[col_ind[a]] * val[a];
+        }
+      }
+  }
+
+  /// Number of stored entries in rows lo, ..., hi-1.
+  inline long NumEntries(long lo, long hi) const {
+      return row_ptr[hi] - row_ptr[lo];
+  }
+
   /**
       Compute y += x * (this without diagonals) 
   */
@@ -190,6 +300,51 @@ public:
       }
   }
 
+  /**
+      Compute Y += X * (this without diagonals), for a block of k
+      vectors stored interleaved: element i of vector j is X[i*k+j].
+      Each matrix entry is read once, for all k vectors.
+  */
+  inline void BlockVectorMatrixMultiply(double *Y, const double* X, int k) const {
+      long a = row_ptr[start];
+      for (long i=start; i<stop; i++) {
+        const double* xi = X + i*k;
+        for ( ; a < row_ptr[i+1]; a++) {
+          double* yj = Y + long(col_ind[a])*k;
+          const double v = val[a];
+          for (int j=0; j<k; j++) yj[j] += xi[j] * v;
+        }
+      }
+  }
+
+  /**
+      Compute Y += (this without diagonals) * X, for a block of k
+      vectors stored interleaved, as in BlockVectorMatrixMultiply().
+  */
+  inline void BlockMatrixVectorMultiply(double *Y, const double* X, int k) const {
+      long a = row_ptr[start];
+      for (long i=start; i<stop; i++) {
+        double* yi = Y + i*k;
+        for ( ; a < row_ptr[i+1]; a++) {
+          const double* xj = X + long(col_ind[a])*k;
+          const double v = val[a];
+          for (int j=0; j<k; j++) yi[j] += xj[j] * v;
+        }
+      }
+  }
+
+  /**
+      Compute sum[j] += (row i of this matrix without diagonals) * X_j,
+      for the k interleaved vectors X_j.
+  */
+  inline void BlockRowDotProduct(long i, const double* X, int k, double* sum) const {
+      for (long a = row_ptr[i]; a < row_ptr[i+1]; a++) {
+        const double* xj = X + long(col_ind[a])*k;
+        const double v = val[a];
+        for (int j=0; j<k; j++) sum[j] += xj[j] * v;
+      }
+  }
+
 };
 
 
@@ -224,7 +379,7 @@ struct LS_CCS_Matrix {
   /// Array of matrix values, dimension at least #nonzeroes
   const REAL* val;
   /// Array of row indexes, dimension at least #nonzeroes
-  const long* row_ind;
+  const LS_Index* row_ind;
   /// Array of col pointers, dimension at least stop+1.
   const long* col_ptr;
 
@@ -238,6 +393,9 @@ public:
   inline long Start() const { return start; }
   inline long Stop() const { return stop; }
   inline long Size() const { return size; }
+
+  /// Value of entry a.
+  inline double Value(long a) const { return val[a]; }
   
   /**
       Compute y += (this without diagonals) * x
@@ -252,6 +410,26 @@ public:
       }
   }
 
+  /**
+      Compute y += (this without diagonals) * x,
+      using columns lo, ..., hi-1 only.
+  */
+  template <class REAL2>
+  inline void MatrixVectorMultiply(double *y, const REAL2* x,
+    long lo, long hi) const {
+      long a = col_ptr[lo];
+      for (long i=lo; i<hi; i++) {
+        for ( ; a < col_ptr[i+1]; a++) {
+          y[row_ind[a]] += x[i] * val[a];
+        }
+      }
+  }
+
+  /// Number of stored entries in columns lo, ..., hi-1.
+  inline long NumEntries(long lo, long hi) const {
+      return col_ptr[hi] - col_ptr[lo];
+  }
+
   /**
       Compute y += x * (this without diagonals) 
   */
@@ -281,6 +459,227 @@ struct LS_CCS_Matrix_double : public LS_CCS_Matrix<double> { } ;
 
 
 
+/**
+    Matrix in compressed row storage format, with each distinct
+    value stored once, in a dictionary; entries store only the
+    (16-bit) index of their value.  Useful when there are few
+    distinct values, as in most Markov chains from high-level models.
+    Diagonal elements are stored separately,
+    as their negative reciprocals, in a vector.
+*/
+struct LS_CRS_Indexed_Matrix {
+  /// Starting row/col, normally 0
+  long start;
+  /// One plus the last row/col, normally the matrix size
+  long stop;
+  /// Size, as needed for solution vectors
+  long size;
+
+  /// Dictionary of distinct values, dimension at most 65536
+  const double* dict;
+  /// Array of value indexes, dimension at least #nonzeroes
+  const unsigned short* val_index;
+  /// Array of column indexes, dimension at least #nonzeroes
+  const LS_Index* col_ind;
+  /// Array of row pointers, dimension at least stop+1.
+  const long* row_ptr;
+
+public:
+  /// negated reciprocals of diagonals, dimension at least stop+1.
+  const double* one_over_diag;
+
+
+public:
+  
+  inline long Start() const { return start; }
+  inline long Stop() const { return stop; }
+  inline long Size() const { return size; }
+
+  /// Value of entry a.
+  inline double Value(long a) const { return dict[val_index[a]]; }
+
+  /**
+      Compute y += (this without diagonals) * x
+  */
+  template <class REAL2>
+  inline void MatrixVectorMultiply(double *y, const REAL2* x) const {
+      MatrixVectorMultiply(y, x, start, stop);
+  }
+
+  /**
+      Compute y += (this without diagonals) * x,
+      for rows lo, ..., hi-1 of y only.
+  */
+  template <class REAL2>
+  inline void MatrixVectorMultiply(double *y, const REAL2* x,
+    long lo, long hi) const {
+      long a = row_ptr[lo];
+      for (long i=lo; i<hi; i++) {
+        double sum = 0;
+        for ( ; a < row_ptr[i+1]; a++) {
+          sum += x[col_ind[a]] * dict[val_index[a]];
+        }
+        y[i] += sum;
+      }
+  }
+
+  /// Number of stored entries in rows lo, ..., hi-1.
+  inline long NumEntries(long lo, long hi) const {
+      return row_ptr[hi] - row_ptr[lo];
+  }
+
+  /**
+      Compute y += x * (this without diagonals) 
+  */
+  template <class REAL2>
+  inline void VectorMatrixMultiply(double *y, const REAL2* x) const {
+      long a = row_ptr[start];
+      for (long i=start; i<stop; i++) {
+        for ( ; a < row_ptr[i+1]; a++) {
+          y[col_ind[a]] += x[i] * dict[val_index[a]];
+        }
+      }
+  }
+
+  /**
+      Compute sum += (row i of this matrix without diagonals) * x
+  */
+  template <class REAL2>
+  inline void RowDotProduct(long i, const REAL2* x, double &sum) const {
+      for (long a = row_ptr[i]; a < row_ptr[i+1]; a++) {
+        sum += x[col_ind[a]] * dict[val_index[a]];
+      }
+  }
+
+  /**
+      Compute Y += X * (this without diagonals), for a block of k
+      interleaved vectors; see LS_CRS_Matrix.
+  */
+  inline void BlockVectorMatrixMultiply(double *Y, const double* X, int k) const {
+      long a = row_ptr[start];
+      for (long i=start; i<stop; i++) {
+        const double* xi = X + i*k;
+        for ( ; a < row_ptr[i+1]; a++) {
+          double* yj = Y + long(col_ind[a])*k;
+          const double v = dict[val_index[a]];
+          for (int j=0; j<k; j++) yj[j] += xi[j] * v;
+        }
+      }
+  }
+
+  /**
+      Compute Y += (this without diagonals) * X, for a block of k
+      interleaved vectors; see LS_CRS_Matrix.
+  */
+  inline void BlockMatrixVectorMultiply(double *Y, const double* X, int k) const {
+      long a = row_ptr[start];
+      for (long i=start; i<stop; i++) {
+        double* yi = Y + i*k;
+        for ( ; a < row_ptr[i+1]; a++) {
+          const double* xj = X + long(col_ind[a])*k;
+          const double v = dict[val_index[a]];
+          for (int j=0; j<k; j++) yi[j] += xj[j] * v;
+        }
+      }
+  }
+
+  /**
+      Compute sum[j] += (row i of this matrix without diagonals) * X_j,
+      for the k interleaved vectors X_j.
+  */
+  inline void BlockRowDotProduct(long i, const double* X, int k, double* sum) const {
+      for (long a = row_ptr[i]; a < row_ptr[i+1]; a++) {
+        const double* xj = X + long(col_ind[a])*k;
+        const double v = dict[val_index[a]];
+        for (int j=0; j<k; j++) sum[j] += xj[j] * v;
+      }
+  }
+
+};
+
+
+
+/**
+    Matrix in compressed column storage format, with each distinct
+    value stored once, in a dictionary; see LS_CRS_Indexed_Matrix.
+*/
+struct LS_CCS_Indexed_Matrix {
+  /// Starting row/col, normally 0
+  long start;
+  /// One plus the last row/col, normally the matrix size
+  long stop;
+  /// Size, as needed for solution vectors
+  long size;
+
+  /// Dictionary of distinct values, dimension at most 65536
+  const double* dict;
+  /// Array of value indexes, dimension at least #nonzeroes
+  const unsigned short* val_index;
+  /// Array of row indexes, dimension at least #nonzeroes
+  const LS_Index* row_ind;
+  /// Array of col pointers, dimension at least stop+1.
+  const long* col_ptr;
+
+public:
+  /// negated reciprocals of diagonals, dimension at least stop+1.
+  const double* one_over_diag;
+
+
+public:
+
+  inline long Start() const { return start; }
+  inline long Stop() const { return stop; }
+  inline long Size() const { return size; }
+
+  /// Value of entry a.
+  inline double Value(long a) const { return dict[val_index[a]]; }
+  
+  /**
+      Compute y += (this without diagonals) * x
+  */
+  template <class REAL2>
+  inline void MatrixVectorMultiply(double *y, const REAL2* x) const {
+      MatrixVectorMultiply(y, x, start, stop);
+  }
+
+  /**
+      Compute y += (this without diagonals) * x,
+      using columns lo, ..., hi-1 only.
+  */
+  template <class REAL2>
+  inline void MatrixVectorMultiply(double *y, const REAL2* x,
+    long lo, long hi) const {
+      long a = col_ptr[lo];
+      for (long i=lo; i<hi; i++) {
+        const double xi = x[i];
+        for ( ; a < col_ptr[i+1]; a++) {
+          y[row_ind[a]] += xi * dict[val_index[a]];
+        }
+      }
+  }
+
+  /// Number of stored entries in columns lo, ..., hi-1.
+  inline long NumEntries(long lo, long hi) const {
+      return col_ptr[hi] - col_ptr[lo];
+  }
+
+  /**
+      Compute y += x * (this without diagonals) 
+  */
+  template <class REAL2>
+  inline void VectorMatrixMultiply(double *y, const REAL2* x) const {
+      // TBD
+      throw LS_Not_Implemented;
+  }
+
+  template <class REAL2>
+  inline void RowDotProduct(long i, const REAL2* x, double &sum) const {
+    throw LS_Wrong_Format;
+  }
+};
+
+
+
 /**
     Interface for user-defined matrices.
     To use, derive a class from this one and provide
@@ -367,6 +766,8 @@ void Solve_AxZero(const LS_CRS_Matrix_float &A,   double* x, const LS_Options &o
 void Solve_AxZero(const LS_CRS_Matrix_double &A,  double* x, const LS_Options &opts, LS_Output &out);
 void Solve_AxZero(const LS_CCS_Matrix_float &A,   double* x, const LS_Options &opts, LS_Output &out);
 void Solve_AxZero(const LS_CCS_Matrix_double &A,  double* x, const LS_Options &opts, LS_Output &out);
+void Solve_AxZero(const LS_CRS_Indexed_Matrix &A, double* x, const LS_Options &opts, LS_Output &out);
+void Solve_AxZero(const LS_CCS_Indexed_Matrix &A, double* x, const LS_Options &opts, LS_Output &out);
 void Solve_AxZero(const LS_Generic_Matrix &A,     double* x, const LS_Options &opts, LS_Output &out);
 
 
@@ -385,8 +786,32 @@ void Solve_Axb(const LS_CRS_Matrix_float &A,  double* x, const LS_Vector &b, con
 void Solve_Axb(const LS_CRS_Matrix_double &A, double* x, const LS_Vector &b, const LS_Options &opts, LS_Output &out);
 void Solve_Axb(const LS_CCS_Matrix_float &A,  double* x, const LS_Vector &b, const LS_Options &opts, LS_Output &out);
 void Solve_Axb(const LS_CCS_Matrix_double &A, double* x, const LS_Vector &b, const LS_Options &opts, LS_Output &out);
+void Solve_Axb(const LS_CRS_Indexed_Matrix &A, double* x, const LS_Vector &b, const LS_Options &opts, LS_Output &out);
+void Solve_Axb(const LS_CCS_Indexed_Matrix &A, double* x, const LS_Vector &b, const LS_Options &opts, LS_Output &out);
 void Solve_Axb(const LS_Generic_Matrix &A,    double* x, const LS_Vector &b, const LS_Options &opts, LS_Output &out);
 
 
 
+/**  Solve the linear system AX = B for a block of k vectors X.
+     The vectors are stored interleaved: element i of vector j
+     is X[i*k+j], and the same for B (which is full).
+     Gauss-Seidel and the Jacobi methods read the matrix once per
+     iteration for all k vectors, using one thread; other methods
+     solve one vector at a time.  Convergence is checked over the
+     whole block.
+        @param  A     The matrix A.
+        @param  X     The solution vectors, of dimension A.Size()*k.
+                      On input: the initial "guess" solutions to use.
+                      On output: the solutions, if the method converged.
+        @param  B     Right-hand side vectors, of dimension A.Size()*k.
+        @param  k     Number of vectors.
+        @param  opts  Solver options.
+        @param  out   Status of solution.
+*/
+void Solve_Axb_Block(const LS_CRS_Matrix_float &A,   double* X, const double* B, int k, const LS_Options &opts, LS_Output &out);
+void Solve_Axb_Block(const LS_CRS_Matrix_double &A,  double* X, const double* B, int k, const LS_Options &opts, LS_Output &out);
+void Solve_Axb_Block(const LS_CRS_Indexed_Matrix &A, double* X, const double* B, int k, const LS_Options &opts, LS_Output &out);
+
+
+
 #endif
@@ -4,6 +4,8 @@
 
 #include "lslib.h"
 #include "debug.hh"
+#include "threads.hh"
+#include "coloring.hh"
 #include "vectors.hh"
 #include <math.h>
 
@@ -106,5 +108,118 @@ void New_RowGS_Axb(
   out.precision = maxerror;
 }
 
+
+/**
+
+    Multi-threaded Gauss-Seidel solving Ax=b.
+    Rows are visited one color at a time; blocks of the same
+    color do not depend on each other, and are updated by
+    the members of the team at the same time, each block
+    in row order (see LS_Coloring).
+
+    The VECTOR class must provide the following methods:
+      
+      void CopyNegativeToFull(double* x, long start, long stop);
+
+    @param  A     Matrix
+    @param  x     Solution vector
+    @param  b     Constant right-hand side vector
+    @param  C     Coloring of the rows of A, for the team
+    @param  team  Threads to use
+    @param  opts  options
+    @param  out   Output information
+*/
+
+template <bool RELAX, class MATRIX, class VECTOR>
+void Par_RowGS_Axb(
+          const MATRIX &A,          // abstract matrix
+          double *x,                // solution vector
+          const VECTOR &b,          // constant vector (right side)
+          const LS_Coloring &C,     // row colors
+          LS_Team &team,            // worker threads
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  double one_minus_omega;
+  if (RELAX) {
+    out.relaxation = opts.relaxation;
+    one_minus_omega = 1.0 - opts.relaxation;
+  } else {
+    out.relaxation = 1;
+    one_minus_omega = 0;
+  }
+
+  // Rows are not visited in order, so expand -b
+  double* negb = (double*) malloc(A.Size() * sizeof(double));
+  if (NULL==negb) throw LS_Out_Of_Memory;
+  for (long s=A.Start(); s<A.Stop(); s++) negb[s] = 0;
+  b.CopyNegativeToFull(negb, A.Start(), A.Stop());
+
+  std::vector <double> part_error(team.Size());
+  long iters;
+  double maxerror = 0;
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    if (opts.debug)  DebugIter("Gauss-Seidel", iters, x, A.Start(), A.Stop());
+    const bool check = (iters >= opts.min_iters);
+
+    team.Run([&](int t) {
+      double myerror = 0;
+      bool mycheck = check;
+      for (long c=0; c<C.NumColors(); c++) {
+        if (c) team.Barrier();
+        for (long i=C.Low(c, t); i<C.High(c, t); i++) {
+          const long s = C.Row(i);
+
+          double tmp = negb[s];
+          A.RowDotProduct(s, x, tmp);
+
+          if (RELAX) {
+            tmp *= A.one_over_diag[s] * opts.relaxation;
+            tmp += x[s] * one_minus_omega;
+          } else {
+            tmp *= A.one_over_diag[s];
+          }
+
+          double delta = tmp - x[s];
+          x[s] = tmp;
+
+          if (mycheck) {
+            if (opts.use_relative) if (x[s]) delta /= x[s];
+            if (delta<0) delta = -delta;
+            if (delta > myerror) {
+                myerror = delta;
+                if (myerror >= opts.precision)
+                  if (iters < opts.max_iters)
+                    mycheck = false;
+            }
+          }
+
+        } // for i
+      } // for c
+      part_error[t] = myerror;
+    });
+
+    maxerror = 0;
+    for (int t=0; t<team.Size(); t++) {
+      if (part_error[t] > maxerror) maxerror = part_error[t];
+    }
+
+    if (iters < opts.min_iters) continue;
+    if (maxerror < opts.precision) {
+      out.status = LS_Success;
+      break;
+    }
+  } // for iters
+  out.num_iters = iters;
+  out.precision = maxerror;
+  free(negb);
+}
+
 #endif
 
@@ -5,6 +5,7 @@
 #include "lslib.h"
 #include "debug.hh"
 #include "vectors.hh"
+#include "threads.hh"
 #include <math.h>
 
 /**
@@ -128,5 +129,138 @@ void New_RowJacobi_Ax0(
   }
 }
 
+
+/**
+
+    Multi-threaded version of New_RowJacobi_Ax0().
+    Each member of the team updates its own rows.
+
+    @param  A     Matrix
+    @param  x     Vector
+    @param  xold  Auxiliary vector
+    @param  team  Threads to use; rows must be split already
+    @param  opts  options
+    @param  out   Output information
+*/
+
+template <bool RELAX, class MATRIX, class REAL>
+void Par_RowJacobi_Ax0(
+          const MATRIX &A,          // abstract matrix
+          double *xnew,             // solution vector
+          REAL *xold,               // auxiliary vector
+          LS_Team &team,            // worker threads
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  double one_minus_omega;
+  if (RELAX) {
+    out.relaxation = opts.relaxation;
+    one_minus_omega = 1.0 - opts.relaxation;
+  } else {
+    out.relaxation = 1;
+    one_minus_omega = 0;
+  }
+  std::vector <double> part_error(team.Size());
+  std::vector <double> part_total(team.Size());
+  long iters;
+  double maxerror = 0;
+  double total = 1;
+
+  //
+  // Copy xnew into xold
+  //
+  for (long s=A.Stop()-1; s>=A.Start(); s--) {
+    xold[s] = xnew[s];
+  }
+
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    if (opts.debug)  DebugIter("Row Jacobi", iters, xnew, A.Start(), A.Stop());
+
+    const bool check = (iters >= opts.min_iters);
+
+    team.Run([&](int t) {
+      const long lo = team.Low(t);
+      const long hi = team.High(t);
+
+      //
+      // Compute the new vector and total, for our rows
+      //
+      double mytotal = 0.0;
+      for (long s=lo; s<hi; s++) {
+        double tmp = 0.0;
+        A.RowDotProduct(s, xold, tmp);
+
+        if (RELAX) {
+          tmp *= A.one_over_diag[s] * opts.relaxation;
+          tmp += xold[s] * one_minus_omega;
+        } else {
+          tmp *= A.one_over_diag[s];
+        }
+
+        mytotal += (xnew[s] = tmp);
+      } // for s
+
+      //
+      // Determine current precision, for our rows
+      //
+      double myerror = 0;
+      if (check) {
+        for (long s=hi-1; s>=lo; s--) {
+          double delta = xnew[s] - xold[s];
+          if (opts.use_relative) if (xnew[s]) delta /= xnew[s];
+          if (delta<0) delta = -delta;
+          if (delta > myerror) {
+              myerror = delta;
+              if ((myerror >= opts.precision) && (iters < opts.max_iters)) {
+                break;
+              }
+          }
+        } // for s
+      }
+      part_error[t] = myerror;
+      part_total[t] = mytotal;
+    });
+
+    // Combine, in member order
+    maxerror = 0;
+    total = 0.0;
+    for (int t=0; t<team.Size(); t++) {
+      total += part_total[t];
+      if (part_error[t] > maxerror) maxerror = part_error[t];
+    }
+
+    //
+    // Normalize and copy vector over
+    //
+    total = 1.0 / total;
+    team.Run([&](int t) {
+      for (long s=team.High(t)-1; s>=team.Low(t); s--) {
+        xold[s] = xnew[s] * total;
+      }
+    });
+
+    if (iters < opts.min_iters) continue;
+    if (maxerror < opts.precision) {
+      out.status = LS_Success;
+      break;
+    }
+  } // for iters
+  out.num_iters = iters;
+  out.precision = maxerror;
+
+  //
+  // Normalize answer
+  //
+  for (long s=A.Stop()-1; s>=A.Start(); s--) {
+    xnew[s] *= total;
+  }
+}
+
 #endif
 
@@ -5,6 +5,7 @@
 #include "lslib.h"
 #include "debug.hh"
 #include "vectors.hh"
+#include "threads.hh"
 #include <math.h>
 
 /**
@@ -111,5 +112,114 @@ void New_RowJacobi_Axb(
   }
 }
 
+
+/**
+
+    Multi-threaded version of New_RowJacobi_Axb().
+    Each member of the team updates its own rows.
+
+    @param  A     Matrix
+    @param  x     Vector
+    @param  xold  Auxiliary vector
+    @param  team  Threads to use; rows must be split already
+    @param  opts  options
+    @param  out   Output information
+*/
+
+template <bool RELAX, class MATRIX, class VECTOR, class REAL>
+void Par_RowJacobi_Axb(
+          const MATRIX &A,          // abstract matrix
+          double *xnew,             // solution vector
+          const VECTOR &b,          // constant vector (right side)
+          REAL *xold,               // auxiliary vector
+          LS_Team &team,            // worker threads
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  double one_minus_omega;
+  if (RELAX) {
+    out.relaxation = opts.relaxation;
+    one_minus_omega = 1.0 - opts.relaxation;
+  } else {
+    out.relaxation = 1;
+    one_minus_omega = 0;
+  }
+  std::vector <double> part_error(team.Size());
+  double* x = xnew;
+  long iters;
+  double maxerror = 0;
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    if (opts.debug)  DebugIter("Row Jacobi", iters, x, A.Start(), A.Stop());
+
+    SwapAux(xold, x);
+    const bool check = (iters >= opts.min_iters);
+
+    team.Run([&](int t) {
+      const long lo = team.Low(t);
+      const long hi = team.High(t);
+      CopyToAux(xold, x, lo, hi);
+      for (long s=lo; s<hi; s++) x[s] = 0;
+      b.CopyNegativeToFull(x, lo, hi);
+      team.Barrier();
+
+      double myerror = 0;
+      bool mycheck = check;
+      for (long s=lo; s<hi; s++) {
+
+        double tmp = x[s];
+        A.RowDotProduct(s, xold, tmp);
+
+        if (RELAX) {
+          tmp *= A.one_over_diag[s] * opts.relaxation;
+          tmp += xold[s] * one_minus_omega;
+        } else {
+          tmp *= A.one_over_diag[s];
+        }
+        x[s] = tmp;
+
+        if (mycheck) {
+          double delta = x[s] - xold[s];
+          if (opts.use_relative) if (x[s]) delta /= x[s];
+          if (delta<0) delta = -delta;
+          if (delta > myerror) {
+              myerror = delta;
+              if (myerror >= opts.precision) {
+                if (iters < opts.max_iters) {
+                  mycheck = false;
+                }
+              }
+          }
+        } // if mycheck
+
+      } // for s
+      part_error[t] = myerror;
+    });
+
+    maxerror = 0;
+    for (int t=0; t<team.Size(); t++) {
+      if (part_error[t] > maxerror) maxerror = part_error[t];
+    }
+
+    if (iters < opts.min_iters) continue;
+    if (maxerror < opts.precision) {
+      out.status = LS_Success;
+      break;
+    }
+  } // for iters
+  out.num_iters = iters;
+  out.precision = maxerror;
+
+  if (x != xnew) {
+      // Solution and aux vectors are swapped; copy results over
+      for (long s=A.Stop()-1; s>=A.Start(); s--) xnew[s] = x[s];
+  }
+}
+
 #endif
 
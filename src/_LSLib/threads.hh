@@ -0,0 +1,417 @@
+
+#ifndef THREADS_HH
+#define THREADS_HH
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <new>
+#include <exception>
+
+// ******************************************************************
+// *                                                                *
+// *                       LS_Transpose class                       *
+// *                                                                *
+// ******************************************************************
+
+/**
+    Row view of a matrix in compressed column storage,
+    so that team members can multiply disjoint blocks of rows
+    without auxiliary vectors.  Entries are not copied:
+    for each row we keep the columns, and the entry indexes
+    to use with the matrix Value() method.
+    Within a row, columns appear in increasing order, so
+    the sums are done in the same order as the sequential product.
+*/
+class LS_Transpose {
+  long start;
+  long stop;
+  /// Row i has entries row_ptr[i-start], ..., row_ptr[i-start+1]-1.
+  std::vector <long> row_ptr;
+  std::vector <LS_Index> col_ind;
+  std::vector <long> entry;
+public:
+  LS_Transpose() { start = stop = 0; }
+
+  inline long Start() const { return start; }
+  inline long Stop() const { return stop; }
+
+  /// Number of entries in rows lo, ..., hi-1.
+  inline long NumEntries(long lo, long hi) const {
+    return row_ptr[hi-start] - row_ptr[lo-start];
+  }
+
+  /// Build the row view of A; the MATRIX class must be CCS.
+  template <class MATRIX>
+  inline void Build(const MATRIX &A);
+
+  /**
+      Compute rows lo, ..., hi-1 of y += (A without diagonals) * x,
+      where A is the matrix given to Build().
+  */
+  template <class MATRIX, class REAL2>
+  inline void MatrixVectorMultiply(const MATRIX &A, double* y,
+    const REAL2* x, long lo, long hi) const
+  {
+    long a = row_ptr[lo-start];
+    for (long i=lo; i<hi; i++) {
+      double yi = y[i];
+      for (const long e = row_ptr[i-start+1]; a < e; a++) {
+        yi += x[col_ind[a]] * A.Value(entry[a]);
+      }
+      y[i] = yi;
+    }
+  }
+};
+
+template <class MATRIX>
+void LS_Transpose::Build(const MATRIX &A)
+{
+  start = A.Start();
+  stop = A.Stop();
+  try {
+    row_ptr.assign(stop-start+1, 0);
+    // Count entries per row
+    for (long a=A.col_ptr[start]; a<A.col_ptr[stop]; a++) {
+      const long i = A.row_ind[a];
+      if (i<start || i>=stop) throw LS_Wrong_Format;
+      row_ptr[i-start+1]++;
+    }
+    for (long i=1; i<=stop-start; i++) row_ptr[i] += row_ptr[i-1];
+    col_ind.resize(row_ptr[stop-start]);
+    entry.resize(row_ptr[stop-start]);
+    // Fill, by increasing column
+    std::vector <long> next(row_ptr.begin(), row_ptr.end()-1);
+    for (long j=start; j<stop; j++) {
+      for (long a=A.col_ptr[j]; a<A.col_ptr[j+1]; a++) {
+        const long n = next[A.row_ind[a]-start]++;
+        col_ind[n] = j;
+        entry[n] = a;
+      }
+    }
+  }
+  catch (std::bad_alloc &) {
+    throw LS_Out_Of_Memory;
+  }
+}
+
+// ******************************************************************
+// *                                                                *
+// *                         LS_Team  class                         *
+// *                                                                *
+// ******************************************************************
+
+/**
+    Team of threads, for the multi-threaded solvers.
+    The calling thread is member 0 of the team;
+    the others wait for work between calls to Run().
+
+    Each member owns a fixed range of rows (see Split()),
+    and partial results are combined in member order,
+    so the answers do not depend on thread timing.
+
+    If a member throws, the team is marked as failed:
+    members waiting in, or later reaching, Barrier() leave the job,
+    and Run() re-throws the first exception once all have finished.
+*/
+class LS_Team {
+  int nt;
+  std::vector <std::thread> workers;
+  /// Member t owns rows bounds[t], ..., bounds[t+1]-1.
+  std::vector <long> bounds;
+  /// Row view of a CCS matrix, if needed.
+  LS_Transpose rows;
+
+  std::mutex lock;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::condition_variable gate;
+  const std::function <void(int)>* job;
+  long generation;
+  int busy;
+  bool quit;
+  /// First exception thrown by a member in the current job.
+  std::exception_ptr failure;
+  /// Set when some member has thrown; checked by Barrier().
+  bool broken;
+  // for barriers
+  int arrived;
+  long phase;
+
+  /// Thrown by Barrier() to members of a broken team.
+  struct abandon { };
+public:
+  LS_Team(int n);
+  ~LS_Team();
+
+  inline int Size() const { return nt; }
+  inline long Low(int t) const { return bounds[t]; }
+  inline long High(int t) const { return bounds[t+1]; }
+  inline const LS_Transpose& Rows() const { return rows; }
+
+  /**
+      Split the rows of A among the team members,
+      so that each gets about the same number of nonzeroes.
+      The MATRIX class must provide NumEntries(lo, hi).
+  */
+  template <class MATRIX>
+  inline void Split(const MATRIX &A);
+
+  /**
+      Build the row view of CCS matrix A,
+      and split its rows as in Split().
+  */
+  template <class MATRIX>
+  inline void SplitRows(const MATRIX &A);
+
+  /**
+      Run f(t) on each member t, and wait for all to finish.
+      If any member throws, the first exception is re-thrown here.
+  */
+  inline void Run(const std::function <void(int)> &f);
+
+  /**
+      Wait for all members; only within a job.
+      Leaves the job if another member has thrown.
+  */
+  inline void Barrier();
+
+private:
+  inline void Work(int t);
+  /// Run f(t), and record anything it throws; lock must not be held.
+  inline void Attempt(const std::function <void(int)> &f, int t);
+};
+
+LS_Team::LS_Team(int n)
+{
+  nt = (n>1) ? n : 1;
+  job = 0;
+  generation = 0;
+  busy = 0;
+  quit = false;
+  broken = false;
+  arrived = 0;
+  phase = 0;
+  bounds.resize(nt+1, 0);
+  for (int t=1; t<nt; t++) {
+    workers.push_back(std::thread(&LS_Team::Work, this, t));
+  }
+}
+
+LS_Team::~LS_Team()
+{
+  {
+    std::lock_guard <std::mutex> guard(lock);
+    quit = true;
+  }
+  wake.notify_all();
+  for (unsigned t=0; t<workers.size(); t++) workers[t].join();
+}
+
+template <class MATRIX>
+void LS_Team::Split(const MATRIX &A)
+{
+  // cost of rows Start(), ..., i-1: one per row, plus one per entry
+  const long start = A.Start();
+  const long total = A.NumEntries(start, A.Stop()) + A.Stop() - start;
+  bounds[0] = start;
+  for (int t=1; t<nt; t++) {
+    const long target = (total * t) / nt;
+    long lo = bounds[t-1];
+    long hi = A.Stop();
+    while (lo < hi) {
+      long mid = (lo+hi)/2;
+      if (A.NumEntries(start, mid) + mid - start < target) lo = mid+1;
+      else hi = mid;
+    }
+    bounds[t] = lo;
+  }
+  bounds[nt] = A.Stop();
+}
+
+template <class MATRIX>
+void LS_Team::SplitRows(const MATRIX &A)
+{
+  rows.Build(A);
+  Split(rows);
+}
+
+void LS_Team::Run(const std::function <void(int)> &f)
+{
+  {
+    std::lock_guard <std::mutex> guard(lock);
+    job = &f;
+    busy = nt-1;
+    failure = nullptr;
+    broken = false;
+    arrived = 0;
+    generation++;
+  }
+  wake.notify_all();
+  Attempt(f, 0);
+  std::unique_lock <std::mutex> guard(lock);
+  while (busy) done.wait(guard);
+  job = 0;
+  if (failure) std::rethrow_exception(failure);
+}
+
+void LS_Team::Barrier()
+{
+  std::unique_lock <std::mutex> guard(lock);
+  if (broken) throw abandon();
+  long p = phase;
+  if (++arrived == nt) {
+    arrived = 0;
+    phase++;
+    gate.notify_all();
+    return;
+  }
+  while ((p == phase) && !broken) gate.wait(guard);
+  if (p == phase) throw abandon();
+}
+
+void LS_Team::Attempt(const std::function <void(int)> &f, int t)
+{
+  try {
+    f(t);
+  }
+  catch (abandon &) {
+    // another member failed; it has the exception
+  }
+  catch (...) {
+    std::lock_guard <std::mutex> guard(lock);
+    if (!failure) failure = std::current_exception();
+    broken = true;
+    gate.notify_all();
+  }
+}
+
+void LS_Team::Work(int t)
+{
+  long seen = 0;
+  std::unique_lock <std::mutex> guard(lock);
+  for (;;) {
+    while (!quit && (seen == generation)) wake.wait(guard);
+    if (quit) return;
+    seen = generation;
+    const std::function <void(int)>* f = job;
+    guard.unlock();
+    Attempt(*f, t);
+    guard.lock();
+    if (0 == --busy) done.notify_one();
+  }
+}
+
+// ******************************************************************
+// *                    Splitting  the  products                    *
+// ******************************************************************
+
+/*
+    Compute rows Low(t), ..., High(t)-1 of y += A * x,
+    as member t of the team.  All members must call this.
+*/
+
+template <class MATRIX, class REAL2>
+inline void ThreadMultiplyRows(LS_Team &team, int t,
+  const MATRIX &A, double* y, const REAL2* x)
+{
+  A.MatrixVectorMultiply(y, x, team.Low(t), team.High(t));
+}
+
+/*
+    Same, for matrices stored by columns,
+    using the row view built by PrepareMultiply().
+*/
+
+template <class MATRIX, class REAL2>
+inline void ThreadMultiplyCols(LS_Team &team, int t,
+  const MATRIX &A, double* y, const REAL2* x)
+{
+  team.Rows().MatrixVectorMultiply(A, y, x, team.Low(t), team.High(t));
+}
+
+template <class REAL, class REAL2>
+inline void ThreadMultiply(LS_Team &team, int t,
+  const LS_CRS_Matrix <REAL> &A, double* y, const REAL2* x)
+{
+  ThreadMultiplyRows(team, t, A, y, x);
+}
+
+template <class REAL2>
+inline void ThreadMultiply(LS_Team &team, int t,
+  const LS_CRS_Indexed_Matrix &A, double* y, const REAL2* x)
+{
+  ThreadMultiplyRows(team, t, A, y, x);
+}
+
+template <class REAL, class REAL2>
+inline void ThreadMultiply(LS_Team &team, int t,
+  const LS_CCS_Matrix <REAL> &A, double* y, const REAL2* x)
+{
+  ThreadMultiplyCols(team, t, A, y, x);
+}
+
+template <class REAL2>
+inline void ThreadMultiply(LS_Team &team, int t,
+  const LS_CCS_Indexed_Matrix &A, double* y, const REAL2* x)
+{
+  ThreadMultiplyCols(team, t, A, y, x);
+}
+
+template <class REAL>
+inline void PrepareMultiply(LS_Team &, const LS_CRS_Matrix <REAL> &)
+{
+  // nothing to do
+}
+
+inline void PrepareMultiply(LS_Team &, const LS_CRS_Indexed_Matrix &)
+{
+  // nothing to do
+}
+
+template <class REAL>
+inline void PrepareMultiply(LS_Team &team, const LS_CCS_Matrix <REAL> &A)
+{
+  team.SplitRows(A);
+}
+
+inline void PrepareMultiply(LS_Team &team, const LS_CCS_Indexed_Matrix &A)
+{
+  team.SplitRows(A);
+}
+
+// ******************************************************************
+// *                   Auxiliary vector  handling                   *
+// ******************************************************************
+
+/*
+    Parallel version of CopyToAuxOrSwap():
+    swapping is done once, by the caller, with SwapAux();
+    copying is done by each member for its own rows, with CopyToAux().
+*/
+
+inline void SwapAux(float*, double*)
+{
+  // no swap for floats
+}
+
+inline void SwapAux(double* &xold, double* &x)
+{
+  double* tmp = xold;
+  xold = x;
+  x = tmp;
+}
+
+inline void CopyToAux(float* xold, const double* x, long start, long stop)
+{
+  for (long s=start; s<stop; s++) xold[s] = x[s];
+}
+
+inline void CopyToAux(double*, const double*, long, long)
+{
+  // already swapped
+}
+
+#endif
@@ -47,6 +47,9 @@ class dryrun_parser : public mc_builder {
 protected:
   // switches
   static bool quiet;
+  static bool index_edges;
+  static bool reorder;
+  static GraphLib::locality_order order;
   static LS_Options ssopts;
   static my_timer* stopwatch;
 
@@ -69,6 +72,13 @@ public:
   static inline void useTimer() { 
     stopwatch = my_timer::getInstance(); 
   }
+  static inline void indexEdges() {
+    index_edges = true;
+  }
+  static inline void useOrder(GraphLib::locality_order o) {
+    reorder = true;
+    order = o;
+  }
   static inline void useMethod(LS_Method m) {
     ssopts.method = m;
   }
@@ -139,6 +149,9 @@ public:
 };
 
 bool dryrun_parser::quiet = false;
+bool dryrun_parser::index_edges = false;
+bool dryrun_parser::reorder = false;
+GraphLib::locality_order dryrun_parser::order = GraphLib::RCM_Order;
 LS_Options dryrun_parser::ssopts;
 my_timer* dryrun_parser::stopwatch = 0;
 
@@ -458,7 +471,20 @@ bool solver_parser::doneEdges()
     DCASSERT(Ren);
     delete ac;
     G->renumberNodes(*Ren);
-    mc = new Markov_chain(is_discrete, *G, C, stopwatch);
+    mc = new Markov_chain(is_discrete, *G, C, stopwatch, reorder, order);
+    GraphLib::node_renumberer* L = mc->takeLocalityRenumberer();
+    if (L) {
+      long* nn = new long[States];
+      for (long i=0; i<States; i++) nn[i] = L->new_number(Ren->new_number(i));
+      delete L;
+      delete Ren;
+      Ren = new GraphLib::array_renumberer(nn, States);
+    }
+    if (index_edges) {
+      if (!mc->compressEdgeValues()) {
+        fprintf(errlog, "Too many distinct edge values, not indexing\n");
+      }
+    }
   }
   catch (error e) {
     fprintf(errlog, "Error finishing chain: %s\n", e.getString());
@@ -584,6 +610,15 @@ bool solver_parser::solveSteady()
         case LS_Jacobi: 
             fprintf(errlog,  "Jacobi");
             break;
+        case LS_GMRES: 
+            fprintf(errlog,  "GMRES");
+            break;
+        case LS_BiCGSTAB: 
+            fprintf(errlog,  "BiCGSTAB");
+            break;
+        case LS_Aggregation: 
+            fprintf(errlog,  "aggregation-disaggregation");
+            break;
         default:
             fprintf(errlog,  "Unknown solver");
       } // switch
@@ -840,6 +875,13 @@ int Usage(const char* name)
   fprintf(stderr, "\tr: Jacobi by rows\n");
   fprintf(stderr, "\tj: Jacobi by vector-matrix multiply\n");
   fprintf(stderr, "\tg: Gauss-Seidel (by rows)\n");
+  fprintf(stderr, "\tk: GMRES, preconditioned by ILU(0)\n");
+  fprintf(stderr, "\tb: BiCGSTAB, preconditioned by ILU(0)\n");
+  fprintf(stderr, "\ty: aggregation-disaggregation (steady-state only)\n");
+  fprintf(stderr, "\tv: store each distinct edge value once\n");
+  fprintf(stderr, "\to x: renumber states within classes for locality;\n");
+  fprintf(stderr, "\t     x is b (breadth-first), r (reverse Cuthill-McKee),\n");
+  fprintf(stderr, "\t     or p (partition)\n");
   fprintf(stderr, "\n");
   fprintf(stderr, "\te x: desired precision (epsilon)\n");
   fprintf(stderr, "\tm x: maximum number of iterations\n");
@@ -856,7 +898,7 @@ int main(int argc, char** argv)
   int ch;
   bool dry_run = false;
   for (;;) {
-    ch = getopt(argc, argv, "?dqtczrjge:m:w:");
+    ch = getopt(argc, argv, "?dqtczrjgkbyve:m:o:w:");
     if (ch<0) break;
     switch (ch) {
       case 'd':
@@ -883,6 +925,22 @@ int main(int argc, char** argv)
           dryrun_parser::useMethod(LS_Gauss_Seidel);
           continue;
 
+      case 'k':
+          dryrun_parser::useMethod(LS_GMRES);
+          continue;
+
+      case 'b':
+          dryrun_parser::useMethod(LS_BiCGSTAB);
+          continue;
+
+      case 'y':
+          dryrun_parser::useMethod(LS_Aggregation);
+          continue;
+
+      case 'v':
+          dryrun_parser::indexEdges();
+          continue;
+
       case 'e':
           if (optarg) dryrun_parser::epsilon( atof(optarg) );
           continue;
@@ -895,6 +953,16 @@ int main(int argc, char** argv)
           if (optarg) dryrun_parser::relaxation( atof(optarg) );
           continue;
 
+      case 'o':
+          if (0==optarg) return Usage(name);
+          switch (optarg[0]) {
+            case 'b': dryrun_parser::useOrder(GraphLib::BFS_Order);       break;
+            case 'r': dryrun_parser::useOrder(GraphLib::RCM_Order);       break;
+            case 'p': dryrun_parser::useOrder(GraphLib::Partition_Order); break;
+            default:  return Usage(name);
+          }
+          continue;
+
       default:
         return Usage(name);
     } // switch
@@ -262,6 +262,88 @@ bool run_test(const char* name, const bool discrete, const edge graph[],
   return okd && okf;
 }
 
+// =======================================================================
+bool run_block_test(const char* name, const bool discrete, const edge graph[],
+  const long num_nodes, const long* target[], const double* reaches[], int k)
+{
+#ifdef VERBOSE
+  const bool verbose = true;
+#else
+  const bool verbose = false;
+#endif
+  cout << "Testing ";
+  if (discrete) cout << "DTMC "; else cout << "CTMC ";
+  cout << name << " (" << k << " targets at once)\n";
+  Markov_chain* MCd = build_double(discrete, graph, num_nodes, verbose);
+  Markov_chain* MCf = build_float(discrete, graph, num_nodes, verbose);
+
+  //
+  // Set up target sets
+  //
+  intset* tsets = new intset[k];
+  for (int j=0; j<k; j++) {
+    tsets[j].resetSize(num_nodes);
+    tsets[j].removeAll();
+    for (long i=0; target[j][i]>=0; i++) {
+      tsets[j].addElement(target[j][i]);
+    }
+  }
+
+  LS_Options opt;
+  opt.method = LS_Gauss_Seidel;
+  LS_Output outd;
+  LS_Output outf;
+
+  double* sold = new double[num_nodes*k];
+  double* solf = new double[num_nodes*k];
+  double* col = new double[num_nodes];
+
+  try {
+    MCd->computeProbsToReach(tsets, k, sold, opt, outd);
+    MCf->computeProbsToReach(tsets, k, solf, opt, outf);
+  }
+  catch (GraphLib::error e) {
+    cout << "    Caught graph library error: ";
+    cout << e.getString() << "\n";
+    return false;
+  }
+  catch (MCLib::error e) {
+    cout << "    Caught Markov chain library error: ";
+    cout << e.getString() << "\n";
+    return false;
+  }
+
+  show_LS_output("double Markov chain", outd);
+  show_LS_output("float  Markov chain", outf);
+
+  bool ok = true;
+  for (int j=0; j<k; j++) {
+    for (long i=0; i<num_nodes; i++) col[i] = sold[i*k+j];
+    double diff_d = diff_vector(reaches[j], col, num_nodes);
+    for (long i=0; i<num_nodes; i++) col[i] = solf[i*k+j];
+    double diff_f = diff_vector(reaches[j], col, num_nodes);
+
+    cout << "  target " << j << " MCd relative difference: " << diff_d;
+    if (diff_d < 1e-5)  cout << " (OK)\n";
+    else                cout << " too large!\n";
+    cout << "  target " << j << " MCf relative difference: " << diff_f;
+    if (diff_f < 1e-5)  cout << " (OK)\n";
+    else                cout << " too large!\n";
+
+    ok = ok && (diff_d < 1e-5) && (diff_f < 1e-5);
+  }
+
+  // Cleanup
+  delete MCd;
+  delete MCf;
+  delete[] tsets;
+  delete[] sold;
+  delete[] solf;
+  delete[] col;
+
+  return ok;
+}
+
 // =======================================================================
 
 int main()
@@ -281,6 +363,16 @@ int main()
   if (!run_test("University ctmc fail", discrete3, graph3, num_nodes3, target3b, reaches3b)) {
     return 1;
   }
+  const long* targets2[] = { target2a, target2b };
+  const double* reaches2[] = { reaches2a, reaches2b };
+  if (!run_block_test("University dtmc", discrete2, graph2, num_nodes2, targets2, reaches2, 2)) {
+    return 1;
+  }
+  const long* targets3[] = { target3a, target3b };
+  const double* reaches3[] = { reaches3a, reaches3b };
+  if (!run_block_test("University ctmc", discrete3, graph3, num_nodes3, targets3, reaches3, 2)) {
+    return 1;
+  }
   return 0;
 }
 
@@ -5,6 +5,7 @@
 
 #include <iostream>
 #include "mcbuilder.h"
+#include "timerlib.h"
 
 // #define VERBOSE
 
@@ -373,6 +374,117 @@ bool run_test(const char* name, const bool discrete, const edge graph[],
 
 // =======================================================================
 
+/*
+  Steady state of a random walk on a grid with shuffled state numbers,
+  with states renumbered for locality or not.  The solutions must
+  match; solution times are shown for comparison.
+*/
+bool run_order_test(const long width)
+{
+  const long N = width*width;
+  cout << "Testing CTMC " << width << "x" << width;
+  cout << " random walk with locality orderings\n";
+
+  // Shuffle
+  long* shuffle = new long[N];
+  for (long i=0; i<N; i++) shuffle[i] = i;
+  unsigned long seed = 8675309;
+  for (long i=N-1; i>0; i--) {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    const long j = (seed >> 33) % (i+1);
+    const long tmp = shuffle[i];
+    shuffle[i] = shuffle[j];
+    shuffle[j] = tmp;
+  }
+
+  const int NUM_ORDERS = 4;
+  const char* names[NUM_ORDERS] = { "discovery", "BFS", "RCM", "partition" };
+  const GraphLib::locality_order orders[NUM_ORDERS] = {
+    RCM_Order, BFS_Order, RCM_Order, Partition_Order
+  };
+  double* sol[NUM_ORDERS];
+  bool ok = true;
+
+  for (int k=0; k<NUM_ORDERS; k++) {
+    dynamic_summable<double> G(true, true);
+    G.addNodes(N);
+    for (long r=0; r<width; r++) {
+      for (long c=0; c<width; c++) {
+        const long g = shuffle[r*width+c];
+        if (c+1 < width) G.addEdge(g, shuffle[r*width+c+1], 2.0);
+        if (c > 0)       G.addEdge(g, shuffle[r*width+c-1], 1.0);
+        if (r+1 < width) G.addEdge(g, shuffle[(r+1)*width+c], 0.5);
+        if (r > 0)       G.addEdge(g, shuffle[(r-1)*width+c], 1.5);
+      }
+    }
+    abstract_classifier* SCCs = G.determineSCCs(0, 1, true, 0);
+    static_classifier C;
+    node_renumberer* R = SCCs->buildRenumbererAndStatic(C);
+    G.renumberNodes(*R);
+
+    timer watch;
+    Markov_chain MC(false, G, C, 0, k>0, orders[k]);
+    const double build = watch.elapsed_seconds();
+    node_renumberer* L = MC.takeLocalityRenumberer();
+
+    double* p = new double[N];
+    double* x = new double[N];
+    for (long i=0; i<N; i++) x[i] = 1.0 / N;
+    LS_Vector p0;
+    p0.size = N;
+    p0.index = 0;
+    p0.d_value = x;
+    p0.f_value = 0;
+    LS_Options opt;
+    opt.method = LS_Gauss_Seidel;
+    opt.precision = 1e-10;
+    LS_Output out;
+
+    watch.reset();
+    try {
+      MC.computeInfinityDistribution(p0, p, opt, out);
+    }
+    catch (MCLib::error e) {
+      cout << "    Caught Markov chain library error: ";
+      cout << e.getString() << "\n";
+      return false;
+    }
+    const double solve = watch.elapsed_seconds();
+    cout << "    " << names[k] << ": " << build << " seconds to build, ";
+    cout << solve << " seconds for " << out.num_iters << " iterations\n";
+
+    // Back to the shuffled numbering
+    sol[k] = new double[N];
+    for (long i=0; i<N; i++) {
+      long j = R->new_number(i);
+      if (L) j = L->new_number(j);
+      sol[k][i] = p[j];
+    }
+    delete[] p;
+    delete[] x;
+    delete L;
+    delete R;
+    delete SCCs;
+
+    if (k) {
+      double diff = diff_vector(sol[0], sol[k], N);
+      cout << "      relative difference: " << diff;
+      if (diff < 1e-5) {
+        cout << " (OK)\n";
+      } else {
+        cout << " too large!\n";
+        ok = false;
+      }
+    }
+  }
+
+  for (int k=0; k<NUM_ORDERS; k++) delete[] sol[k];
+  delete[] shuffle;
+  return ok;
+}
+
+// =======================================================================
+
 int main()
 {
   if (!run_test("Oz dtmc", discrete1, graph1, num_nodes1, init1, pinfinity1)) {
@@ -396,6 +508,9 @@ int main()
   if (!run_test("FMS N=1 ctmc", discrete5, graph5, num_nodes5, init5, pinfinity5)) {
     return 1;
   }
+  if (!run_order_test(150)) {
+    return 1;
+  }
   return 0;
 }
 
@@ -5,6 +5,7 @@
 
 #include <iostream>
 #include <string.h>
+#include <vector>
 #include "mcbuilder.h"
 
 // #define VERBOSE
@@ -102,6 +103,36 @@ const double p4_8[] = {0.39998184, 0.20003632, 0.39998184};
 
 const double p4_ss[] = {2.0/5.0, 1.0/5.0, 2.0/5.0};
 
+// ==============================> Graph 5 <==============================
+
+/*
+  Stiff CTMC: a chain of slow steps before a large ring of fast states,
+  which are almost never reached in the time of interest.
+*/
+const long slow5 = 20;
+const long ring5 = 400;
+const long num_nodes5 = slow5 + ring5;
+
+void build_graph5(std::vector <edge> &graph, std::vector <double> &init)
+{
+  graph.clear();
+  for (long i=0; i<slow5; i++) {
+    edge e = { i, i+1, 0.01 };
+    graph.push_back(e);
+  }
+  for (long i=0; i<ring5; i++) {
+    edge fwd = { slow5 + i, slow5 + (i+1) % ring5, 100 };
+    edge bck = { slow5 + (i+1) % ring5, slow5 + i, 100 };
+    graph.push_back(fwd);
+    graph.push_back(bck);
+  }
+  edge end = { -1, -1, -1 };
+  graph.push_back(end);
+
+  init.assign(num_nodes5, 0.0);
+  init[0] = 1;
+}
+
 
 // =======================================================================
 
@@ -126,6 +157,17 @@ double diff_vector(const double* A, const double* B, long size)
   return rel_diff;
 }
 
+double abs_diff_vector(const double* A, const double* B, long size)
+{
+  double sum = 0;
+  for (long i=0; i<size; i++) {
+    double d = A[i] - B[i];
+    if (d<0) d*=-1;
+    sum += d;
+  }
+  return sum;
+}
+
 // =======================================================================
 
 bool run_dtmc_test(const char* name, const edge graph[], 
@@ -298,6 +340,291 @@ bool run_ctmc_test(const char* name, const double q, const edge graph[],
 
 // =======================================================================
 
+bool run_ctmc_multi_test(const char* name, const edge graph[],
+  const long num_nodes, const double init[], const long ntimes,
+  const double times[], const double* pt[])
+{
+#ifdef VERBOSE
+  const bool verbose = true;
+#else
+  const bool verbose = false;
+#endif
+
+  cout << "Testing CTMC multiple times ";
+  cout << name << "\n";
+
+  Markov_chain* MCd = build_double(false, graph, num_nodes, verbose);
+  Markov_chain* MCf = build_float(false, graph, num_nodes, verbose);
+
+  //
+  // No steady-state detection, so every Poisson window is used
+  //
+  Markov_chain::CTMC_transient_options opt;
+  Markov_chain::CTMC_transient_options last;
+  opt.ssprec = 0;
+  last.ssprec = 0;
+
+  //
+  // Solve for all times at once, and for the last time alone
+  //
+  double** sold = new double*[ntimes];
+  double** solf = new double*[ntimes];
+  for (long j=0; j<ntimes; j++) {
+    sold[j] = new double[num_nodes];
+    solf[j] = new double[num_nodes];
+  }
+  double* alone = new double[num_nodes];
+  memcpy(alone, init, num_nodes*sizeof(double));
+
+  try {
+    MCd->computeTransient(times, ntimes, init, sold, opt);
+    MCf->computeTransient(times, ntimes, init, solf, opt);
+    MCd->computeTransient(times[ntimes-1], alone, last);
+  }
+  catch (GraphLib::error e) {
+    cout << "    Caught graph library error: ";
+    cout << e.getString() << "\n";
+    return false;
+  }
+  catch (MCLib::error e) {
+    cout << "    Caught Markov chain library error: ";
+    cout << e.getString() << "\n";
+    return false;
+  }
+
+  //
+  // Check results
+  //
+  bool ok = true;
+  cout << "Performed " << opt.multiplications << " multiplications, ";
+  cout << last.multiplications << " for the last time alone\n";
+  if (opt.multiplications > last.multiplications) {
+    cout << "  too many multiplications!\n";
+    ok = false;
+  }
+
+  for (long j=0; j<ntimes; j++) {
+    double diff_d = diff_vector(pt[j], sold[j], num_nodes);
+    double diff_f = diff_vector(pt[j], solf[j], num_nodes);
+    cout << "  time " << times[j] << " relative differences: ";
+    cout << diff_d << ", " << diff_f;
+    if (diff_d < 1e-5 && diff_f < 1e-5) {
+      cout << " (OK)\n";
+    } else {
+      cout << " too large!\n";
+      show_vector("MCd solution vector", sold[j], num_nodes);
+      show_vector("MCf solution vector", solf[j], num_nodes);
+      show_vector("Expected     vector", pt[j], num_nodes);
+      ok = false;
+    }
+  }
+
+  //
+  // Cleanup
+  //
+  delete MCd;
+  delete MCf;
+  for (long j=0; j<ntimes; j++) {
+    delete[] sold[j];
+    delete[] solf[j];
+  }
+  delete[] sold;
+  delete[] solf;
+  delete[] alone;
+
+  return ok;
+}
+
+// =======================================================================
+
+const char* method_name(Markov_chain::CTMC_transient_options::transient_method m)
+{
+  switch (m) {
+    case Markov_chain::CTMC_transient_options::Uniformization:
+      return "uniformization";
+    case Markov_chain::CTMC_transient_options::Adaptive_Uniformization:
+      return "adaptive uniformization";
+    case Markov_chain::CTMC_transient_options::Krylov:
+      return "Krylov";
+  }
+  return "?";
+}
+
+/*
+  Compare the transient methods against uniformization,
+  and against the expected vector (if given).
+  If stiff is set, adaptive uniformization and Krylov
+  must use fewer multiplications than uniformization.
+*/
+bool run_ctmc_method_test(const char* name, const edge graph[],
+  const long num_nodes, const double init[], const double time,
+  const double pt[], bool stiff)
+{
+#ifdef VERBOSE
+  const bool verbose = true;
+#else
+  const bool verbose = false;
+#endif
+
+  cout << "Testing CTMC transient methods ";
+  cout << name << "\n";
+
+  Markov_chain* MCd = build_double(false, graph, num_nodes, verbose);
+
+  const Markov_chain::CTMC_transient_options::transient_method methods[] = {
+    Markov_chain::CTMC_transient_options::Uniformization,
+    Markov_chain::CTMC_transient_options::Adaptive_Uniformization,
+    Markov_chain::CTMC_transient_options::Krylov
+  };
+  double* sol[3];
+  long mults[3];
+  bool ok = true;
+
+  for (int i=0; i<3; i++) {
+    Markov_chain::CTMC_transient_options opt;
+    opt.method = methods[i];
+    sol[i] = new double[num_nodes];
+    memcpy(sol[i], init, num_nodes*sizeof(double));
+    try {
+      MCd->computeTransient(time, sol[i], opt);
+    }
+    catch (GraphLib::error e) {
+      cout << "    Caught graph library error: ";
+      cout << e.getString() << "\n";
+      return false;
+    }
+    catch (MCLib::error e) {
+      cout << "    Caught Markov chain library error: ";
+      cout << e.getString() << "\n";
+      return false;
+    }
+    mults[i] = opt.multiplications;
+    cout << "  " << method_name(methods[i]) << ": ";
+    cout << mults[i] << " multiplications";
+
+    double diff = abs_diff_vector(pt ? pt : sol[0], sol[i], num_nodes);
+    cout << ", difference " << diff;
+    if (diff < 1e-6) {
+      cout << " (OK)\n";
+    } else {
+      cout << " too large!\n";
+      show_vector("Solution vector", sol[i], num_nodes);
+      show_vector("Expected vector", pt ? pt : sol[0], num_nodes);
+      ok = false;
+    }
+    if (stiff && i && mults[i] >= mults[0]) {
+      cout << "  too many multiplications!\n";
+      ok = false;
+    }
+  }
+
+  //
+  // Cleanup
+  //
+  delete MCd;
+  for (int i=0; i<3; i++) delete[] sol[i];
+
+  return ok;
+}
+
+// =======================================================================
+
+/*
+  Compare the block transient solvers, for k vectors at once,
+  against one vector at a time, both forward and reverse.
+*/
+bool run_ctmc_block_test(const char* name, const edge graph[],
+  const long num_nodes, const double* init[], const int k, const double time)
+{
+#ifdef VERBOSE
+  const bool verbose = true;
+#else
+  const bool verbose = false;
+#endif
+
+  cout << "Testing CTMC block transient ";
+  cout << name << " with " << k << " vectors\n";
+
+  Markov_chain* MCd = build_double(false, graph, num_nodes, verbose);
+  Markov_chain* MCf = build_float(false, graph, num_nodes, verbose);
+
+  double* blockd = new double[num_nodes*k];
+  double* blockf = new double[num_nodes*k];
+  double* single = new double[num_nodes];
+  double* col = new double[num_nodes];
+  bool ok = true;
+
+  for (int reverse=0; reverse<2; reverse++) {
+    for (long i=0; i<num_nodes; i++) {
+      for (int j=0; j<k; j++) {
+        blockd[i*k+j] = blockf[i*k+j] = init[j][i];
+      }
+    }
+    Markov_chain::CTMC_transient_options optd;
+    Markov_chain::CTMC_transient_options optf;
+    try {
+      if (reverse) {
+        MCd->reverseTransient(time, blockd, k, optd);
+        MCf->reverseTransient(time, blockf, k, optf);
+      } else {
+        MCd->computeTransient(time, blockd, k, optd);
+        MCf->computeTransient(time, blockf, k, optf);
+      }
+    }
+    catch (GraphLib::error e) {
+      cout << "    Caught graph library error: ";
+      cout << e.getString() << "\n";
+      return false;
+    }
+    catch (MCLib::error e) {
+      cout << "    Caught Markov chain library error: ";
+      cout << e.getString() << "\n";
+      return false;
+    }
+    cout << "  " << (reverse ? "reverse" : "forward") << ": ";
+    cout << optd.multiplications << " block multiplications\n";
+
+    for (int j=0; j<k; j++) {
+      Markov_chain::CTMC_transient_options opt;
+      memcpy(single, init[j], num_nodes*sizeof(double));
+      if (reverse) {
+        MCd->reverseTransient(time, single, opt);
+      } else {
+        MCd->computeTransient(time, single, opt);
+      }
+
+      for (long i=0; i<num_nodes; i++) col[i] = blockd[i*k+j];
+      double diff_d = abs_diff_vector(single, col, num_nodes);
+      for (long i=0; i<num_nodes; i++) col[i] = blockf[i*k+j];
+      double diff_f = abs_diff_vector(single, col, num_nodes);
+
+      cout << "    vector " << j << " differences: ";
+      cout << diff_d << ", " << diff_f;
+      if (diff_d < 1e-6 && diff_f < 1e-6) {
+        cout << " (OK)\n";
+      } else {
+        cout << " too large!\n";
+        show_vector("Single vector", single, num_nodes);
+        ok = false;
+      }
+    } // for j
+  } // for reverse
+
+  //
+  // Cleanup
+  //
+  delete MCd;
+  delete MCf;
+  delete[] blockd;
+  delete[] blockf;
+  delete[] single;
+  delete[] col;
+
+  return ok;
+}
+
+// =======================================================================
+
 int main()
 {
   cout.precision(8);
@@ -362,6 +689,39 @@ int main()
     return 1;
   }
 
+  const double times4[] = { 0, 1, 2, 4, 8, 100 };
+  const double* p4_t[] = { p4_0, p4_1, p4_2, p4_4, p4_8, p4_ss };
+  if (!run_ctmc_multi_test("Oz", graph4, num_nodes4, p4_0, 6, times4, p4_t)) {
+    return 1;
+  }
+
+  if (!run_ctmc_method_test("Transient", graph3, num_nodes3, p3_0, 10, p3_10, false)) {
+    return 1;
+  }
+  if (!run_ctmc_method_test("Oz t4", graph4, num_nodes4, p4_0, 4, p4_4, false)) {
+    return 1;
+  }
+  if (!run_ctmc_method_test("Oz t100", graph4, num_nodes4, p4_0, 100, p4_ss, false)) {
+    return 1;
+  }
+  std::vector <edge> graph5;
+  std::vector <double> p5_0;
+  build_graph5(graph5, p5_0);
+  if (!run_ctmc_method_test("Stiff t10", graph5.data(), num_nodes5, p5_0.data(), 10, 0, true)) {
+    return 1;
+  }
+
+  const double e4_0[] = {1, 0, 0};
+  const double e4_2[] = {0, 0, 1};
+  const double* block4[] = { p4_0, e4_0, e4_2, p4_1 };
+  if (!run_ctmc_block_test("Oz t4", graph4, num_nodes4, block4, 4, 4)) {
+    return 1;
+  }
+  const double* block3[] = { p3_0, p3_10 };
+  if (!run_ctmc_block_test("Transient t10", graph3, num_nodes3, block3, 2, 10)) {
+    return 1;
+  }
+
   return 0;
 }
 
@@ -7,6 +7,11 @@
 
 #include <math.h>
 #include <string.h>
+#include <stdlib.h>
+
+#include <new>
+#include <vector>
+#include <algorithm>
 
 // #define DEBUG_CONSTRUCTOR
 // #define DEBUG_PERIOD
@@ -122,6 +127,17 @@ inline void zeroArray(TYPE* A, long size)
   for (long i=0; i<size; i++) A[i] = 0;
 }
 
+// Move A[i] to A[r.new_number(i)], for all i.
+template <class TYPE>
+inline void permute_array(TYPE* &A, const GraphLib::node_renumberer &r,
+  long size)
+{
+  TYPE* B = new TYPE[size];
+  for (long i=0; i<size; i++) B[r.new_number(i)] = A[i];
+  delete[] A;
+  A = B;
+}
+
 
 template <class REAL>
 inline void fillVector(REAL* x, long size, const LS_Vector &y)
@@ -229,6 +245,29 @@ long float_graph_edge_idf(const GraphLib::static_graph &G, long s,
     return -1;
 }
 
+//
+// In an indexed graph, find the first edge from state s
+// such that (sum of edge probabilities/rates) > u.
+//    @param  G       The graph, must have unsigned short edge indexes.
+//    @param  values  Table of edge values.
+//    @param  s       State.
+//    @param  u       Value.
+//    @param  total   Total so far, caller needs this if we fail
+//    @return         Destination state of that edge, or -1 if none
+long indexed_graph_edge_idf(const GraphLib::static_graph &G, 
+        const double* values, long s, double u, double &total)
+{
+    DCASSERT(G.EdgeBytes() == sizeof(unsigned short));
+    const unsigned short* index = (const unsigned short*) G.Labels();
+    for (long e=G.RowPointer(s); e<G.RowPointer(s+1); e++) {
+      total += values[index[e]];
+      if (total > u) {
+        return G.ColumnIndex(e);
+      }
+    }
+    return -1;
+}
+
 template <class REAL>
 inline void graphToMatrix(const GraphLib::static_graph &G, LS_CCS_Matrix<REAL> &M)
 {
@@ -261,6 +300,72 @@ inline void graphToMatrix(const GraphLib::static_graph &G, LS_CRS_Matrix<REAL> &
   M.one_over_diag = 0;  // We'll do this by hand later
 }
 
+inline void graphToMatrix(const GraphLib::static_graph &G, 
+  LS_CCS_Indexed_Matrix &M, const double* values)
+{
+  DCASSERT(G.EdgeBytes() == sizeof(unsigned short));
+
+  M.start = 0;
+  M.stop = G.getNumNodes();
+  M.size = G.getNumNodes();
+
+  M.dict = values;
+  M.val_index = (const unsigned short*) G.Labels();
+  M.row_ind = G.ColumnIndex();
+  M.col_ptr = G.RowPointer();
+
+  M.one_over_diag = 0;  // We'll do this by hand later
+}
+
+inline void graphToMatrix(const GraphLib::static_graph &G, 
+  LS_CRS_Indexed_Matrix &M, const double* values)
+{
+  DCASSERT(G.EdgeBytes() == sizeof(unsigned short));
+
+  M.start = 0;
+  M.stop = G.getNumNodes();
+  M.size = G.getNumNodes();
+
+  M.dict = values;
+  M.val_index = (const unsigned short*) G.Labels();
+  M.col_ind = G.ColumnIndex();
+  M.row_ptr = G.RowPointer();
+
+  M.one_over_diag = 0;  // We'll do this by hand later
+}
+
+//
+// Collect the edge labels of G into table, as doubles.
+//
+void collect_edge_values(const GraphLib::static_graph &G, bool dbl,
+  std::vector <double> &table)
+{
+  for (long e=0; e<G.getNumEdges(); e++) {
+    if (dbl)  table.push_back(*((const double*) G.Label(e)));
+    else      table.push_back(*((const float*) G.Label(e)));
+  }
+}
+
+//
+// Replace the edge labels of G by indexes into (sorted) table.
+//
+void index_edge_values(GraphLib::static_graph &G, bool dbl,
+  const std::vector <double> &table)
+{
+  unsigned short* index = (unsigned short*) 
+    malloc(G.getNumEdges() * sizeof(unsigned short));
+  if (G.getNumEdges() && 0==index) {
+    throw MCLib::error(MCLib::error::Out_Of_Memory);
+  }
+  for (long e=0; e<G.getNumEdges(); e++) {
+    double v = dbl  ? *((const double*) G.Label(e)) 
+                    : *((const float*) G.Label(e));
+    index[e] = std::lower_bound(table.begin(), table.end(), v) - table.begin();
+    DCASSERT(table[index[e]] == v);
+  }
+  G.replaceLabels(sizeof(unsigned short), index);
+}
+
 /**
     Multiply by diagonals, where diagonals are stored explicitly.
     Essentially, the same as element-wise product.
@@ -455,7 +560,8 @@ void MCLib::Markov_chain::DTMC_distribution_options
 MCLib::Markov_chain::Markov_chain(bool discrete, 
   GraphLib::dynamic_summable<double> &G, 
   const GraphLib::static_classifier &TSCCinfo,
-  GraphLib::timer_hook *sw) : stateClass(TSCCinfo)
+  GraphLib::timer_hook *sw, bool reorder, GraphLib::locality_order ord)
+  : stateClass(TSCCinfo)
 {
 #ifdef DEBUG_CONSTRUCTOR
   cout << "Inside Markov_chain (double) constructor.\n";
@@ -469,6 +575,9 @@ MCLib::Markov_chain::Markov_chain(bool discrete,
   // 
   selfloops_d = 0;
   selfloops_f = 0;
+  edge_values = 0;
+  num_edge_values = 0;
+  locality = 0;
 
   //
   // Allocate row sum array
@@ -497,7 +606,7 @@ MCLib::Markov_chain::Markov_chain(bool discrete,
   //
   // Common stuff (to double/float graphs) here
   //
-  finish_construction(G, sw);
+  finish_construction(G, sw, reorder, ord);
 
 #ifdef DEBUG_CONSTRUCTOR
   cout << "Exiting Markov_chain (double) constructor.\n";
@@ -509,7 +618,8 @@ MCLib::Markov_chain::Markov_chain(bool discrete,
 MCLib::Markov_chain::Markov_chain(bool discrete, 
   GraphLib::dynamic_summable<float> &G, 
   const GraphLib::static_classifier &TSCCinfo,
-  GraphLib::timer_hook *sw) : stateClass(TSCCinfo)
+  GraphLib::timer_hook *sw, bool reorder, GraphLib::locality_order ord)
+  : stateClass(TSCCinfo)
 {
 #ifdef DEBUG_CONSTRUCTOR
   cout << "Inside Markov_chain (float) constructor.\n";
@@ -523,6 +633,9 @@ MCLib::Markov_chain::Markov_chain(bool discrete,
   // 
   selfloops_d = 0;
   selfloops_f = 0;
+  edge_values = 0;
+  num_edge_values = 0;
+  locality = 0;
 
   //
   // Allocate row sum array
@@ -550,7 +663,7 @@ MCLib::Markov_chain::Markov_chain(bool discrete,
   //
   // Common stuff (to double/float graphs) here
   //
-  finish_construction(G, sw);
+  finish_construction(G, sw, reorder, ord);
 
 #ifdef DEBUG_CONSTRUCTOR
   cout << "Exiting Markov_chain (float) constructor.\n";
@@ -566,13 +679,33 @@ MCLib::Markov_chain::~Markov_chain()
   delete[] rowsums;
   delete[] one_over_rowsums_d;
   delete[] one_over_rowsums_f;
+  delete[] edge_values;
+  delete locality;
 }
 
 // ******************************************************************
 
 void MCLib::Markov_chain::finish_construction(GraphLib::dynamic_graph &G,
-    GraphLib::timer_hook *sw)
+    GraphLib::timer_hook *sw, bool reorder, GraphLib::locality_order ord)
 {
+  //
+  // Renumber states within classes, for locality
+  //
+  if (reorder) {
+    if (sw) sw->start("Renumbering states for locality");
+    locality = G.localityRenumberer(stateClass, ord);
+    if (locality->changes_something()) {
+      G.renumberNodes(*locality);
+      if (selfloops_d) {
+        permute_array(selfloops_d, *locality, G.getNumNodes());
+      }
+      if (selfloops_f) {
+        permute_array(selfloops_f, *locality, G.getNumNodes());
+      }
+    }
+    if (sw) sw->stop();
+  }
+
   //
   // Build subgraphs and remove any self loops
   //
@@ -740,12 +873,70 @@ size_t MCLib::Markov_chain::getMemTotal() const
   if (one_over_rowsums_f) mem += getNumStates() * sizeof(float);
   if (selfloops_d)        mem += getNumStates() * sizeof(double);
   if (selfloops_f)        mem += getNumStates() * sizeof(float);
+  if (edge_values)        mem += num_edge_values * sizeof(double);
 
   return mem;
 }
 
 // ******************************************************************
 
+bool MCLib::Markov_chain::compressEdgeValues()
+{
+  if (edge_values) return true;
+
+  //
+  // Build the sorted table of distinct values.
+  // The column graphs are transposes of the row graphs,
+  // so they have the same values.
+  //
+  std::vector <double> table;
+  try {
+    collect_edge_values(G_byrows_diag, double_graphs, table);
+    collect_edge_values(G_byrows_off, double_graphs, table);
+    std::sort(table.begin(), table.end());
+    table.erase(std::unique(table.begin(), table.end()), table.end());
+  }
+  catch (std::bad_alloc &) {
+    throw MCLib::error(MCLib::error::Out_Of_Memory);
+  }
+  if (table.size() > 65536) return false;
+
+  //
+  // Replace the labels
+  //
+  index_edge_values(G_byrows_diag, double_graphs, table);
+  index_edge_values(G_byrows_off, double_graphs, table);
+  index_edge_values(G_bycols_diag, double_graphs, table);
+  index_edge_values(G_bycols_off, double_graphs, table);
+
+  num_edge_values = table.size();
+  edge_values = new double[num_edge_values];
+  for (long i=0; i<num_edge_values; i++) edge_values[i] = table[i];
+
+  //
+  // Switch the remaining float arrays to doubles
+  //
+  if (!double_graphs) {
+    if (selfloops_f) {
+      selfloops_d = new double[getNumStates()];
+      for (long i=0; i<getNumStates(); i++) selfloops_d[i] = selfloops_f[i];
+      delete[] selfloops_f;
+      selfloops_f = 0;
+    }
+    one_over_rowsums_d = new double[getNumStates()];
+    for (long i=0; i<getNumStates(); i++) {
+      one_over_rowsums_d[i] = rowsums[i] ? (1.0/rowsums[i]) : 0.0;
+    }
+    delete[] one_over_rowsums_f;
+    one_over_rowsums_f = 0;
+    double_graphs = true;
+  }
+
+  return true;
+}
+
+// ******************************************************************
+
 bool MCLib::Markov_chain::traverseOutgoing(GraphLib::BF_graph_traversal &t)
 const
 {
@@ -760,7 +951,7 @@ const
       for (long z=G_byrows_diag.RowPointer(s); 
             z<G_byrows_diag.RowPointer(s+1); z++) 
       {
-        if (t.visit(s, G_byrows_diag.ColumnIndex(z), G_byrows_diag.Label(z))) {
+        if (t.visit(s, G_byrows_diag.ColumnIndex(z), edgeLabel(G_byrows_diag, z))) {
           return true;
         }
       }
@@ -781,7 +972,7 @@ const
       for (long z=G_byrows_off.RowPointer(s); 
             z<G_byrows_off.RowPointer(s+1); z++) 
       {
-        if (t.visit(s, G_byrows_off.ColumnIndex(z), G_byrows_off.Label(z))) {
+        if (t.visit(s, G_byrows_off.ColumnIndex(z), edgeLabel(G_byrows_off, z))) {
           return true;
         }
       }
@@ -806,7 +997,7 @@ const
       for (long z=G_bycols_diag.RowPointer(s); 
             z<G_bycols_diag.RowPointer(s+1); z++) 
       {
-        if (t.visit(s, G_bycols_diag.ColumnIndex(z), G_bycols_diag.Label(z))) {
+        if (t.visit(s, G_bycols_diag.ColumnIndex(z), edgeLabel(G_bycols_diag, z))) {
           return true;
         }
       }
@@ -827,7 +1018,7 @@ const
       for (long z=G_bycols_off.RowPointer(s); 
             z<G_bycols_off.RowPointer(s+1); z++) 
       {
-        if (t.visit(s, G_bycols_off.ColumnIndex(z), G_bycols_off.Label(z))) {
+        if (t.visit(s, G_bycols_off.ColumnIndex(z), edgeLabel(G_bycols_off, z))) {
           return true;
         }
       }
@@ -1034,7 +1225,19 @@ void MCLib::Markov_chain::computeTransient(int t, double* p,
     throw MCLib::error(MCLib::error::Wrong_Type);
   }
 
-  if (double_graphs) {
+  if (edge_values) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag, edge_values);
+    graphToMatrix(G_byrows_off, Qoff, edge_values);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_dtmc_transient(Qdiag, Qoff, selfloops_d, t, p, true, opts);
+  } else if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
@@ -1074,7 +1277,19 @@ void MCLib::Markov_chain::reverseTransient(int t, double* p,
     throw MCLib::error(MCLib::error::Wrong_Type);
   }
 
-  if (double_graphs) {
+  if (edge_values) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_bycols_diag, Qdiag, edge_values);
+    graphToMatrix(G_bycols_off, Qoff, edge_values);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_dtmc_transient(Qdiag, Qoff, selfloops_d, t, p, false, opts);
+  } else if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
@@ -1190,109 +1405,181 @@ namespace MCLib {
 
 // ******************************************************************
 
-void MCLib::Markov_chain::computeTransient(double t, double* p, 
-  CTMC_transient_options &opts) const
-{
-  if (0==p) {
-    throw MCLib::error(MCLib::error::Null_Vector);
-  }
-  if (isDiscrete()) {
-    throw MCLib::error(MCLib::error::Wrong_Type);
-  }
-
-  opts.q = MAX(opts.q, getUniformizationConst());
-
-  //
-  // Set up poisson distribution
-  //
-  discrete_pdf poisson_pdf;
-  computePoissonPDF(opts.q * t, opts.epsilon, poisson_pdf);
-
-  if (double_graphs) {
-    //
-    // Set up matrices (shallow copies here)
-    //
-    LS_CRS_Matrix_double Qdiag, Qoff;
-    graphToMatrix(G_byrows_diag, Qdiag);
-    graphToMatrix(G_byrows_off, Qoff);
-
-    //
-    // And pass everything to our nice template function :^)
-    //
-    templ_ctmc_transient(Qdiag, Qoff, rowsums, t, p, true, poisson_pdf, 1, opts);
-  } else {
-    //
-    // Set up matrices (shallow copies here)
-    //
-    LS_CRS_Matrix_float Qdiag, Qoff;
-    graphToMatrix(G_byrows_diag, Qdiag);
-    graphToMatrix(G_byrows_off, Qoff);
+namespace MCLib {
 
-    //
-    // And pass everything to our nice template function :^)
-    //
-    templ_ctmc_transient(Qdiag, Qoff, rowsums, t, p, true, poisson_pdf, 1, opts);
+  /**
+      Rates for adaptive uniformization.
+      On output, lambda[n] is the largest rowsum among the states
+      reachable in at most n steps from the nonzero entries of p;
+      the last element is the largest rowsum of any state reachable
+      from p, and is the first time that value appears.
+  */
+  template <class MATRIX>
+  void adaptiveRates(const MATRIX &Qdiag, const MATRIX &Qoff,
+    const double* rowsums, const double* p, std::vector <double> &lambda)
+  {
+      const long size = Qdiag.Size();
+      std::vector <bool> seen(size, false);
+      std::vector <long> frontier, next;
+      double rate = 0;
+      for (long i=0; i<size; i++) {
+        if (0==p[i]) continue;
+        seen[i] = true;
+        frontier.push_back(i);
+        rate = MAX(rate, rowsums[i]);
+      }
+      lambda.clear();
+      lambda.push_back(rate);
+      while (frontier.size()) {
+        next.clear();
+        for (size_t f=0; f<frontier.size(); f++) {
+          const long i = frontier[f];
+          for (long a=Qdiag.row_ptr[i]; a<Qdiag.row_ptr[i+1]; a++) {
+            const long j = Qdiag.col_ind[a];
+            if (seen[j]) continue;
+            seen[j] = true;
+            next.push_back(j);
+            rate = MAX(rate, rowsums[j]);
+          }
+          for (long a=Qoff.row_ptr[i]; a<Qoff.row_ptr[i+1]; a++) {
+            const long j = Qoff.col_ind[a];
+            if (seen[j]) continue;
+            seen[j] = true;
+            next.push_back(j);
+            rate = MAX(rate, rowsums[j]);
+          }
+        }
+        frontier.swap(next);
+        lambda.push_back(rate);
+      }
+      while (lambda.size() > 1 && lambda[lambda.size()-2] == lambda.back()) {
+        lambda.pop_back();
+      }
   }
-}
-
 
-// ******************************************************************
+  /**
+      Jump probabilities for adaptive uniformization.
+      These are the probabilities for the number of jumps by time t,
+      of a pure birth process with rate lambda[n] in state n,
+      where the last rate is used for all larger states too.
+      We uniformize the birth process with the last (largest) rate.
 
-void MCLib::Markov_chain::reverseTransient(double t, double* p, 
-  CTMC_transient_options &opts) const
-{
-  if (0==p) {
-    throw MCLib::error(MCLib::error::Null_Vector);
-  }
-  if (isDiscrete()) {
-    throw MCLib::error(MCLib::error::Wrong_Type);
-  }
+        @param  lambda    Rates, from adaptiveRates().
+        @param  t         Time.
+        @param  epsilon   Precision for the Poisson distribution.
+        @param  limit     Give up if this needs more than about
+                          limit scalar operations.
+        @param  b         On output: b[n] is the probability of
+                          n jumps by time t.
 
-  opts.q = MAX(opts.q, getUniformizationConst());
+        @return true on success, false if we gave up.
+  */
+  inline bool adaptiveJumpProbs(const std::vector <double> &lambda, double t,
+    double epsilon, double limit, std::vector <double> &b)
+  {
+      const long m = long(lambda.size()) - 1;
+      const double L = lambda.back();
+      discrete_pdf poisson;
+      computePoissonPDF(L * t, epsilon, poisson);
+      const long left = poisson.left_trunc();
+      const long R = poisson.right_trunc();
 
-  //
-  // Set up poisson distribution
-  //
-  discrete_pdf poisson_pdf;
-  computePoissonPDF(opts.q * t, opts.epsilon, poisson_pdf);
+      if (double(m) * double(R) > limit) return false;
 
-  if (double_graphs) {
-    //
-    // Set up matrices (shallow copies here)
-    //
-    LS_CRS_Matrix_double Qdiag, Qoff;
-    graphToMatrix(G_bycols_diag, Qdiag);
-    graphToMatrix(G_bycols_off, Qoff);
+      //
+      // c[n]: probability that the uniformized birth process
+      //       is in state n < m.
+      // e[k]: probability that it enters state m at step k;
+      //       from there, it moves up once per step.
+      //
+      b.assign(m, 0.0);
+      std::vector <double> c(m+1, 0.0);
+      std::vector <double> e(R+1, 0.0);
+      if (m) c[0] = 1;
+      else   e[0] = 1;
+      for (long k=0; k<=R; k++) {
+        const long top = MIN(m-1, k);
+        const double fk = poisson.f(k);
+        if (fk) {
+          for (long n=0; n<=top; n++) b[n] += fk * c[n];
+        }
+        if (k==R) break;
+        for (long n=top; n>=0; n--) {
+          const double move = c[n] * lambda[n] / L;
+          c[n] -= move;
+          if (n+1<m)  c[n+1] += move;
+          else        e[k+1] += move;
+        }
+      }
 
-    //
-    // And pass everything to our nice template function :^)
-    //
-    templ_ctmc_transient(Qdiag, Qoff, rowsums, t, p, false, poisson_pdf, 1, opts);
-  } else {
-    //
-    // Set up matrices (shallow copies here)
-    //
-    LS_CRS_Matrix_float Qdiag, Qoff;
-    graphToMatrix(G_bycols_diag, Qdiag);
-    graphToMatrix(G_bycols_off, Qoff);
+      //
+      // b[m+s] = sum over j of e[j] * f(j+s);
+      // skipped if the fast states are unlikely to be reached at all.
+      //
+      double e_total = 0;
+      for (long j=0; j<=R; j++) e_total += e[j];
+      if (e_total >= epsilon) {
+        long jlo = 0;
+        while (0==e[jlo]) jlo++;
+        long jhi = R;
+        while (0==e[jhi]) jhi--;
+        const double width = MIN(jhi-jlo, R-left) + 1;
+        if (double(R-jlo+1) * width > limit) return false;
+        for (long s=0; s<=R-jlo; s++) {
+          const long lo = MAX(jlo, left-s);
+          const long hi = MIN(jhi, R-s);
+          double sum = 0;
+          for (long j=lo; j<=hi; j++) sum += e[j] * poisson.f(j+s);
+          b.push_back(sum);
+        }
+      }
 
-    //
-    // And pass everything to our nice template function :^)
-    //
-    templ_ctmc_transient(Qdiag, Qoff, rowsums, t, p, false, poisson_pdf, 1, opts);
+      //
+      // Right truncation
+      //
+      double tail = 0;
+      while (b.size() > 1 && tail + b.back() < epsilon) {
+        tail += b.back();
+        b.pop_back();
+      }
+      return true;
   }
-}
-
-
-// ******************************************************************
 
-namespace MCLib {
-  template <class MATRIX, class REAL>
-  void templ_dtmc_accumulate(MATRIX &Qdiag, MATRIX &Qoff, const REAL* diags,
-    int t, double* n, Markov_chain::DTMC_transient_options &opts)
+  template <class MATRIX>
+  void templ_ctmc_adaptive_transient(MATRIX &Qdiag, MATRIX &Qoff,
+    const double* rowsums, double t, double* p, bool normalize,
+    Markov_chain::CTMC_transient_options &opts)
   {
-      DCASSERT(diags);
       const long size = Qdiag.Size();
+      opts.multiplications = 0;
+      opts.poisson_right = 0;
+
+      std::vector <double> lambda;
+      adaptiveRates(Qdiag, Qoff, rowsums, p, lambda);
+      if (0==lambda.back()) return;   // nothing can move
+      const long m = long(lambda.size()) - 1;
+
+      //
+      // If the jump probabilities cost more than plain uniformization
+      // would, use that instead (with the largest reachable rate).
+      //
+      const double nnz = Qdiag.NumEntries(0, size) + Qoff.NumEntries(0, size);
+      std::vector <double> b;
+      if (!adaptiveJumpProbs(lambda, t, opts.epsilon,
+            (nnz + size) * (lambda.back() * t + 1), b))
+      {
+        const double q = opts.q;
+        opts.q = lambda.back();
+        discrete_pdf poisson_pdf;
+        computePoissonPDF(opts.q * t, opts.epsilon, poisson_pdf);
+        templ_ctmc_transient(Qdiag, Qoff, rowsums, t, p, normalize,
+          poisson_pdf, 1, opts);
+        opts.q = q;
+        return;
+      }
+      const long N = long(b.size()) - 1;
+      opts.poisson_right = N;
+
       //
       // Set up auxiliary vectors if necessary
       //
@@ -1303,40 +1590,779 @@ namespace MCLib {
         opts.accumulator = new double[size];
       }
       zeroArray(opts.accumulator, size);
-
       double* aux = opts.vm_result;
-      double* myp = n;
+      double* myp = p;
 
-      addToVector(opts.accumulator, n, size);
-#ifdef DEBUG_ACCUMULATE
-      showAccStep(0, n, opts.accumulator, size);
-#endif
+      addToVector(opts.accumulator, b[0], p, size);
 
-      for (opts.multiplications=0; opts.multiplications<t; opts.multiplications++) {
-        // VM multiply
+      //
+      // Step n uses rate lambda[n]: the vector has nonzeroes only
+      // in states reachable in n steps.
+      //
+      long n;
+      for (n=0; n<N; n++) {
+        const double q = lambda[MIN(n, m)];
         zeroArray(aux, size);
         Qdiag.VectorMatrixMultiply(aux, myp);
         Qoff.VectorMatrixMultiply(aux, myp);
-        adjustDiagonals(aux, myp, diags, size);
-
-        normalizeVector(aux, size);
+        adjustDiagonals(aux, myp, q, rowsums, size);
 
-        // aux is now the distribution after one step.
-        // Add it to the accumulator.
-        addToVector(opts.accumulator, aux, size);
+        if (normalize)  normalizeVector(aux, size);
+        else            divideVector(aux, q, size);
 
-#ifdef DEBUG_ACCUMULATE
-        showAccStep(1+opts.multiplications, aux, opts.accumulator, size);
-#endif
+        // Steady state is possible only once the rate is fixed
+        opts.multiplications++;
+        if (n >= m && vectorsWithinEpsilon(myp, aux, size, opts.ssprec)) break;
 
-        // Check if we've hit steady state
-        if (vectorsWithinEpsilon(myp, aux, size, opts.ssprec)) {
-          opts.multiplications++;
-          break;
-        }
-    
+        addToVector(opts.accumulator, b[n+1], aux, size);
         SWAP(aux, myp);
-      } // for opts.multiplications
+      } // for n
+
+      double remaining_probs = 0;
+      for (; n<N; n++) {
+        remaining_probs += b[n+1];
+      }
+      if (remaining_probs) {
+        addToVector(opts.accumulator, remaining_probs, aux, size);
+      }
+
+      memcpy(p, opts.accumulator, size * sizeof(double));
+  }
+
+  // ******************************************************************
+
+  /// C = A * B, for dense n by n matrices stored by rows.
+  inline void denseMultiply(const std::vector <double> &A,
+    const std::vector <double> &B, long n, std::vector <double> &C)
+  {
+      C.assign(n*n, 0.0);
+      for (long i=0; i<n; i++) {
+        for (long k=0; k<n; k++) {
+          const double a = A[i*n+k];
+          if (0==a) continue;
+          for (long j=0; j<n; j++) C[i*n+j] += a * B[k*n+j];
+        }
+      }
+  }
+
+  /**
+      Exponential of a small dense n by n matrix, stored by rows.
+      Uses a degree 6 Pade approximation with scaling and squaring.
+  */
+  inline void denseExp(const std::vector <double> &A, long n,
+    std::vector <double> &F)
+  {
+      const int deg = 6;
+      double norm = 0;
+      for (long i=0; i<n; i++) {
+        double sum = 0;
+        for (long j=0; j<n; j++) sum += fabs(A[i*n+j]);
+        norm = MAX(norm, sum);
+      }
+      int squarings = 0;
+      if (norm > 0.5) squarings = int(log(norm) / log(2.0)) + 2;
+      const double scale = ldexp(1.0, -squarings);
+
+      std::vector <double> X(A), P(n*n, 0.0), T;
+      for (long i=0; i<n*n; i++) X[i] *= scale;
+      for (long i=0; i<n; i++) P[i*n+i] = 1;
+      std::vector <double> N(P), D(P);
+      double c = 1;
+      for (int k=1; k<=deg; k++) {
+        c = c * (deg-k+1) / (k * (2*deg-k+1));
+        denseMultiply(P, X, n, T);
+        P.swap(T);
+        const double cd = (k % 2) ? -c : c;
+        for (long i=0; i<n*n; i++) {
+          N[i] += c * P[i];
+          D[i] += cd * P[i];
+        }
+      }
+
+      //
+      // F = D^{-1} N, by Gaussian elimination with partial pivoting
+      //
+      for (long k=0; k<n; k++) {
+        long piv = k;
+        for (long i=k+1; i<n; i++) {
+          if (fabs(D[i*n+k]) > fabs(D[piv*n+k])) piv = i;
+        }
+        if (piv != k) {
+          for (long j=0; j<n; j++) {
+            SWAP(D[k*n+j], D[piv*n+j]);
+            SWAP(N[k*n+j], N[piv*n+j]);
+          }
+        }
+        const double d = D[k*n+k];
+        if (0==d) throw MCLib::error(MCLib::error::Internal);
+        for (long i=k+1; i<n; i++) {
+          const double r = D[i*n+k] / d;
+          if (0==r) continue;
+          for (long j=k; j<n; j++) D[i*n+j] -= r * D[k*n+j];
+          for (long j=0; j<n; j++) N[i*n+j] -= r * N[k*n+j];
+        }
+      }
+      for (long k=n-1; k>=0; k--) {
+        for (long j=0; j<n; j++) {
+          double x = N[k*n+j];
+          for (long i=k+1; i<n; i++) x -= D[k*n+i] * N[i*n+j];
+          N[k*n+j] = x / D[k*n+k];
+        }
+      }
+
+      for (int s=0; s<squarings; s++) {
+        denseMultiply(N, N, n, T);
+        N.swap(T);
+      }
+      F.swap(N);
+  }
+
+  inline double norm2(const double* x, long size)
+  {
+      double sum = 0;
+      for (long i=0; i<size; i++) sum += x[i] * x[i];
+      return sqrt(sum);
+  }
+
+  inline double dotProduct(const double* x, const double* y, long size)
+  {
+      double sum = 0;
+      for (long i=0; i<size; i++) sum += x[i] * y[i];
+      return sum;
+  }
+
+  /// Round a Krylov time step to 2 significant digits, as Expokit does.
+  inline double roundStep(double h)
+  {
+      if (h <= 0) return h;
+      const double s = pow(10.0, floor(log10(h)) - 1);
+      return ceil(h / s) * s;
+  }
+
+  /**
+      Krylov subspace transient analysis, following Expokit's dgexpv:
+      Arnoldi on the generator, exponential of the small Hessenberg
+      matrix, and time steps chosen from a local error estimate.
+  */
+  template <class MATRIX>
+  void templ_ctmc_krylov_transient(MATRIX &Qdiag, MATRIX &Qoff,
+    const double* rowsums, double t, double* p, bool normalize,
+    Markov_chain::CTMC_transient_options &opts)
+  {
+      const long size = Qdiag.Size();
+      opts.multiplications = 0;
+      opts.poisson_right = 0;
+      if (0==size || t <= 0) return;
+
+      double anorm = 0;
+      for (long i=0; i<size; i++) anorm = MAX(anorm, rowsums[i]);
+      anorm *= 2;
+      if (0==anorm) return;   // nothing can move
+
+      const long m = MIN(MAX(2L, long(opts.krylov_dim)), size);
+      const long hn = m+2;
+      const double tol = MAX(opts.epsilon, 1e-12);
+      const double btol = 1e-7 * anorm;
+      const double gamma = 0.9;
+      const double delta = 1.2;
+      const int max_reject = 10;
+
+      //
+      // Set up auxiliary vectors if necessary
+      //
+      if (0== opts.vm_result) {
+        opts.vm_result = new double[size];
+      }
+      double* Av = opts.vm_result;
+      std::vector <double> V((m+1)*size);
+      std::vector <double> H, A, F;
+
+      double beta = norm2(p, size);
+      if (0==beta) return;
+      double xm = 1.0 / m;
+      const double fact = pow((m+1) / exp(1.0), double(m+1))
+                          * sqrt(2 * 3.14159265358979323846 * (m+1));
+      double t_new = roundStep(
+        (1/anorm) * pow((fact*tol) / (4*beta*anorm), xm)
+      );
+      double t_now = 0;
+
+      while (t_now < t) {
+        double t_step = MIN(t - t_now, t_new);
+
+        //
+        // Arnoldi process
+        //
+        H.assign(hn*hn, 0.0);
+        for (long i=0; i<size; i++) V[i] = p[i] / beta;
+        long mb = m;
+        long k1 = 2;
+        for (long j=0; j<m; j++) {
+          double* vj = V.data() + j*size;
+          double* vn = vj + size;
+          zeroArray(vn, size);
+          Qdiag.VectorMatrixMultiply(vn, vj);
+          Qoff.VectorMatrixMultiply(vn, vj);
+          adjustDiagonals(vn, vj, 0.0, rowsums, size);
+          opts.multiplications++;
+          for (long i=0; i<=j; i++) {
+            const double* vi = V.data() + i*size;
+            const double h = dotProduct(vi, vn, size);
+            H[i*hn+j] = h;
+            addToVector(vn, -h, vi, size);
+          }
+          const double s = norm2(vn, size);
+          if (s < btol) {
+            // happy breakdown: the subspace is invariant
+            k1 = 0;
+            mb = j+1;
+            t_step = t - t_now;
+            break;
+          }
+          H[(j+1)*hn+j] = s;
+          for (long i=0; i<size; i++) vn[i] /= s;
+        }
+        double avnorm = 0;
+        if (k1) {
+          H[(m+1)*hn+m] = 1;
+          const double* vm = V.data() + m*size;
+          zeroArray(Av, size);
+          Qdiag.VectorMatrixMultiply(Av, vm);
+          Qoff.VectorMatrixMultiply(Av, vm);
+          adjustDiagonals(Av, vm, 0.0, rowsums, size);
+          opts.multiplications++;
+          avnorm = norm2(Av, size);
+        }
+
+        //
+        // Local error estimate; shrink the step until it is acceptable
+        //
+        double err_loc = btol;
+        long mx = mb + k1;
+        for (int reject=0; ; reject++) {
+          A.resize(mx*mx);
+          for (long i=0; i<mx; i++) {
+            for (long j=0; j<mx; j++) A[i*mx+j] = t_step * H[i*hn+j];
+          }
+          denseExp(A, mx, F);
+          if (0==k1) break;
+
+          const double phi1 = fabs(beta * F[m*mx]);
+          const double phi2 = fabs(beta * F[(m+1)*mx] * avnorm);
+          if (phi1 > 10*phi2) {
+            err_loc = phi2;
+            xm = 1.0 / m;
+          } else if (phi1 > phi2) {
+            err_loc = (phi1*phi2) / (phi1-phi2);
+            xm = 1.0 / m;
+          } else {
+            err_loc = phi1;
+            xm = 1.0 / (m-1);
+          }
+          if (err_loc <= delta * t_step * tol) break;
+          if (reject >= max_reject) break;  // take the step anyway
+          t_step = roundStep(gamma * t_step * pow(t_step*tol/err_loc, xm));
+        }
+
+        //
+        // p = beta * V * F(:,0)
+        //
+        const long fn = mx;
+        mx = mb + MAX(0L, k1-1);
+        zeroArray(p, size);
+        for (long j=0; j<mx; j++) {
+          addToVector(p, beta * F[j*fn], V.data() + j*size, size);
+        }
+        beta = norm2(p, size);
+        t_now += t_step;
+        if (0==beta) break;
+        t_new = roundStep(gamma * t_step * pow(t_step*tol/err_loc, xm));
+      } // while t_now
+
+      //
+      // Remove round-off negatives
+      //
+      for (long i=0; i<size; i++) {
+        if (p[i] < 0) p[i] = 0;
+      }
+      if (normalize) normalizeVector(p, size);
+  }
+
+  // ******************************************************************
+
+  /// Transient analysis, using the method selected in opts.
+  template <class MATRIX>
+  void templ_ctmc_transient_method(MATRIX &Qdiag, MATRIX &Qoff,
+    const double* rowsums, double t, double* p, bool normalize,
+    Markov_chain::CTMC_transient_options &opts)
+  {
+      switch (opts.method) {
+        case Markov_chain::CTMC_transient_options::Adaptive_Uniformization:
+          templ_ctmc_adaptive_transient(Qdiag, Qoff, rowsums, t, p,
+            normalize, opts);
+          return;
+
+        case Markov_chain::CTMC_transient_options::Krylov:
+          templ_ctmc_krylov_transient(Qdiag, Qoff, rowsums, t, p,
+            normalize, opts);
+          return;
+
+        default:
+          discrete_pdf poisson_pdf;
+          computePoissonPDF(opts.q * t, opts.epsilon, poisson_pdf);
+          templ_ctmc_transient(Qdiag, Qoff, rowsums, t, p, normalize,
+            poisson_pdf, 1, opts);
+      }
+  }
+}
+
+// ******************************************************************
+
+void MCLib::Markov_chain::computeTransient(double t, double* p, 
+  CTMC_transient_options &opts) const
+{
+  if (0==p) {
+    throw MCLib::error(MCLib::error::Null_Vector);
+  }
+  if (isDiscrete()) {
+    throw MCLib::error(MCLib::error::Wrong_Type);
+  }
+
+  opts.q = MAX(opts.q, getUniformizationConst());
+
+  if (edge_values) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag, edge_values);
+    graphToMatrix(G_byrows_off, Qoff, edge_values);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_ctmc_transient_method(Qdiag, Qoff, rowsums, t, p, true, opts);
+  } else if (double_graphs) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Matrix_double Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag);
+    graphToMatrix(G_byrows_off, Qoff);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_ctmc_transient_method(Qdiag, Qoff, rowsums, t, p, true, opts);
+  } else {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Matrix_float Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag);
+    graphToMatrix(G_byrows_off, Qoff);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_ctmc_transient_method(Qdiag, Qoff, rowsums, t, p, true, opts);
+  }
+}
+
+
+// ******************************************************************
+
+void MCLib::Markov_chain::reverseTransient(double t, double* p, 
+  CTMC_transient_options &opts) const
+{
+  if (0==p) {
+    throw MCLib::error(MCLib::error::Null_Vector);
+  }
+  if (isDiscrete()) {
+    throw MCLib::error(MCLib::error::Wrong_Type);
+  }
+
+  opts.q = MAX(opts.q, getUniformizationConst());
+
+  if (edge_values) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_bycols_diag, Qdiag, edge_values);
+    graphToMatrix(G_bycols_off, Qoff, edge_values);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_ctmc_transient_method(Qdiag, Qoff, rowsums, t, p, false, opts);
+  } else if (double_graphs) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Matrix_double Qdiag, Qoff;
+    graphToMatrix(G_bycols_diag, Qdiag);
+    graphToMatrix(G_bycols_off, Qoff);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_ctmc_transient_method(Qdiag, Qoff, rowsums, t, p, false, opts);
+  } else {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Matrix_float Qdiag, Qoff;
+    graphToMatrix(G_bycols_diag, Qdiag);
+    graphToMatrix(G_bycols_off, Qoff);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_ctmc_transient_method(Qdiag, Qoff, rowsums, t, p, false, opts);
+  }
+}
+
+// ******************************************************************
+
+namespace MCLib {
+  template <class MATRIX, class DISTRO>
+  void templ_ctmc_block_transient(MATRIX &Qdiag, MATRIX &Qoff,
+    const double* rowsums, double* P, int k, bool normalize,
+    const DISTRO &dist, Markov_chain::CTMC_transient_options &opts)
+  {
+      const long size = Qdiag.Size();
+      const long total = size * k;
+      opts.poisson_right = dist.right_trunc();
+      opts.multiplications = 0;
+
+      std::vector <double> acc, aux;
+      std::vector <double> sums(k);
+      try {
+        acc.resize(total);
+        aux.resize(total);
+      }
+      catch (std::bad_alloc &) {
+        throw MCLib::error(MCLib::error::Out_Of_Memory);
+      }
+      double* myaux = aux.data();
+      double* myp = P;
+
+      for (long i=0; i<total; i++) acc[i] = dist.f(0) * P[i];
+
+      long n;
+      for (n=0; n<dist.right_trunc(); n++) {
+        // Block VM multiply
+        zeroArray(myaux, total);
+        Qdiag.BlockVectorMatrixMultiply(myaux, myp, k);
+        Qoff.BlockVectorMatrixMultiply(myaux, myp, k);
+        for (long s=0; s<size; s++) {
+          const double d = opts.q - rowsums[s];
+          for (int j=0; j<k; j++) myaux[s*k+j] += d * myp[s*k+j];
+        }
+
+        if (normalize) {
+          for (int j=0; j<k; j++) sums[j] = 0;
+          for (long s=0; s<size; s++) {
+            for (int j=0; j<k; j++) sums[j] += myaux[s*k+j];
+          }
+          for (int j=0; j<k; j++) {
+            if (sums[j]) sums[j] = 1.0 / sums[j];
+          }
+          for (long s=0; s<size; s++) {
+            for (int j=0; j<k; j++) myaux[s*k+j] *= sums[j];
+          }
+        } else {
+          divideVector(myaux, opts.q, total);
+        }
+
+        opts.multiplications++;
+        if (vectorsWithinEpsilon(myp, myaux, total, opts.ssprec)) break;
+
+        addToVector(acc.data(), dist.f(n+1), myaux, total);
+        SWAP(myaux, myp);
+      } // for n
+
+      double remaining_probs = 0;
+      for (; n<dist.right_trunc(); n++) {
+        remaining_probs += dist.f(n+1);
+      }
+      if (remaining_probs) {
+        addToVector(acc.data(), remaining_probs, myaux, total);
+      }
+
+      memcpy(P, acc.data(), total * sizeof(double));
+  }
+}
+
+// ******************************************************************
+
+void MCLib::Markov_chain::computeTransient(double t, double* P, int k,
+  CTMC_transient_options &opts) const
+{
+  if (0==P) {
+    throw MCLib::error(MCLib::error::Null_Vector);
+  }
+  if (isDiscrete()) {
+    throw MCLib::error(MCLib::error::Wrong_Type);
+  }
+  if (k<1) return;
+
+  opts.q = MAX(opts.q, getUniformizationConst());
+
+  discrete_pdf poisson_pdf;
+  computePoissonPDF(opts.q * t, opts.epsilon, poisson_pdf);
+
+  if (edge_values) {
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag, edge_values);
+    graphToMatrix(G_byrows_off, Qoff, edge_values);
+    templ_ctmc_block_transient(Qdiag, Qoff, rowsums, P, k, true,
+      poisson_pdf, opts);
+  } else if (double_graphs) {
+    LS_CRS_Matrix_double Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag);
+    graphToMatrix(G_byrows_off, Qoff);
+    templ_ctmc_block_transient(Qdiag, Qoff, rowsums, P, k, true,
+      poisson_pdf, opts);
+  } else {
+    LS_CRS_Matrix_float Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag);
+    graphToMatrix(G_byrows_off, Qoff);
+    templ_ctmc_block_transient(Qdiag, Qoff, rowsums, P, k, true,
+      poisson_pdf, opts);
+  }
+}
+
+// ******************************************************************
+
+void MCLib::Markov_chain::reverseTransient(double t, double* X, int k,
+  CTMC_transient_options &opts) const
+{
+  if (0==X) {
+    throw MCLib::error(MCLib::error::Null_Vector);
+  }
+  if (isDiscrete()) {
+    throw MCLib::error(MCLib::error::Wrong_Type);
+  }
+  if (k<1) return;
+
+  opts.q = MAX(opts.q, getUniformizationConst());
+
+  discrete_pdf poisson_pdf;
+  computePoissonPDF(opts.q * t, opts.epsilon, poisson_pdf);
+
+  if (edge_values) {
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_bycols_diag, Qdiag, edge_values);
+    graphToMatrix(G_bycols_off, Qoff, edge_values);
+    templ_ctmc_block_transient(Qdiag, Qoff, rowsums, X, k, false,
+      poisson_pdf, opts);
+  } else if (double_graphs) {
+    LS_CRS_Matrix_double Qdiag, Qoff;
+    graphToMatrix(G_bycols_diag, Qdiag);
+    graphToMatrix(G_bycols_off, Qoff);
+    templ_ctmc_block_transient(Qdiag, Qoff, rowsums, X, k, false,
+      poisson_pdf, opts);
+  } else {
+    LS_CRS_Matrix_float Qdiag, Qoff;
+    graphToMatrix(G_bycols_diag, Qdiag);
+    graphToMatrix(G_bycols_off, Qoff);
+    templ_ctmc_block_transient(Qdiag, Qoff, rowsums, X, k, false,
+      poisson_pdf, opts);
+  }
+}
+
+
+
+// ******************************************************************
+
+namespace MCLib {
+  template <class MATRIX>
+  void templ_ctmc_multi_transient(MATRIX &Qdiag, MATRIX &Qoff,
+    const double* rowsums, const double* times, long ntimes, const double* p,
+    double** dists, const discrete_pdf* poisson,
+    Markov_chain::CTMC_transient_options &opts)
+  {
+      const long size = Qdiag.Size();
+      //
+      // Set up auxiliary vectors if necessary
+      //
+      if (0== opts.vm_result) {
+        opts.vm_result = new double[size];
+      }
+      if (0== opts.accumulator) {
+        opts.accumulator = new double[size];
+      }
+
+      //
+      // Initialize vectors; times 0 are just p.
+      // Poisson windows are sorted, because times are.
+      //
+      opts.poisson_right = 0;
+      long first = 0;
+      for (long j=0; j<ntimes; j++) {
+        if (0==times[j]) {
+          memcpy(dists[j], p, size * sizeof(double));
+          first = j+1;
+          continue;
+        }
+        opts.poisson_right = MAX(opts.poisson_right, poisson[j].right_trunc());
+        zeroArray(dists[j], size);
+        addToVector(dists[j], poisson[j].f(0), p, size);
+      }
+      double* aux = opts.vm_result;
+      double* myp = opts.accumulator;
+      memcpy(myp, p, size * sizeof(double));
+
+      //
+      // Loop and add the vector after n steps, to every
+      // time whose window contains n
+      //
+      opts.multiplications = 0;
+      long i;
+      for (i=0; i<opts.poisson_right; i++) {
+        // VM multiply
+        zeroArray(aux, size);
+        Qdiag.VectorMatrixMultiply(aux, myp);
+        Qoff.VectorMatrixMultiply(aux, myp);
+        adjustDiagonals(aux, myp, opts.q, rowsums, size);
+        normalizeVector(aux, size);
+
+        // Check if we've hit steady state
+        opts.multiplications++;
+        if (vectorsWithinEpsilon(myp, aux, size, opts.ssprec)) break;
+
+        // Skip times whose windows are done
+        while (first < ntimes && poisson[first].right_trunc() <= i) first++;
+
+        for (long j=first; j<ntimes; j++) {
+          const double w = poisson[j].f(i+1);
+          if (w) addToVector(dists[j], w, aux, size);
+        }
+
+        SWAP(aux, myp);
+      } // for i
+
+      // If we detected steady state, then finish the computation
+      // assuming aux vector does not change.
+      for (long j=first; j<ntimes; j++) {
+        double remaining_probs = 0;
+        for (long k=i; k<poisson[j].right_trunc(); k++) {
+          remaining_probs += poisson[j].f(k+1);
+        }
+        if (remaining_probs) {
+          addToVector(dists[j], remaining_probs, aux, size);
+        }
+      }
+  }
+}
+
+// ******************************************************************
+
+void MCLib::Markov_chain::computeTransient(const double* times, long ntimes,
+  const double* p, double** dists, CTMC_transient_options &opts) const
+{
+  if (0==p || 0==times || 0==dists) {
+    throw MCLib::error(MCLib::error::Null_Vector);
+  }
+  if (isDiscrete()) {
+    throw MCLib::error(MCLib::error::Wrong_Type);
+  }
+  for (long j=0; j<ntimes; j++) {
+    if (0==dists[j]) {
+      throw MCLib::error(MCLib::error::Null_Vector);
+    }
+    if (times[j] < 0 || (j && times[j] < times[j-1])) {
+      throw MCLib::error(MCLib::error::Bad_Time);
+    }
+  }
+
+  opts.q = MAX(opts.q, getUniformizationConst());
+
+  //
+  // Set up poisson distributions
+  //
+  std::vector <discrete_pdf> poisson(ntimes);
+  for (long j=0; j<ntimes; j++) {
+    if (times[j]) computePoissonPDF(opts.q * times[j], opts.epsilon, poisson[j]);
+  }
+
+  if (edge_values) {
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag, edge_values);
+    graphToMatrix(G_byrows_off, Qoff, edge_values);
+    templ_ctmc_multi_transient(Qdiag, Qoff, rowsums, times, ntimes, p, dists,
+      poisson.data(), opts);
+  } else if (double_graphs) {
+    LS_CRS_Matrix_double Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag);
+    graphToMatrix(G_byrows_off, Qoff);
+    templ_ctmc_multi_transient(Qdiag, Qoff, rowsums, times, ntimes, p, dists,
+      poisson.data(), opts);
+  } else {
+    LS_CRS_Matrix_float Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag);
+    graphToMatrix(G_byrows_off, Qoff);
+    templ_ctmc_multi_transient(Qdiag, Qoff, rowsums, times, ntimes, p, dists,
+      poisson.data(), opts);
+  }
+}
+
+
+// ******************************************************************
+
+namespace MCLib {
+  template <class MATRIX, class REAL>
+  void templ_dtmc_accumulate(MATRIX &Qdiag, MATRIX &Qoff, const REAL* diags,
+    int t, double* n, Markov_chain::DTMC_transient_options &opts)
+  {
+      DCASSERT(diags);
+      const long size = Qdiag.Size();
+      //
+      // Set up auxiliary vectors if necessary
+      //
+      if (0== opts.vm_result) {
+        opts.vm_result = new double[size];
+      }
+      if (0== opts.accumulator) {
+        opts.accumulator = new double[size];
+      }
+      zeroArray(opts.accumulator, size);
+
+      double* aux = opts.vm_result;
+      double* myp = n;
+
+      addToVector(opts.accumulator, n, size);
+#ifdef DEBUG_ACCUMULATE
+      showAccStep(0, n, opts.accumulator, size);
+#endif
+
+      for (opts.multiplications=0; opts.multiplications<t; opts.multiplications++) {
+        // VM multiply
+        zeroArray(aux, size);
+        Qdiag.VectorMatrixMultiply(aux, myp);
+        Qoff.VectorMatrixMultiply(aux, myp);
+        adjustDiagonals(aux, myp, diags, size);
+
+        normalizeVector(aux, size);
+
+        // aux is now the distribution after one step.
+        // Add it to the accumulator.
+        addToVector(opts.accumulator, aux, size);
+
+#ifdef DEBUG_ACCUMULATE
+        showAccStep(1+opts.multiplications, aux, opts.accumulator, size);
+#endif
+
+        // Check if we've hit steady state
+        if (vectorsWithinEpsilon(myp, aux, size, opts.ssprec)) {
+          opts.multiplications++;
+          break;
+        }
+    
+        SWAP(aux, myp);
+      } // for opts.multiplications
 
       //
       // If we bailed out early because aux has converged,
@@ -1371,7 +2397,19 @@ void MCLib::Markov_chain::accumulate(int t, const double* p0, double* n0t,
     memcpy(n0t, p0, getNumStates() * sizeof(double));
   }
 
-  if (double_graphs) {
+  if (edge_values) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag, edge_values);
+    graphToMatrix(G_byrows_off, Qoff, edge_values);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_dtmc_accumulate(Qdiag, Qoff, selfloops_d, t, n0t, opts);
+  } else if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
@@ -1441,7 +2479,19 @@ void MCLib::Markov_chain::accumulate(double t, const double* p0, double* n0t,
     memcpy(n0t, p0, getNumStates() * sizeof(double));
   }
 
-  if (double_graphs) {
+  if (edge_values) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag, edge_values);
+    graphToMatrix(G_byrows_off, Qoff, edge_values);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_ctmc_transient(Qdiag, Qoff, rowsums, t, n0t, true, poisson_1mcdf, opts.q, opts);
+  } else if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
@@ -1511,7 +2561,21 @@ void MCLib::Markov_chain::computeTTA(const LS_Vector &p0, double* p,
   // where n gives the expected time spent in each state.
   // Note: since we actually use p0, we need to negate n when we're done.
 
-  if (double_graphs) {
+  if (edge_values) {
+    //
+    // Set up matrix (shallow copies here)
+    //
+    LS_CRS_Indexed_Matrix Qtt;
+    graphToMatrix(G_bycols_diag, Qtt, edge_values);
+    Qtt.start = stateClass.firstNodeOfClass(0);
+    Qtt.stop  = 1+stateClass.lastNodeOfClass(0);
+    Qtt.one_over_diag = one_over_rowsums_d;
+
+    //
+    // Call the linear solver
+    //
+    Solve_Axb(Qtt, p, p0, opt, out);
+  } else if (double_graphs) {
     //
     // Set up matrix (shallow copies here)
     //
@@ -1572,7 +2636,18 @@ void MCLib::Markov_chain::computeFirstRecurrentProbs(const LS_Vector &p0,
     // Multiply np by  Pta
     //
 
-    if (double_graphs) {
+    if (edge_values) {
+      //
+      // Set up matrix (shallow copies here)
+      //
+      LS_CRS_Indexed_Matrix Qta;
+      graphToMatrix(G_byrows_off, Qta, edge_values);
+      
+      //
+      // Multiply np += np * Qta 
+      //
+      Qta.VectorMatrixMultiply(np, np);
+    } else if (double_graphs) {
       //
       // Set up matrix (shallow copies here)
       //
@@ -1694,7 +2769,21 @@ void MCLib::Markov_chain::computeInfinityDistribution(const LS_Vector &p0,
       p[i] = 1;
     } // for i
 
-    if (double_graphs) {
+    if (edge_values) {
+      //
+      // Set up matrix (shallow copies here)
+      //
+      LS_CRS_Indexed_Matrix Qcc;
+      graphToMatrix(G_bycols_diag, Qcc, edge_values);
+      Qcc.start = stateClass.firstNodeOfClass(c);
+      Qcc.stop  = 1+stateClass.lastNodeOfClass(c);
+      Qcc.one_over_diag = one_over_rowsums_d;
+
+      //
+      // Call the linear solver
+      //
+      Solve_AxZero(Qcc, p, opt, out);
+    } else if (double_graphs) {
       //
       // Set up matrix (shallow copies here)
       //
@@ -1795,7 +2884,31 @@ void MCLib::Markov_chain::computeProbsToReach(const intset &target, double* p,
   // Build b = -Qta * target, and then solve Qtt * p = b
   //
   zeroArray(myaux, getNumStates());
-  if (double_graphs) {
+  if (edge_values) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Indexed_Matrix Qta;
+    LS_CRS_Indexed_Matrix Qtt;
+    graphToMatrix(G_byrows_diag, Qtt, edge_values);
+    Qtt.start = stateClass.firstNodeOfClass(0);
+    Qtt.stop  = 1+stateClass.lastNodeOfClass(0);
+    Qtt.one_over_diag = one_over_rowsums_d;
+    graphToMatrix(G_byrows_off, Qta, edge_values);
+
+    //
+    // Multiply b += Qta * p, then negate it
+    //
+    Qta.MatrixVectorMultiply(myaux, p);
+    for (long i=stateClass.firstNodeOfClass(0); i<=stateClass.lastNodeOfClass(0); i++) {
+      myaux[i] = -myaux[i];
+    } // for i
+
+    //
+    // Call the linear solver
+    //
+    Solve_Axb(Qtt, p, b, opt, out);
+  } else if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
@@ -1856,6 +2969,86 @@ void MCLib::Markov_chain::computeProbsToReach(const intset &target, double* p,
 
 // ******************************************************************
 
+namespace MCLib {
+  template <class MATRIX>
+  void templ_block_probs_to_reach(MATRIX &Qtt, MATRIX &Qta, double* P,
+    int k, const LS_Options &opt, LS_Output &out)
+  {
+      const long size = Qtt.Size();
+      std::vector <double> B;
+      try {
+        B.resize(size * k);
+      }
+      catch (std::bad_alloc &) {
+        throw MCLib::error(MCLib::error::Out_Of_Memory);
+      }
+
+      //
+      // Build B = -Qta * targets, and then solve Qtt * P = B
+      //
+      Qta.BlockMatrixVectorMultiply(B.data(), P, k);
+      for (long i=Qtt.Start()*k; i<Qtt.Stop()*k; i++) {
+        B[i] = -B[i];
+      }
+      Solve_Axb_Block(Qtt, P, B.data(), k, opt, out);
+  }
+}
+
+// ******************************************************************
+
+void MCLib::Markov_chain::computeProbsToReach(const intset* targets, int k,
+      double* P, const LS_Options &opt, LS_Output &out) const
+{
+  if (0==P || 0==targets) {
+    throw MCLib::error(MCLib::error::Null_Vector);
+  }
+  if (k<1) return;
+
+  //
+  // Set P[i*k+j] = 1, if i is recurrent and belongs to target j; 0 otherwise
+  //
+  zeroArray(P, getNumStates() * k);
+  for (int j=0; j<k; j++) {
+    long i = stateClass.lastNodeOfClass(0);
+    for (i = targets[j].getSmallestAfter(i); i>=0 && i<getNumStates();
+         i = targets[j].getSmallestAfter(i))
+    {
+      P[i*k+j] = 1;
+    }  // for i
+  } // for j
+
+  if (edge_values) {
+    LS_CRS_Indexed_Matrix Qta;
+    LS_CRS_Indexed_Matrix Qtt;
+    graphToMatrix(G_byrows_diag, Qtt, edge_values);
+    Qtt.start = stateClass.firstNodeOfClass(0);
+    Qtt.stop  = 1+stateClass.lastNodeOfClass(0);
+    Qtt.one_over_diag = one_over_rowsums_d;
+    graphToMatrix(G_byrows_off, Qta, edge_values);
+    templ_block_probs_to_reach(Qtt, Qta, P, k, opt, out);
+  } else if (double_graphs) {
+    LS_CRS_Matrix_double Qta;
+    LS_CRS_Matrix_double Qtt;
+    graphToMatrix(G_byrows_diag, Qtt);
+    Qtt.start = stateClass.firstNodeOfClass(0);
+    Qtt.stop  = 1+stateClass.lastNodeOfClass(0);
+    Qtt.one_over_diag = one_over_rowsums_d;
+    graphToMatrix(G_byrows_off, Qta);
+    templ_block_probs_to_reach(Qtt, Qta, P, k, opt, out);
+  } else {
+    LS_CRS_Matrix_float Qta;
+    LS_CRS_Matrix_float Qtt;
+    graphToMatrix(G_byrows_diag, Qtt);
+    Qtt.start = stateClass.firstNodeOfClass(0);
+    Qtt.stop  = 1+stateClass.lastNodeOfClass(0);
+    Qtt.one_over_diag = one_over_rowsums_f;
+    graphToMatrix(G_byrows_off, Qta);
+    templ_block_probs_to_reach(Qtt, Qta, P, k, opt, out);
+  }
+}
+
+// ******************************************************************
+
 namespace MCLib {
   template <class MATRIX>
   void templ_dtmc_distro(MATRIX &Qdiag, MATRIX &Qoff, const double* rowsums,
@@ -2039,7 +3232,20 @@ void MCLib::Markov_chain::computeDiscreteDistTTA(
   // vector matrix multiplications and real work.
   //
 
-  if (double_graphs) {
+  if (edge_values) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag, edge_values);
+    graphToMatrix(G_byrows_off, Qoff, edge_values);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_dtmc_distro(Qdiag, Qoff, rowsums, opts, 1, cstart, cstop, 
+      1+stateClass.lastNodeOfClass(0), dist);
+  } else if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
@@ -2126,7 +3332,20 @@ void MCLib::Markov_chain::computeContinuousDistTTA(
   //
   discrete_pdf dtmc_tta;
 
-  if (double_graphs) {
+  if (edge_values) {
+    //
+    // Set up matrices (shallow copies here)
+    //
+    LS_CRS_Indexed_Matrix Qdiag, Qoff;
+    graphToMatrix(G_byrows_diag, Qdiag, edge_values);
+    graphToMatrix(G_byrows_off, Qoff, edge_values);
+
+    //
+    // And pass everything to our nice template function :^)
+    //
+    templ_dtmc_distro(Qdiag, Qoff, rowsums, opts, opts.q, cstart, cstop, 
+      1+stateClass.lastNodeOfClass(0), dtmc_tta);
+  } else if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
@@ -2289,7 +3508,9 @@ long MCLib::Markov_chain::randomWalk(rng_stream &rng, long &state,
     //
     long next;
     double total = 0;
-    if (double_graphs) {
+    if (edge_values) {
+      next = indexed_graph_edge_idf(G_byrows_diag, edge_values, state, u, total);
+    } else if (double_graphs) {
       next = double_graph_edge_idf(G_byrows_diag, state, u, total);
     } else {
       next = float_graph_edge_idf(G_byrows_diag, state, u, total);
@@ -2302,7 +3523,9 @@ long MCLib::Markov_chain::randomWalk(rng_stream &rng, long &state,
     //
     // Not found, try off-diagonal block
     //
-    if (double_graphs) {
+    if (edge_values) {
+      next = indexed_graph_edge_idf(G_byrows_off, edge_values, state, u, total);
+    } else if (double_graphs) {
       next = double_graph_edge_idf(G_byrows_off, state, u, total);
     } else {
       next = float_graph_edge_idf(G_byrows_off, state, u, total);
@@ -2374,7 +3597,9 @@ double MCLib::Markov_chain::randomWalk(rng_stream &rng, long &state,
     //
     long next;
     double total = 0;
-    if (double_graphs) {
+    if (edge_values) {
+      next = indexed_graph_edge_idf(G_byrows_diag, edge_values, state, u, total);
+    } else if (double_graphs) {
       next = double_graph_edge_idf(G_byrows_diag, state, u, total);
     } else {
       next = float_graph_edge_idf(G_byrows_diag, state, u, total);
@@ -2387,7 +3612,9 @@ double MCLib::Markov_chain::randomWalk(rng_stream &rng, long &state,
     //
     // Not found, try off-diagonal block
     //
-    if (double_graphs) {
+    if (edge_values) {
+      next = indexed_graph_edge_idf(G_byrows_off, edge_values, state, u, total);
+    } else if (double_graphs) {
       next = double_graph_edge_idf(G_byrows_off, state, u, total);
     } else {
       next = float_graph_edge_idf(G_byrows_off, state, u, total);
@@ -16,6 +16,12 @@
 #include "../_IntSets/intset.h"
 #include "../_Distros/distros.h"
 
+#include <type_traits>
+
+// Matrices are built directly on top of the graph edge arrays.
+static_assert(std::is_same <GraphLib::node_index, LS_Index>::value,
+  "GRAPHLIB_LONG_NODE_INDEX and LS_LONG_INDEX must be defined together");
+
 namespace MCLib {
 
   // ======================================================================
@@ -123,21 +129,43 @@ namespace MCLib {
 
       /// Options and auxiliary vectors for transient analysis of CTMCs.
       struct CTMC_transient_options : public DTMC_transient_options {
+        /// Methods for computing transient distributions.
+        enum transient_method {
+          /// Uniformization, with the largest rowsum (or q).
+          Uniformization,
+          /** Adaptive uniformization: the rate grows with the set of
+              states reachable after each jump, so that slow states near
+              the start do not pay for fast states far away.
+              The uniformization constant q is ignored.
+          */
+          Adaptive_Uniformization,
+          /** Krylov subspace approximation of the matrix exponential,
+              with time stepping and local error control.
+              Needs krylov_dim+1 extra vectors, allocated here.
+          */
+          Krylov
+        };
+        /// Which method to use.
+        transient_method method;
         /** Uniformization constant to use (if possible).
             If not large enough, we will change the value.
         */
         double q;
-        /// Precision for poisson distribution
+        /// Precision for poisson distribution (Krylov: local error, at least 1e-12)
         double epsilon;
         /// Output: right truncation point of poisson.
         long poisson_right;
-        
+        /// Krylov subspace dimension.
+        int krylov_dim;
+
         /** 
           Constructor; sets reasonable defaults
         */
         CTMC_transient_options() {
+          method = Uniformization;
           q = 0;  // Use smallest possible.
           epsilon = 1e-20;
+          krylov_dim = 30;
         }
 
       };
@@ -258,10 +286,19 @@ namespace MCLib {
                                 to recurrent classes.
 
             @param  sw  Where to report timing information (nowhere if 0).
+
+            @param  reorder     If true, renumber the states within
+                                each class, for better memory locality
+                                during numerical solution; the caller
+                                must then apply takeLocalityRenumberer()
+                                to its own state numbers.
+
+            @param  ord         Ordering to use, if reorder is true.
       */
       Markov_chain(bool discrete, GraphLib::dynamic_summable<double> &G, 
         const GraphLib::static_classifier &TSCCinfo,
-        GraphLib::timer_hook *sw);  
+        GraphLib::timer_hook *sw, bool reorder = false,
+        GraphLib::locality_order ord = GraphLib::RCM_Order);
 
 
       /**
@@ -288,10 +325,19 @@ namespace MCLib {
                                 to recurrent classes.
 
             @param  sw  Where to report timing information (nowhere if 0).
+
+            @param  reorder     If true, renumber the states within
+                                each class, for better memory locality
+                                during numerical solution; the caller
+                                must then apply takeLocalityRenumberer()
+                                to its own state numbers.
+
+            @param  ord         Ordering to use, if reorder is true.
       */
       Markov_chain(bool discrete, GraphLib::dynamic_summable<float> &G, 
         const GraphLib::static_classifier &TSCCinfo,
-        GraphLib::timer_hook *sw);  
+        GraphLib::timer_hook *sw, bool reorder = false,
+        GraphLib::locality_order ord = GraphLib::RCM_Order);
 
 
 
@@ -299,6 +345,18 @@ namespace MCLib {
       ~Markov_chain();
 
     public:
+      /**
+          Renumbering of states done for locality during construction,
+          from the numbering of the graph passed to the constructor.
+          The caller becomes responsible for deleting it.
+            @return The renumbering, or 0 if none was done.
+      */
+      inline GraphLib::node_renumberer* takeLocalityRenumberer() {
+        GraphLib::node_renumberer* r = locality;
+        locality = 0;
+        return r;
+      }
+
       /// Is this a discrete-time chain?
       inline bool isDiscrete() const { return is_discrete; }
 
@@ -358,6 +416,30 @@ namespace MCLib {
         return double_graphs;
       }
 
+      /**
+          Store each distinct edge value once, in a table of doubles,
+          and replace the edge labels of the graphs by 16-bit indexes
+          into that table.  Chains built from a model usually have
+          only a handful of distinct rates or probabilities, so this
+          shrinks the graphs (by 3/4 for doubles, 1/2 for floats)
+          and the memory traffic of every numerical solution.
+          Self loops and row sums become doubles, so afterwards
+          the graphs behave as if they were stored with doubles.
+
+            @return true,   if the edges are now stored indexed;
+                    false,  if there are too many distinct values
+                            (more than 65536), and nothing changed.
+      */
+      bool compressEdgeValues();
+
+      /**
+          Return true if the edge labels are indexes
+          into a table of distinct values.
+      */
+      inline bool edgesStoredIndexed() const {
+        return edge_values;
+      }
+
       /**
           Run graph traversal t, on outgoing edges.
 
@@ -423,6 +505,9 @@ namespace MCLib {
                           On output: distribution at time t.
 
           @param  opts    Options and auxiliary vectors.
+                          opts.method selects the algorithm;
+                          for all of them, opts.multiplications is
+                          the number of vector-matrix multiplies.
       */
       void computeTransient(double t, double* p, CTMC_transient_options &opts) 
       const;
@@ -462,6 +547,72 @@ namespace MCLib {
       const;
 
 
+      /** Compute the distributions at several times, given the starting
+          distribution, with a single uniformization pass.
+          Must be a CTMC.
+          The vectors p * P^n are computed once, and shared by the
+          (overlapping) Poisson windows of all the times; the cost is
+          about the same as computeTransient() for the largest time.
+
+          @param  times   Times, in non-decreasing order.
+
+          @param  ntimes  Number of times.
+
+          @param  p       Distribution at time 0; not modified.
+
+          @param  dists   On output: dists[j] is the distribution
+                          at time times[j].  Each vector must have
+                          the same dimension as p, and must not
+                          overlap p or the auxiliary vectors.
+
+          @param  opts    Options and auxiliary vectors.
+                          opts.method is ignored; this is always
+                          standard uniformization.
+                          On output, poisson_right is the largest
+                          right truncation point.
+      */
+      void computeTransient(const double* times, long ntimes, const double* p,
+        double** dists, CTMC_transient_options &opts) const;
+
+      /** Compute the distributions at time t, for a block of k
+          starting distributions at once.  Must be a CTMC.
+          The vectors are stored interleaved: the probability of
+          state s in distribution j is P[s*k+j].
+          Each vector-matrix multiply reads the matrix once for all
+          k vectors.  This always uses standard uniformization,
+          with steady-state detection over the whole block.
+
+          @param  t       Time.
+
+          @param  P       On input: k distributions at time 0.
+                          On output: the k distributions at time t.
+
+          @param  k       Number of distributions.
+
+          @param  opts    Options; the auxiliary vectors are not used,
+                          we allocate (two) blocks of our own.
+      */
+      void computeTransient(double t, double* P, int k,
+        CTMC_transient_options &opts) const;
+
+      /** Compute expectations at time t, for all possible starting
+          states, for a block of k functions at once.  Must be a CTMC.
+          This is reverseTransient() for k vectors, stored interleaved
+          as for the block computeTransient().
+
+          @param  t   Time
+
+          @param  X   On input: k functions to compute expectations over.
+                      On output: expected values for each starting state.
+
+          @param  k   Number of functions.
+
+          @param  opts    Options; the auxiliary vectors are not used.
+      */
+      void reverseTransient(double t, double* X, int k,
+        CTMC_transient_options &opts) const;
+
+
 
       /** Compute the accumulated time spent in every state, up
           to and including time t.
@@ -571,6 +722,10 @@ namespace MCLib {
                         chain is in state s, as time goes to infinity.
 
           @param  opt   Options for linear solver.
+                        Each recurrent class is solved separately;
+                        for LS_Aggregation, the blocks are chosen
+                        within each class, or taken from 
+                        opt.aggregates, indexed by state handle.
 
           @param  out   Linear solver status information as output.
       */
@@ -606,6 +761,26 @@ namespace MCLib {
       */
       void computeProbsToReach(const intset &target, double* p, double* aux, 
         const LS_Options &opt, LS_Output &out) const;
+
+      /** Determine probabilities to eventually hit one of the target states,
+          for k target sets at once; see computeProbsToReach().
+          The linear solver reads the matrix once per iteration
+          for all k sets (for Gauss-Seidel and Jacobi).
+
+            @param  targets   Array of k sets of target states.
+
+            @param  k         Number of target sets.
+
+            @param  P         Solution vectors, stored interleaved:
+                              P[s*k+j] is the probability to reach
+                              targets[j] from state s.
+
+            @param  opt       Options for linear solver.
+
+            @param  out       Linear solver status information as output.
+      */
+      void computeProbsToReach(const intset* targets, int k, double* P,
+        const LS_Options &opt, LS_Output &out) const;
         
 
 
@@ -696,7 +871,20 @@ namespace MCLib {
           Moved here to eliminate code duplication.
       */
       void finish_construction(GraphLib::dynamic_graph &G, 
-        GraphLib::timer_hook *sw);
+        GraphLib::timer_hook *sw, bool reorder, GraphLib::locality_order ord);
+
+      /**
+          Label of edge z in graph G, as passed to traversals:
+          a pointer to a double if the edges are indexed.
+      */
+      inline const void* edgeLabel(const GraphLib::static_graph &G, 
+        long z) const 
+      {
+        if (edge_values) {
+          return edge_values + ((const unsigned short*) G.Labels())[z];
+        }
+        return G.Label(z);
+      }
 
     private:
       /**
@@ -722,6 +910,9 @@ namespace MCLib {
           For a CTMC, this will be null.
       */
       float* selfloops_f;
+
+      /// Renumbering for locality, until the caller takes it.
+      GraphLib::node_renumberer* locality;
       
       /**
           Row sums.
@@ -772,6 +963,17 @@ namespace MCLib {
       /// Did we build from a graph of doubles?
       bool double_graphs;
 
+      /**
+          Table of distinct edge values, or null.
+          If set, the edge labels of all four graphs are
+          unsigned shorts, indexing this table.
+          See compressEdgeValues().
+      */
+      double* edge_values;
+
+      /// Size of the edge_values table.
+      long num_edge_values;
+
   };  // class Markov_chain
 
 
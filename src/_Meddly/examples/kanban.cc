@@ -74,6 +74,7 @@ int usage(const char* who)
   printf("\t-exact:  determine the exact number of states (requires gmp)\n\n");
   printf("\t-exp: use explicit (very slow)\n\n");
   printf("\t--batch b: specify explicit batch size\n\n");
+  printf("\t-ctdirect: use the direct-mapped compute table\n\n");
   printf("\t -l lfile: Write logging information to specified file\n\n");
   printf("\t-pdf: write the MDD representing the reachable states to Kanban.pdf\n\n");
   return 1;
@@ -100,6 +101,7 @@ int main(int argc, const char** argv)
   const char* lfile = 0;
   bool build_pdf = false;
   bool approx_count = true;
+  bool direct_ct = false;
 
   for (int i=1; i<argc; i++) {
     if (strcmp("-bfs", argv[i])==0) {
@@ -148,6 +150,10 @@ int main(int argc, const char** argv)
       build_pdf = true;
       continue;
     }
+    if (strcmp("-ctdirect", argv[i])==0) {
+      direct_ct = true;
+      continue;
+    }
     N = atoi(argv[i]);
   }
 
@@ -156,7 +162,11 @@ int main(int argc, const char** argv)
   domain* d = 0;
   try {
 
-    MEDDLY::initialize();
+    initializer_list* L = defaultInitializerList(0);
+    if (direct_ct) {
+      ct_initializer::setBuiltinStyle(ct_initializer::MonolithicDirectMapped);
+    }
+    MEDDLY::initialize(L);
 
     timer start;
 
@@ -720,6 +720,7 @@ void usage() {
   fprintf(stderr, "-esat  : use saturation with event-wise relation compute reachable states\n");
   fprintf(stderr, "-ksat  : use saturation with level-wise relation compute reachable states\n");
   fprintf(stderr, "-kspsat: same as ksat, with additional pre-processing of events to improve saturation\n");
+  fprintf(stderr, "-ctdirect: use the direct-mapped compute table\n");
   fprintf(stderr, "-l<key>: key can be any combination of\n");
   fprintf(stderr, "         A: Front face clock-wise rotation,\n");
   fprintf(stderr, "         a: Front face counter clock-wise rotation,\n");
@@ -1257,9 +1258,10 @@ int main(int argc, char *argv[])
   bool bfs = false;
   char saturation_type = 'm';
   bool split = true;
+  bool direct_ct = false;
 
   if (argc > 1) {
-    assert(argc <= 5);
+    assert(argc <= 6);
     for (int i=1; i<argc; i++) {
       char *cmd = argv[i];
       if (strncmp(cmd, "-msat", 6) == 0) {
@@ -1275,6 +1277,7 @@ int main(int argc, char *argv[])
         dfs = true; saturation_type = 'k'; split = true;
       }
       else if (strncmp(cmd, "-bfs", 5) == 0) bfs = true;
+      else if (strncmp(cmd, "-ctdirect", 10) == 0) direct_ct = true;
       else if (strncmp(cmd, "-l", 2) == 0) {
         for (unsigned j = 2; j < strlen(cmd); j++) {
           switch (cmd[j]) {
@@ -1314,7 +1317,11 @@ int main(int argc, char *argv[])
 
   // Initialize MEDDLY
   MEDDLY::initializer_list* L = defaultInitializerList(0);
-  ct_initializer::setBuiltinStyle(ct_initializer::MonolithicChainedHash);
+  if (direct_ct) {
+    ct_initializer::setBuiltinStyle(ct_initializer::MonolithicDirectMapped);
+  } else {
+    ct_initializer::setBuiltinStyle(ct_initializer::MonolithicChainedHash);
+  }
   ct_initializer::setMaxSize(16 * 16777216);
   // ct_initializer::setStaleRemoval(ct_initializer::Lazy);
   // ct_initializer::setStaleRemoval(ct_initializer::Moderate);
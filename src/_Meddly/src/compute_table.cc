@@ -125,6 +125,10 @@ void MEDDLY::ct_initializer::setBuiltinStyle(builtinCTstyle cts)
     case OperationChainedHash:
           builtin_ct_factory = new operation_chained_style;
           break;
+
+    case MonolithicDirectMapped:
+          builtin_ct_factory = new monolithic_direct_style;
+          break;
   }
 
   ct_factory = builtin_ct_factory;
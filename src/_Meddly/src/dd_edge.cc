@@ -428,6 +428,53 @@ void MEDDLY::dd_edge::read(forest* p, input &s, const node_handle* map)
   MEDDLY_DCASSERT(index);
 }
 
+void MEDDLY::dd_edge::writeBinary(output &s, const node_handle* map) const
+{
+  expert_forest* eParent = smart_cast<expert_forest*>(parent);
+
+  if (!eParent->isMultiTerminal()) {
+    s.write(eParent->edgeBytes(), (const unsigned char*) &raw_value);
+  }
+  s.put_zigzag( (node > 0) ? map[node] : node );
+}
+
+void MEDDLY::dd_edge::readBinary(forest* p, input &s, const node_handle* map,
+  long num_nodes)
+{
+  destroy();
+
+  parent = p;
+  expert_forest* eParent = smart_cast<expert_forest*>(parent);
+
+  if (!eParent->isMultiTerminal()) {
+    raw_value = 0;
+    const unsigned bytes = eParent->edgeBytes();
+    if (s.read(bytes, (unsigned char*) &raw_value) != bytes) {
+      throw error(error::INVALID_FILE, __FILE__, __LINE__);
+    }
+  }
+
+  long lnode = s.get_zigzag();
+  if (lnode > num_nodes) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  if (lnode <= 0) {
+    node = lnode;
+  } else {
+    node = map[lnode];
+  }
+
+  linkNode(parent, node);
+
+  opPlus = 0;
+  opStar = 0;
+  opMinus = 0;
+  opDivide = 0;
+
+  if (parent) parent->registerEdge(*this);
+  MEDDLY_DCASSERT(index);
+}
+
 
 void MEDDLY::dd_edge::writePicture(const char* filename, const char* extension) const
 {
@@ -218,6 +218,7 @@ MEDDLY::domain::domain(variable** v, int N)
   is_marked_for_deletion = false;
   forests = 0;
   szForests = 0;
+  order_locks = 0;
 
   //
   // Add myself to the master list
@@ -421,6 +422,69 @@ void MEDDLY::domain::unlinkForest(forest* f, unsigned slot)
   forests[slot] = 0;
 }
 
+void MEDDLY::domain::reorderIfNeeded()
+{
+  if (order_locks || nVars < 2) return;
+
+  for (unsigned i=0; i<szForests; i++) {
+    expert_forest* ef = dynamic_cast <expert_forest*> (forests[i]);
+    if (0==ef || !ef->needsDynamicReordering()) continue;
+
+    // Sifting is implemented for multi-terminal forests only;
+    // the others may still be over the trigger.
+    if (!ef->isMultiTerminal()) {
+      ef->raiseReorderTrigger();
+      continue;
+    }
+
+    // Every other forest must be able to follow the new order.
+    for (unsigned j=0; j<szForests; j++) {
+      expert_forest* g = dynamic_cast <expert_forest*> (forests[j]);
+      if (g && !g->canSwapVariables()) return;
+    }
+
+    ef->siftVariables();
+
+    std::vector<int> level2var(nVars+1);
+    ef->getVariableOrder(level2var.data());
+    for (unsigned j=0; j<szForests; j++) {
+      if (j==i) continue;
+      expert_forest* g = dynamic_cast <expert_forest*> (forests[j]);
+      if (g) g->reorderVariables(level2var.data());
+    }
+
+    // New forests start with the current order
+    default_var_order = ef->variableOrder();
+    var_orders[0] = default_var_order;
+  }
+}
+
+bool MEDDLY::domain::reorderAtSafePoint()
+{
+  std::shared_ptr<const variable_order> before = default_var_order;
+
+  unlockVariableOrder();
+  try {
+    reorderIfNeeded();
+  }
+  catch (...) {
+    lockVariableOrder();
+    throw;
+  }
+  lockVariableOrder();
+
+  return before != default_var_order;
+}
+
+bool MEDDLY::domain::usesDynamicReordering() const
+{
+  for (unsigned i=0; i<szForests; i++) {
+    expert_forest* ef = dynamic_cast <expert_forest*> (forests[i]);
+    if (ef && ef->usesDynamicReordering()) return true;
+  }
+  return false;
+}
+
 unsigned MEDDLY::domain::findEmptyForestSlot()
 {
   for (unsigned slot=0; slot<szForests; slot++) {
@@ -23,6 +23,7 @@
 
 #include <fstream>
 #include <sstream>
+#include <climits>
 #include "defines.h"
 #include "unique_table.h"
 #include "impl_unique_table.h"
@@ -117,6 +118,9 @@ void MEDDLY::forest::policies::useDefaults(bool rel)
 
   reorder = reordering_type::SINK_DOWN;
   swap = variable_swap_type::VAR;
+
+  reorderTrigger = 0;
+  reorderGrowth = 2.0;
 }
 
 // ******************************************************************
@@ -842,6 +846,7 @@ MEDDLY::expert_forest::expert_forest(int ds, domain *d, bool rel, range_type t,
   unique = new unique_table(this);
   implUT = new impl_unique_table(this);
   performing_gc = false;
+  reorder_trigger = p.reorderTrigger;
   in_validate = 0;
   in_val_size = 0;
   delete_depth = 0;
@@ -1496,75 +1501,19 @@ void MEDDLY::expert_forest
 void MEDDLY::expert_forest
 ::writeEdges(output &s, const dd_edge* E, int n) const
 {
-  node_handle* eRaw = new node_handle[n];
-  for (int i=0; i<n; i++) {
-    eRaw[i] = E[i].getNode();
-  }
-  node_handle* output2index = markNodesInSubgraph(eRaw, n, false);
-  delete[] eRaw;
-
-  // Make a dummy array for fringe case where
-  // there are no non-zero nodes in the subgraph.
-  if (0 == output2index) {
-    output2index = (node_handle*) malloc(1*sizeof(node_handle));
-    output2index[0] = 0;
-  }
-
-  // move a pointer to the end of the list, and
-  // find the largest node index we're writing
-  int maxnode = 0;
-  int last;
-  for (last = 0; output2index[last]; last++) {
-    maxnode = MAX(maxnode, output2index[last]);
-  };
-  int num_nodes = last;
-  last--;
-
-  // arrange nodes to output, by levels
-  for (int k=getNumVariables(); k; ) {
-    int i = 0;
-    while (i < last) {
-      // move last to the left, until we have something not at level k
-      for (; i < last; last--) {
-        if (getNodeLevel(output2index[last]) != k) break;
-      }
-      // move i to the right, until we have something at level k
-      for (; i < last; i++) {
-        if (getNodeLevel(output2index[i]) == k) break;
-      }
-      if (i < last) {
-        SWAP(output2index[i], output2index[last]);
-      }
-    }
-
-    // next level
-    k *= -1;
-    if (k>0) k--;
-  } // loop over levels
-
-  // build the inverse mapping
-  node_handle* index2output = new node_handle[maxnode+1];
-  for (int i=0; i<maxnode; i++) index2output[i] = 0;
-  for (int i=0; output2index[i]; i++) {
-    MEDDLY_CHECK_RANGE(1, output2index[i], maxnode+1);
-    index2output[output2index[i]] = i+1;
-  }
+  node_handle* index2output = 0;
+  node_handle* output2index = orderNodesForWriting(E, n, index2output);
+  int num_nodes;
+  for (num_nodes = 0; output2index[num_nodes]; num_nodes++);
 
 #ifdef DEBUG_WRITE
   printf("Writing edges:\n");
-  showNodeGraph(stdout, eRaw, n);
   printf("Got list of nodes:\n");
   for (int i=0; output2index[i]; i++) {
     if (i) printf(", ");
     printf("%ld", long(output2index[i]));
   }
   printf("\n");
-  printf("Got inverse list:\n");
-  for (int i=0; i<=maxnode; i++) {
-    if (i) printf(", ");
-    printf("%ld", long(index2output[i]));
-  }
-  printf("\n");
 #endif
 
   // Write the nodes
@@ -1791,6 +1740,249 @@ void MEDDLY::expert_forest::readEdges(input &s, dd_edge* E, int n)
   }
 }
 
+// Binary format, see writeEdgesBinary() in meddly.h
+static const char* BINARY_MAGIC = "MDDB";
+static const char* BINARY_TRAILER = "BDDM";
+static const unsigned short BINARY_BYTE_ORDER = 0x0102;
+
+void MEDDLY::expert_forest
+::writeEdgesBinary(output &s, const dd_edge* E, int n) const
+{
+  node_handle* index2output = 0;
+  node_handle* output2index = orderNodesForWriting(E, n, index2output);
+  long num_nodes;
+  for (num_nodes = 0; output2index[num_nodes]; num_nodes++);
+
+  //
+  // Header: forest type, byte order, variable order, extra bytes
+  //
+  s.put(BINARY_MAGIC);
+  s.put(codeChars());
+  s.put('\0');
+  s.write(sizeof(BINARY_BYTE_ORDER), (const unsigned char*) &BINARY_BYTE_ORDER);
+  s.put_varint(getNumVariables());
+  for (int k=1; k<=getNumVariables(); k++) {
+    s.put_varint(getVarByLevel(k));
+  }
+  s.put_varint(edgeBytes());
+  s.put_varint(unhashedHeaderBytes());
+  s.put_varint(hashedHeaderBytes());
+
+  //
+  // Nodes, as runs of nodes at the same level
+  //
+  s.put_varint(num_nodes);
+  unpacked_node* un = unpacked_node::useUnpackedNode();
+  for (long i=0; i<num_nodes; ) {
+    const int k = getNodeLevel(output2index[i]);
+    long run;
+    for (run=i+1; run<num_nodes; run++) {
+      if (getNodeLevel(output2index[run]) != k) break;
+    }
+    s.put_zigzag(k);
+    s.put_varint(run-i);
+
+    for (; i<run; i++) {
+      un->initFromNode(this, output2index[i], unpacked_node::AS_STORED);
+      const unsigned stop = un->isSparse() ? un->getNNZs() : un->getSize();
+      // size, sparse flag, extensible flag
+      s.put_varint( ((unsigned long)stop << 2)
+                    | (un->isSparse() ? 2 : 0)
+                    | (un->isExtensible() ? 1 : 0) );
+      // indexes (sparse only), as differences
+      if (un->isSparse()) {
+        long prev = 0;
+        for (unsigned z=0; z<stop; z++) {
+          s.put_zigzag(long(un->i(z)) - prev);
+          prev = un->i(z);
+        }
+      }
+      // down pointers: positive for nodes, terminals as is
+      for (unsigned z=0; z<stop; z++) {
+        const node_handle d = un->d(z);
+        s.put_zigzag( (d > 0) ? index2output[d] : d );
+      }
+      // edge values and extra header information, raw
+      if (edgeBytes()) {
+        for (unsigned z=0; z<stop; z++) {
+          s.write(edgeBytes(), (const unsigned char*) un->eptr(z));
+        }
+      }
+      if (un->UHbytes()) {
+        s.write(un->UHbytes(), (const unsigned char*) un->UHptr());
+      }
+      if (un->HHbytes()) {
+        s.write(un->HHbytes(), (const unsigned char*) un->HHptr());
+      }
+    } // for i
+  } // for runs
+  unpacked_node::recycle(un);
+
+  //
+  // The actual edges
+  //
+  s.put_varint(n);
+  for (int i=0; i<n; i++) {
+    E[i].writeBinary(s, index2output);
+  }
+  s.put(BINARY_TRAILER);
+
+  // Cleanup
+  delete[] index2output;
+  free(output2index);
+}
+
+void MEDDLY::expert_forest::readEdgesBinary(input &s, dd_edge* E, int n)
+{
+  //
+  // Header; must match this forest
+  //
+  s.consumeKeyword(BINARY_MAGIC);
+  s.consumeKeyword(codeChars());
+  if (s.get_char() != 0) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  unsigned short order;
+  if ( (s.read(sizeof(order), (unsigned char*) &order) != sizeof(order))
+        || (order != BINARY_BYTE_ORDER) )
+  {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  if (s.get_varint() != (unsigned long) getNumVariables()) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  for (int k=1; k<=getNumVariables(); k++) {
+    if (s.get_varint() != (unsigned long) getVarByLevel(k)) {
+      throw error(error::INVALID_FILE, __FILE__, __LINE__);
+    }
+  }
+  if ( (s.get_varint() != edgeBytes())
+        || (s.get_varint() != unhashedHeaderBytes())
+        || (s.get_varint() != hashedHeaderBytes()) )
+  {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  const unsigned long num_nodes = s.get_varint();
+  if (num_nodes >= (unsigned long) INT_MAX) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+
+  // start a mapping
+  node_handle* map = new node_handle[num_nodes+1];
+  for (unsigned long i=0; i<=num_nodes; i++) map[i] = 0;
+
+  try {
+    //
+    // Nodes, as runs of nodes at the same level
+    //
+    long node_index = 1;
+    while (node_index <= long(num_nodes)) {
+      const int k = int(s.get_zigzag());
+      if (0==k || !isValidLevel(k)) {
+        throw error(error::INVALID_LEVEL, __FILE__, __LINE__);
+      }
+      const unsigned long run = s.get_varint();
+      if (0==run || run > num_nodes + 1 - node_index) {
+        throw error(error::INVALID_FILE, __FILE__, __LINE__);
+      }
+      // Extensible levels have no fixed bound
+      const bool bounded = !isExtensibleLevel(k);
+      const long bound = getLevelSize(k);
+
+      for (long last = node_index + run; node_index < last; node_index++) {
+        const unsigned long info = s.get_varint();
+        const long stop = info >> 2;
+        if (bounded && stop > bound) {
+          throw error(error::INVALID_FILE, __FILE__, __LINE__);
+        }
+        unpacked_node* nb = (info & 2)
+          ? unpacked_node::newSparse(this, k, stop)
+          : unpacked_node::newFull(this, k, stop);
+
+        // indexes (sparse only)
+        if (info & 2) {
+          long idx = 0;
+          for (long z=0; z<stop; z++) {
+            idx += s.get_zigzag();
+            if (idx < 0 || (bounded && idx >= bound)) {
+              throw error(error::INVALID_FILE, __FILE__, __LINE__);
+            }
+            nb->i_ref(z) = idx;
+          }
+        }
+
+        // down pointers; nodes must be read before their parents
+        for (long z=0; z<stop; z++) {
+          const long down = s.get_zigzag();
+          if (down >= node_index) {
+            throw error(error::INVALID_ASSIGNMENT, __FILE__, __LINE__);
+          }
+          nb->d_ref(z) = (down > 0) ? linkNode(map[down]) : node_handle(down);
+        }
+
+        // edge values and extra header information
+        if (edgeBytes()) {
+          for (long z=0; z<stop; z++) {
+            if (s.read(edgeBytes(), (unsigned char*) nb->eptr_write(z))
+                != edgeBytes())
+            {
+              throw error(error::INVALID_FILE, __FILE__, __LINE__);
+            }
+          }
+        }
+        if (nb->UHbytes()) {
+          if (s.read(nb->UHbytes(), (unsigned char*) nb->UHdata())
+              != nb->UHbytes())
+          {
+            throw error(error::INVALID_FILE, __FILE__, __LINE__);
+          }
+        }
+        if (nb->HHbytes()) {
+          if (s.read(nb->HHbytes(), (unsigned char*) nb->HHdata())
+              != nb->HHbytes())
+          {
+            throw error(error::INVALID_FILE, __FILE__, __LINE__);
+          }
+        }
+
+        if (info & 1) {
+          if (bounded || 0==stop) {
+            throw error(error::INVALID_FILE, __FILE__, __LINE__);
+          }
+          nb->markAsExtensible();
+        }
+
+        map[node_index] = createReducedNode(-1, nb);
+      } // for node_index
+    } // while
+
+    //
+    // The actual edges
+    //
+    const unsigned long num_ptrs = s.get_varint();
+    if (num_ptrs > (unsigned long) n) {
+      throw error(error::INVALID_ASSIGNMENT, __FILE__, __LINE__);
+    }
+    for (unsigned long i=0; i<num_ptrs; i++) {
+      E[i].readBinary(this, s, map, num_nodes);
+    }
+    s.consumeKeyword(BINARY_TRAILER);
+  } // try
+  catch (error& e) {
+    for (unsigned long i=0; i<=num_nodes; i++) unlinkNode(map[i]);
+    delete[] map;
+    throw e;
+  }
+
+  // unlink map pointers
+  for (unsigned long i=0; i<=num_nodes; i++) unlinkNode(map[i]);
+  delete[] map;
+
+#ifdef DEVELOPMENT_CODE
+  validateIncounts(true);
+#endif
+}
+
 /*
 
 void MEDDLY::expert_forest::garbageCollect()
@@ -1982,6 +2174,23 @@ void MEDDLY::expert_forest::reorderVariables(const int* level2var)
   var_order = useDomain()->makeVariableOrder(*var_order);
 }
 
+void MEDDLY::expert_forest::siftVariables()
+{
+  if (getNumVariables() > 1) {
+    // Sift a private copy of the order, as in reorderVariables()
+    var_order = std::make_shared<variable_order>(*var_order);
+    dynamicReorderVariables(getNumVariables(), 1);
+    var_order = useDomain()->makeVariableOrder(*var_order);
+  }
+  raiseReorderTrigger();
+}
+
+void MEDDLY::expert_forest::raiseReorderTrigger()
+{
+  long next = long(getPolicies().reorderGrowth * getCurrentNumNodes());
+  if (next > reorder_trigger) reorder_trigger = next;
+}
+
 // ''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
 // '                                                                '
 // '                                                                '
@@ -1991,6 +2200,66 @@ void MEDDLY::expert_forest::reorderVariables(const int* level2var)
 // ''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
 
 
+MEDDLY::node_handle* MEDDLY::expert_forest
+::orderNodesForWriting(const dd_edge* E, int n, node_handle* &index2output) const
+{
+  node_handle* eRaw = new node_handle[n];
+  for (int i=0; i<n; i++) {
+    eRaw[i] = E[i].getNode();
+  }
+  node_handle* output2index = markNodesInSubgraph(eRaw, n, false);
+  delete[] eRaw;
+
+  // Make a dummy array for fringe case where
+  // there are no non-zero nodes in the subgraph.
+  if (0 == output2index) {
+    output2index = (node_handle*) malloc(1*sizeof(node_handle));
+    output2index[0] = 0;
+  }
+
+  // move a pointer to the end of the list, and
+  // find the largest node index we're writing
+  int maxnode = 0;
+  int last;
+  for (last = 0; output2index[last]; last++) {
+    maxnode = MAX(maxnode, output2index[last]);
+  };
+  last--;
+
+  // arrange nodes to output, by levels
+  for (int k=getNumVariables(); k; ) {
+    int i = 0;
+    while (i < last) {
+      // move last to the left, until we have something not at level k
+      for (; i < last; last--) {
+        if (getNodeLevel(output2index[last]) != k) break;
+      }
+      // move i to the right, until we have something at level k
+      for (; i < last; i++) {
+        if (getNodeLevel(output2index[i]) == k) break;
+      }
+      if (i < last) {
+        SWAP(output2index[i], output2index[last]);
+      }
+    }
+
+    // next level
+    k *= -1;
+    if (k>0) k--;
+  } // loop over levels
+
+  // build the inverse mapping
+  index2output = new node_handle[maxnode+1];
+  for (int i=0; i<=maxnode; i++) index2output[i] = 0;
+  for (int i=0; output2index[i]; i++) {
+    MEDDLY_CHECK_RANGE(1, output2index[i], maxnode+1);
+    index2output[output2index[i]] = i+1;
+  }
+
+  return output2index;
+}
+
+
 void MEDDLY::expert_forest::deleteNode(node_handle p)
 {
 #ifdef TRACK_DELETIONS
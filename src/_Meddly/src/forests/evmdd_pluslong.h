@@ -81,6 +81,7 @@ class MEDDLY::evmdd_pluslong : public evmdd_forest {
     }
 
     virtual void swapAdjacentVariables(int level);
+    virtual bool canSwapVariables() const { return true; }
 
   protected:
     virtual void normalize(unpacked_node &nb, long& ev) const;
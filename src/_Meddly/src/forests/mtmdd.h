@@ -35,6 +35,7 @@ class MEDDLY::mtmdd_forest : public mt_forest {
     virtual void moveUpVariable(int low, int high);
 
     virtual void dynamicReorderVariables(int top, int bottom);
+    virtual bool canSwapVariables() const { return true; }
 
     virtual enumerator::iterator* makeFullIter() const 
     {
@@ -176,7 +176,8 @@ void MEDDLY::mtmxd_forest::swapAdjacentVariablesByVarSwap(int level)
     for (int i = 0; i < phnum; i++) {
       // Revoke the protection
       unlinkNode(phnodes[i]);
-      if (isActiveNode(phnodes[i])) {
+      // A deleted handle may be past the last one still in use
+      if (isValidNonterminalIndex(phnodes[i]) && isActiveNode(phnodes[i])) {
         phnodes[j++] = phnodes[i];
       }
     }
@@ -37,6 +37,12 @@ class MEDDLY::mtmxd_forest : public mt_forest {
     virtual void dynamicReorderVariables(int top, int bottom);
     void sifting(int var, int top, int bottom);
 
+    // Level swaps do not work for identity-reduced relations
+    virtual bool canSwapVariables() const {
+      return getPolicies().swap == policies::variable_swap_type::VAR
+          || !isIdentityReduced();
+    }
+
     virtual enumerator::iterator* makeFullIter() const 
     {
       return new mtmxd_iterator(this);
@@ -24,6 +24,9 @@
 #include "defines.h"
 
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
 #include <iostream>
 
 // ******************************************************************
@@ -72,6 +75,25 @@ void MEDDLY::input::consumeKeyword(const char* keyword)
     }
 }
 
+unsigned long MEDDLY::input::get_varint()
+{
+  unsigned long x = 0;
+  for (unsigned shift=0; shift < 8*sizeof(unsigned long); shift += 7) {
+    int c = get_char();
+    if (EOF == c) throw error(error::INVALID_FILE, __FILE__, __LINE__);
+    x |= (unsigned long)(c & 0x7f) << shift;
+    if (0 == (c & 0x80)) return x;
+  }
+  // too many bytes
+  throw error(error::INVALID_FILE, __FILE__, __LINE__);
+}
+
+long MEDDLY::input::get_zigzag()
+{
+  unsigned long x = get_varint();
+  return (x & 1) ? ~long(x >> 1) : long(x >> 1);
+}
+
 // ******************************************************************
 // *                                                                *
 // *                       FILE_input methods                       *
@@ -185,6 +207,88 @@ size_t MEDDLY::istream_input::read(size_t bytes, unsigned char* buffer)
 }
 
 
+// ******************************************************************
+// *                                                                *
+// *                     memory_input  methods                      *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::memory_input::memory_input(const unsigned char* buf, size_t len)
+{
+  base = buf;
+  length = len;
+  pos = 0;
+}
+
+MEDDLY::memory_input::~memory_input()
+{
+  // DO NOT release the memory, user owns it!
+}
+
+bool MEDDLY::memory_input::eof() const
+{
+  return pos >= length;
+}
+
+int MEDDLY::memory_input::get_char()
+{
+  if (pos >= length) return EOF;
+  return base[pos++];
+}
+
+void MEDDLY::memory_input::unget(char x)
+{
+  if (0==pos) {
+    throw error(error::COULDNT_READ, __FILE__, __LINE__);
+  }
+  pos--;
+}
+
+long MEDDLY::memory_input::get_integer()
+{
+  while (pos < length && isspace(base[pos])) pos++;
+  bool neg = false;
+  if (pos < length && ('-' == base[pos] || '+' == base[pos])) {
+    neg = ('-' == base[pos]);
+    pos++;
+  }
+  if (pos >= length || !isdigit(base[pos])) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  long data = 0;
+  for (; pos < length && isdigit(base[pos]); pos++) {
+    data = data * 10 + (base[pos] - '0');
+  }
+  return neg ? -data : data;
+}
+
+double MEDDLY::memory_input::get_real()
+{
+  while (pos < length && isspace(base[pos])) pos++;
+  // copy the characters that could be part of a number
+  char buffer[64];
+  unsigned len = 0;
+  for (size_t p=pos; p < length && len+1 < sizeof(buffer); p++, len++) {
+    char c = char(base[p]);
+    if (!isdigit(base[p]) && !(c && strchr("+-.eEinfatyINFATY", c))) break;
+    buffer[len] = c;
+  }
+  buffer[len] = 0;
+  char* end;
+  double data = strtod(buffer, &end);
+  if (end == buffer) throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  pos += (end - buffer);
+  return data;
+}
+
+size_t MEDDLY::memory_input::read(size_t bytes, unsigned char* buffer)
+{
+  if (bytes > length - pos) bytes = length - pos;
+  memcpy(buffer, base + pos, bytes);
+  pos += bytes;
+  return bytes;
+}
+
 // ******************************************************************
 // *                                                                *
 // *                         output methods                         *
@@ -230,6 +334,25 @@ void MEDDLY::output::put_mem(size_t m, bool human)
   put(" Tbytes");
 }
 
+void MEDDLY::output::put_varint(unsigned long x)
+{
+  unsigned char buffer[2*sizeof(unsigned long)];
+  size_t len = 0;
+  while (x >= 0x80) {
+    buffer[len++] = (unsigned char) (x | 0x80);
+    x >>= 7;
+  }
+  buffer[len++] = (unsigned char) x;
+  if (write(len, buffer) != len) {
+    throw error(error::COULDNT_WRITE, __FILE__, __LINE__);
+  }
+}
+
+void MEDDLY::output::put_zigzag(long x)
+{
+  put_varint( (x<0) ? ((~(unsigned long)x) << 1) | 1 : (unsigned long)x << 1 );
+}
+
 // ******************************************************************
 // *                                                                *
 // *                      FILE_output  methods                      *
@@ -234,6 +234,7 @@ void MEDDLY::apply(const unary_opname* code, const dd_edge &a, dd_edge &c)
     throw error(error::UNKNOWN_OPERATION, __FILE__, __LINE__);
   unary_operation* op = getOperation(code, a, c);
   op->computeTemp(a, c);
+  c.getForest()->useDomain()->reorderIfNeeded();
 }
 
 void MEDDLY::apply(const unary_opname* code, const dd_edge &a, long &c)
@@ -276,6 +277,7 @@ void MEDDLY::apply(const binary_opname* code, const dd_edge &a,
     throw error(error::UNKNOWN_OPERATION, __FILE__, __LINE__);
   binary_operation* op = getOperation(code, a, b, c);
   op->computeTemp(a, b, c);
+  c.getForest()->useDomain()->reorderIfNeeded();
 }
 
 //----------------------------------------------------------------------
@@ -117,6 +117,7 @@ namespace MEDDLY {
   class input;
   class FILE_input;
   class istream_input;
+  class memory_input;
   class output;
   class FILE_output;
   class ostream_output;
@@ -470,6 +471,8 @@ namespace MEDDLY {
       The operand and the result are not necessarily in the same forest,
       but they must belong to forests that share the same domain.
       This is useful, for instance, for copying a function to a new forest.
+      Afterwards, forests over the domain may be dynamically reordered;
+      see domain::reorderIfNeeded().
         @param  op    Operator handle.
         @param  a     Operand.
         @param  c     Output parameter: the result, where \a c = \a op \a a.
@@ -519,6 +522,8 @@ namespace MEDDLY {
       Useful, for example, for constructing comparisons
       where the resulting type is "boolean" but the operators are not,
       e.g., c = f EQUALS g.
+      Afterwards, forests over the domain may be dynamically reordered;
+      see domain::reorderIfNeeded().
       @param  op    Operator handle.
       @param  a     First operand.
       @param  b     Second operand.
@@ -754,6 +759,18 @@ class MEDDLY::input {
       we throw an INVALID_FILE error.
   */
   void consumeKeyword(const char* keyword);
+
+  /**
+      Read an unsigned integer written by output::put_varint().
+      If the input ends early, we throw an INVALID_FILE error.
+  */
+  unsigned long get_varint();
+
+  /**
+      Read a signed integer written by output::put_zigzag().
+      If the input ends early, we throw an INVALID_FILE error.
+  */
+  long get_zigzag();
 };  // end of input class
 
 // ******************************************************************
@@ -814,6 +831,39 @@ class MEDDLY::istream_input : public MEDDLY::input {
 
 #endif
 
+// ******************************************************************
+// *                                                                *
+// *                      memory_input  class                       *
+// *                                                                *
+// ******************************************************************
+
+/** memory_input class.
+    Use for input from a block of memory,
+    for example a file that was mapped into memory.
+    The memory is not copied, and must remain valid
+    for as long as the object is used.
+*/
+class MEDDLY::memory_input : public MEDDLY::input {
+  public:
+    memory_input(const unsigned char* buf, size_t len);
+    virtual ~memory_input();
+
+    virtual bool eof() const;
+    virtual int get_char();
+    virtual void unget(char);
+    virtual long get_integer();
+    virtual double get_real();
+    virtual size_t read(size_t bytes, unsigned char* buffer);
+
+    /// Number of bytes consumed so far.
+    inline size_t position() const { return pos; }
+
+  private:
+    const unsigned char* base;
+    size_t length;
+    size_t pos;
+};  // end of memory_input class
+
 // ******************************************************************
 // *                                                                *
 // *                          output class                          *
@@ -904,6 +954,25 @@ class MEDDLY::output {
     */
     void put_mem(size_t m, bool human);
 
+    /**
+        Write an unsigned integer in a compact binary format:
+        seven bits per byte, low bits first, with the high bit
+        of each byte set when more bytes follow.
+          @param  x   Integer to write
+          @throws     An appropriate error
+    */
+    void put_varint(unsigned long x);
+
+    /**
+        Write a signed integer in a compact binary format.
+        The value is "zigzag" mapped (0, -1, 1, -2, ... becomes
+        0, 1, 2, 3, ...) so that small magnitudes use few bytes,
+        and then written using put_varint().
+          @param  x   Integer to write
+          @throws     An appropriate error
+    */
+    void put_zigzag(long x);
+
 };  // end of output class
 
 /* 
@@ -1134,6 +1203,13 @@ class MEDDLY::forest {
       // Default variable swap strategy.
       variable_swap_type swap;
 
+      /// Dynamic reordering: number of active nodes that triggers
+      /// sifting of the variables, or 0 to never reorder automatically.
+      long reorderTrigger;
+      /// Dynamic reordering: after sifting, the trigger is raised to
+      /// this factor times the number of active nodes.
+      double reorderGrowth;
+
       /// Backend memory management mechanism for nodes.
       const memory_manager_style* nodemm;
 
@@ -1191,6 +1267,9 @@ class MEDDLY::forest {
 
       void setVarSwap();
       void setLevelSwap();
+
+      void setDynamicReordering(long trigger, double growth = 2.0);
+      void setNoDynamicReordering();
     }; // end of struct policies
 
     /// Collection of various stats for performance measurement
@@ -1967,6 +2046,37 @@ class MEDDLY::forest {
     */
     virtual void readEdges(input &s, dd_edge* E, int n) = 0;
 
+    /** Write edges to a file in a compact binary format.
+        Like \a writeEdges(), all nodes below the edges are written.
+        Nodes are written bottom level first, so that each node
+        appears after its children, and are renumbered in that order;
+        integers are written with output::put_varint().
+        Edge values and extra header information are written as
+        raw bytes, so the file should be read back on a machine
+        with the same byte order.
+          @param  s   Stream to write to
+          @param  E   Array of edges
+          @param  n   Dimension of the edge array
+
+          @throws     COULDNT_WRITE, if writing failed
+    */
+    virtual void writeEdgesBinary(output &s, const dd_edge* E, int n) const = 0;
+
+    /** Read edges from a file written by \a writeEdgesBinary().
+        The forest does not need to be empty;
+        the edges are added to the forest as necessary.
+        For large files, a memory_input over a memory-mapped
+        file avoids any copying or parsing of text.
+          @param  s   Stream to read from
+          @param  E   Array of edges
+          @param  n   Dimension of the edge array
+
+          @throws     INVALID_FILE, if the file does not match what we expect,
+                      including a different forest type, variable order,
+                      or number of edges.
+    */
+    virtual void readEdgesBinary(input &s, dd_edge* E, int n) = 0;
+
     /** Force garbage collection.
         All disconnected nodes in this forest are discarded along with any
         compute table entries that may include them.
@@ -2300,6 +2410,8 @@ class MEDDLY::domain {
     bool is_marked_for_deletion;
     forest** forests;
     unsigned szForests;
+    /// Number of active lockVariableOrder() calls.
+    unsigned order_locks;
 
     /// Find a free slot for a new forest.
     unsigned findEmptyForestSlot();
@@ -2319,6 +2431,42 @@ class MEDDLY::domain {
     std::shared_ptr<const variable_order> makeDefaultVariableOrder();
     void cleanVariableOrders();
 
+    /** Prevent dynamic reordering of the forests over this domain.
+        Used by objects that remember levels, such as saturation
+        relations, for as long as they exist.  Calls may be nested.
+    */
+    void lockVariableOrder();
+    void unlockVariableOrder();
+    bool isVariableOrderLocked() const;
+
+    /** Dynamic variable reordering.
+        If a forest over this domain has grown past its reordering
+        trigger (see forest::policies::reorderTrigger), sift its
+        variables, move every other forest over this domain to the
+        new order using its reordering strategy, and raise the trigger.
+        Nothing happens if the order is locked, or if some forest
+        cannot be reordered.
+        A forest that cannot be sifted only has its trigger raised.
+        Must not be called while an operation is in progress;
+        apply() calls this after each top-level operation, and
+        saturation calls reorderAtSafePoint() between its rounds.
+    */
+    void reorderIfNeeded();
+
+    /** Safe point for dynamic reordering, for an operation that
+        holds one order lock (through its relation) and currently
+        holds no nodes by level, such as saturation between rounds.
+        The lock is released, reorderIfNeeded() is called, and the
+        lock is taken again.
+          @return true if the variable order changed; the caller must
+                  then rebuild anything it keeps by level, and must
+                  not use its compute table entries keyed by level.
+    */
+    bool reorderAtSafePoint();
+
+    /// Does some forest over this domain use dynamic reordering?
+    bool usesDynamicReordering() const;
+
   private:
     /// List of all domains; initialized in meddly.cc
     static domain** dom_list;
@@ -2584,6 +2732,16 @@ class MEDDLY::dd_edge {
     /// Read from a file
     void read(forest* p, input &s, const node_handle* map);
 
+    /// Write to a file, in the format of forest::writeEdgesBinary()
+    void writeBinary(output &s, const node_handle* map) const;
+
+    /** Read from a file, in the format of forest::writeEdgesBinary().
+        The map has entries for nodes 1 through num_nodes;
+        we throw INVALID_FILE for any other node.
+    */
+    void readBinary(forest* p, input &s, const node_handle* map,
+      long num_nodes);
+
   private:
     friend class forest;
     friend class unpacked_node;
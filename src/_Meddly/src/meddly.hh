@@ -250,6 +250,17 @@ inline void MEDDLY::forest::policies::setLevelSwap() {
   swap = variable_swap_type::LEVEL;
 }
 
+inline void MEDDLY::forest::policies::setDynamicReordering(long trigger,
+  double growth)
+{
+  reorderTrigger = trigger;
+  reorderGrowth = growth;
+}
+
+inline void MEDDLY::forest::policies::setNoDynamicReordering() {
+  reorderTrigger = 0;
+}
+
 // end of struct policies
 
 // forest::statset::
@@ -583,6 +594,19 @@ inline std::shared_ptr<const MEDDLY::variable_order> MEDDLY::domain::makeDefault
   return default_var_order;
 }
 
+inline void MEDDLY::domain::lockVariableOrder() {
+  order_locks++;
+}
+
+inline void MEDDLY::domain::unlockVariableOrder() {
+  MEDDLY_DCASSERT(order_locks);
+  order_locks--;
+}
+
+inline bool MEDDLY::domain::isVariableOrderLocked() const {
+  return order_locks;
+}
+
 inline int MEDDLY::domain::ID() const { return my_index; }
 
 
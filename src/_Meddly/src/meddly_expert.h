@@ -2775,6 +2775,8 @@ class MEDDLY::expert_forest: public forest
 
     virtual void writeEdges(output &s, const dd_edge* E, int n) const;
     virtual void readEdges(input &s, dd_edge* E, int n);
+    virtual void writeEdgesBinary(output &s, const dd_edge* E, int n) const;
+    virtual void readEdgesBinary(input &s, dd_edge* E, int n);
     // virtual void garbageCollect();
     // virtual void compactMemory();
     virtual void showInfo(output &strm, int verbosity);
@@ -2899,6 +2901,38 @@ class MEDDLY::expert_forest: public forest
     	throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
     }
 
+    /*
+     * Does this forest implement swapAdjacentVariables(),
+     * so that reorderVariables() may be used?
+     */
+    virtual bool canSwapVariables() const {
+      return false;
+    }
+
+    /*
+     * Has the forest grown past its dynamic reordering trigger?
+     */
+    bool needsDynamicReordering() const;
+
+    /*
+     * Does the forest have a dynamic reordering trigger at all?
+     */
+    bool usesDynamicReordering() const;
+
+    /*
+     * Raise the dynamic reordering trigger past the current
+     * number of nodes, by the growth factor of the policies.
+     */
+    void raiseReorderTrigger();
+
+    /*
+     * Sift all variables (see dynamicReorderVariables()),
+     * then raise the dynamic reordering trigger.
+     * Use domain::reorderIfNeeded() instead, which keeps
+     * the other forests over the domain consistent.
+     */
+    void siftVariables();
+
     /** Show a terminal node.
           @param  s       Stream to write to.
           @param  tnode   Handle to a terminal node.
@@ -3107,6 +3141,19 @@ class MEDDLY::expert_forest: public forest
     // Sanity check; used in development code.
     void validateDownPointers(const unpacked_node &nb) const;
 
+    /** List the nodes below some edges, in the order they are written
+        by writeEdges() and writeEdgesBinary(): by levels, bottom first,
+        so that every node comes after its children.
+          @param  E             Array of edges
+          @param  n             Dimension of the edge array
+          @param  index2output  On output: a new[]'d array, giving the
+                                position (starting from 1) of each
+                                listed node handle.
+          @return   A malloc'd array of nodes, terminated by 0.
+    */
+    node_handle* orderNodesForWriting(const dd_edge* E, int n,
+      node_handle* &index2output) const;
+
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   // |                                                                |
   // |                              Data                              |
@@ -3136,6 +3183,9 @@ class MEDDLY::expert_forest: public forest
     // Garbage collection in progress
     bool performing_gc;
 
+    // Active node count that triggers dynamic reordering; 0 for never
+    long reorder_trigger;
+
     // memory for validating incounts
     node_handle* in_validate;
     int  in_val_size;
@@ -3372,6 +3422,14 @@ class MEDDLY::satpregen_opname : public specialized_opname {
         */
         void finalize(splittingOption split = SplitSubtract);
 
+        /** To be called after the variable order has changed,
+            on a finalized relation.
+            Moves each sub-relation to the level of its new top
+            variable; "by levels" relations are combined and split
+            again, as with MonolithicSplit.
+        */
+        void relevel();
+
         bool isFinalized() const;
 
         forest* getInForest() const;
@@ -4527,6 +4585,12 @@ class MEDDLY::ct_initializer : public initializer_list {
 
       /// A hash table (no chaining) for each operation.
       OperationUnchainedHash,
+
+      /** One fixed-size, direct-mapped table of cache-line slots.
+          Entries are overwritten on collision, and the table
+          never grows; maxSize bounds the number of entry items.
+      */
+      MonolithicDirectMapped,
     };
 
     enum compressionOption {
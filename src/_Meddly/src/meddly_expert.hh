@@ -2637,6 +2637,18 @@ MEDDLY::expert_forest::getVariableOrder(int* level2var) const
   }
 }
 
+inline bool
+MEDDLY::expert_forest::needsDynamicReordering() const
+{
+  return reorder_trigger && getCurrentNumNodes() > reorder_trigger;
+}
+
+inline bool
+MEDDLY::expert_forest::usesDynamicReordering() const
+{
+  return reorder_trigger;
+}
+
 inline std::shared_ptr<const MEDDLY::variable_order>
 MEDDLY::expert_forest::variableOrder() const
 {
@@ -156,6 +156,9 @@ bool MEDDLY::multiply_mxd::checkTerminals(node_handle a, node_handle b, node_han
       }
       return true;
     }
+    // With identity reductions, a terminal stands for a diagonal,
+    // so multiplying by one does not give the other operand.
+    if (resF->isIdentityReduced()) return false;
     if (arg2F != resF) return false;
     if (resF->getRangeType() == forest::INTEGER) {
       if (1==arg1F->getIntegerFromHandle(a)) {
@@ -171,6 +174,7 @@ bool MEDDLY::multiply_mxd::checkTerminals(node_handle a, node_handle b, node_han
     }
   } // a is terminal
   if (arg2F->isTerminalNode(b)) {
+    if (resF->isIdentityReduced()) return false;
     if (arg1F != resF) return false;
     if (resF->getRangeType() == forest::INTEGER) {
       if (1==arg2F->getIntegerFromHandle(b)) {
@@ -174,6 +174,9 @@ class MEDDLY::common_dfs : public binary_operation {
 
   protected:
     dd_edge* splits;
+    /// Only events with top level up to this one are saturated;
+    /// below the number of variables when saturating in rounds.
+    int round_top;
     binary_operation* mddUnion;
     binary_operation* mxdIntersection;
     binary_operation* mxdDifference;
@@ -296,6 +299,10 @@ class MEDDLY::common_dfs_mt : public common_dfs {
     virtual void computeDDEdge(const dd_edge& a, const dd_edge& b, dd_edge &c, bool userFlag);
     virtual void saturateHelper(unpacked_node &mdd) = 0;
 
+    inline int roundTop() const {
+      return round_top;
+    }
+
   protected:
     inline compute_table::entry_key* 
     findResult(node_handle a, node_handle b, node_handle &c) 
@@ -441,7 +448,7 @@ MEDDLY::node_handle MEDDLY::saturation_op::saturate(node_handle mdd, int k)
   // Cleanup
   unpacked_node::recycle(mddDptrs);
 
-  parent->saturateHelper(*C);
+  if (k <= parent->roundTop()) parent->saturateHelper(*C);
   n = resF->createReducedNode(-1, C);
 
   // save in compute table
@@ -572,6 +579,7 @@ MEDDLY::common_dfs::common_dfs(const binary_opname* oc, expert_forest* a1,
 : binary_operation(oc, 1, a1, a2, res)
 {
   splits = 0;
+  round_top = 0;
   mddUnion = 0;
   mxdIntersection = 0;
   mxdDifference = 0;
@@ -768,7 +776,43 @@ void MEDDLY::common_dfs_mt
 
   // Execute saturation operation
   saturation_op *so = new saturation_op(this, arg1F, resF);
-  so->saturate(a, c);
+  const int K = arg2F->getNumVariables();
+  domain* d = resF->useDomain();
+  if (!d->usesDynamicReordering()) {
+    round_top = K;
+    so->saturate(a, c);
+  } else {
+    //
+    // Saturate in rounds, adding the events of one more level
+    // each round, so the forests may be reordered in between.
+    // The splits remember levels, so they lock the order.
+    //
+    dd_edge nsf(b);
+    c = a;
+    d->lockVariableOrder();
+    try {
+      for (round_top = 1; round_top <= K; round_top++) {
+        if (round_top < K && 0==splits[round_top].getNode()) continue;
+        so->saturate(c, c);
+        if (round_top == K) break;
+
+        // Safe point: saturation results depend on the round,
+        // and nothing is held by level but c and the splits.
+        so->removeAllComputeTableEntries();
+        if (d->reorderAtSafePoint()) {
+          removeAllComputeTableEntries();
+          delete[] splits;
+          splits = 0;
+          splitMxd(nsf.getNode());
+        }
+      }
+    }
+    catch (...) {
+      d->unlockVariableOrder();
+      throw;
+    }
+    d->unlockVariableOrder();
+  }
 
   // Cleanup
   cleanup();
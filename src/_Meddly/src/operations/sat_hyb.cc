@@ -103,6 +103,9 @@ MEDDLY::sathyb_opname::hybrid_relation::hybrid_relation(forest* inmdd, forest* r
   // Forests are good; set number of variables
   num_levels = insetF->getDomain()->getNumVariables() + 1;
 
+  // The relation remembers levels
+  insetF->useDomain()->lockVariableOrder();
+
   //Allocate event_list
   event_list = (node_handle**)malloc(unsigned(num_levels)*sizeof(node_handle*));
   event_list_alloc = (long*)malloc(unsigned(num_levels)*sizeof(long));
@@ -400,6 +403,7 @@ MEDDLY::sathyb_opname::hybrid_relation::setConfirmedStates(int level, int index)
 
 MEDDLY::sathyb_opname::hybrid_relation::~hybrid_relation()
 {
+  insetF->useDomain()->unlockVariableOrder();
   /*last_in_node_array = 0;
   impl_unique.clear();
   
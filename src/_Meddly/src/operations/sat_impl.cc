@@ -143,6 +143,9 @@ MEDDLY::satimpl_opname::implicit_relation::implicit_relation(forest* inmdd, fore
   
   // Forests are good; set number of variables
   num_levels = insetF->getDomain()->getNumVariables();
+
+  // The relation remembers levels
+  insetF->useDomain()->lockVariableOrder();
   
   
   
@@ -284,6 +287,7 @@ void MEDDLY::satimpl_opname::implicit_relation::setConfirmedStates(const dd_edge
 
 MEDDLY::satimpl_opname::implicit_relation::~implicit_relation()
 {
+  insetF->useDomain()->unlockVariableOrder();
   last_in_node_array = 0;
   impl_unique.clear();
   
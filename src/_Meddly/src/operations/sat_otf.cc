@@ -439,6 +439,9 @@ MEDDLY::satotf_opname::otf_relation::otf_relation(forest* inmdd,
   // Forests are good; set number of variables
   num_levels = mxdF->getDomain()->getNumVariables() + 1;
 
+  // The relation remembers levels
+  insetF->useDomain()->lockVariableOrder();
+
   // Build the events-per-level data structure
   // (0) Initialize
   num_events_by_top_level = new int[num_levels];
@@ -545,6 +548,7 @@ MEDDLY::satotf_opname::otf_relation::otf_relation(forest* inmdd,
 
 MEDDLY::satotf_opname::otf_relation::~otf_relation()
 {
+  insetF->useDomain()->unlockVariableOrder();
   // ostream_output out(std::cout);
   // showInfo(out);
   for (int i = 0; i < num_levels; i++) {
@@ -91,6 +91,9 @@ MEDDLY::satpregen_opname::pregen_relation
 
   // Forests are good; set number of variables
   K = unsigned(mxdF->getDomain()->getNumVariables());
+
+  // The relation remembers levels
+  insetF->useDomain()->lockVariableOrder();
 }
 
 MEDDLY::satpregen_opname::pregen_relation
@@ -136,6 +139,7 @@ MEDDLY::satpregen_opname::pregen_relation
 MEDDLY::satpregen_opname::pregen_relation
 ::~pregen_relation()
 {
+  insetF->useDomain()->unlockVariableOrder();
   delete[] events;
   delete[] next;
   delete[] level_index;
@@ -443,6 +447,37 @@ MEDDLY::satpregen_opname::pregen_relation
 #endif
 }
 
+void
+MEDDLY::satpregen_opname::pregen_relation
+::relevel()
+{
+  MEDDLY_DCASSERT(isFinalized());
+
+  if (0==level_index) {
+    // by levels
+    splitMxd(MonolithicSplit);
+    return;
+  }
+
+  //
+  // By events: sort the events array again, by new top level.
+  //
+  dd_edge* new_events = new dd_edge[last_event];
+  unsigned P = 0;
+  for (unsigned k=K; k; k--) {
+    level_index[k] = P;
+    for (unsigned e=0; e<last_event; e++) {
+      if (unsigned(ABS(events[e].getLevel())) == k) {
+        new_events[P++] = events[e];
+      }
+    }
+  }
+  MEDDLY_DCASSERT(P == last_event);
+  level_index[0] = P;
+  delete[] events;
+  events = new_events;
+}
+
 // ******************************************************************
 // *                                                                *
 // *               saturation_by_events_opname  class               *
@@ -528,6 +563,10 @@ class MEDDLY::common_dfs_by_events_mt : public specialized_operation {
     virtual void compute(const dd_edge& a, dd_edge &c);
     virtual void saturateHelper(unpacked_node& mdd) = 0;
 
+    inline int roundTop() const {
+      return round_top;
+    }
+
   protected:
     inline compute_table::entry_key* 
     findResult(node_handle a, node_handle b, node_handle &c) 
@@ -557,6 +596,9 @@ class MEDDLY::common_dfs_by_events_mt : public specialized_operation {
     binary_operation* mxdDifference;
 
     satpregen_opname::pregen_relation* rel;
+    /// Only events with top level up to this one are saturated;
+    /// below the number of variables when saturating in rounds.
+    int round_top;
 
     expert_forest* arg1F;
     expert_forest* arg2F;
@@ -745,7 +787,7 @@ MEDDLY::saturation_by_events_op::saturate(node_handle mdd, int k)
   // Cleanup
   unpacked_node::recycle(mddDptrs);
 
-  parent->saturateHelper(*nb);
+  if (k <= parent->roundTop()) parent->saturateHelper(*nb);
   n = resF->createReducedNode(-1, nb);
 
   // save in compute table
@@ -776,6 +818,7 @@ MEDDLY::common_dfs_by_events_mt::common_dfs_by_events_mt(
   freeqs = 0;
   freebufs = 0;
   rel = relation;
+  round_top = 0;
   arg1F = static_cast<expert_forest*>(rel->getInForest());
   arg2F = static_cast<expert_forest*>(rel->getRelForest());
   resF = static_cast<expert_forest*>(rel->getOutForest());
@@ -830,7 +873,31 @@ void MEDDLY::common_dfs_by_events_mt
     printf("done.\n");
   }
   saturation_by_events_op* so = new saturation_by_events_op(this, arg1F, resF);
-  so->saturate(a, c);
+  const int K = arg2F->getNumVariables();
+  domain* d = resF->useDomain();
+  if (!d->usesDynamicReordering()) {
+    round_top = K;
+    so->saturate(a, c);
+  } else {
+    //
+    // Saturate in rounds, adding the events of one more level
+    // each round, so the forests may be reordered in between.
+    //
+    c = a;
+    for (round_top = 1; round_top <= K; round_top++) {
+      if (round_top < K && 0==rel->lengthForLevel(round_top)) continue;
+      so->saturate(c, c);
+      if (round_top == K) break;
+
+      // Safe point: saturation results depend on the round,
+      // and nothing is held by level but c and the relation.
+      so->removeAllComputeTableEntries();
+      if (d->reorderAtSafePoint()) {
+        removeAllComputeTableEntries();
+        rel->relevel();
+      }
+    }
+  }
 
   // Cleanup
   while (freeqs) {
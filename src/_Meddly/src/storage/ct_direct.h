@@ -0,0 +1,674 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CT_DIRECT_H
+#define CT_DIRECT_H
+
+// **********************************************************************
+// *                                                                    *
+// *                                                                    *
+// *                          ct_direct  class                          *
+// *                                                                    *
+// *                                                                    *
+// **********************************************************************
+
+/*
+    Lossy, direct-mapped, monolithic compute table.
+
+    The table is an array of fixed-size slots, each one cache line,
+    allocated once and never resized or rehashed.
+    An entry lives only in the slot given by its hash;
+    adding an entry overwrites whatever was there.
+    Entries too large for a slot are simply not cached.
+
+    Slot layout, in entry_items:
+      [0]   tag: entry type ID plus one (high 32 bits), key hash (low 32);
+            zero for an empty slot.
+      [1]   number of repetitions, for repeating entry types only.
+      ...   key, then result.
+
+    The tag rejects almost all misses without touching the key.
+    Forest garbage collection still calls removeStales(),
+    which is a single pass over the pages of slots in use;
+    a count of entries per page lets it skip the empty ones.
+*/
+
+namespace MEDDLY {
+  class ct_direct : public compute_table {
+    public:
+      ct_direct(const ct_initializer::settings &s);
+      virtual ~ct_direct();
+
+      // required functions
+
+      virtual void find(entry_key* key, entry_result &res);
+      virtual void addEntry(entry_key* key, const entry_result& res);
+      virtual void updateEntry(entry_key* key, const entry_result& res);
+      virtual void removeStales();
+      virtual void removeAll();
+      virtual void show(output &s, int verbLevel = 0);
+      virtual void countNodeEntries(const expert_forest* f, size_t* counts) const;
+
+    private:  // helper methods
+
+      static unsigned hash(const entry_key* key);
+
+      static inline unsigned long makeTag(const entry_type* et, unsigned h) {
+        return ((unsigned long)(et->getID()+1) << 32) | h;
+      }
+      static inline unsigned tagID(unsigned long tag) {
+        return unsigned(tag >> 32) - 1;
+      }
+
+      inline entry_item* slotFor(unsigned h) const {
+        return table + (h & mask) * slotItems;
+      }
+      inline unsigned long pageOf(const entry_item* slot) const {
+        return (unsigned long)(slot - table) / (slotItems << pageShift);
+      }
+
+      /// Apply discard() to every occupied slot (or just the stale ones).
+      void scanSlots(bool onlyStales);
+
+      /// Number of items used by an entry, including the tag.
+      static inline unsigned entrySize(const entry_type* et, unsigned reps) {
+        return 1 + (et->isRepeating() ? 1 : 0)
+          + et->getKeySize(reps) + et->getResultSize();
+      }
+
+      /**
+          Compare the key portion of a slot, whose tag already matches.
+            @return Result portion of the slot if equal, 0 otherwise.
+      */
+      static entry_item* equal(entry_item* slot, const entry_key* key);
+
+      /**
+          Check if a slot is stale, and set cache bits if not.
+      */
+      bool isStale(const entry_item* slot) const;
+
+      /**
+          Check if a result is dead (unrecoverable).
+      */
+      bool isDead(const entry_item* res, const entry_type* et) const;
+
+      /**
+          Discard the entry in a slot, and mark the slot empty.
+      */
+      void discard(entry_item* slot);
+
+      /**
+          Discard an entry that was never stored.
+          Generic objects are deleted, since the table owns them.
+      */
+      static void discardUnstored(const entry_key* key, const entry_result &res);
+
+      void showEntry(output &s, const entry_item* slot) const;
+
+    private:
+      /// Entry items per slot: one 64-byte cache line.
+      static const unsigned slotItems = 64 / sizeof(entry_item);
+      /// 2^pageShift slots per page (4 Kbytes).
+      static const unsigned pageShift = 6;
+
+      /// Aligned slots
+      entry_item* table;
+      /// What we got from calloc
+      void* table_alloc;
+      /// Number of slots; a power of two
+      unsigned long tableSize;
+      /// tableSize - 1
+      unsigned long mask;
+      /// Number of entries in each page of slots
+      unsigned* pageCount;
+
+      /// Memory statistics
+      memstats mstats;
+
+      /// Stats: how many entries were overwritten
+      unsigned long collisions;
+      /// Stats: how many entries were too large to cache
+      unsigned long oversized;
+  }; // class ct_direct
+} // namespace
+
+
+// **********************************************************************
+// *                                                                    *
+// *                         ct_direct  methods                         *
+// *                                                                    *
+// **********************************************************************
+
+MEDDLY::ct_direct::ct_direct(const ct_initializer::settings &s)
+: compute_table(s, 0, 0)
+{
+  static_assert(sizeof(unsigned long) >= 8, "tags need 64-bit longs");
+
+  //
+  // maxSize is the number of entry items we may use;
+  // round the number of slots down to a power of two.
+  //
+  tableSize = 1024;
+  while (2 * tableSize * slotItems <= maxSize) tableSize *= 2;
+  mask = tableSize - 1;
+
+  //
+  // calloc leaves the pages untouched until used
+  //
+  const size_t bytes = tableSize * slotItems * sizeof(entry_item);
+  table_alloc = calloc(bytes + 64, 1);
+  if (0==table_alloc) throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+  size_t addr = (size_t) table_alloc;
+  table = (entry_item*) ((addr + 63) & ~size_t(63));
+
+  const unsigned long pages = tableSize >> pageShift;
+  pageCount = new unsigned[pages];
+  for (unsigned long i=0; i<pages; i++) pageCount[i] = 0;
+
+  mstats.incMemUsed(bytes + pages * sizeof(unsigned));
+  mstats.incMemAlloc(bytes + 64 + pages * sizeof(unsigned));
+
+  collisions = 0;
+  oversized = 0;
+}
+
+// **********************************************************************
+
+MEDDLY::ct_direct::~ct_direct()
+{
+  free(table_alloc);
+  delete[] pageCount;
+
+  /*
+    Update stats: important for global usage
+  */
+  mstats.zeroMemUsed();
+  mstats.zeroMemAlloc();
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct::find(entry_key *key, entry_result& res)
+{
+  setHash(key, hash(key));
+  perf.pings++;
+
+  entry_item* slot = slotFor(key->getHash());
+  entry_item* answer = 0;
+  if (slot[0].UL) {
+    perf.searchHistogram[1]++;
+    if (slot[0].UL == makeTag(key->getET(), key->getHash())) {
+      answer = equal(slot, key);
+    }
+    if (answer) {
+      if (isDead(answer, key->getET())) {
+        discard(slot);
+        answer = 0;
+      }
+    } else {
+      if (checkStalesOnFind && isStale(slot)) discard(slot);
+    }
+  } else {
+    perf.searchHistogram[0]++;
+  }
+  if (perf.maxSearchLength < 1) perf.maxSearchLength = 1;
+
+  if (answer) {
+    perf.hits++;
+    res.reset();
+    res.setValid(answer);
+  } else {
+    res.setInvalid();
+  }
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct::addEntry(entry_key* key, const entry_result &res)
+{
+  MEDDLY_DCASSERT(key);
+  const entry_type* et = key->getET();
+  MEDDLY_DCASSERT(et);
+
+  if (entrySize(et, key->numRepeats()) > slotItems) {
+    oversized++;
+    discardUnstored(key, res);
+    recycle(key);
+    return;
+  }
+
+  //
+  // Increment cache counters for nodes in the key and result
+  //
+  key->cacheNodes();
+  res.cacheNodes();
+
+  entry_item* slot = slotFor(key->getHash());
+  if (slot[0].UL) {
+    collisions++;
+    discard(slot);
+  }
+  pageCount[pageOf(slot)]++;
+
+  slot[0].UL = makeTag(et, key->getHash());
+  entry_item* key_portion = slot+1;
+  if (et->isRepeating()) {
+    (*key_portion).U = key->numRepeats();
+    key_portion++;
+  }
+  const unsigned key_slots = et->getKeySize(key->numRepeats());
+  memcpy(key_portion, key->rawData(), key_slots * sizeof(entry_item));
+  memcpy(key_portion + key_slots, res.rawData(),
+    res.dataLength() * sizeof(entry_item));
+  perf.numEntries++;
+
+  recycle(key);
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct::updateEntry(entry_key* key, const entry_result &res)
+{
+  MEDDLY_DCASSERT(key->getET()->isResultUpdatable());
+  entry_item* slot = slotFor(key->getHash());
+  entry_item* answer = 0;
+  if (slot[0].UL == makeTag(key->getET(), key->getHash())) {
+    answer = equal(slot, key);
+  }
+  if (!answer) {
+    //
+    // The entry was overwritten since it was found;
+    // just add it again.
+    //
+    addEntry(key, res);
+    return;
+  }
+
+  const entry_type* et = key->getET();
+  for (unsigned i=0; i<et->getResultSize(); i++) {
+    expert_forest* f = et->getResultForest(i);
+    if (f) f->uncacheNode( answer[i].N );
+  }
+  res.cacheNodes();
+  memcpy(answer, res.rawData(), res.dataLength() * sizeof(entry_item));
+  recycle(key);
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct::removeStales()
+{
+  scanSlots(true);
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct::removeAll()
+{
+  scanSlots(false);
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct::show(output &s, int verbLevel)
+{
+  if (verbLevel < 1) return;
+
+  s << "Monolithic direct-mapped compute table\n";
+
+  s.put("", 6);
+  s << "Current CT memory   :\t" << mstats.getMemUsed() << " bytes\n";
+  s.put("", 6);
+  s << "Current CT alloc'd  :\t" << mstats.getMemAlloc() << " bytes\n";
+  s.put("", 6);
+  s << "Collisions          :\t" << long(collisions) << "\n";
+  s.put("", 6);
+  s << "Too large to cache  :\t" << long(oversized) << "\n";
+  s.put("", 6);
+  s << "Number of slots     :\t" << long(tableSize) << "\n";
+  s.put("", 6);
+  s << "Number of entries   :\t" << long(perf.numEntries) << "\n";
+
+  if (--verbLevel < 1) return;
+
+  s.put("", 6);
+  s << "Pings               :\t" << long(perf.pings) << "\n";
+  s.put("", 6);
+  s << "Hits                :\t" << long(perf.hits) << "\n";
+
+  if (--verbLevel < 1) return;
+
+  s.put("", 6);
+  s << "Searches of empty slots    : " << long(perf.searchHistogram[0]) << "\n";
+  s.put("", 6);
+  s << "Searches of occupied slots : " << long(perf.searchHistogram[1]) << "\n";
+
+  if (--verbLevel < 1) return;
+
+  s << "Slots:\n";
+  const entry_item* slot = table;
+  for (unsigned long i=0; i<tableSize; i++, slot += slotItems) {
+    if (0==slot[0].UL) continue;
+    s << "\tslot[";
+    s.put(long(i), 9);
+    s << "]: ";
+    showEntry(s, slot);
+    s.put('\n');
+  }
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct
+::countNodeEntries(const expert_forest* f, size_t* counts) const
+{
+  const entry_item* slot = table;
+  for (unsigned long s=0; s<tableSize; s++, slot += slotItems) {
+    if (0==slot[0].UL) continue;
+    const entry_type* et = getEntryType(tagID(slot[0].UL));
+    MEDDLY_DCASSERT(et);
+
+    const entry_item* ptr = slot+1;
+    unsigned reps = 0;
+    if (et->isRepeating()) {
+      reps = (*ptr).U;
+      ptr++;
+    }
+    const unsigned stop = et->getKeySize(reps);
+    for (unsigned i=0; i<stop; i++) {
+      if (f != et->getKeyForest(i)) continue;
+      if (ptr[i].N > 0) ++counts[ ptr[i].N ];
+    }
+    ptr += stop;
+    for (unsigned i=0; i<et->getResultSize(); i++) {
+      if (f != et->getResultForest(i)) continue;
+      if (ptr[i].N > 0) ++counts[ ptr[i].N ];
+    }
+  } // for s
+}
+
+// **********************************************************************
+
+unsigned MEDDLY::ct_direct::hash(const entry_key* key)
+{
+  const entry_type* et = key->getET();
+  MEDDLY_DCASSERT(et);
+
+  hash_stream H;
+  H.start();
+  H.push(et->getID());
+  if (et->isRepeating()) {
+    H.push(key->numRepeats());
+  }
+
+  const entry_item* entry = key->rawData();
+  const unsigned klen = et->getKeySize(key->numRepeats());
+  for (unsigned i=0; i<klen; i++) {
+    switch (et->getKeyType(i)) {
+        case FLOAT:
+        case NODE:
+        case INTEGER:
+                        H.push(entry[i].U);
+                        continue;
+
+        case DOUBLE:
+        case GENERIC:
+        case LONG:
+                        {
+                          unsigned* hack = (unsigned*) (& (entry[i].L));
+                          H.push(hack[0], hack[1]);
+                        }
+                        continue;
+        default:
+                        MEDDLY_DCASSERT(0);
+    } // switch t
+  } // for i
+
+  return H.finish();
+}
+
+// **********************************************************************
+
+MEDDLY::compute_table::entry_item*
+MEDDLY::ct_direct::equal(entry_item* slot, const entry_key* key)
+{
+  const entry_type* et = key->getET();
+  entry_item* a = slot+1;
+  if (et->isRepeating()) {
+    if (key->numRepeats() != (*a).U) return 0;
+    a++;
+  }
+  const entry_item* b = key->rawData();
+  const unsigned klen = et->getKeySize(key->numRepeats());
+  for (unsigned i=0; i<klen; i++) {
+    switch (et->getKeyType(i)) {
+        case FLOAT:
+                  if (a[i].F != b[i].F) return 0;
+                  continue;
+        case NODE:
+                  if (a[i].N != b[i].N) return 0;
+                  continue;
+        case INTEGER:
+                  if (a[i].I != b[i].I) return 0;
+                  continue;
+        case DOUBLE:
+                  if (a[i].D != b[i].D) return 0;
+                  continue;
+        case GENERIC:
+                  if (a[i].G != b[i].G) return 0;
+                  continue;
+        case LONG:
+                  if (a[i].L != b[i].L) return 0;
+                  continue;
+        default:
+                  MEDDLY_DCASSERT(0);
+    } // switch t
+  } // for i
+  return a + klen;
+}
+
+// **********************************************************************
+
+bool MEDDLY::ct_direct::isStale(const entry_item* slot) const
+{
+  const entry_type* et = getEntryType(tagID(slot[0].UL));
+  MEDDLY_DCASSERT(et);
+
+  if (et->isMarkedForDeletion()) return true;
+
+  const entry_item* entry = slot+1;
+  const unsigned reps = (et->isRepeating()) ? (*entry++).U : 0;
+  const unsigned klen = et->getKeySize(reps);
+
+  for (unsigned i=0; i<klen; i++) {
+    expert_forest* f = et->getKeyForest(i);
+    if (f) {
+      if (MEDDLY::forest::ACTIVE != f->getNodeStatus(entry[i].N)) {
+        return true;
+      } else {
+        f->setCacheBit(entry[i].N);
+      }
+    }
+  } // for i
+  entry += klen;
+
+  for (unsigned i=0; i<et->getResultSize(); i++) {
+    expert_forest* f = et->getResultForest(i);
+    if (f) {
+      if (MEDDLY::forest::ACTIVE != f->getNodeStatus(entry[i].N)) {
+        return true;
+      } else {
+        f->setCacheBit(entry[i].N);
+      }
+    }
+  } // for i
+
+  return false;
+}
+
+// **********************************************************************
+
+bool MEDDLY::ct_direct
+::isDead(const entry_item* result, const entry_type* et) const
+{
+  for (unsigned i=0; i<et->getResultSize(); i++) {
+    expert_forest* f = et->getResultForest(i);
+    if (f) {
+      if (MEDDLY::forest::DEAD == f->getNodeStatus(result[i].N)) {
+        return true;
+      }
+    }
+  } // for i
+  return false;
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct::discard(entry_item* slot)
+{
+  const entry_type* et = getEntryType(tagID(slot[0].UL));
+  MEDDLY_DCASSERT(et);
+
+  const entry_item* ptr = slot+1;
+  unsigned reps = 0;
+  if (et->isRepeating()) {
+    reps = (*ptr).U;
+    ptr++;
+  }
+
+  //
+  // Key portion
+  //
+  const unsigned stop = et->getKeySize(reps);
+  for (unsigned i=0; i<stop; i++) {
+    typeID t;
+    expert_forest* f;
+    et->getKeyType(i, t, f);
+    if (f) {
+      f->uncacheNode( ptr[i].N );
+      continue;
+    }
+    if (GENERIC == t) {
+      delete ptr[i].G;
+    }
+  } // for i
+  ptr += stop;
+
+  //
+  // Result portion
+  //
+  for (unsigned i=0; i<et->getResultSize(); i++) {
+    typeID t;
+    expert_forest* f;
+    et->getResultType(i, t, f);
+    if (f) {
+      f->uncacheNode( ptr[i].N );
+      continue;
+    }
+    if (GENERIC == t) {
+      delete ptr[i].G;
+    }
+  } // for i
+
+  slot[0].UL = 0;
+  pageCount[pageOf(slot)]--;
+  perf.numEntries--;
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct::scanSlots(bool onlyStales)
+{
+  const unsigned long pages = tableSize >> pageShift;
+  const unsigned long perPage = 1UL << pageShift;
+  for (unsigned long p=0; p<pages && perf.numEntries; p++) {
+    if (0==pageCount[p]) continue;
+    entry_item* slot = table + p * perPage * slotItems;
+    for (unsigned long i=0; i<perPage; i++, slot += slotItems) {
+      if (0==slot[0].UL) continue;
+      if (onlyStales && !isStale(slot)) continue;
+      discard(slot);
+    }
+  }
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct
+::discardUnstored(const entry_key* key, const entry_result &res)
+{
+  const entry_type* et = key->getET();
+  const entry_item* k = key->rawData();
+  const unsigned stop = et->getKeySize(key->numRepeats());
+  for (unsigned i=0; i<stop; i++) {
+    if (GENERIC == et->getKeyType(i)) delete k[i].G;
+  }
+  const entry_item* r = res.rawData();
+  for (unsigned i=0; i<et->getResultSize(); i++) {
+    if (GENERIC == et->getResultType(i)) delete r[i].G;
+  }
+}
+
+// **********************************************************************
+
+void MEDDLY::ct_direct::showEntry(output &s, const entry_item* slot) const
+{
+  const entry_type* et = getEntryType(tagID(slot[0].UL));
+  MEDDLY_DCASSERT(et);
+
+  const entry_item* ptr = slot+1;
+  unsigned reps = 0;
+  if (et->isRepeating()) {
+    reps = (*ptr).U;
+    ptr++;
+  }
+  s << "[" << et->getName() << "(";
+  const unsigned stop = et->getKeySize(reps);
+  for (unsigned i=0; i<stop+et->getResultSize(); i++) {
+    if (i==stop) s << "): ";
+    else if (i) s << ", ";
+    typeID t = (i<stop) ? et->getKeyType(i) : et->getResultType(i-stop);
+    switch (t) {
+      case NODE:
+                      s.put(long(ptr[i].N));
+                      break;
+      case INTEGER:
+                      s.put(long(ptr[i].I));
+                      break;
+      case LONG:
+                      s.put(ptr[i].L);
+                      break;
+      case FLOAT:
+                      s.put(ptr[i].F, 0, 0, 'e');
+                      break;
+      case DOUBLE:
+                      s.put(ptr[i].D, 0, 0, 'e');
+                      break;
+      case GENERIC:
+                      s.put_hex((unsigned long)ptr[i].G);
+                      break;
+      default:
+                      MEDDLY_DCASSERT(0);
+    } // switch t
+  } // for i
+  s << "]";
+}
+
+#endif  // include guard
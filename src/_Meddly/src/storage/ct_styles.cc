@@ -48,6 +48,7 @@
 #include <climits>
 #include "ct_typebased.h"
 #include "ct_none.h"
+#include "ct_direct.h"
 
 
 // **********************************************************************
@@ -166,3 +167,27 @@ bool MEDDLY::operation_unchained_style::usesMonolithic() const
 }
 
 
+// **********************************************************************
+// *                                                                    *
+// *                  monolithic_direct_style  methods                  *
+// *                                                                    *
+// **********************************************************************
+
+
+MEDDLY::monolithic_direct_style::monolithic_direct_style() 
+{ 
+}
+
+MEDDLY::compute_table* 
+MEDDLY::monolithic_direct_style::create(const ct_initializer::settings &s) const 
+{
+  // Entries are stored as is; there is no compression.
+  return new ct_direct(s);
+}
+
+bool MEDDLY::monolithic_direct_style::usesMonolithic() const 
+{
+  return true;
+}
+
+
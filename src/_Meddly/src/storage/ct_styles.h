@@ -36,6 +36,7 @@ namespace MEDDLY {
   class monolithic_unchained_style;
   class operation_chained_style;
   class operation_unchained_style;
+  class monolithic_direct_style;
 };
 
 // **********************************************************************
@@ -92,5 +93,18 @@ class MEDDLY::operation_unchained_style : public compute_table_style {
     virtual bool usesMonolithic() const;
 };
 
+// **********************************************************************
+// *                                                                    *
+// *                   monolithic_direct_style  class                   *
+// *                                                                    *
+// **********************************************************************
+
+class MEDDLY::monolithic_direct_style : public compute_table_style {
+  public:
+    monolithic_direct_style();
+    virtual compute_table* create(const ct_initializer::settings &s) const;
+    virtual bool usesMonolithic() const;
+};
+
 
 #endif
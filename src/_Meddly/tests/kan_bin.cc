@@ -0,0 +1,282 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+    Tests the binary format of writeEdgesBinary() / readEdgesBinary(),
+    reading back both from a FILE and from memory.
+*/
+
+#include <cstdlib>
+#include <string.h>
+#include <unistd.h>
+
+#include "../src/meddly.h"
+#include "simple_model.h"
+
+// #define DEBUG_FILE
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+long expected[] = {
+  1, 160, 4600, 58400, 454475, 2546432, 11261376,
+  41644800, 133865325, 384392800, 1005927208
+};
+
+using namespace MEDDLY;
+
+struct kanban_dds {
+  domain* d;
+  forest* mdd;
+  forest* mxd;
+  forest* evmdd;
+  dd_edge init_state;
+  dd_edge nsf;
+  dd_edge reachable;
+  dd_edge reach_index;
+
+  kanban_dds(int N) {
+    int sizes[16];
+    for (int i=15; i>=0; i--) sizes[i] = N+1;
+    d = createDomainBottomUp(sizes, 16);
+    mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+    mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+    evmdd = d->createForest(0, forest::INTEGER, forest::INDEX_SET);
+  }
+  ~kanban_dds() {
+    destroyDomain(d);
+  }
+
+  void generate(int N) {
+    int initial[17];
+    for (int i=16; i; i--) initial[i] = 0;
+    initial[1] = initial[5] = initial[9] = initial[13] = N;
+    int* initptr = initial;
+    init_state = dd_edge(mdd);
+    mdd->createEdge(&initptr, 1, init_state);
+
+    nsf = dd_edge(mxd);
+    buildNextStateFunction(kanban, 16, mxd, nsf);
+
+    reachable = dd_edge(mdd);
+    apply(REACHABLE_STATES_DFS, init_state, nsf, reachable);
+
+    reach_index = dd_edge(evmdd);
+    apply(CONVERT_TO_INDEX_SET, reachable, reach_index);
+  }
+
+  void write(output &s) const {
+    mxd->writeEdgesBinary(s, &nsf, 1);
+    dd_edge list[2];
+    list[0] = init_state;
+    list[1] = reachable;
+    mdd->writeEdgesBinary(s, list, 2);
+    evmdd->writeEdgesBinary(s, &reach_index, 1);
+  }
+
+  bool readAndCheck(input &s) {
+    dd_edge list[2];
+    mxd->readEdgesBinary(s, list, 1);
+    if (list[0] != nsf) {
+      printf("Failed to read MXD\n");
+      return false;
+    }
+    mdd->readEdgesBinary(s, list, 2);
+    if (list[0] != init_state || list[1] != reachable) {
+      printf("Failed to read MDDs\n");
+      return false;
+    }
+    evmdd->readEdgesBinary(s, list, 1);
+    if (list[0] != reach_index) {
+      printf("Failed to read index set\n");
+      return false;
+    }
+    return true;
+  }
+};
+
+int main()
+{
+  const int N = 8;
+  MEDDLY::initialize();
+
+  char filename[20];
+  strcpy(filename, "kan_bin.data.XXXXXX");
+  int fd = mkstemp(filename);
+  if (fd < 0) {
+    printf("Couldn't create temporary file\n");
+    return 2;
+  }
+  close(fd);
+#ifdef DEBUG_FILE
+  printf("Using file %s\n", filename);
+#endif
+
+  unsigned char* buffer = 0;
+  try {
+    for (int n=1; n<N; n++) {
+      printf("N=%2d:  ", n);
+      fflush(stdout);
+
+      //
+      // Generate and write, also in text for comparison
+      //
+      long textsize, rbinsize, binsize;
+      {
+        kanban_dds K(n);
+        K.generate(n);
+        long c;
+        apply(CARDINALITY, K.reachable, c);
+        if (c != expected[n]) {
+          printf("Wrong number of states!\n");
+          throw 1;
+        }
+
+        FILE* s = fopen(filename, "w");
+        if (0==s) throw 2;
+        FILE_output mys(s);
+        K.mdd->writeEdges(mys, &K.reachable, 1);
+        textsize = ftell(s);
+        fclose(s);
+
+        s = fopen(filename, "w");
+        if (0==s) throw 2;
+        FILE_output myr(s);
+        K.mdd->writeEdgesBinary(myr, &K.reachable, 1);
+        rbinsize = ftell(s);
+        if (rbinsize >= textsize) {
+          printf("Binary reachable set is not smaller than text\n");
+          throw 5;
+        }
+        fclose(s);
+
+        s = fopen(filename, "w");
+        if (0==s) throw 2;
+        FILE_output myw(s);
+        K.write(myw);
+        binsize = ftell(s);
+        fclose(s);
+      }
+
+      //
+      // Read into empty forests, from the file
+      //
+      {
+        kanban_dds K(n);
+        FILE* s = fopen(filename, "r");
+        if (0==s) throw 2;
+        FILE_input mys(s);
+        dd_edge nsf, list[2], index;
+        K.mxd->readEdgesBinary(mys, &nsf, 1);
+        K.mdd->readEdgesBinary(mys, list, 2);
+        K.evmdd->readEdgesBinary(mys, &index, 1);
+        fclose(s);
+
+        K.generate(n);
+        if (nsf != K.nsf || list[0] != K.init_state
+            || list[1] != K.reachable || index != K.reach_index)
+        {
+          printf("Failed to read and generate\n");
+          throw 3;
+        }
+      }
+
+      //
+      // Read into full forests, from memory
+      //
+      {
+        FILE* s = fopen(filename, "r");
+        if (0==s) throw 2;
+        buffer = (unsigned char*) malloc(binsize);
+        if (0==buffer || fread(buffer, 1, binsize, s) != size_t(binsize)) {
+          throw 2;
+        }
+        fclose(s);
+
+        kanban_dds K(n);
+        K.generate(n);
+        memory_input mym(buffer, binsize);
+        if (!K.readAndCheck(mym)) throw 4;
+        if (mym.position() != size_t(binsize)) {
+          printf("Didn't consume the entire buffer\n");
+          throw 4;
+        }
+
+        // A forest of a different type must reject the data
+        memory_input bad(buffer, binsize);
+        dd_edge e;
+        try {
+          K.mdd->readEdgesBinary(bad, &e, 1);
+          printf("Read MXD data into an MDD forest\n");
+          throw 6;
+        }
+        catch (MEDDLY::error e) {
+          if (e.getCode() != MEDDLY::error::INVALID_FILE) throw;
+        }
+
+        free(buffer);
+        buffer = 0;
+      }
+
+      printf("%10ld states: %9ld text bytes, %8ld binary bytes, verified\n",
+        expected[n], textsize, rbinsize);
+    }
+
+#ifndef DEBUG_FILE
+    remove(filename);
+#endif
+    MEDDLY::cleanup();
+    printf("Done\n");
+    return 0;
+  }
+  catch (int e) {
+    free(buffer);
+#ifndef DEBUG_FILE
+    remove(filename);
+#endif
+    MEDDLY::cleanup();
+    printf("\nError %d\n", e);
+    return e;
+  }
+  catch (MEDDLY::error e) {
+    free(buffer);
+#ifndef DEBUG_FILE
+    remove(filename);
+#endif
+    MEDDLY::cleanup();
+    printf("\nError: %s\n", e.getName());
+    return 1;
+  }
+}
@@ -0,0 +1,206 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <string.h>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+/*
+    Same as kanban, but with dynamic reordering triggered
+    after a few nodes, so that forests are reordered
+    between the steps of the traditional iteration,
+    and between the rounds of saturation.
+*/
+
+#define PROGRESS
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+long expected[] = { 
+  1, 160, 4600, 58400, 454475, 2546432, 11261376, 
+  41644800, 133865325, 384392800, 1005927208 
+};
+
+const int nstart = 1;
+const int nstop = 4;
+
+using namespace MEDDLY;
+
+bool reordered;
+
+enum method { MONOLITHIC_SAT, EVENTS_SAT, LEVELS_SAT, TRADITIONAL };
+
+long buildReachset(int N, method m, long trigger)
+{
+  int sizes[16];
+
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  forest::policies pmdd(false);
+  pmdd.setDynamicReordering(trigger);
+  forest::policies pmxd(true);
+  pmxd.setDynamicReordering(trigger);
+
+  // Build initial state
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, pmdd);
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  delete[] initial;
+
+#ifdef PROGRESS
+  fputc('i', stdout);
+  fflush(stdout);
+#endif
+
+  // Build next-state function
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL, pmxd);
+  dd_edge nsf(mxd);
+  if (MONOLITHIC_SAT == m || TRADITIONAL == m) {
+    buildNextStateFunction(kanban, 16, mxd, nsf);
+  }
+
+#ifdef PROGRESS
+  fputc('n', stdout);
+  fflush(stdout);
+#endif
+
+  dd_edge reachable(mdd);
+  if (MONOLITHIC_SAT == m) {
+    apply(REACHABLE_STATES_DFS, init_state, nsf, reachable);
+  } else if (TRADITIONAL != m) {
+    // One sub-relation per event, or per level.  The relation locks
+    // the order, so any reordering happens at the safe points of
+    // saturation.
+    satpregen_opname::pregen_relation* ensf = (EVENTS_SAT == m)
+      ? new satpregen_opname::pregen_relation(mdd, mxd, mdd, 16)
+      : new satpregen_opname::pregen_relation(mdd, mxd, mdd);
+    for (int e=0; e<16; e++) {
+      dd_edge ev(mxd);
+      buildNextStateFunction(kanban+e, 1, mxd, ev);
+      ensf->addToRelation(ev);
+    }
+    ensf->finalize();
+    specialized_operation* sat = SATURATION_FORWARD->buildOperation(ensf);
+    sat->compute(init_state, reachable);
+    destroyOperation(sat);
+  } else {
+    dd_edge next(mdd);
+    reachable = init_state;
+    for (;;) {
+      apply(POST_IMAGE, reachable, nsf, next);
+      apply(UNION, reachable, next, next);
+      if (next == reachable) break;
+      reachable = next;
+    }
+  }
+
+#ifdef PROGRESS
+  fputc('r', stdout);
+  fflush(stdout);
+#endif
+
+  long c;
+  apply(CARDINALITY, reachable, c);
+
+#ifdef PROGRESS
+  fputc('c', stdout);
+  fflush(stdout);
+#endif
+
+  // Both forests must always use the same order
+  expert_forest* emdd = static_cast<expert_forest*>(mdd);
+  expert_forest* emxd = static_cast<expert_forest*>(mxd);
+  if (emdd->variableOrder() != emxd->variableOrder()) {
+    printf("Forest orders differ!\n");
+    c = -1;
+  }
+  for (int k=1; k<=16; k++) {
+    if (emdd->getVarByLevel(k) != k) reordered = true;
+  }
+
+  destroyDomain(d);
+  
+#ifdef PROGRESS
+  fputc(' ', stdout);
+  fflush(stdout);
+#endif
+  return c;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  const char* names[] = {
+    "saturation", "saturation by events", "saturation by levels",
+    "traditional iteration"
+  };
+  const method methods[] = {
+    MONOLITHIC_SAT, EVENTS_SAT, LEVELS_SAT, TRADITIONAL
+  };
+  // saturation builds much smaller diagrams
+  const long triggers[] = { 100, 100, 100, 1000 };
+
+  for (int i=0; i<4; i++) {
+    printf("Building Kanban reachability sets, using %s\n", names[i]);
+    reordered = false;
+    for (int n=nstart; n<=nstop; n++) {
+      printf("N=%2d:  ", n);
+      fflush(stdout);
+      long c = buildReachset(n, methods[i], triggers[i]);
+      printf("%12ld states\n", c);
+      if (c != expected[n]) {
+        printf("Wrong number of states!\n");
+        return 1;
+      }
+    }
+    if (!reordered) {
+      printf("Variables were never reordered!\n");
+      return 1;
+    }
+  }
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
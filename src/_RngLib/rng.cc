@@ -132,7 +132,7 @@ double well1024a_stream::Uniform64()
   double unif = u[0];
   unif *= 4294967296.0;
   unif += u[1];
-  return unif * (1.0 / 9223372036854775808.0);
+  return unif * (1.0 / 18446744073709551616.0);
 }
 
 
@@ -277,6 +277,7 @@ bool well1024a_manager_32::SetJumpValue(int d)
 void well1024a_manager_32::Initialize(well1024a_stream* s, int seed)
 {
   DCASSERT(s);
+  s->state_ptr = 0;
   // Fill state using Park's old RNG
   const int A = 48271;
   const int M = 2147483647;
@@ -299,7 +300,13 @@ void well1024a_manager_32
   DCASSERT(s);
   DCASSERT(j);
   BuildJumpMatrix();  // NO-OP if already built
-  VMMult(j->state, jump_matrix, s->state);
+  // The matrix works on the state words in order, starting from
+  // state_ptr, and adds to the result (so clear it first).
+  unsigned int x[32];
+  for (int i=0; i<32; i++) x[i] = j->state[ (j->state_ptr+i) & 0x0000001fUL ];
+  memset(s->state, 0, 32*sizeof(unsigned int));
+  s->state_ptr = 0;
+  VMMult(x, jump_matrix, s->state);
 }
 
 void well1024a_manager_32::VMMult(const unsigned int* x, const unsigned int* M, unsigned int* y) 
@@ -0,0 +1,81 @@
+
+#include "event_heap.h"
+
+// ******************************************************************
+// *                                                                *
+// *                    sim_event_heap  methods                     *
+// *                                                                *
+// ******************************************************************
+
+sim_event_heap::sim_event_heap(int size)
+{
+  if (size < 1) size = 1;
+  clock = new double[size];
+  heap = new int[size];
+  pos = new int[size];
+  for (int i=0; i<size; i++) {
+    clock[i] = 0.0;
+    pos[i] = -1;
+  }
+  length = 0;
+}
+
+sim_event_heap::~sim_event_heap()
+{
+  delete[] clock;
+  delete[] heap;
+  delete[] pos;
+}
+
+void sim_event_heap::Schedule(int e, double t)
+{
+  if (pos[e] < 0) {
+    clock[e] = t;
+    place(length, e);
+    SiftUp(length++);
+    return;
+  }
+  bool earlier = (t < clock[e]);
+  clock[e] = t;
+  if (earlier)  SiftUp(pos[e]);
+  else          SiftDown(pos[e]);
+}
+
+void sim_event_heap::Cancel(int e)
+{
+  int i = pos[e];
+  if (i < 0) return;
+  pos[e] = -1;
+  length--;
+  if (i == length) return;
+  int last = heap[length];
+  place(i, last);
+  SiftUp(i);
+  SiftDown(pos[last]);
+}
+
+void sim_event_heap::SiftUp(int i)
+{
+  int e = heap[i];
+  while (i > 0) {
+    int parent = (i-1) / 2;
+    if (!before(e, heap[parent])) break;
+    place(i, heap[parent]);
+    i = parent;
+  }
+  place(i, e);
+}
+
+void sim_event_heap::SiftDown(int i)
+{
+  int e = heap[i];
+  for (;;) {
+    int child = 2*i+1;
+    if (child >= length) break;
+    if (child+1 < length && before(heap[child+1], heap[child])) child++;
+    if (!before(heap[child], e)) break;
+    place(i, heap[child]);
+    i = child;
+  }
+  place(i, e);
+}
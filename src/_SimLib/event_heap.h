@@ -0,0 +1,58 @@
+#ifndef EVENT_HEAP_H
+#define EVENT_HEAP_H
+
+/** Future event list for model simulation.
+
+    An indexed binary min-heap of event clocks.
+    Events are integers between 0 and size-1, and each is either
+    scheduled (with a firing time) or not.
+    The most imminent event is found in constant time;
+    scheduling, rescheduling, or cancelling an event
+    takes logarithmic time.
+    Ties go to the smaller event index.
+*/
+class sim_event_heap {
+  /// Firing time of each event, if scheduled.
+  double* clock;
+  /// Scheduled events, in heap order.
+  int* heap;
+  /// Position of each event in the heap, or -1 if not scheduled.
+  int* pos;
+  /// Number of scheduled events.
+  int length;
+public:
+  sim_event_heap(int size);
+  ~sim_event_heap();
+
+  inline bool isEmpty() const { return 0==length; }
+  inline int  Length() const { return length; }
+
+  /// The most imminent event; the heap must not be empty.
+  inline int  Top() const { return heap[0]; }
+  /// Firing time of the most imminent event.
+  inline double TopTime() const { return clock[heap[0]]; }
+
+  inline bool isScheduled(int e) const { return pos[e] >= 0; }
+  inline double Time(int e) const { return clock[e]; }
+
+  /// Schedule event e at time t, or move it if already scheduled.
+  void Schedule(int e, double t);
+
+  /// Remove event e, if it is scheduled.
+  void Cancel(int e);
+
+private:
+  inline bool before(int a, int b) const {
+    if (clock[a] < clock[b]) return true;
+    if (clock[a] > clock[b]) return false;
+    return a < b;
+  }
+  inline void place(int i, int e) {
+    heap[i] = e;
+    pos[e] = i;
+  }
+  void SiftUp(int i);
+  void SiftDown(int i);
+};
+
+#endif
@@ -16,10 +16,11 @@
 class my_expt : public sim_experiment {
 int die;
 public:
-  my_expt() : sim_experiment() { die = 6; }
+  my_expt(int start = 6) : sim_experiment() { die = start; }
   virtual ~my_expt() { }
 
   virtual void PerformExperiment(sim_outcome* outlist, int n);
+  virtual sim_experiment* Clone(int t) const;
 };
 
 
@@ -45,6 +46,13 @@ void my_expt::PerformExperiment(sim_outcome* outlist, int n)
 }
 
 
+sim_experiment* my_expt::Clone(int t) const
+{
+  // Each copy starts on a different face
+  return new my_expt(1 + (die+t-1) % 6);
+}
+
+
 void DumpResults(sim_confintl* measures, int num)
 {
   printf("Results:\n");
@@ -64,25 +72,29 @@ void DumpResults(sim_confintl* measures, int num)
   }
 }
 
-int main()
+int main(int argc, char** argv)
 {
   const char* version = SIM_LibraryVersion();
   printf("Using %s\n", version);
 
+  int threads = (argc>1) ? atoi(argv[1]) : 1;
+  if (threads < 1) threads = 1;
+  printf("Using %d threads\n", threads);
+
   my_expt foo;
 
   sim_confintl* measures = new sim_confintl[7];
 
   printf("Starting dice simulation, variable number of iterations\n");
-  SIM_MonteCarlo_S(&foo, measures, 7, 0.99, 0.01);
+  SIM_MonteCarlo_S(&foo, measures, 7, 0.99, 0.01, threads);
   DumpResults(measures, 7);
 
   printf("Starting dice simulation, variable half-widths\n");
-  SIM_MonteCarlo_W(&foo, measures, 7, 10000000, 0.99);
+  SIM_MonteCarlo_W(&foo, measures, 7, 10000000, 0.99, threads);
   DumpResults(measures, 7);
 
   printf("Starting dice simulation, variable confidence\n");
-  SIM_MonteCarlo_C(&foo, measures, 7, 10000000, 0.01);
+  SIM_MonteCarlo_C(&foo, measures, 7, 10000000, 0.01, threads);
   DumpResults(measures, 7);
 
   delete[] measures;
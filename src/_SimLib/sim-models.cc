@@ -3,252 +3,189 @@
 #include <iostream>
 #include <cmath>
 #include "sim-models.h"
+#include "event_heap.h"
 #include "normal.h"
 #include "autocorrelation.h"
 #include <vector>
 
 using namespace std;
 
-int nextEvent(double* events, int n, int* flags);
+/*  event list variables:
+  *  Each enabled event has an amount of "work" left (its sampled time)
+  *  as of time last[i], which elapses at its current speed.
+  *  Its clock (absolute firing time) is kept in the future event list.
+  */
+struct event_list {
+  vector<double> work;
+  vector<double> speeds;
+  vector<double> last;
+  sim_event_heap fel;
+
+  event_list(int noe) : work(noe, 0.0), speeds(noe, 0.0), last(noe, 0.0), fel(noe) { }
+
+  /* (re)schedule event i in state s, at time now */
+  void update(sim_model* m, int i, bool fired, const sim_state* s, double now) {
+    if (!m->IsEventEnabled(i, s)) {
+      fel.Cancel(i);
+      return;
+    }
+    if (fired || !fel.isScheduled(i)) {
+      // disabled previously or enabled previously and fired
+      work[i] = m->GenerateEventTime(i, s);
+    } else {
+      work[i] -= (now - last[i]) * speeds[i];
+      if (work[i] < 0) work[i] = 0;
+    }
+    speeds[i] = m->GetEventSpeed(i, s);
+    last[i] = now;
+    fel.Schedule(i, now + work[i]/speeds[i]);
+  }
+};
 
 int SIM_BatchMeans(sim_model* m, int N, void* msrdata, sim_confintl* estlist, int batchNum, int batchSize, float percentage){
-  
+
   int samples = batchNum*batchSize;
   double simClock = 0.0; /* current simulation clock */
   double firedTime = 0.0; /* next simulation clock */
   double deltaTime = 0.0; /* time difference between next and current */
-  double t = 0.0; /* time for eventTime/speed */
-  int firedEvent; 
-  
-  /*  event list variables: 
-    *  Each event is associated with a clock, speed, and an enabled(1) or not(0) flag.
-    */
+  int firedEvent;
+
   int noe = m->NumberOfEvents();
-  double* clocks = new double[noe];
-  int* enabledFlags = new int[noe]; 
-  double* eventTimes = new double[noe];
-  double* speeds = new double[noe];
-  
+  event_list events(noe);
+
   /* statistical array variables for each measure */
-  double* stats = new double[N];
-  double* curBatchMean = new double[N];
-  double* preBatchMean = new double[N];
-  double* autoCovariance = new double[N];
-  double* avglist = new double[N];
-  double* mean = new double[N];
-  double* sum = new double[N];
+  vector<double> stats(N, 0.0);
+  vector<double> curBatchMean(N, 0.0);
+  vector<double> avglist(N, 0.0);
+  vector<double> mean(N, 0.0);
+  vector<double> sum(N, 0.0);
   double error;
   double std;
   double tNormal = idfStdNormal((1+percentage)/2);
-  
-  //vector<autocorrelation> autocorrelationVector;
-  vector<autocorrelation*> autoVector;
-  autocorrelation *a;
-  
-  /* initialize */
-  for (int j =0 ; j < noe; j++){
-    clocks[j] = 0.0; 
-    enabledFlags[j] = 0;
-    eventTimes[j] = 0.0;
-    speeds[j] = 0.0;
-    }
-  
-  for (int l = 0; l < N; l++){
-    mean[l] = 0.0;
-    sum[l] = 0.0;
-    avglist[l] = 0.0;
-    curBatchMean[l] = 0.0;
-    preBatchMean[l] = 0.0;
-    autoCovariance[l] = 0.0;
-    stats[l] = 0.0;
-    a = new autocorrelation();
-    autoVector.push_back(a);
 
-  }
-  
-    sim_state* currState = m->CreateState();
-  int initialSuccess = m->FillInitialState(currState);
-  if (initialSuccess != 0) {
-    return initialSuccess;
-  }
-  
-  sim_state* nextState;
-  
-  bool flag = false;  /* general flag to indicate whether there is event enabled */
-  int i = 0;
+  vector<autocorrelation> autoVector(N);
+
+  sim_state* currState = m->CreateState();
+  sim_state* nextState = m->CreateState();
+  int code = m->FillInitialState(currState);
+
   double diffMean = 0.0; /* for grand mean */
   int index = 0;
   double preBatchTime = 0.0;
   double batchTime = 0.0; /* time difference between previous batch and current batch */
-  
+  bool absorbed = false;  /* no event is enabled in the current state */
+
   /* initial scheduling  */
-  for (i=0; i<noe; i++){
-    if (m->IsEventEnabled(i, currState)){
-      enabledFlags[i] = 1; 
-      eventTimes[i] = m->GenerateEventTime(i, currState);
-      speeds[i] = m->GetEventSpeed(i, currState);
-      eventTimes[i]/=speeds[i];
-      clocks[i] = eventTimes[i];
-    }
+  if (0==code) {
+    for (int i=0; i<noe; i++) events.update(m, i, true, currState, simClock);
   }
-  
-  for (int g = 1; g <= batchNum; g++){
+
+  for (int g = 1; g <= batchNum && 0==code && !absorbed; g++){
     while ((++index) <= (batchSize*g)){
-      firedEvent = nextEvent(clocks, noe, enabledFlags);
-      if (firedEvent >= noe){ // all the events are disabled
+      if (events.fel.isEmpty()) { // all the events are disabled
+        absorbed = true;
         break;
       }
-      
-      firedTime = clocks[firedEvent];
-      enabledFlags[firedEvent] = 0; 
-      
+      firedEvent = events.fel.Top();
+      firedTime = events.fel.TopTime();
+      events.fel.Cancel(firedEvent);
+
       //fire event
-      nextState = m->CreateState();
-      int nextSuccess = m->FillNextState(firedEvent, currState, nextState);
-      if (nextSuccess != 0) {
-        return nextSuccess;
-      }
-      
+      code = m->FillNextState(firedEvent, currState, nextState);
+      if (code) break;
+
       /* update statistics */
-      int measureSuccess = m->EvaluateMeasures(currState, N, msrdata, avglist);
-      if (measureSuccess != 0) {
-        return measureSuccess;
-      }
-      
+      code = m->EvaluateMeasures(currState, N, msrdata, avglist.data());
+      if (code) break;
+
       deltaTime = firedTime - simClock;
-      
+
       for (int j = 0; j<N; j++){
         stats[j]+=avglist[j]*deltaTime;
       }
-      
+
       /* advance the current clock */
       simClock = firedTime;
-      m->DestroyState(currState);
-      currState = nextState; 
-      
+      sim_state* tmp = currState;
+      currState = nextState;
+      nextState = tmp;
+
       //update the event list
-      for (i=0; i<noe; i++){
-        if (m->IsEventEnabled(i, currState)){
-          flag = true;
-          // disabled previously or enabled previously and fired 
-          if ( enabledFlags[i] == 0){
-            enabledFlags[i] = 1; 
-            eventTimes[i] = m->GenerateEventTime(i, currState);
-            speeds[i] = m->GetEventSpeed(i, currState);
-            t = eventTimes[i]/speeds[i];
-            clocks[i] = simClock + t;
-          } 
-          else{
-            eventTimes[i] = eventTimes[i] - deltaTime*speeds[i];
-            speeds[i] = m->GetEventSpeed(i, currState);
-            t = eventTimes[i]/speeds[i];
-            clocks[i] = simClock + t;
-          }
-        } //end if
-        else{ //event i is not enabled in the current state
-          enabledFlags[i] = 0;
+      const int* changed = 0;
+      int nc = m->GetAffectedEvents(changed);
+      if (nc < 0) {
+        for (int i=0; i<noe; i++) {
+          events.update(m, i, i==firedEvent, currState, simClock);
+        }
+      } else {
+        events.update(m, firedEvent, true, currState, simClock);
+        for (int c=0; c<nc; c++) {
+          if (changed[c] == firedEvent) continue;
+          events.update(m, changed[c], false, currState, simClock);
         }
-      }//end for
-      
-      if (!flag) { //no single event is enabled
-        break;
       }
-      flag = true;    
     } //end while
+    if (code || absorbed) break;
     batchTime = firedTime - preBatchTime;
     index--;
-    
+
     if (g==1){
       for (int l=0; l<N; l++) {
         mean[l] = stats[l]/batchTime;
-        a = autoVector.at(l);
-        a->add(mean[l]);
-        //preBatchMean[l] = mean[l];
+        autoVector[l].add(mean[l]);
         stats[l] = 0.0;
       }
     }
     else{
       for (int l=0; l<N; l++) {
         curBatchMean[l] = stats[l]/batchTime;
-        a = autoVector.at(l);
-        a->add(curBatchMean[l]);
-        
+        autoVector[l].add(curBatchMean[l]);
+
         diffMean =   curBatchMean[l] - mean[l];
         sum[l]  += diffMean * diffMean * (batchTime * preBatchTime)/firedTime;
         mean[l] += (diffMean*batchTime)/firedTime;
-        
-        //sum[l]  += diffMean * diffMean * (g-1)/g;
-        //mean[l] += diffMean/g;
-        
-        //autoCovariance[l] += preBatchMean[l]*curBatchMean[l];
-        //preBatchMean[l] = curBatchMean[l];
-        
-        stats[l] = 0.0;      
+
+        stats[l] = 0.0;
       }
     }
     preBatchTime = firedTime;
   } //end for
-  
-  /* Compute autocorrelation for each measure */
-  //for (int l=0; l<N; l++) {
-  //    autoCovariance[l] = autoCovariance[l]/(batchNum-1) - (mean[l] * mean[l]);  
-  //    //sum[l] = sum[l]/firedTime;   // sample variance for time averages
-  //    sum[l] = sum[l]/batchNum; //sample variance for job averages
-  //  }
-  
+
+  if (absorbed) {
+    /* the run stays in the current state forever; this depends on
+       the path taken, so there is no confidence interval */
+    code = m->EvaluateMeasures(currState, N, msrdata, avglist.data());
+    for (int i=0; 0==code && i<N; i++) {
+      estlist[i].is_valid = false;
+      estlist[i].average = avglist[i];
+      estlist[i].variance = 0.0;
+      estlist[i].samples = index-1;  /* events fired */
+      estlist[i].confidence = percentage;
+      estlist[i].half_width = 0.0;
+      estlist[i].autocorrelation = 0.0;
+    }
+  }
+
   /* compute confidence interval for each measure */
-    for (i=0; i<N; i++) {
+  for (int i=0; 0==code && !absorbed && i<N; i++) {
     sum[i] = sum[i]/firedTime;   // sample variance for time average
-    //sum[i] /= batchNum;
     std = sqrt(sum[i]);
     error = std/sqrt(double(batchNum));
-    //error = std/sqrt(firingTime);
-    
+
     /* store data into estlist */
+    estlist[i].is_valid = true;
     estlist[i].average = mean[i];
     estlist[i].variance = sum[i];
     estlist[i].samples = samples;
     estlist[i].confidence = percentage;
     estlist[i].half_width = tNormal * error;
-    //estlist[i].autocorrelation = autoCovariance[i]/sum[i];
-    a = autoVector.at(i);
-    estlist[i].autocorrelation = a->getAutocorrelation();
-    
+    estlist[i].autocorrelation = autoVector[i].getAutocorrelation();
   }
+
   /* release memory */
-  delete [] eventTimes;
-  delete [] speeds;
-  delete [] avglist;
-  delete [] clocks;
-  delete [] enabledFlags;
-  delete [] stats;
-  delete [] curBatchMean;
-  delete [] preBatchMean;
-  delete [] autoCovariance;
-  delete [] mean;
-  delete [] sum;
-  
-  return 0;
-}
+  m->DestroyState(currState);
+  m->DestroyState(nextState);
 
-int nextEvent(double* events, int n, int* flags){
-  /* ---------------------------------------
-  * return the index of the next event type
-  * ---------------------------------------
-  */
-  
-  int e;                                      
-  int i = 0;
-  
-  while (flags[i] != 1)       /* find the index of the first 'active' */
-    i++;                        /* element in the event list            */ 
-  e = i;                        
-  while (i < n) {         /* now, check the others to find which  */
-    i++;                        /* event type is most imminent          */
-    if ((flags[i] == 1) && (events[i] < events[e]))
-      e = i;
-  }
-return (e);
+  return code;
 }
 
-
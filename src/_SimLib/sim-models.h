@@ -10,31 +10,8 @@
 #ifndef SIM_MODELS
 #define SIM_MODELS
 
-/** Struct to return a confidence interval.
-    Used to measure the average of an outcome.
-
-    The confidence interval obtained (if valid)
-    is "average +- half_width".
-    
-    For completeness, the struct also contains
-    the number of samples taken so far, and the confidence level.
-    The variance is also included, in case we want to
-    collect more samples.
-*/
-struct sim_confintl {
-  /// midpoint of the interval.
-  double average;
-  /// variance of measurements.
-  double variance;
-  /// number of samples used to obtain this estimate
-  long samples;
-  /// Level of confidence, between 0 and 1 (e.g., 0.95 for 95%).
-  float confidence;
-  /// half width of interval (absolute).
-  double half_width;
-  /// autocorrelation for sample data with lag = 1 .
-  double autocorrelation;
-};
+// Confidence intervals are returned as in Monte carlo simulation.
+#include "sim.h"
 
 /** Abstract type.
     (Must be defined in the application.)
@@ -107,6 +84,8 @@ public:
                       (assumed to be enabled in the given state).
         @param  curr  The current state (input).
         @param  next  The state reached (output).
+                      This may hold some older state,
+                      which must be overwritten.
 
         @return    0 on success, nonzero on failure.
   */
@@ -147,6 +126,24 @@ public:
   virtual double GetEventSpeed(int evno, const sim_state* state) = 0;
 
 
+  /** Which events may have changed, by the last call to FillNextState().
+      Those are the events whose enabling or speed may differ
+      between the current and the next state; the other events
+      keep their schedule without being checked.
+      The event that occurred is always checked, whether listed or not.
+      The default says that any event may have changed.
+
+        @param  list    Output: the list of events, if known.
+                        Must remain valid until the next call
+                        to FillNextState().
+
+        @return   The number of events in the list,
+                  or a negative number if unknown
+                  (then, every event is checked).
+  */
+  virtual int  GetAffectedEvents(const int* &list) { return -1; }
+
+
   /** Evaluate measures in the given state.
 
         @param  state     Current state of the model.
@@ -164,7 +161,16 @@ public:
 
 
 
-/** Compute steady-state averages for the desired measures.
+/** Compute steady-state averages for the desired measures,
+    using batch means on a single long run.
+    The run starts in the initial state and fires
+    batchNum * batchSize events.
+    Enabled events are kept in a future event list ordered by clock,
+    and after each event only the events given by
+    sim_model::GetAffectedEvents() are checked again.
+    If the run reaches a state with no enabled events,
+    then the estimates are marked invalid, with the
+    measures in that state as their averages.
 
       @param  m         The model of interest.
       @param  N         Number of measures.
@@ -173,6 +179,10 @@ public:
                         Array (dimension \a N) of confidence intervals
                         to estimate steady-state measures.
 
+      @param  batchNum    Number of batches.
+      @param  batchSize   Number of events per batch.
+      @param  percentage  Level of confidence (e.g., 0.95 for 95%)
+
       @return   0 on success, nonzero on failure.
                 The failure code will match the code given
                 by one of the sim_model virtual functions.
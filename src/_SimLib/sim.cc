@@ -7,10 +7,14 @@
 #include <stdio.h>
 #include <math.h>
 
+#include <exception>
+#include <thread>
+#include <vector>
+
 // #define DEBUG
 
 const int MAJOR_VERSION = 1;  // (significant) backend algorithm changes
-const int MINOR_VERSION = 3;  // interface changes
+const int MINOR_VERSION = 4;  // interface changes
 
 // Global constants
 
@@ -62,6 +66,127 @@ void MCSim(sim_experiment* expt, sim_confintl* estlist, int n,
 }
 
 
+/*
+    MCSim() for one thread of a team.
+    Exceptions cannot leave a thread, so we save the first one
+    and the team rethrows it after every thread has finished.
+*/
+void MCShare(sim_experiment* expt, sim_confintl* estlist, int n, 
+     sim_outcome* results, long iters, std::exception_ptr* failure)
+{
+  try {
+    MCSim(expt, estlist, n, results, iters);
+  }
+  catch (...) {
+    *failure = std::current_exception();
+  }
+}
+
+
+/*
+    Merge the (unfinalized) estimates from one thread into another.
+    Variances are still sums of squared differences here,
+    so we can use the usual pairwise update.
+*/
+void MergeEstimates(sim_confintl* estlist, const sim_confintl* more, int n)
+{
+  for (int m=n-1; m>=0; m--) if (estlist[m].is_valid) {
+    if (!more[m].is_valid) {
+      estlist[m].is_valid = false;
+      continue;
+    }
+    if (0==more[m].samples) continue;
+    long total = estlist[m].samples + more[m].samples;
+    double d = more[m].average - estlist[m].average;
+    estlist[m].variance += more[m].variance 
+      + d * d * (double(estlist[m].samples) * more[m].samples / total);
+    estlist[m].average += d * more[m].samples / total;
+    estlist[m].samples = total;
+  } // for valid measures
+}
+
+
+/*
+    Experiments to run, one per thread, with their scratch space.
+    Thread t runs iterations iters*t/nt through iters*(t+1)/nt - 1
+    of each batch, with its own estimates, which are then merged
+    in thread order.  So results do not depend on thread timing.
+*/
+class MCTeam {
+  int n;
+  std::vector <sim_experiment*> expts;
+  std::vector <sim_outcome*> results;
+  std::vector <sim_confintl*> ests;
+public:
+  MCTeam(sim_experiment* expt, int n, int threads);
+  ~MCTeam();
+
+  void Run(sim_confintl* estlist, long iters);
+};
+
+MCTeam::MCTeam(sim_experiment* expt, int _n, int threads)
+{
+  n = _n;
+  expts.push_back(expt);
+  for (int t=1; t<threads; t++) {
+    sim_experiment* copy = expt->Clone(t);
+    if (0==copy) break;
+    expts.push_back(copy);
+  }
+  for (unsigned t=0; t<expts.size(); t++) {
+    results.push_back( (sim_outcome*) malloc(n*sizeof(sim_outcome)) );
+    ests.push_back( (sim_confintl*) malloc(n*sizeof(sim_confintl)) );
+  }
+#ifdef DEBUG
+  printf("Running MC sim on %d threads\n", int(expts.size()));
+#endif
+}
+
+MCTeam::~MCTeam()
+{
+  for (unsigned t=0; t<expts.size(); t++) {
+    if (t) delete expts[t];
+    free(results[t]);
+    free(ests[t]);
+  }
+}
+
+void MCTeam::Run(sim_confintl* estlist, long iters)
+{
+  const int nt = expts.size();
+  if (1==nt) {
+    MCSim(expts[0], estlist, n, results[0], iters);
+    return;
+  }
+
+  std::vector <std::thread> workers;
+  std::vector <std::exception_ptr> failures(nt);
+  for (int t=nt-1; t>=0; t--) {
+    for (int m=n-1; m>=0; m--) {
+      ests[t][m].is_valid = estlist[m].is_valid;
+      ests[t][m].average = 0.0;
+      ests[t][m].variance = 0.0;
+      ests[t][m].samples = 0;
+    }
+    long share = (iters * (t+1)) / nt - (iters * t) / nt;
+    if (t) {
+      workers.push_back(std::thread(MCShare, expts[t], ests[t], n, 
+        results[t], share, &failures[t]));
+    } else {
+      MCShare(expts[0], ests[0], n, results[0], share, &failures[0]);
+    }
+  }
+  for (unsigned i=0; i<workers.size(); i++) workers[i].join();
+  for (int t=0; t<nt; t++) {
+    if (failures[t]) std::rethrow_exception(failures[t]);
+  }
+
+  for (int t=0; t<nt; t++) {
+    MergeEstimates(estlist, ests[t], n);
+  }
+}
+
+
 inline int DecideIterations(double estimated_iters)
 {
   if (estimated_iters < 2) return 1;
@@ -89,10 +214,10 @@ const char* SIM_LibraryVersion()
 
 
 void SIM_MonteCarlo_S(sim_experiment* expt, sim_confintl* estlist, int n,
-        float conf, double prec)
+        float conf, double prec, int threads)
 {
-  // allocate experiment outcomes
-  sim_outcome* results = (sim_outcome*) malloc(n*sizeof(sim_outcome));
+  // allocate experiments and outcomes, for each thread
+  MCTeam team(expt, n, threads);
 
   // get critical value
   double alpha = 1.0 - double(conf);
@@ -111,6 +236,7 @@ void SIM_MonteCarlo_S(sim_experiment* expt, sim_confintl* estlist, int n,
     estlist[m].average = 0.0;
     estlist[m].variance = 0.0;
     estlist[m].samples = 0;
+    estlist[m].autocorrelation = 0.0;
     estlist[m].confidence = conf;
   }
 
@@ -118,7 +244,7 @@ void SIM_MonteCarlo_S(sim_experiment* expt, sim_confintl* estlist, int n,
 
   for ( ; ; ) {
 
-    MCSim(expt, estlist, n, results, batch_size);
+    team.Run(estlist, batch_size);
  
     // check if desired precision is reached
     batch_size = 0;
@@ -145,18 +271,15 @@ void SIM_MonteCarlo_S(sim_experiment* expt, sim_confintl* estlist, int n,
     // update stats
     estlist[m].variance /= estlist[m].samples;
   }
-
-  // cleanup
-  free(results);
 }
 
 
 
 void SIM_MonteCarlo_W(sim_experiment* expt, sim_confintl* estlist, int n,
-        long iters, float conf)
+        long iters, float conf, int threads)
 {
-  // allocate experiment outcomes
-  sim_outcome* results = (sim_outcome*) malloc(n*sizeof(sim_outcome));
+  // allocate experiments and outcomes, for each thread
+  MCTeam team(expt, n, threads);
 
   // get critical value
   double alpha = 1.0 - double(conf);
@@ -175,27 +298,25 @@ void SIM_MonteCarlo_W(sim_experiment* expt, sim_confintl* estlist, int n,
     estlist[m].average = 0.0;
     estlist[m].variance = 0.0;
     estlist[m].samples = 0;
+    estlist[m].autocorrelation = 0.0;
     estlist[m].confidence = conf;
   }
 
-  MCSim(expt, estlist, n, results, iters);
+  team.Run(estlist, iters);
 
   // finalize stats
   for (m=n-1; m>=0; m--) if (estlist[m].is_valid) {
     estlist[m].variance /= estlist[m].samples;
     estlist[m].half_width = tstar * sqrt(estlist[m].variance/(estlist[m].samples-1));
   } // for valid measures
-
-  // cleanup
-  free(results);
 }
 
 
 void SIM_MonteCarlo_C(sim_experiment* expt, sim_confintl* estlist, int n,
-        long iters, double prec)
+        long iters, double prec, int threads)
 {
-  // allocate experiment outcomes
-  sim_outcome* results = (sim_outcome*) malloc(n*sizeof(sim_outcome));
+  // allocate experiments and outcomes, for each thread
+  MCTeam team(expt, n, threads);
 
   // initialize estimates
   int m;
@@ -204,9 +325,10 @@ void SIM_MonteCarlo_C(sim_experiment* expt, sim_confintl* estlist, int n,
     estlist[m].average = 0.0;
     estlist[m].variance = 0.0;
     estlist[m].samples = 0;
+    estlist[m].autocorrelation = 0.0;
   }
 
-  MCSim(expt, estlist, n, results, iters);
+  team.Run(estlist, iters);
 
   // finalize stats
   for (m=n-1; m>=0; m--) if (estlist[m].is_valid) {
@@ -226,9 +348,6 @@ void SIM_MonteCarlo_C(sim_experiment* expt, sim_confintl* estlist, int n,
 #endif
 
   } // for valid measures
-
-  // cleanup
-  free(results);
 }
 
 
@@ -25,6 +25,15 @@
       "_C" functions determine the level of confidence achieved for
       a fixed sample size and half-width "precision".
 
+      Monte-carlo functions may run the experiments on several threads,
+      if the experiment can be cloned (see sim_experiment::Clone()).
+      Each thread runs a fixed share of every batch of experiments,
+      and the per-thread estimates are merged in thread order,
+      so the results depend only on the experiments (and their
+      random number streams) and on the number of threads.
+      If an experiment throws, the other threads finish their share
+      and the exception is rethrown by the monte-carlo function.
+
   
 
     TO DO:
@@ -80,6 +89,8 @@ struct sim_confintl {
   float confidence;
   /// half width of interval (absolute).
   double half_width;
+  /// lag-1 autocorrelation of the batch means (batch means only).
+  double autocorrelation;
 };
 
 
@@ -105,6 +116,23 @@ public:
       is independent of the others.
   */
   virtual void PerformExperiment(sim_outcome* olist, int n) = 0;
+
+  /** Build a copy of this experiment, to run on another thread.
+      The copy may run at the same time as this experiment
+      and the other copies, so it must not share any state
+      with them; in particular, it needs its own random number
+      stream, independent of the others (e.g., obtained by
+      jumping ahead), chosen the same way for every run
+      if results should be reproducible.
+      The copy is destroyed by the library.
+      The default returns 0, meaning the experiment must run
+      on a single thread.
+
+        @param  t   Which thread the copy is for,
+                    from 1 to number of threads - 1
+                    (thread 0 uses the original experiment).
+  */
+  virtual sim_experiment* Clone(int t) const { return 0; }
 };
 
 
@@ -127,9 +155,12 @@ public:
 
       @param  prec      Desired half-width precision relative to
                         the point estimate.
+
+      @param  threads   Number of threads to use.  If the experiment
+                        cannot be cloned, fewer threads are used.
 */
 void SIM_MonteCarlo_S(sim_experiment* expt, sim_confintl* estlist, int n,
-        float conf, double prec);
+        float conf, double prec, int threads = 1);
 
 /** Monte carlo simulation with varying half-width.
 
@@ -146,9 +177,12 @@ void SIM_MonteCarlo_S(sim_experiment* expt, sim_confintl* estlist, int n,
       @param  iters     Number of iterations.
 
       @param  conf      Level of confidence (e.g., 0.95 for 95%)
+
+      @param  threads   Number of threads to use.  If the experiment
+                        cannot be cloned, fewer threads are used.
 */
 void SIM_MonteCarlo_W(sim_experiment* expt, sim_confintl* estlist, int n,
-        long iters, float conf);
+        long iters, float conf, int threads = 1);
 
 /** Monte carlo simulation with varying confidence.
 
@@ -166,9 +200,12 @@ void SIM_MonteCarlo_W(sim_experiment* expt, sim_confintl* estlist, int n,
 
       @param  prec      Desired half-width precision relative to
                         the point estimate.
+
+      @param  threads   Number of threads to use.  If the experiment
+                        cannot be cloned, fewer threads are used.
 */
 void SIM_MonteCarlo_C(sim_experiment* expt, sim_confintl* estlist, int n,
-        long iters, double prec);
+        long iters, double prec, int threads = 1);
 
 
 
@@ -145,7 +145,7 @@ const StateLib::state_coll* bst_db::GetStateCollection() const
 StateLib::state_coll* bst_db::TakeStateCollection()
 {
   StateLib::state_coll* ans = states;
-  states = new main_coll(0==index2handle, ans->StateSizesAreStored());
+  states = states->NewCollection();
   root = -1;
   num_states = 0;
   return ans;
@@ -209,16 +209,7 @@ long main_coll::AddState(const int* s, int np)
   long answer;
   if (firsthandle<0) firsthandle = lasthandle;
   if (map) {
-    if (numstates+1>=mapsize) {
-      // Enlarge map array
-      if (0==mapsize)                     mapsize = MAX_STATE_ADD;
-      else if (mapsize > MAX_STATE_ADD)   mapsize += MAX_STATE_ADD;
-      else                                mapsize *= 2;
-      map = (long*) realloc(map, mapsize * sizeof(long));
-      if (0==map) {
-        throw StateLib::error(StateLib::error::NoMemory);
-      }
-    }
+    EnlargeMap();
     answer = numstates;
     map[answer] = lasthandle;
   } else {
@@ -348,6 +339,54 @@ long main_coll::AddState(const int* s, int np)
 }
 
 
+long main_coll::AddRawState(const unsigned char* raw, long bytes)
+{
+  long answer;
+  if (firsthandle<0) firsthandle = lasthandle;
+  if (map) {
+    EnlargeMap();
+    answer = numstates;
+    map[answer] = lasthandle;
+  } else {
+    answer = lasthandle;
+  }
+  DCASSERT(bytes>0);
+  EnlargeMem(lasthandle + bytes);
+  CopyIn(lasthandle, raw, bytes);
+
+  // update encoding counts; encoding is in the first two bits
+  switch (raw[0] >> 6) {
+    case ENCODING_FULL:
+      full_count++;
+      break;
+
+    case ENCODING_SPARSE:
+      sparse_count++;
+      break;
+
+    default:
+      throw StateLib::error(StateLib::error::Internal);
+  }
+
+  lasthandle += bytes;
+  numstates++;
+  if (map) map[numstates] = lasthandle;
+  return answer;
+}
+
+void main_coll::EnlargeMap()
+{
+  if (numstates+1<mapsize) return;
+  if (0==mapsize)                     mapsize = MAX_STATE_ADD;
+  else if (mapsize > MAX_STATE_ADD)   mapsize += MAX_STATE_ADD;
+  else                                mapsize *= 2;
+  map = (long*) realloc(map, mapsize * sizeof(long));
+  if (0==map) {
+    throw StateLib::error(StateLib::error::NoMemory);
+  }
+}
+
+
 bool main_coll::PopLast(long hndl)
 {
   if (hndl < 0) return false;
@@ -900,6 +939,11 @@ long main_coll::ReportEncodingCount(int m) const
   return 0;  
 }
 
+main_coll* main_coll::NewCollection() const
+{
+  return new main_coll(map, store_sizes);
+}
+
 long main_coll::ReportMemTotal() const 
 {
   long answer = 0;
@@ -2,6 +2,7 @@
 #ifndef COLL_H
 #define COLL_H
 
+#include <string.h>
 #include "statelib.h"
 #include "../include/defines.h"
 
@@ -68,6 +69,7 @@ public:
 */
 
 class coll_base : public StateLib::state_coll {
+protected:
   /// Memory space for actual states
   unsigned char *mem;
   /// Current dimension of the \a mem array.
@@ -78,12 +80,14 @@ public:
 
   /** Enlarge the memory array, if necessary. 
       Throws an error if malloc fails.
+      Derived classes may override this to obtain memory elsewhere;
+      they are then responsible for releasing it.
 
         @param  newsize   Desired size.  Memory will be expanded
                           if necessary but not shrunk.
 
   */
-  void EnlargeMem(long newsize);
+  virtual void EnlargeMem(long newsize);
 
   /** The workhorse of the whole thing.
       So it better be efficient!
@@ -115,6 +119,14 @@ public:
   inline const unsigned char* GetPtr(long h) const { return mem + h; }
   inline const unsigned char GetByte(long h) const { return mem[h]; }
 
+  /** Copy a chunk of raw memory, starting at byte \a h.
+      The memory must already be large enough (see EnlargeMem()).
+  */
+  inline void CopyIn(long h, const unsigned char* raw, long bytes) {
+    CHECK_RANGE(0, h+bytes, memsize+1);
+    memcpy(mem + h, raw, bytes);
+  }
+
   virtual long ReportMemTotal() const {
     return memsize;
   }
@@ -293,6 +305,9 @@ protected:
   // Helper for NextHandle, GetRawState
   long NextRawHandle(long rawh) const;
 
+  // Helper for AddState, AddRawState
+  void EnlargeMap();
+
 public:
   main_coll(bool use_indices, bool use_sizes);
   virtual ~main_coll();
@@ -302,6 +317,17 @@ public:
   virtual void Clear();
   virtual long AddState(const int* state, int size);
   virtual bool PopLast(long hndl);
+
+  /** Add an already encoded state to the collection.
+        @param  raw     Encoding of the state, as obtained by
+                        GetRawState() on a collection with the same
+                        setting for storing state sizes.
+        @param  bytes   Number of bytes in the encoding.
+
+        @return   A handle to the state, as for AddState().
+  */
+  long AddRawState(const unsigned char* raw, long bytes);
+
   virtual long GetStateKnown(long hndl, int* state, int size) const;
   virtual int GetStateUnknown(long hndl, int* state, int size) const;
   virtual const unsigned char* GetRawState(long hndl, long &bytes) const;
@@ -316,6 +342,11 @@ public:
   virtual long ReportEncodingCount(int m) const;
   virtual long ReportMemTotal() const;
 
+  /** Create a new, empty collection of the same kind,
+      with the same settings.
+  */
+  virtual main_coll* NewCollection() const;
+
   inline void DumpState(FILE* s, long h) const {
     if (map) DumpMemory(s, map[h], map[h+1]);
     else {
@@ -0,0 +1,348 @@
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <new>
+#include "conc_coll.h"
+
+// ******************************************************************
+// *                         scratch space                          *
+// ******************************************************************
+
+// Per-thread collections used to encode states.
+inline main_coll& Encoder(bool store_sizes)
+{
+  static thread_local main_coll with_sizes(true, true);
+  static thread_local main_coll without_sizes(true, false);
+  return store_sizes ? with_sizes : without_sizes;
+}
+
+// Per-thread collections used to decode states.
+inline main_coll& Decoder(bool store_sizes)
+{
+  static thread_local main_coll with_sizes(true, true);
+  static thread_local main_coll without_sizes(true, false);
+  return store_sizes ? with_sizes : without_sizes;
+}
+
+// ******************************************************************
+// *                      conc_coll  methods                        *
+// ******************************************************************
+
+conc_coll::conc_coll(bool use_sizes) : state_coll()
+{
+  store_sizes = use_sizes;
+  for (int k=0; k<MAX_CHUNKS; k++) {
+    arena[k] = 0;
+    map[k] = 0;
+  }
+  arena_top = 0;
+  next_index = 0;
+  full_count = 0;
+  sparse_count = 0;
+}
+
+conc_coll::~conc_coll()
+{
+  for (int k=0; k<MAX_CHUNKS; k++) {
+    free(arena[k]);
+    delete[] map[k].load();
+  }
+}
+
+const unsigned char* conc_coll::Encode(const int* s, int np,
+  long &bytes, unsigned long &hash) const
+{
+  main_coll &e = Encoder(store_sizes);
+  e.Clear();
+  e.AddState(s, np);
+  hash = e.Hash(0, 8*sizeof(unsigned long)-1);
+  return e.GetRawState(0, bytes);
+}
+
+long conc_coll::Store(const unsigned char* raw, long bytes, unsigned long hash)
+{
+  // records are aligned on 8 bytes
+  long need = sizeof(record) + bytes;
+  need = 8 * ((need+7) / 8);
+  for (;;) {
+    long rec = arena_top.fetch_add(need);
+    long start;
+    int k = whichChunk(rec, ARENA_BITS, start);
+    if (k >= MAX_CHUNKS) throw StateLib::error(StateLib::error::NoMemory);
+    long stop = start + (1L << (ARENA_BITS+k));
+    // Records may not span chunks; if ours would, try again
+    // (the end of this chunk is wasted).
+    if (rec + need > stop) continue;
+
+    unsigned char* chunk = arenaChunk(k);
+    record* r = new (chunk + (rec-start)) record;
+    r->index.store(-1, std::memory_order_relaxed);
+    r->hash = hash;
+    r->bytes = bytes;
+    memcpy((unsigned char*) (r+1), raw, bytes);
+    return rec;
+  }
+}
+
+long conc_coll::Publish(long rec)
+{
+  const record* r = getRecord(rec);
+  for (;;) {
+    // Read the next index first: if it has moved past our index,
+    // then our index is visible below.
+    long i = next_index.load(std::memory_order_acquire);
+    long index = r->index.load(std::memory_order_acquire);
+    if (index >= 0) {
+      // whoever set it might not have moved the next index yet
+      finishPublish(rec, index);
+      return index;
+    }
+    long start;
+    int k = whichChunk(i, INDEX_BITS, start);
+    if (k >= MAX_CHUNKS) throw StateLib::error(StateLib::error::NoMemory);
+    std::atomic <long> &entry = mapChunk(k)[i-start];
+    long owner = 0;
+    if (entry.compare_exchange_strong(owner, rec+1)) owner = rec+1;
+    // Index i is claimed, by us or by someone else; finish it.
+    finishPublish(owner-1, i);
+  }
+}
+
+void conc_coll::finishPublish(long rec, long i)
+{
+  record* r = (record*) getRecord(rec);
+  long none = -1;
+  if (r->index.compare_exchange_strong(none, i)) {
+    switch (r->encoding()[0] >> 6) {
+      case 0:   full_count++;     break;
+      case 1:   sparse_count++;   break;
+    }
+  }
+  DCASSERT(r->index.load() == i);
+  long expected = i;
+  if (!next_index.compare_exchange_strong(expected, i+1)) return;
+  // numstates is only read when no insertions are in progress,
+  // but advances may reach it out of order.
+  long ns = __atomic_load_n(&numstates, __ATOMIC_RELAXED);
+  while (ns <= i) {
+    if (__atomic_compare_exchange_n(&numstates, &ns, i+1,
+          false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) break;
+  }
+}
+
+void conc_coll::Tighten()
+{
+  long start;
+  int ka = arena_top ? whichChunk(arena_top-1, ARENA_BITS, start) : -1;
+  int km = next_index ? whichChunk(next_index-1, INDEX_BITS, start) : -1;
+  for (int k=0; k<MAX_CHUNKS; k++) {
+    if (k > ka) {
+      free(arena[k]);
+      arena[k] = 0;
+    }
+    if (k > km) {
+      delete[] map[k].load();
+      map[k] = 0;
+    }
+  }
+}
+
+bool conc_coll::StateSizesAreStored() const
+{
+  return store_sizes;
+}
+
+bool conc_coll::StateHandlesAreIndexes() const
+{
+  return true;
+}
+
+void conc_coll::Clear()
+{
+  // keep the chunks, but clear the index mapping
+  for (int k=0; k<MAX_CHUNKS; k++) {
+    std::atomic <long>* chunk = map[k].load();
+    if (0==chunk) continue;
+    for (long i=(1L << (INDEX_BITS+k))-1; i>=0; i--) {
+      chunk[i].store(0, std::memory_order_relaxed);
+    }
+  }
+  arena_top = 0;
+  next_index = 0;
+  __atomic_store_n(&numstates, 0, __ATOMIC_RELEASE);
+  full_count = 0;
+  sparse_count = 0;
+}
+
+long conc_coll::AddState(const int* s, int np)
+{
+  long bytes;
+  unsigned long hash;
+  const unsigned char* raw = Encode(s, np, bytes, hash);
+  return Publish(Store(raw, bytes, hash));
+}
+
+bool conc_coll::PopLast(long hndl)
+{
+  if (hndl < 0) return false;
+  long ns = committed();
+  if (hndl+1 != ns) return false;
+  // the record space is not reclaimed
+  const record* r = getRecord(getRecordOf(hndl));
+  switch (r->encoding()[0] >> 6) {
+    case 0:   full_count--;     break;
+    case 1:   sparse_count--;   break;
+  }
+  long start;
+  int k = whichChunk(hndl, INDEX_BITS, start);
+  map[k].load()[hndl-start].store(0, std::memory_order_relaxed);
+  next_index = ns-1;
+  __atomic_store_n(&numstates, ns-1, __ATOMIC_RELEASE);
+  return true;
+}
+
+long conc_coll::GetStateKnown(long hndl, int* s, int size) const
+{
+  long ans = decode(hndl).GetStateKnown(0, s, size);
+  if (ans < 0) return ans;
+  hndl++;
+  if (hndl == committed()) return 0;
+  return hndl;
+}
+
+int conc_coll::GetStateUnknown(long hndl, int* s, int size) const
+{
+  if (!store_sizes) return -1;
+  return decode(hndl).GetStateUnknown(0, s, size);
+}
+
+const unsigned char* conc_coll::GetRawState(long hndl, long &bytes) const
+{
+  if ((hndl<0) || (hndl >= committed()))
+    return 0;
+  const record* r = getRecord(getRecordOf(hndl));
+  bytes = r->bytes;
+  return r->encoding();
+}
+
+long conc_coll::FirstHandle() const
+{
+  return 0;
+}
+
+long conc_coll::NextHandle(long hndl) const
+{
+  if (hndl >= committed()) return -1;
+  return hndl+1;
+}
+
+int conc_coll::CompareHH(long h1, long h2) const
+{
+  long ns = committed();
+  if ((h1>=ns) || (h2>=ns)) return 0;
+  if ((h1<0) || (h2<0)) return 0;
+
+  // same as main_coll: by length first, then the encodings.
+  const record* r1 = getRecord(getRecordOf(h1));
+  const record* r2 = getRecord(getRecordOf(h2));
+  int foo = r1->bytes - r2->bytes;
+  if (foo!=0) return foo;
+  return memcmp(r1->encoding(), r2->encoding(), r1->bytes);
+}
+
+int conc_coll::CompareHF(long hndl, int size, const int* state) const
+{
+  return decode(hndl).CompareHF(0, size, state);
+}
+
+unsigned long conc_coll::Hash(long hndl, int bits) const
+{
+  if (0==bits) return 0;
+  if ((hndl<0) || (hndl >= committed()))
+    return 0;
+  unsigned long h = getRecord(getRecordOf(hndl))->hash;
+  // stored hash has the same low-order bits as main_coll::Hash()
+  if (bits >= int(8*sizeof(unsigned long)-1)) return h;
+  unsigned long mask = 1;
+  mask <<= bits;
+  mask--;
+  return h & mask;
+}
+
+long* conc_coll::RemoveIndexHandles()
+{
+  // Handles are always indexes, so the "handle" of index i is i.
+  long ns = committed();
+  long* answer = (long*) malloc(ns * sizeof(long));
+  if (0==answer) throw StateLib::error(StateLib::error::NoMemory);
+  for (long i=0; i<ns; i++) answer[i] = i;
+  return answer;
+}
+
+int conc_coll::NumEncodingMethods() const
+{
+  return Encoder(store_sizes).NumEncodingMethods();
+}
+
+const char* conc_coll::EncodingMethod(int m) const
+{
+  return Encoder(store_sizes).EncodingMethod(m);
+}
+
+long conc_coll::ReportEncodingCount(int m) const
+{
+  switch (m) {
+    case 0:   return full_count;
+    case 1:   return sparse_count;
+  };
+  return 0;
+}
+
+long conc_coll::ReportMemTotal() const
+{
+  long answer = 0;
+  for (int k=0; k<MAX_CHUNKS; k++) {
+    if (arena[k]) answer += 1L << (ARENA_BITS+k);
+    if (map[k])   answer += sizeof(long) << (INDEX_BITS+k);
+  }
+  return answer;
+}
+
+unsigned char* conc_coll::arenaChunk(int k)
+{
+  unsigned char* chunk = arena[k].load(std::memory_order_acquire);
+  if (chunk) return chunk;
+  chunk = (unsigned char*) malloc(1L << (ARENA_BITS+k));
+  if (0==chunk) throw StateLib::error(StateLib::error::NoMemory);
+  unsigned char* old = 0;
+  if (arena[k].compare_exchange_strong(old, chunk)) return chunk;
+  // someone beat us to it
+  free(chunk);
+  return old;
+}
+
+std::atomic <long>* conc_coll::mapChunk(int k)
+{
+  std::atomic <long>* chunk = map[k].load(std::memory_order_acquire);
+  if (chunk) return chunk;
+  chunk = new (std::nothrow) std::atomic <long> [1L << (INDEX_BITS+k)];
+  if (0==chunk) throw StateLib::error(StateLib::error::NoMemory);
+  for (long i=(1L << (INDEX_BITS+k))-1; i>=0; i--) {
+    chunk[i].store(0, std::memory_order_relaxed);
+  }
+  std::atomic <long>* old = 0;
+  if (map[k].compare_exchange_strong(old, chunk)) return chunk;
+  // someone beat us to it
+  delete[] chunk;
+  return old;
+}
+
+const main_coll& conc_coll::decode(long hndl) const
+{
+  const record* r = getRecord(getRecordOf(hndl));
+  main_coll &d = Decoder(store_sizes);
+  d.Clear();
+  d.AddRawState(r->encoding(), r->bytes);
+  return d;
+}
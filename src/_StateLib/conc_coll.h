@@ -0,0 +1,220 @@
+
+#ifndef CONC_COLL_H
+#define CONC_COLL_H
+
+#include <atomic>
+#include "coll.h"
+
+// ******************************************************************
+// *                                                                *
+// *                       conc_coll  class                         *
+// *                                                                *
+// ******************************************************************
+
+/** Thread-safe version of main_coll.
+
+    States are encoded exactly as in main_coll (using a per-thread
+    main_coll as scratch space), and the encodings are copied into
+    "records" in an append-only arena.  The arena is a sequence of
+    chunks of doubling size, so memory is never moved and readers
+    never need to wait for a writer.  Space for records is obtained
+    with an atomic increment.
+
+    Storing a state is done in two steps, so that a state database
+    can check for duplicates before the state gets an index:
+      (1) Store() copies the encoding into a new record, and
+      (2) Publish() gives the record the next available index.
+    A record that is never published wastes its space;
+    this happens only when two threads race to insert the same state.
+
+    Publishing is lock-free.  The next index i is claimed for a record
+    by writing the record into (empty) entry i of the index to record
+    mapping, with compare-and-swap.  Whoever sees entry i filled,
+    including a thread publishing a different record, finishes the
+    job: it sets the index of the record written there, and advances
+    the next index past i.  So a thread that stops between claiming
+    an index and finishing never holds up the others, and indexes
+    below the next index always have their mapping in place.
+    Any thread may publish (or finish publishing) any stored record;
+    every call returns the same index.
+
+    Handles are always indexes.
+
+    Methods AddState(), Store(), Publish(), and the const methods
+    may be called simultaneously from any number of threads.
+    Methods Clear(), PopLast(), RemoveIndexHandles(), and Tighten()
+    may not.
+*/
+class conc_coll : public StateLib::state_coll {
+  /// Record header; the state encoding follows it.
+  struct record {
+    /// Index of the record, or -1 if not (yet) published.
+    std::atomic<long> index;
+    /// Hash of the encoding.
+    unsigned long hash;
+    /// Number of bytes in the encoding.
+    long bytes;
+
+    inline const unsigned char* encoding() const {
+      return (const unsigned char*) (this+1);
+    }
+  };
+
+  /// Size of the first arena chunk is 2^ARENA_BITS bytes.
+  static const int ARENA_BITS = 16;
+  /// Size of the first index chunk is 2^INDEX_BITS handles.
+  static const int INDEX_BITS = 10;
+  /// Maximum number of chunks.
+  static const int MAX_CHUNKS = 40;
+
+  /// Should we store the sizes?
+  bool store_sizes;
+
+  /// Arena chunks; chunk k has 2^(ARENA_BITS+k) bytes.
+  std::atomic <unsigned char*> arena[MAX_CHUNKS];
+  /// Next free byte in the arena.
+  std::atomic <long> arena_top;
+
+  /// Index to record mapping, as 1 + record handle, or 0 if unclaimed;
+  /// chunk k has 2^(INDEX_BITS+k) entries.
+  std::atomic <std::atomic <long>*> map[MAX_CHUNKS];
+  /// Next index to hand out; all smaller indexes are complete.
+  std::atomic <long> next_index;
+
+  /// Stats: counts the number of full encodings
+  std::atomic <long> full_count;
+  /// Stats: counts the number of sparse encodings
+  std::atomic <long> sparse_count;
+
+public:
+  conc_coll(bool use_sizes);
+  virtual ~conc_coll();
+
+  /** Encode a state.
+      Thread safe: the encoding is built in per-thread scratch space.
+
+        @param  state   The state to encode.
+        @param  size    Size of the state.
+        @param  bytes   (Output) number of bytes in the encoding.
+        @param  hash    (Output) hash of the encoding.
+
+        @return   The encoding.  It remains valid until the next
+                  call to Encode() from the same thread.
+  */
+  const unsigned char* Encode(const int* state, int size,
+    long &bytes, unsigned long &hash) const;
+
+  /** Copy an encoding into a new, unpublished record.
+
+        @return   Handle of the record (not an index!).
+  */
+  long Store(const unsigned char* raw, long bytes, unsigned long hash);
+
+  /** Assign the next index to a record, unless it has one.
+      Lock-free; may be called for the same record by several
+      threads, e.g., to get the index of a record found in
+      a search while its inserting thread is still publishing it.
+
+        @param  rec   Record handle, from Store().
+
+        @return   The index of the record.
+  */
+  long Publish(long rec);
+
+  /// Number of indexes that may be retrieved.
+  inline long Committed() const {
+    return next_index.load(std::memory_order_acquire);
+  }
+
+  /// Does a record hold the given encoding?
+  inline bool Matches(long rec, const unsigned char* raw, long bytes,
+    unsigned long hash) const
+  {
+    const record* r = getRecord(rec);
+    if (r->hash != hash) return false;
+    if (r->bytes != bytes) return false;
+    return 0==memcmp(r->encoding(), raw, bytes);
+  }
+
+  /// Hash of a record.
+  inline unsigned long RecordHash(long rec) const {
+    return getRecord(rec)->hash;
+  }
+
+  /** Free arena and index chunks that are not in use.
+      These remain after Clear(), so that a collection
+      can be refilled without allocating.
+  */
+  void Tighten();
+
+  // required interface
+
+  virtual bool StateSizesAreStored() const;
+  virtual bool StateHandlesAreIndexes() const;
+  virtual void Clear();
+  virtual long AddState(const int* state, int size);
+  virtual bool PopLast(long hndl);
+  virtual long GetStateKnown(long hndl, int* state, int size) const;
+  virtual int GetStateUnknown(long hndl, int* state, int size) const;
+  virtual const unsigned char* GetRawState(long hndl, long &bytes) const;
+  virtual long FirstHandle() const;
+  virtual long NextHandle(long hndl) const;
+  virtual int CompareHH(long h1, long h2) const;
+  virtual int CompareHF(long hndl, int size, const int* state) const;
+  virtual unsigned long Hash(long hndl, int bits) const;
+  virtual long* RemoveIndexHandles();
+  virtual int NumEncodingMethods() const;
+  virtual const char* EncodingMethod(int m) const;
+  virtual long ReportEncodingCount(int m) const;
+  virtual long ReportMemTotal() const;
+
+protected:
+  /** Determine the chunk containing a position.
+        @param  pos     Position (byte in the arena, or index).
+        @param  bits    Size of the first chunk is 2^bits.
+        @param  start   (Output) first position in the chunk.
+        @return   The chunk number.
+  */
+  static inline int whichChunk(long pos, int bits, long &start) {
+    unsigned long q = (pos >> bits) + 1;
+    int k = 0;
+    while (q >>= 1) k++;
+    start = ((1L << k) - 1) << bits;
+    return k;
+  }
+
+  inline const record* getRecord(long rec) const {
+    long start;
+    int k = whichChunk(rec, ARENA_BITS, start);
+    return (const record*) (arena[k].load(std::memory_order_acquire) + (rec-start));
+  }
+
+  /// Number of committed indexes.
+  inline long committed() const {
+    return Committed();
+  }
+
+  inline long getRecordOf(long hndl) const {
+    if ((hndl<0) || (hndl >= committed()))
+      throw StateLib::error(StateLib::error::BadHandle);
+    long start;
+    int k = whichChunk(hndl, INDEX_BITS, start);
+    return map[k].load(std::memory_order_acquire)[hndl-start].load(
+      std::memory_order_acquire) - 1;
+  }
+
+  /** Finish publishing: record rec has claimed index i.
+      Sets the index of the record, and moves the next index past i.
+  */
+  void finishPublish(long rec, long i);
+
+  // Get an arena chunk, allocating it if necessary.
+  unsigned char* arenaChunk(int k);
+  // Get an index chunk, allocating (and clearing) it if necessary.
+  std::atomic <long>* mapChunk(int k);
+
+  // Scratch space for decoding
+  const main_coll& decode(long hndl) const;
+};
+
+#endif
@@ -0,0 +1,315 @@
+
+#include <stdlib.h>
+#include "conc_hash_db.h"
+
+// ******************************************************************
+// *                                                                *
+// *                 conc_hash_db::table  methods                   *
+// *                                                                *
+// ******************************************************************
+
+conc_hash_db::table::table(int b, table* old)
+{
+  bits = b;
+  slot = new std::atomic <long> [size()];
+  for (long i=size()-1; i>=0; i--) {
+    slot[i].store(0, std::memory_order_relaxed);
+  }
+  done = new std::atomic <bool> [numBlocks()];
+  for (long i=numBlocks()-1; i>=0; i--) {
+    done[i].store(false, std::memory_order_relaxed);
+  }
+  claimed = 0;
+  moved = 0;
+  next = 0;
+  older = old;
+}
+
+conc_hash_db::table::~table()
+{
+  delete[] slot;
+  delete[] done;
+  delete older;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                     conc_hash_db  methods                      *
+// *                                                                *
+// ******************************************************************
+
+conc_hash_db::conc_hash_db(bool storesize) : state_db()
+{
+  states = new conc_coll(storesize);
+  current = new table(MIN_BITS, 0);
+}
+
+conc_hash_db::~conc_hash_db()
+{
+  delete current.load();
+  delete states;
+}
+
+void conc_hash_db::SetMaximumStackSize(long max_stack)
+{
+  // no stack required for hashing
+}
+
+long conc_hash_db::GetMaximumStackSize() const
+{
+  return 0;
+}
+
+void conc_hash_db::Clear()
+{
+  if (is_static) return;
+  reset();
+  num_states = 0;
+  states->Clear();
+}
+
+void conc_hash_db::ConvertToStatic(bool tighten)
+{
+  if (is_static) return;
+  is_static = true;
+  if (!tighten) return;
+  dropOlderTables();
+  states->Tighten();
+}
+
+void conc_hash_db::ConvertToDynamic(bool)
+{
+  // nothing was discarded by ConvertToStatic()
+  is_static = false;
+}
+
+long conc_hash_db::InsertState(const int* s, int np)
+{
+  bool is_new;
+  return InsertNewState(s, np, is_new);
+}
+
+long conc_hash_db::InsertNewState(const int* s, int np, bool &is_new)
+{
+  long bytes;
+  unsigned long hash;
+  const unsigned char* raw = states->Encode(s, np, bytes, hash);
+  long rec = -1;
+  long index;
+  is_new = false;
+  if (is_static) {
+    if (!search(current.load(), raw, bytes, hash, 0, index, is_new)) {
+      index = -1;
+    }
+    if (index < 0) throw StateLib::error(StateLib::error::Static);
+    return index;
+  }
+  for (;;) {
+    table* t = current.load(std::memory_order_acquire);
+    if (search(t, raw, bytes, hash, &rec, index, is_new)) return index;
+  }
+}
+
+bool conc_hash_db::IsConcurrent() const
+{
+  return true;
+}
+
+long conc_hash_db::ReadySize() const
+{
+  // Indexes below the next one are complete; see conc_coll::Publish().
+  return states->Committed();
+}
+
+long conc_hash_db::FindState(const int* s, int np)
+{
+  long bytes;
+  unsigned long hash;
+  const unsigned char* raw = states->Encode(s, np, bytes, hash);
+  long index;
+  bool added;
+  for (;;) {
+    table* t = current.load(std::memory_order_acquire);
+    if (search(t, raw, bytes, hash, 0, index, added)) return index;
+  }
+}
+
+const StateLib::state_coll* conc_hash_db::GetStateCollection() const
+{
+  return states;
+}
+
+StateLib::state_coll* conc_hash_db::TakeStateCollection()
+{
+  StateLib::state_coll* ans = states;
+  states = new conc_coll(ans->StateSizesAreStored());
+  reset();
+  num_states = 0;
+  return ans;
+}
+
+long conc_hash_db::ReportMemTotal() const
+{
+  long memsize = 0;
+  for (const table* t = current.load(); t; t=t->older) {
+    memsize += t->size() * sizeof(long);
+  }
+  if (states) memsize += states->ReportMemTotal();
+  return memsize;
+}
+
+long conc_hash_db::GetStateKnown(long index, int* state, int size) const
+{
+  return states->GetStateKnown(index, state, size);
+}
+
+int conc_hash_db::GetStateUnknown(long index, int* state, int size) const
+{
+  return states->GetStateUnknown(index, state, size);
+}
+
+const unsigned char* conc_hash_db::GetRawState(long index, long &bytes) const
+{
+  return states->GetRawState(index, bytes);
+}
+
+void conc_hash_db::DumpDot(FILE* out)
+{
+  const table* t = current.load();
+  fprintf(out, "digraph hash {\n\trankdir=LR;\n");
+  fprintf(out, "\tnode [shape=record, width=.1, height=.1];\n\n");
+  fprintf(out, "\ttable [label = \"<f0>0");
+  for (long i=1; i<t->size(); i++) {
+    fprintf(out, "|<f%ld>%ld", i, i);
+  }
+  fprintf(out, "\"];\n\n\tnode [width=0.5];\n");
+  for (long i=0; i<num_states; i++) {
+    fprintf(out, "\tnode%ld [label= \"<n> %ld\"];\n", i, i);
+  }
+  fprintf(out, "\n");
+
+  for (long i=0; i<t->size(); i++) {
+    long v = t->slot[i].load();
+    if (v<=0) continue;
+    fprintf(out, "\ttable:f%ld -> node%ld:n;\n", i, states->Publish(v-1));
+  }
+  fprintf(out, "\n}\n");
+}
+
+bool conc_hash_db::search(table* t, const unsigned char* raw, long bytes,
+  unsigned long hash, long* rec, long &index, bool &added)
+{
+  if (t->next.load(std::memory_order_acquire)) {
+    migrate(t);
+    return false;
+  }
+  long h = hash & t->mask();
+  for (;;) {
+    long v = t->slot[h].load(std::memory_order_acquire);
+    if (v < 0) {
+      // slot moved, so the table is being replaced
+      migrate(t);
+      return false;
+    }
+    if (0==v) {
+      // not found
+      if (0==rec) {
+        index = -1;
+        return true;
+      }
+      if (*rec < 0) *rec = states->Store(raw, bytes, hash);
+      if (!t->slot[h].compare_exchange_strong(v, *rec+1)) {
+        // someone else got the slot; look at it again
+        continue;
+      }
+      index = states->Publish(*rec);
+      added = true;
+      long ns = __atomic_add_fetch(&num_states, 1, __ATOMIC_ACQ_REL);
+      if (ns > t->size()/2) grow(t);
+      return true;
+    }
+    if (states->Matches(v-1, raw, bytes, hash)) {
+      // found; if it was just added by another thread,
+      // help it get its index.
+      index = states->Publish(v-1);
+      return true;
+    }
+    h = (h+1) & t->mask();
+  } // infinite loop
+}
+
+void conc_hash_db::grow(table* t)
+{
+  if (t->next.load(std::memory_order_acquire)) return;
+  table* bigger = new table(t->bits+1, t);
+  table* none = 0;
+  if (!t->next.compare_exchange_strong(none, bigger)) {
+    // someone else is already growing the table
+    bigger->older = 0;
+    delete bigger;
+    return;
+  }
+  migrate(t);
+}
+
+void conc_hash_db::migrate(table* t)
+{
+  table* n = t->next.load(std::memory_order_acquire);
+  DCASSERT(n);
+  const long blocks = t->numBlocks();
+  const long per_block = t->size() / blocks;
+  for (;;) {
+    long b = t->claimed.fetch_add(1);
+    if (b >= blocks) break;
+    for (long i=b*per_block; i<(b+1)*per_block; i++) {
+      moveSlot(t, n, i);
+    }
+    t->done[b].store(true, std::memory_order_release);
+    t->moved.fetch_add(1);
+  } // for blocks
+
+  // Rather than wait for other threads to finish their blocks,
+  // move whatever they have not moved yet.
+  if (t->moved.load(std::memory_order_acquire) < blocks) {
+    for (long b=0; b<blocks; b++) {
+      if (t->done[b].load(std::memory_order_acquire)) continue;
+      for (long i=b*per_block; i<(b+1)*per_block; i++) {
+        moveSlot(t, n, i);
+      }
+      t->done[b].store(true, std::memory_order_release);
+    }
+  }
+  current.compare_exchange_strong(t, n);
+}
+
+void conc_hash_db::moveSlot(table* t, table* n, long i)
+{
+  // mark the slot as moved
+  long v = t->slot[i].load(std::memory_order_acquire);
+  while (v >= 0 && !t->slot[i].compare_exchange_weak(v, v | MOVED));
+  v &= ~MOVED;
+  if (0==v) return;
+  // Add to the new table, unless someone moving the same slot
+  // got there first; nobody adds new states to the new table
+  // until every slot is moved, so there are no other duplicates.
+  long h = states->RecordHash(v-1) & n->mask();
+  for (;;) {
+    long w = 0;
+    if (n->slot[h].compare_exchange_strong(w, v)) return;
+    if (w == v) return;
+    h = (h+1) & n->mask();
+  }
+}
+
+void conc_hash_db::reset()
+{
+  delete current.load();
+  current = new table(MIN_BITS, 0);
+}
+
+void conc_hash_db::dropOlderTables()
+{
+  table* t = current.load();
+  delete t->older;
+  t->older = 0;
+}
@@ -0,0 +1,147 @@
+
+#ifndef CONC_HASH_DB_H
+#define CONC_HASH_DB_H
+
+#include <stdio.h>
+#include <limits.h>
+#include <atomic>
+#include "conc_coll.h"
+
+// ======================================================================
+// |                                                                    |
+// |                       Concurrent hash tables                       |
+// |                                                                    |
+// ======================================================================
+
+/** Hash table that allows simultaneous insertions and searches.
+
+    Open addressing with linear probing; each table slot holds
+    (1 + record handle) of a state in a conc_coll, or 0 if empty.
+    Slots are claimed with compare-and-swap, and no thread ever
+    waits for another: a search that finds a state whose inserting
+    thread has not yet given it an index finishes the job
+    (see conc_coll::Publish()).
+
+    When the table becomes half full, a table twice as large is
+    attached to it, and every thread that touches the old table
+    helps to move its entries, one block of slots at a time;
+    moved slots are marked so that nothing else can be added to them.
+    A thread that runs out of blocks to claim while others are still
+    moving theirs moves any remaining slots itself (moving a slot
+    twice is harmless), and then makes the new table current.
+    Old tables are kept (they are at most as large as the current one)
+    until the database is cleared or destroyed, since other threads
+    might still be looking at them.
+
+    InsertState(), InsertNewState() and FindState() may be called
+    simultaneously from any number of threads, as may ReadySize()
+    and the (const) state retrieval methods for states whose index
+    is known.  All other methods, including Size(), should be called
+    only when there are no insertions in progress.
+
+    The table is also the search structure in static mode, so
+    converting only changes whether new states may be inserted.
+    With tightening, converting to static releases the replaced
+    tables and any unused state storage.
+*/
+class conc_hash_db : public StateLib::state_db {
+  struct table {
+    int bits;
+    std::atomic <long>* slot;
+    /// Number of blocks claimed for moving.
+    std::atomic <long> claimed;
+    /// Number of blocks moved.
+    std::atomic <long> moved;
+    /// Has each block been moved.
+    std::atomic <bool>* done;
+    /// Larger table, if we are being replaced.
+    std::atomic <table*> next;
+    /// Previous (smaller) table.
+    table* older;
+
+    table(int b, table* old);
+    ~table();
+
+    inline long size() const {
+      return ((long)1) << bits;
+    }
+    inline long numBlocks() const {
+      return (bits > BLOCK_BITS) ? (((long)1) << (bits - BLOCK_BITS)) : 1;
+    }
+    inline long mask() const {
+      return size()-1;
+    }
+  };
+
+  /// Slots are moved in blocks of 2^BLOCK_BITS.
+  static const int BLOCK_BITS = 10;
+  /// Initial table size is 2^MIN_BITS.
+  static const int MIN_BITS = 10;
+  /// Marks a slot that has been moved to the next table.
+  static const long MOVED = LONG_MIN;
+
+  conc_coll* states;
+  std::atomic <table*> current;
+public:
+  conc_hash_db(bool storesize);
+  virtual ~conc_hash_db();
+
+  virtual void SetMaximumStackSize(long max_stack);
+  virtual long GetMaximumStackSize() const;
+
+  virtual void Clear();
+  virtual void ConvertToStatic(bool);
+  virtual void ConvertToDynamic(bool);
+  virtual long InsertState(const int* state, int size);
+  virtual long FindState(const int* state, int size);
+  virtual bool IsConcurrent() const;
+  virtual long InsertNewState(const int* state, int size, bool &is_new);
+  virtual long ReadySize() const;
+  virtual const StateLib::state_coll* GetStateCollection() const;
+  virtual StateLib::state_coll* TakeStateCollection();
+  virtual long ReportMemTotal() const;
+
+  virtual long  GetStateKnown(long index, int* state, int size) const;
+  virtual int GetStateUnknown(long index, int* state, int size) const;
+  virtual const unsigned char* GetRawState(long hndl, long &bytes) const;
+
+  virtual void DumpDot(FILE*);
+
+protected:
+  /** Search for a state in a table, and add it if requested.
+
+        @param  t       Table to search.
+        @param  raw     Encoded state.
+        @param  bytes   Size of the encoding.
+        @param  hash    Hash of the encoding.
+        @param  rec     If non-null, we are inserting: the record
+                        handle for the state, or -1 if the state has
+                        not been stored yet.  Updated if we store it.
+        @param  index   (Output) index of the state, or -1 if not found.
+        @param  added   (Output) set to true if we stored the state;
+                        unchanged otherwise.
+
+        @return   false, if the table is being replaced and
+                  the search must be repeated in the current table;
+                  true, otherwise.
+  */
+  bool search(table* t, const unsigned char* raw, long bytes,
+    unsigned long hash, long* rec, long &index, bool &added);
+
+  /// Start replacing a table with one twice as large.
+  void grow(table* t);
+
+  /// Help move the entries of a table into its replacement.
+  void migrate(table* t);
+
+  /// Move slot i of table t into its replacement n, if not yet done.
+  void moveSlot(table* t, table* n, long i);
+
+  /// Reset to a single empty table.
+  void reset();
+
+  /// Release the tables that have been replaced.
+  void dropOlderTables();
+};
+
+#endif
@@ -0,0 +1,422 @@
+
+/*
+  Throughput test of state databases:
+  generates the reachable markings of a Petri net,
+  read from a (simple) .pn file, and reports the time required.
+
+  Markings are explored breadth first, one level at a time;
+  with the concurrent hash table, each level is explored
+  by several threads at once.
+*/
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include "statelib.h"
+#include "timerlib.h"
+
+using namespace StateLib;
+
+// ======================================================================
+// |                                                                    |
+// |                         Petri net  reader                          |
+// |                                                                    |
+// ======================================================================
+
+struct arc {
+  int place;
+  // Cardinality: constant if by_place < 0,
+  // otherwise the number of tokens in place by_place.
+  int card;
+  int by_place;
+
+  inline int cardinality(const int* m) const {
+    return (by_place < 0) ? card : m[by_place];
+  }
+};
+
+struct transition {
+  std::string name;
+  bool immediate;
+  std::vector <arc> inputs;
+  std::vector <arc> outputs;
+  std::vector <arc> inhibitors;
+};
+
+struct petri_net {
+  std::vector <std::string> places;
+  std::vector <int> initial;
+  std::vector <transition> trans;
+
+  int findPlace(const std::string &n) const {
+    for (unsigned i=0; i<places.size(); i++) if (places[i] == n) return i;
+    return -1;
+  }
+  int findTrans(const std::string &n) const {
+    for (unsigned i=0; i<trans.size(); i++) if (trans[i].name == n) return i;
+    return -1;
+  }
+
+  inline bool enabled(int t, const int* m) const {
+    const transition &tr = trans[t];
+    for (unsigned a=0; a<tr.inputs.size(); a++) {
+      if (m[tr.inputs[a].place] < tr.inputs[a].cardinality(m)) return false;
+    }
+    for (unsigned a=0; a<tr.inhibitors.size(); a++) {
+      if (m[tr.inhibitors[a].place] >= tr.inhibitors[a].cardinality(m)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  inline void fire(int t, const int* m, int* next) const {
+    const transition &tr = trans[t];
+    for (unsigned p=0; p<places.size(); p++) next[p] = m[p];
+    for (unsigned a=0; a<tr.inputs.size(); a++) {
+      next[tr.inputs[a].place] -= tr.inputs[a].cardinality(m);
+    }
+    for (unsigned a=0; a<tr.outputs.size(); a++) {
+      next[tr.outputs[a].place] += tr.outputs[a].cardinality(m);
+    }
+  }
+
+  inline bool vanishing(const int* m) const {
+    for (unsigned t=0; t<trans.size(); t++) {
+      if (trans[t].immediate && enabled(t, m)) return true;
+    }
+    return false;
+  }
+};
+
+class pn_reader {
+  FILE* in;
+  const char* filename;
+  std::string token;
+  int line;
+public:
+  pn_reader(FILE* f, const char* fn) {
+    in = f;
+    filename = fn;
+    line = 1;
+    next();
+  }
+
+  bool read(petri_net &pn);
+
+protected:
+  void next();
+  bool error(const char* what) {
+    fprintf(stderr, "%s line %d: %s, near `%s'\n",
+      filename, line, what, token.c_str());
+    return false;
+  }
+  bool expect(const char* t) {
+    if (token != t) return error("unexpected token");
+    next();
+    return true;
+  }
+  bool readNames(std::vector <std::string> &names);
+  bool readCard(const petri_net &pn, arc &a);
+};
+
+void pn_reader::next()
+{
+  token.clear();
+  int c;
+  // skip whitespace and comments
+  for (;;) {
+    c = fgetc(in);
+    if ('\n' == c) line++;
+    if (isspace(c)) continue;
+    if ('#' != c) break;
+    while ((c != '\n') && (c != EOF)) c = fgetc(in);
+    line++;
+  }
+  if (EOF == c) return;
+  if (isalnum(c) || ('_' == c)) {
+    while (isalnum(c) || ('_' == c)) {
+      token.push_back(char(c));
+      c = fgetc(in);
+    }
+    ungetc(c, in);
+    return;
+  }
+  token.push_back(char(c));
+}
+
+bool pn_reader::readNames(std::vector <std::string> &names)
+{
+  for (;;) {
+    names.push_back(token);
+    next();
+    if (token == ";") {
+      next();
+      return true;
+    }
+    if (!expect(",")) return false;
+  }
+}
+
+bool pn_reader::readCard(const petri_net &pn, arc &a)
+{
+  a.card = 1;
+  a.by_place = -1;
+  if (token != ":") return true;
+  next();
+  if (isdigit(token[0])) {
+    a.card = atoi(token.c_str());
+  } else {
+    a.by_place = pn.findPlace(token);
+    if (a.by_place < 0) return error("unknown place");
+  }
+  next();
+  return true;
+}
+
+bool pn_reader::read(petri_net &pn)
+{
+  if (!expect("PN")) return false;
+  for (;;) {
+    if (token == "END") return true;
+
+    if (token == "PLACES") {
+      next();
+      if (!readNames(pn.places)) return false;
+      pn.initial.resize(pn.places.size(), 0);
+      continue;
+    }
+
+    if ((token == "TRANS") || (token == "IMMEDIATE")) {
+      bool imm = (token == "IMMEDIATE");
+      next();
+      std::vector <std::string> names;
+      if (!readNames(names)) return false;
+      for (unsigned i=0; i<names.size(); i++) {
+        transition t;
+        t.name = names[i];
+        t.immediate = imm;
+        pn.trans.push_back(t);
+      }
+      continue;
+    }
+
+    if (token == "BOUNDS") {
+      // ignored
+      while (token != ";") {
+        if (token.empty()) return error("unexpected end of file");
+        next();
+      }
+      next();
+      continue;
+    }
+
+    if (token == "INIT") {
+      next();
+      for (;;) {
+        int p = pn.findPlace(token);
+        if (p<0) return error("unknown place");
+        next();
+        if (!expect(":")) return false;
+        pn.initial[p] = atoi(token.c_str());
+        next();
+        if (token == ";") break;
+        if (!expect(",")) return false;
+      }
+      next();
+      continue;
+    }
+
+    if ((token == "ARCS") || (token == "INHIBITORS")) {
+      bool inh = (token == "INHIBITORS");
+      next();
+      for (;;) {
+        std::string from = token;
+        next();
+        if (!expect(":")) return false;
+        std::string to = token;
+        next();
+        arc a;
+        int t;
+        a.place = pn.findPlace(from);
+        if (a.place >= 0) {
+          t = pn.findTrans(to);
+          if (t<0) return error("unknown transition");
+          if (!readCard(pn, a)) return false;
+          if (inh)  pn.trans[t].inhibitors.push_back(a);
+          else      pn.trans[t].inputs.push_back(a);
+        } else {
+          if (inh) return error("inhibitor arcs must start at places");
+          t = pn.findTrans(from);
+          a.place = pn.findPlace(to);
+          if ((t<0) || (a.place<0)) return error("unknown place or transition");
+          if (!readCard(pn, a)) return false;
+          pn.trans[t].outputs.push_back(a);
+        }
+        if (token == ";") break;
+        if (!expect(",")) return false;
+      }
+      next();
+      continue;
+    }
+
+    return error("unsupported section");
+  }
+}
+
+// ======================================================================
+// |                                                                    |
+// |                             Generation                             |
+// |                                                                    |
+// ======================================================================
+
+/*
+  Explore the states with indexes lo, ..., hi-1.
+  Several threads may be doing this at once.
+*/
+void Explore(const petri_net &pn, state_db* rs, long lo, long hi,
+  std::atomic <long> *claim, std::atomic <long> *tangible)
+{
+  const int np = pn.places.size();
+  int* curr = new int[np];
+  int* next = new int[np];
+  long tcount = 0;
+  for (;;) {
+    long i = claim->fetch_add(1);
+    if (i >= hi) break;
+    rs->GetStateKnown(i, curr, np);
+    bool van = pn.vanishing(curr);
+    if (!van) tcount++;
+    for (unsigned t=0; t<pn.trans.size(); t++) {
+      if (pn.trans[t].immediate != van) continue;
+      if (!pn.enabled(t, curr)) continue;
+      pn.fire(t, curr, next);
+      rs->InsertState(next, np);
+    }
+  }
+  tangible->fetch_add(tcount);
+  delete[] curr;
+  delete[] next;
+}
+
+int Usage(char* name)
+{
+  printf("\nUsage: %s [-c|-d|-r|-s|-t] [-p threads] file.pn ...\n", name);
+  puts("\nState database throughput test: generates the reachable markings");
+  puts("of each Petri net.");
+  puts("\nOptions:");
+  puts("\t-c:\tUse concurrent hash table");
+  puts("\t-d:\tUse hash table with states on disk");
+  puts("\t-r:\tUse red-black tree");
+  puts("\t-s:\tUse splay tree");
+  puts("\t-t:\tUse hash table (default)\n");
+  puts("\t-p n:\tUse n threads (concurrent hash table only)\n");
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  fputs(LibraryVersion(), stderr);
+  fputc('\n', stderr);
+  state_db_type which = SDBT_Hash;
+  int threads = 1;
+  char* name = argv[0];
+  int ch;
+  for (;;) {
+    ch = getopt(argc, argv, "cdrstp:");
+    if (ch<0) break;
+    switch (ch) {
+      case 'c':
+        which = SDBT_ConcurrentHash;
+        break;
+      case 'd':
+        which = SDBT_DiskHash;
+        break;
+      case 'r':
+        which = SDBT_RedBlack;
+        break;
+      case 's':
+        which = SDBT_Splay;
+        break;
+      case 't':
+        which = SDBT_Hash;
+        break;
+      case 'p':
+        threads = atoi(optarg);
+        break;
+      default:
+        return Usage(name);
+    } // switch
+  } // for
+  if (optind >= argc) return Usage(name);
+  if (threads < 1) threads = 1;
+  if (which != SDBT_ConcurrentHash) threads = 1;
+
+  switch(which) {
+    case SDBT_RedBlack:         printf("Using red-black tree\n");  break;
+    case SDBT_Splay:            printf("Using splay tree\n");    break;
+    case SDBT_Hash:             printf("Using hash table\n");    break;
+    case SDBT_ConcurrentHash:   printf("Using concurrent hash table, %d threads\n", threads);    break;
+    case SDBT_DiskHash:         printf("Using hash table with states on disk\n");    break;
+    default:                    printf("Using unknown data structure\n");
+  }
+
+  for (int f=optind; f<argc; f++) {
+    FILE* in = fopen(argv[f], "r");
+    if (0==in) {
+      printf("Couldn't open file %s\n", argv[f]);
+      return 1;
+    }
+    petri_net pn;
+    pn_reader reader(in, argv[f]);
+    bool ok = reader.read(pn);
+    fclose(in);
+    if (!ok) return 1;
+
+    state_db* rs = CreateStateDB(which, true, false);
+    if (0==rs) {
+      printf("NULL database\n");
+      return 1;
+    }
+
+    printf("%-20s", argv[f]);
+    fflush(stdout);
+    timer watch;
+    std::atomic <long> tangible(0);
+    try {
+      rs->InsertState(pn.initial.data(), pn.places.size());
+      long lo = 0;
+      long hi = rs->Size();
+      while (lo < hi) {
+        std::atomic <long> claim(lo);
+        std::vector <std::thread> workers;
+        for (int w=1; w<threads; w++) {
+          workers.push_back(
+            std::thread(Explore, std::cref(pn), rs, lo, hi, &claim, &tangible)
+          );
+        }
+        Explore(pn, rs, lo, hi, &claim, &tangible);
+        for (unsigned w=0; w<workers.size(); w++) workers[w].join();
+        lo = hi;
+        hi = rs->Size();
+      }
+    }
+    catch (StateLib::error e) {
+      printf("\n\t%s\n", e.getName());
+      return 1;
+    }
+    double secs = watch.elapsed_seconds();
+    printf(" %10ld states %10ld tangible %9.3lf seconds",
+      rs->Size(), tangible.load(), secs);
+    if (secs > 0) printf(" %12.0lf states/sec", rs->Size() / secs);
+    printf(" %12ld bytes\n", rs->ReportMemTotal());
+    delete rs;
+  }
+  return 0;
+}
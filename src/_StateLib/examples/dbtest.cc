@@ -27,11 +27,13 @@ void PrintState(FILE* out, int* state, int size)
 
 int Usage(char* name)
 {
-  printf("\nUsage: %s [-h|-i] [-r|-s|-t]\n", name);
+  printf("\nUsage: %s [-h|-i] [-c|-d|-r|-s|-t]\n", name);
   puts("\nDatabase testing utility.");
   puts("\nOptions:");
   puts("\t-h:\tUse handles to identify states");
   puts("\t-i:\tUse indexes to identify states (default)\n");
+  puts("\t-c:\tUse concurrent hash table");
+  puts("\t-d:\tUse hash table with states on disk");
   puts("\t-r:\tUse red-black tree");
   puts("\t-s:\tUse splay tree (default)");
   puts("\t-t:\tUse hash table\n");
@@ -47,7 +49,7 @@ int main(int argc, char** argv)
   char* name = argv[0];
   int ch;
   for (;;) {
-    ch = getopt(argc, argv, "hirst");
+    ch = getopt(argc, argv, "cdhirst");
     if (ch<0) break;
     switch (ch) {
       case 'h':
@@ -56,6 +58,12 @@ int main(int argc, char** argv)
       case 'i':
         use_index = true;
         break;
+      case 'c':
+        which = SDBT_ConcurrentHash;
+        break;
+      case 'd':
+        which = SDBT_DiskHash;
+        break;
       case 'r':
         which = SDBT_RedBlack;
         break;
@@ -79,6 +87,10 @@ int main(int argc, char** argv)
     case SDBT_RedBlack:   fprintf(stderr, "Using red-black tree ");  break;
     case SDBT_Splay:      fprintf(stderr, "Using splay tree ");    break;
     case SDBT_Hash:       fprintf(stderr, "Using hash table ");    break;
+    case SDBT_ConcurrentHash:
+                          fprintf(stderr, "Using concurrent hash table ");
+                          break;
+    case SDBT_DiskHash:   fprintf(stderr, "Using disk hash table ");    break;
     default:              fprintf(stderr, "Using unknown data structure ");
   }
   if (use_index)  fprintf(stderr, "with indexes\n"); 
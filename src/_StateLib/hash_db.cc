@@ -10,9 +10,16 @@
 // *                                                                *
 // ******************************************************************
 
-hash_db::hash_db(bool indexed, bool storesize) : state_db()
+hash_db::hash_db(bool indexed, bool storesize)
+  : hash_db(new main_coll(indexed, storesize))
 {
-  states = new main_coll(indexed, storesize);
+}
+
+hash_db::hash_db(main_coll* coll) : state_db()
+{
+  states = coll;
+  DCASSERT(states);
+  bool indexed = states->StateHandlesAreIndexes();
 
   hash_bits = 4;
   table = (long*) malloc (size()*sizeof(long));
@@ -82,7 +89,7 @@ const StateLib::state_coll* hash_db::GetStateCollection() const
 StateLib::state_coll* hash_db::TakeStateCollection()
 {
   StateLib::state_coll* ans = states;
-  states = new main_coll(0==index2handle, ans->StateSizesAreStored());
+  states = states->NewCollection();
   num_states = 0;
   return ans;
 }
@@ -157,6 +164,11 @@ hash_index_db::hash_index_db(bool storesize) : hash_db(true, storesize)
 {
 }
 
+hash_index_db::hash_index_db(main_coll* coll) : hash_db(coll)
+{
+  DCASSERT(coll->StateHandlesAreIndexes());
+}
+
 hash_index_db::~hash_index_db()
 {
 }
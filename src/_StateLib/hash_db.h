@@ -28,6 +28,8 @@ protected:
   int hash_bits;
 public:
   hash_db(bool indexed, bool storesize);
+  /// Use the given (empty) collection to store states.
+  hash_db(main_coll* coll);
   virtual ~hash_db();
 
   virtual void SetMaximumStackSize(long max_stack);
@@ -63,6 +65,7 @@ protected:
 class hash_index_db : public hash_db {
 public:
   hash_index_db(bool storesize);
+  hash_index_db(main_coll* coll);
   virtual ~hash_index_db();
 
   virtual long InsertState(const int* state, int size);
@@ -0,0 +1,99 @@
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "mmap_coll.h"
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H) && defined(HAVE_UNISTD_H)
+#define USE_MMAP
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+// ******************************************************************
+// *                      mmap_coll  methods                        *
+// ******************************************************************
+
+mmap_coll::mmap_coll(bool use_indices, bool use_sizes)
+ : main_coll(use_indices, use_sizes)
+{
+  // we don't use the base class memory
+  free(mem);
+  mem = 0;
+  memsize = 0;
+  fd = -1;
+
+#ifdef USE_MMAP
+  const char* dir = getenv("TMPDIR");
+  if (0==dir || 0==dir[0]) dir = "/tmp";
+  long len = strlen(dir) + 20;
+  char* name = (char*) malloc(len);
+  if (0==name) throw StateLib::error(StateLib::error::NoMemory);
+  snprintf(name, len, "%s/statesXXXXXX", dir);
+  fd = mkstemp(name);
+  if (fd >= 0) unlink(name);
+  free(name);
+  if (fd < 0) throw StateLib::error(StateLib::error::NoMemory);
+
+  EnlargeMem(1);
+#else
+  throw StateLib::error(StateLib::error::NotImplemented);
+#endif
+}
+
+mmap_coll::~mmap_coll()
+{
+#ifdef USE_MMAP
+  if (mem) munmap(mem, memsize);
+  if (fd >= 0) close(fd);
+#endif
+  // Don't let the base class free() this
+  mem = 0;
+}
+
+void mmap_coll::EnlargeMem(long newsize)
+{
+  if (newsize < 0) {
+    throw StateLib::error(StateLib::error::NoMemory);
+  }
+  if (newsize<memsize)   return;   // easy success
+#ifdef USE_MMAP
+  long newmemsize = memsize ? memsize : INITIAL_MAP;
+  while (newsize>=newmemsize) {
+    newmemsize *= 2;
+    if (newmemsize <= 0) throw StateLib::error(StateLib::error::NoMemory);
+  }
+  // Grow the file; new space reads as zeroes, and is not
+  // actually allocated on disk until written.
+  if (ftruncate(fd, newmemsize)) {
+    throw StateLib::error(StateLib::error::NoMemory);
+  }
+  if (mem) munmap(mem, memsize);
+  void* nmem = mmap(0, newmemsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (MAP_FAILED == nmem) {
+    mem = 0;
+    memsize = 0;
+    throw StateLib::error(StateLib::error::NoMemory);
+  }
+  mem = (unsigned char*) nmem;
+  memsize = newmemsize;
+#else
+  throw StateLib::error(StateLib::error::NotImplemented);
+#endif
+}
+
+main_coll* mmap_coll::NewCollection() const
+{
+  return new mmap_coll(StateHandlesAreIndexes(), StateSizesAreStored());
+}
+
+bool mmap_coll::IsSupported()
+{
+#ifdef USE_MMAP
+  return true;
+#else
+  return false;
+#endif
+}
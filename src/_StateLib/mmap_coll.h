@@ -0,0 +1,48 @@
+
+#ifndef MMAP_COLL_H
+#define MMAP_COLL_H
+
+#include "coll.h"
+
+// ******************************************************************
+// *                                                                *
+// *                       mmap_coll  class                         *
+// *                                                                *
+// ******************************************************************
+
+/** Disk-backed version of main_coll.
+
+    The encoded states are kept in an append-only temporary file,
+    which is mapped into memory; only the (compact) index to handle
+    mapping stays in RAM.  The operating system decides which
+    portions of the file are resident, so collections much larger
+    than physical memory can be built, at reduced speed.
+
+    The file is created in the directory given by environment
+    variable TMPDIR, or in /tmp, and is removed immediately
+    (so it disappears when the collection is destroyed,
+    or if the program exits).
+*/
+class mmap_coll : public main_coll {
+  /// File descriptor of the backing file.
+  int fd;
+public:
+  /** Constructor.
+      Throws an error if the backing file cannot be created,
+      or if memory mapped files are not supported.
+  */
+  mmap_coll(bool use_indices, bool use_sizes);
+  virtual ~mmap_coll();
+
+  virtual void EnlargeMem(long newsize);
+  virtual main_coll* NewCollection() const;
+
+  /// Are memory mapped files supported on this platform?
+  static bool IsSupported();
+
+private:
+  /// Initial size of the mapping; the file itself is sparse.
+  static const long INITIAL_MAP = 1L << 24;
+};
+
+#endif
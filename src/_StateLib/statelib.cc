@@ -7,6 +7,8 @@
 #include "splaydb.h"
 #include "rb_db.h"
 #include "hash_db.h"
+#include "conc_hash_db.h"
+#include "mmap_coll.h"
 
 const int MAJOR_VERSION = 2;  // interface changes
 const int MINOR_VERSION = 0;  // (significant) backend algorithm changes
@@ -72,6 +74,24 @@ long* StateLib::state_db::TakeIndexMap()
   return answer;
 }
 
+bool StateLib::state_db::IsConcurrent() const
+{
+  return false;
+}
+
+long StateLib::state_db::InsertNewState(const int* s, int np, bool &is_new)
+{
+  long oldsize = num_states;
+  long index = InsertState(s, np);
+  is_new = (index >= oldsize);
+  return index;
+}
+
+long StateLib::state_db::ReadySize() const
+{
+  return num_states;
+}
+
 // ******************************************************************
 // *                                                                *
 // *                       frontend functions                       *
@@ -110,6 +130,20 @@ StateLib::CreateStateDB(state_db_type which, bool useindices, bool storesize)
         if (useindices)   return new hash_index_db(storesize);
         return NULL;
 
+    case SDBT_ConcurrentHash:
+        if (useindices)   return new conc_hash_db(storesize);
+        return NULL;
+
+    case SDBT_DiskHash:
+        if (!useindices)                  return NULL;
+        if (!mmap_coll::IsSupported())    return NULL;
+        try {
+          return new hash_index_db(new mmap_coll(true, storesize));
+        }
+        catch (StateLib::error) {
+          return NULL;
+        }
+
   }
   return NULL;
 }
@@ -420,6 +420,33 @@ namespace StateLib {
     */
     virtual long FindState(const int* state, int size) = 0;
 
+    /** Can InsertState(), InsertNewState(), FindState(),
+        and the state retrieval methods for known indexes,
+        be called simultaneously from several threads?
+        The default is no.
+    */
+    virtual bool IsConcurrent() const;
+
+    /** Unique insertion that also reports if the state was added.
+        For concurrent databases, when several threads insert
+        the same state, exactly one of them sees \a is_new.
+        The default uses InsertState() and the database size.
+
+          @param  state   The state to insert.
+          @param  size    The size of the state.
+          @param  is_new  (Output) true iff the state was not present.
+
+          @return   The index of the inserted (or existing) state.
+    */
+    virtual long InsertNewState(const int* state, int size, bool &is_new);
+
+    /** Number of states that may be retrieved by index,
+        while insertions may be in progress in other threads.
+        States 0, ..., ReadySize()-1 are complete.
+        The default is Size().
+    */
+    virtual long ReadySize() const;
+
 
     /** Fill in a state with known size.
         Calls method of the same name for the database's underlying
@@ -545,7 +572,17 @@ namespace StateLib {
   enum state_db_type {
     SDBT_Splay,
     SDBT_RedBlack,
-    SDBT_Hash
+    SDBT_Hash,
+    /** Hash table that allows simultaneous InsertState()
+        and FindState() calls from multiple threads.
+        Requires indices.
+    */
+    SDBT_ConcurrentHash,
+    /** Hash table, with the states stored in a memory-mapped
+        temporary file instead of main memory.
+        Requires indices.
+    */
+    SDBT_DiskHash
   };
 
 
@@ -5,6 +5,8 @@
 #include "defines.h"
 #include "../Streams/streams.h"
 
+#include <atomic>
+
 // #define DEBUG_LINKCOUNTS
 // #define DISPLAY_LINKCOUNTS
 
@@ -26,13 +28,26 @@
     In particular, this is used for all computed results
     of expressions, except for the basic types of BOOL,
     INT, and REAL (for speed).
+
+    The link count is atomic, because expressions are evaluated
+    by several threads at once (e.g., multi-threaded process
+    generation, Monte Carlo simulation), and they share and
+    delete the same objects.
 */
 class shared_object {
-  long linkcount;
+  std::atomic <long> linkcount;
 public:
   shared_object() {
     linkcount = 1;
   }
+  /// A copy is a new object, with a single link.
+  shared_object(const shared_object &) {
+    linkcount = 1;
+  }
+  /// Assignment copies the object, not its links.
+  shared_object& operator= (const shared_object &) {
+    return *this;
+  }
 protected:
   virtual ~shared_object() {
   }
@@ -51,7 +66,7 @@ public:
     }
 #endif
     DCASSERT(linkcount > 0);
-    linkcount++;
+    linkcount.fetch_add(1, std::memory_order_relaxed);
   }
   /** Write the object to the given stream.
         @param  s     The output stream to write to.
@@ -110,14 +125,14 @@ inline void Delete(shared_object* o)
   }
 #endif
   DCASSERT(o->linkcount>0);
-  o->linkcount--;
+  long left = o->linkcount.fetch_sub(1, std::memory_order_acq_rel) - 1;
 #ifdef DISPLAY_LINKCOUNTS
   DisplayStream cout(stderr);
-  cout << "-1 (total " << o->numRefs() << ") for object: ";
+  cout << "-1 (total " << left << ") for object: ";
   o->Print(cout, 0);
   cout << "\n";
 #endif
-  if (0==o->linkcount) {
+  if (0==left) {
 #ifndef DEBUG_LINKCOUNTS
     delete o;
 #endif